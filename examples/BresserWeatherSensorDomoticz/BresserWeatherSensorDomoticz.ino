@@ -76,6 +76,7 @@
 // 20240325 domoticz virtual rain sensor: added hourly rain rate
 // 20240504 Added board initialization
 // 20240603 Modified for arduino-esp32 v3.0.0
+// 20250507 publishWeatherdata(): payload built with field visitor and JSON writer (SensorFields.h)
 //
 // ToDo:
 //
@@ -278,6 +279,7 @@ uint32_t statusPublishPreviousMillis = 0;
 time_t now;
 
 void publishWeatherdata(void);
+void publishDomo(unsigned idx, const char *svalue);
 void mqtt_connect(void);
 
 /*!
@@ -398,59 +400,77 @@ void mqtt_connect(void)
 // {
 // }
 
+// Visitor collecting the field values of a sensor data slot (index: SensorFieldId)
+struct FieldValues
+{
+    float value[SF_NUM];
+    bool valid[SF_NUM];
+
+    template <typename F, typename T>
+    void operator()(F, T v, bool isValid)
+    {
+        value[F::id()] = v;
+        valid[F::id()] = isValid;
+    }
+};
+
+// Publish domoticz device update {"idx":<idx>,"nvalue":0,"svalue":"<svalue>"}
+void publishDomo(unsigned idx, const char *svalue)
+{
+    char domo_payload[PAYLOAD_SIZE];
+    SensorJsonWriter json(domo_payload, sizeof(domo_payload));
+
+    json.writeUInt("idx", idx);
+    json.writeUInt("nvalue", 0);
+    json.writeString("svalue", svalue);
+    json.end();
+    Serial.printf("%s: %s\n", MQTT_PUB_DOMO, domo_payload);
+    client.publish(MQTT_PUB_DOMO, domo_payload, false, 0);
+}
+
 /*!
   \brief Publish weather data as MQTT message
-
-  \param complete Indicate that entire data is complete, regardless of the flags temp_ok/wind_ok/rain_ok
-                  (which reflect only the state of the last message)
 */
 void publishWeatherdata(void)
 {
-    String domo_payload;
-    String domo2_payload;
-    String domo3_payload;
+    char svalue[64];
+    FieldValues f = {};
     int const i = 0;
 
     // ArduinoJson does not allow to set number of decimals for floating point data -
     // neither does MQTT Dashboard...
     // Therefore the JSON string is created manually.
+    visitSensorFields(weatherSensor.sensor[i], f);
 
     // domoticz virtual wind sensor
-    if (weatherSensor.sensor[i].w.wind_ok && weatherSensor.sensor[i].w.temp_ok)
+    if (f.valid[SF_WIND_DIR] && f.valid[SF_TEMP_C])
     {
-        domo_payload = String("{\"idx\":") + String(DOMO_WIND_IDX) + String(",\"nvalue\":0,\"svalue\":\"") + String(weatherSensor.sensor[i].w.wind_direction_deg, 1);
         char buf[4];
-        winddir_flt_to_str(weatherSensor.sensor[i].w.wind_direction_deg, buf);
-        domo_payload += String(";") + String(buf);
-        domo_payload += String(";") + String(weatherSensor.sensor[i].w.wind_avg_meter_sec * 10, 1);
-        domo_payload += String(";") + String(weatherSensor.sensor[i].w.wind_gust_meter_sec * 10, 1);
-        domo_payload += String(";") + String(weatherSensor.sensor[i].w.temp_c, 1);
-        domo_payload += String(";") + String(perceived_temperature(weatherSensor.sensor[i].w.temp_c, weatherSensor.sensor[i].w.wind_avg_meter_sec, weatherSensor.sensor[i].w.humidity), 1);
-        domo_payload += String("\"}");
-        Serial.printf("%s: %s\n", MQTT_PUB_DOMO, domo_payload.c_str());
-        client.publish(MQTT_PUB_DOMO, domo_payload.c_str(), false, 0);
+        winddir_flt_to_str(f.value[SF_WIND_DIR], buf);
+        snprintf(svalue, sizeof(svalue), "%.1f;%s;%.1f;%.1f;%.1f;%.1f",
+                 f.value[SF_WIND_DIR],
+                 buf,
+                 f.value[SF_WIND_AVG] * 10,
+                 f.value[SF_WIND_GUST] * 10,
+                 f.value[SF_TEMP_C],
+                 perceived_temperature(f.value[SF_TEMP_C], f.value[SF_WIND_AVG], f.value[SF_HUMIDITY]));
+        publishDomo(DOMO_WIND_IDX, svalue);
     }
 
     // domoticz virtual rain sensor
-    if (weatherSensor.sensor[i].w.rain_ok)
+    if (f.valid[SF_RAIN])
     {
         rainGauge.update(now, weatherSensor.sensor[i].w.rain_mm, weatherSensor.sensor[i].startup);
-        
-        domo2_payload = String("{\"idx\":") + String(DOMO_RAIN_IDX) + String(",\"nvalue\":0,\"svalue\":\"") + String(rainGauge.pastHour() * 100, 0);
-        domo2_payload += String(";") + String(weatherSensor.sensor[i].w.rain_mm, 1);
-        domo2_payload += String("\"}");
-        Serial.printf("%s: %s\n", MQTT_PUB_DOMO, domo2_payload.c_str());
-        client.publish(MQTT_PUB_DOMO, domo2_payload.c_str(), false, 0);
+
+        snprintf(svalue, sizeof(svalue), "%.0f;%.1f", rainGauge.pastHour() * 100, f.value[SF_RAIN]);
+        publishDomo(DOMO_RAIN_IDX, svalue);
     }
 
     // domoticz virtual temp & humidity sensor
-    if (weatherSensor.sensor[i].w.temp_ok && weatherSensor.sensor[i].w.humidity_ok)
+    if (f.valid[SF_TEMP_C] && f.valid[SF_HUMIDITY])
     {
-        domo3_payload = String("{\"idx\":") + String(DOMO_TH_IDX) + String(",\"nvalue\":0,\"svalue\":\"") + String(weatherSensor.sensor[i].w.temp_c, 1);
-        domo3_payload += String(";") + String(weatherSensor.sensor[i].w.humidity);
-        domo3_payload += String(";0\"}");
-        Serial.printf("%s: %s\n", MQTT_PUB_DOMO, domo3_payload.c_str());
-        client.publish(MQTT_PUB_DOMO, domo3_payload.c_str(), false, 0);
+        snprintf(svalue, sizeof(svalue), "%.1f;%u;0", f.value[SF_TEMP_C], (unsigned)f.value[SF_HUMIDITY]);
+        publishDomo(DOMO_TH_IDX, svalue);
     }
 }
 
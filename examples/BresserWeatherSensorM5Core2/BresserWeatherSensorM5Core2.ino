@@ -38,9 +38,18 @@
 // 20240324 Created from BresserWeatherSensorBasic.ino
 // 20240325 Fake missing degree sign with small 'o', print only weather sensor data on LCD
 // 20240504 Added board initialization
+// 20250412 Replaced full screen redraw by dirty-region rendering of cached display fields
+//          Added optional off-screen sprite (DISPLAY_USE_SPRITE) and frame time statistics
+// 20250507 Fixed temperature unit erased with "Waiting for data..." message
 //
 // Notes:
 // - The character set does not provide a degrees sign
+// - Each display field is redrawn only if its text has changed; static labels are drawn once.
+//   This avoids flicker and keeps the time spent outside of getMessage() short.
+// - Frame time statistics are printed every DISPLAY_STATS_INTERVAL frames. 'rx during redraw'
+//   counts radio packets which arrived while the display was being updated - these are at risk
+//   of being overwritten by the next packet before getMessage() can read them.
+// - Enable DISPLAY_FULL_REDRAW to get the same statistics for the previous (full screen) method.
 //
 // ToDo:
 // -
@@ -53,8 +62,174 @@
 #include "WeatherSensor.h"
 #include "InitBoard.h"
 
+// Draw into off-screen sprite and push it to the LCD in a single blit
+// (uses 150 kB of PSRAM)
+//#define DISPLAY_USE_SPRITE
+
+// Clear and redraw all fields on every update (for comparison only)
+//#define DISPLAY_FULL_REDRAW
+
+// Number of frames between frame time statistics outputs
+#define DISPLAY_STATS_INTERVAL 20
+
+// Maximum length of display field text
+#define FIELD_LEN 32
+
+// Flag set by the radio receive interrupt (see WeatherSensor.cpp)
+extern volatile bool receivedFlag;
+
 WeatherSensor ws;
 
+/*!
+ * \brief Display field layout
+ *
+ * Position and size of the rectangle which is cleared before the field is redrawn
+ */
+typedef struct {
+    int16_t x;      //!< x position
+    int16_t y;      //!< y position
+    int16_t w;      //!< width
+    int16_t h;      //!< height
+    uint8_t size;   //!< text size
+    uint16_t color; //!< text color
+} FieldLayout;
+
+/// Display fields
+enum DisplayField {
+    FLD_TEMP,
+    FLD_HUM,
+    FLD_WIND,
+    FLD_WDIR,
+    FLD_RAIN,
+    FLD_ID,
+    FLD_STATUS,
+    FLD_NUM
+};
+
+/// Pre-laid-out rectangles of all display fields
+const FieldLayout fieldLayout[FLD_NUM] = {
+    // x    y    w    h  size color
+    {  10,  40, 198, 24, 3, BLACK    }, // FLD_TEMP
+    {  10,  74, 300, 16, 2, BLACK    }, // FLD_HUM
+    {  10,  98, 300, 16, 2, BLACK    }, // FLD_WIND
+    {  10, 122, 300, 16, 2, BLACK    }, // FLD_WDIR
+    {  10, 146, 300, 16, 2, BLACK    }, // FLD_RAIN
+    {  10, 195, 300, 16, 2, DARKGREY }, // FLD_ID
+    {  10, 219, 300, 16, 2, DARKGREY }  // FLD_STATUS
+};
+
+/// Text of each field as last drawn
+char fieldCache[FLD_NUM][FIELD_LEN];
+
+#if defined(DISPLAY_USE_SPRITE)
+M5Canvas canvas(&M5.Lcd);
+lgfx::LovyanGFX *gfx = &canvas;
+#else
+lgfx::LovyanGFX *gfx = &M5.Lcd;
+#endif
+
+/// Frame time statistics
+struct {
+    uint32_t frames;      //!< number of frames
+    uint32_t fields;      //!< number of fields redrawn
+    uint32_t time_sum;    //!< sum of frame times in us
+    uint32_t time_max;    //!< maximum frame time in us
+    uint32_t rx_pending;  //!< radio packets received during redraw
+} frameStats;
+
+/*!
+ * \brief Draw static screen contents (title and units)
+ */
+void drawStatic(void)
+{
+    gfx->fillScreen(WHITE);
+    gfx->setTextSize(2);
+    gfx->setCursor(10, 10);
+    gfx->setTextColor(BLUE, WHITE);
+    gfx->printf("Weather Sensor Receiver");
+
+    // Fake degrees sign which is not available in character set :-(
+    gfx->setTextColor(BLACK, WHITE);
+    gfx->setTextSize(1);
+    gfx->setCursor(fieldLayout[FLD_TEMP].x + fieldLayout[FLD_TEMP].w, fieldLayout[FLD_TEMP].y);
+    gfx->printf("o");
+    gfx->setTextSize(3);
+    gfx->printf("C");
+}
+
+/*!
+ * \brief Draw display field if its text has changed
+ *
+ * \param field    display field
+ * \param fmt      printf() style format string
+ *
+ * \returns true if field was redrawn
+ */
+bool drawField(DisplayField field, const char *fmt, ...)
+{
+    char text[FIELD_LEN];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, FIELD_LEN, fmt, args);
+    va_end(args);
+
+    if (strcmp(text, fieldCache[field]) == 0)
+    {
+        return false;
+    }
+    strcpy(fieldCache[field], text);
+
+    const FieldLayout &fl = fieldLayout[field];
+    gfx->fillRect(fl.x, fl.y, fl.w, fl.h, WHITE);
+    gfx->setTextSize(fl.size);
+    gfx->setTextColor(fl.color, WHITE);
+    gfx->setCursor(fl.x, fl.y);
+    gfx->print(text);
+    frameStats.fields++;
+    return true;
+}
+
+/*!
+ * \brief Invalidate all cached fields - forces redraw
+ */
+void invalidateFields(void)
+{
+    for (int f = 0; f < FLD_NUM; f++)
+    {
+        fieldCache[f][0] = '\0';
+    }
+}
+
+/*!
+ * \brief Update frame time statistics and print them periodically
+ *
+ * \param t_start  start of frame in us
+ */
+void frameDone(uint32_t t_start)
+{
+    uint32_t t_frame = micros() - t_start;
+
+    frameStats.frames++;
+    frameStats.time_sum += t_frame;
+    if (t_frame > frameStats.time_max)
+    {
+        frameStats.time_max = t_frame;
+    }
+    if (receivedFlag)
+    {
+        frameStats.rx_pending++;
+    }
+    if (frameStats.frames % DISPLAY_STATS_INTERVAL == 0)
+    {
+        Serial.printf("Display: frames: %u fields: %u avg: %u us max: %u us rx during redraw: %u\n",
+                      frameStats.frames,
+                      frameStats.fields,
+                      frameStats.time_sum / frameStats.frames,
+                      frameStats.time_max,
+                      frameStats.rx_pending);
+    }
+}
+
 void setup()
 {
     Serial.begin(115200);
@@ -66,14 +241,19 @@ void setup()
     // Note: M5.begin() is called in ws.begin()
     ws.begin();
 
-    M5.Lcd.setTextSize(2);    // Set the font size
-    M5.Lcd.fillScreen(WHITE); // Set the screen background.
-    M5.Lcd.setCursor(10, 10);
-    M5.Lcd.setTextColor(BLUE); // Set the font color
-    M5.Lcd.printf("Weather Sensor Receiver");
-    M5.Lcd.setCursor(10, 30);
-    M5.Lcd.setTextColor(BLACK);
-    M5.Lcd.printf("Waiting for data...");
+#if defined(DISPLAY_USE_SPRITE)
+    canvas.setPsram(true);
+    canvas.createSprite(M5.Lcd.width(), M5.Lcd.height());
+#endif
+    drawStatic();
+    gfx->setTextSize(2);
+    gfx->setCursor(10, 40);
+    gfx->setTextColor(BLACK, WHITE);
+    gfx->printf("Waiting for data...");
+#if defined(DISPLAY_USE_SPRITE)
+    canvas.pushSprite(0, 0);
+#endif
+    invalidateFields();
 }
 
 void loop()
@@ -87,19 +267,9 @@ void loop()
     // Tries to receive radio message (non-blocking) and to decode it.
     // Timeout occurs after a small multiple of expected time-on-air.
     int decode_status = ws.getMessage();
-    uint8_t y = 10;
 
     if (decode_status == DECODE_OK)
     {
-        if ((ws.sensor[i].s_type == SENSOR_TYPE_WEATHER0) || (ws.sensor[i].s_type == SENSOR_TYPE_WEATHER1))
-        {
-            M5.Lcd.fillScreen(WHITE); // Set the screen background.
-            M5.Lcd.setCursor(10, y);
-            M5.Lcd.setTextColor(BLUE); // Set the font color
-            M5.Lcd.printf("Weather Sensor Receiver");
-            M5.Lcd.setTextColor(BLACK); // Set the font color
-        }
-
         Serial.printf("Id: [%8X] Typ: [%X] Ch: [%d] St: [%d] Bat: [%-3s] RSSI: [%6.1fdBm] ",
                       static_cast<int>(ws.sensor[i].sensor_id),
                       ws.sensor[i].s_type,
@@ -259,92 +429,70 @@ void loop()
 
             if ((ws.sensor[i].s_type == SENSOR_TYPE_WEATHER0) || (ws.sensor[i].s_type == SENSOR_TYPE_WEATHER1))
             {
-                y += 30;
-                M5.Lcd.setTextSize(3); // Set the font size
-                M5.Lcd.setCursor(10, y);
-                static float temp_c;
-                static uint8_t humidity;
-                if (ws.sensor[i].w.temp_ok)
+                static bool first_frame = true;
+                uint32_t t_start = micros();
+
+#if defined(DISPLAY_FULL_REDRAW)
+                drawStatic();
+                invalidateFields();
+#else
+                if (first_frame)
                 {
-                    M5.Lcd.printf("Temp: %5.1f", temp_c = ws.sensor[i].w.temp_c);
+                    // Remove "Waiting for data..." - it overlaps the temperature unit,
+                    // so the static contents are redrawn once
+                    drawStatic();
+                    invalidateFields();
                 }
-                else
+#endif
+                first_frame = false;
+
+                // Fields which are not contained in the current message keep their previous value
+                if (ws.sensor[i].w.temp_ok)
                 {
-                    M5.Lcd.printf("Temp: %5.1f", temp_c);
+                    drawField(FLD_TEMP, "Temp: %5.1f", ws.sensor[i].w.temp_c);
                 }
-                // Fake degrees sign which is not available in character set :-(
-                M5.Lcd.setTextSize(1);
-                M5.Lcd.printf("o");
-                M5.Lcd.setTextSize(3);
-                M5.Lcd.printf("C");
-
-                y += 34;
-                M5.Lcd.setTextSize(2);
-                M5.Lcd.setCursor(10, y);
                 if (ws.sensor[i].w.humidity_ok)
                 {
-                    M5.Lcd.printf("Hum:     %3d%% ", humidity = ws.sensor[i].w.humidity);
+                    drawField(FLD_HUM, "Hum:     %3d%% ", ws.sensor[i].w.humidity);
                 }
-                else
-                {
-                    M5.Lcd.printf("Hum:     %3d%% ", humidity);
-                }
-
-                y += 24;
-                M5.Lcd.setCursor(10, y);
                 if (ws.sensor[i].w.wind_ok)
                 {
-                    M5.Lcd.printf("Wmx: %4.1fm/s Wav: %4.1fm/s",
-                                  ws.sensor[i].w.wind_gust_meter_sec,
-                                  ws.sensor[i].w.wind_avg_meter_sec);
-
-                    y += 24;
-                    M5.Lcd.setCursor(10, y);
-                    M5.Lcd.printf("Wdir:  %5.1fdeg",
-                                  ws.sensor[i].w.wind_direction_deg);
+                    drawField(FLD_WIND, "Wmx: %4.1fm/s Wav: %4.1fm/s",
+                              ws.sensor[i].w.wind_gust_meter_sec,
+                              ws.sensor[i].w.wind_avg_meter_sec);
+                    drawField(FLD_WDIR, "Wdir:  %5.1fdeg",
+                              ws.sensor[i].w.wind_direction_deg);
                 }
                 else
                 {
-                    M5.Lcd.printf("Wmx: --.-m/s Wav: --.-m/s");
-                    y += 22;
-                    M5.Lcd.setCursor(10, y);
-                    M5.Lcd.printf("Wdir:  ---.-deg");
+                    drawField(FLD_WIND, "Wmx: --.-m/s Wav: --.-m/s");
+                    drawField(FLD_WDIR, "Wdir:  ---.-deg");
                 }
-
-                y += 24;
-                M5.Lcd.setCursor(10, y);
-                static float rain_mm;
                 if (ws.sensor[i].w.rain_ok)
                 {
-                    M5.Lcd.printf("Rain:%7.1fmm ",
-                                  rain_mm = ws.sensor[i].w.rain_mm);
-                }
-                else
-                {
-                    M5.Lcd.printf("Rain:%7.1fmm ",
-                                  rain_mm);
+                    drawField(FLD_RAIN, "Rain:%7.1fmm ", ws.sensor[i].w.rain_mm);
                 }
 
-                M5.Lcd.setTextColor(DARKGREY);
-                y = 195;
-                M5.Lcd.setCursor(10, y);
-                M5.Lcd.printf("Id: %8X Typ: %X Ch: %d",
-                              static_cast<int>(ws.sensor[i].sensor_id),
-                              ws.sensor[i].s_type,
-                              ws.sensor[i].chan);
+                drawField(FLD_ID, "Id: %8X Typ: %X Ch: %d",
+                          static_cast<int>(ws.sensor[i].sensor_id),
+                          ws.sensor[i].s_type,
+                          ws.sensor[i].chan);
 
                 static bool battery_ok;
-                y += 24;
-                M5.Lcd.setCursor(10, y);
                 if (ws.sensor[i].w.temp_ok)
                 {
                     // 6-in-1 protocol - only valid in messages containing temp
                     battery_ok = ws.sensor[i].battery_ok;
                 }
-                M5.Lcd.printf("S: %u B: %u RSSI: %6.1fdBm",
-                              ws.sensor[i].startup,
-                              battery_ok,
-                              ws.sensor[i].rssi);
+                drawField(FLD_STATUS, "S: %u B: %u RSSI: %6.1fdBm",
+                          ws.sensor[i].startup,
+                          battery_ok,
+                          ws.sensor[i].rssi);
+
+#if defined(DISPLAY_USE_SPRITE)
+                canvas.pushSprite(0, 0);
+#endif
+                frameDone(t_start);
             } // if ((ws.sensor[i].s_type == SENSOR_TYPE_WEATHER0) || (ws.sensor[i].s_type == SENSOR_TYPE_WEATHER1))
         } // weather-like sensor
 
@@ -20,6 +20,35 @@
 // The data topics are published at an interval of >DATA_INTERVAL.
 // The 'status' and the 'radio' topics are published at an interval of STATUS_INTERVAL.
 //
+// Optionally (WAKE_CYCLE_EN), the time spent in each phase of a wake cycle (boot, radio
+// initialization, reception, decoding, WiFi, MQTT, sleep entry) is accounted by WakeCycle
+// and retained in RTC RAM. A summary of the last cycle and the average of recent cycles
+// (incl. estimated charge) is published with the 'status/cycles' topic after connecting
+// to the MQTT broker.
+//
+// Optionally (MEM_STATS_EN), heap usage (free heap, largest free block, allocations) of
+// getData(), decoding, publishWeatherdata() and haAutoDiscovery() and the loop task's
+// stack high-water mark are recorded by MemStats and published with the 'status/memory' topic at an interval
+// of STATUS_INTERVAL.
+//
+// Home Assistant auto discovery messages are assembled from flash resident templates
+// (see src/mqtt_comm.cpp). The number of messages, payload size, minimum free heap and
+// duration of each discovery cycle are published with the 'status/discovery' topic.
+//
+// Optionally (NOISE_FLOOR_EN, see src/mqtt_comm.h), the RSSI noise floor is estimated from
+// samples taken between packets (NoiseFloor); frames below the adaptive RSSI threshold are
+// dropped before decoding. The noise floor, threshold margin and interference/jamming state
+// are published with the 'radio' topic.
+//
+// In sleep mode, the sensor data is retained in RTC RAM during deep sleep. This allows to
+// combine a 6-in-1 weather sensor message received in the previous wake cycle with one
+// received now. The number of getData() calls which completed early due to this is
+// published with the 'radio' topic ("rx_early" of "rx_compl").
+//
+// The state of rain gauge and lightning post-processing and the receiver configuration can be
+// saved and restored as a versioned checkpoint (see Checkpoint.h) - via MQTT (see below) or via
+// serial console: 'checkpoint' prints the checkpoint as hex string, 'restore <hex>' restores it.
+//
 // If sleep mode is enabled (SLEEP_EN), the device goes into deep sleep mode after data has
 // been published. If AWAKE_TIMEOUT is reached before data has been published, deep sleep is
 // entered, too. After SLEEP_INTERVAL, the controller is restarted.
@@ -38,20 +67,30 @@
 //     <base_topic>/extra                                   calculated data
 //     <base_topic>/radio                                   radio transceiver info as JSON string - see publishRadio()
 //     <base_topic>/status                                  "online"|"offline"|"dead"$
+//     <base_topic>/status/cycles                           wake cycle accounting summary as JSON string
+//                                                          - see WakeCycle::summary() (WAKE_CYCLE_EN)
+//     <base_topic>/status/memory                           heap/stack statistics as JSON string
+//                                                          - see MemStats::summary() (MEM_STATS_EN)
 //     <base_topic>/sensors_inc                             sensors include list as JSON string;
 //                                                          triggered by 'get_sensors_inc' MQTT topic
 //     <base_topic>/sensors_exc                             sensors exclude list as JSON string;
 //                                                          triggered by 'get_sensors_exc' MQTT topic
+//     <base_topic>/checkpoint                              checkpoint as hex string (see Checkpoint.h);
+//                                                          triggered by 'get_checkpoint' MQTT topic
 //     homeassistant/sensor/<sensor_id>_<json_ele>/config   Home Assistand auto discovery for sensor data
 //     homeassistant/sensor/<hostname>_<json_ele>/config    Home Assistand auto discovery for receiver control/status
 //
 // MQTT subscriptions:
 //     <base_topic>/reset <flags>                           reset rain counters (see RainGauge.h for <flags>)
 //                                                          reset lightning post-processing (flags & 0x10)
+//                                                          reset evapotranspiration (flags & 0x20, ET0_EN)
 //     <base_topic>/get_sensors_inc                         get sensors include list
 //     <base_topic>/get_sensors_exc                         get sensors exclude list
 //     <base_topic>/set_sensors_inc {"ids": [<id0>, ... ]}  set sensors include list, e.g. {"ids": ["0x89ABCDEF"]}
 //     <base_topic>/set_sensors_exc {"ids": [<id0>, ... ]}  set sensors exclude list, e.g. {"ids": ["0x89ABCDEF"]}
+//     <base_topic>/get_checkpoint                          get checkpoint of rain gauge/lightning post-processing
+//                                                          and receiver configuration
+//     <base_topic>/set_checkpoint <hex>                    restore checkpoint, e.g. on new hardware
 //
 // $ via LWT
 //
@@ -129,6 +168,23 @@
 // 20250129 Added calculated WBGT (Wet Bulb Globe Temperature)
 // 20250220 Added Home Assistant auto discovery
 // 20250223 Moved MQTT functions to src/mqtt_comm.h/.cpp
+// 20250414 Added wake cycle accounting
+// 20250415 Added retention of sensor data in RTC RAM during deep sleep
+// 20250419 Added optional metrics endpoint in Prometheus text format (see src/metrics_http.h)
+// 20250423 Added heap/stack instrumentation (MemStats)
+// 20250426 Added trace events for publishing (see Trace.h)
+// 20250427 Added auto discovery statistics ('status/discovery')
+// 20250429 Added noise floor estimator and adaptive RSSI threshold (NoiseFloor)
+// 20250504 Added PM NowCast and Air Quality Index (AirQuality)
+// 20250505 Added reference evapotranspiration and water balance (Evapotranspiration)
+// 20250506 Added checkpoint/restore of post-processing state via MQTT and serial console
+// 20250507 Metrics endpoint served from loop() only (not during getData())
+// 20250507 PM NowCast/AQI: one AirQuality object per configured sensor ID (airQualitySensors[])
+// 20250508 Wake cycle accounting is optional (WAKE_CYCLE_EN)
+// 20250508 Heap/stack instrumentation is optional (MEM_STATS_EN)
+// 20250508 Noise floor estimator is optional (NOISE_FLOOR_EN)
+// 20250508 PM NowCast/AQI is optional (AIR_QUALITY_EN)
+// 20250508 Evapotranspiration is optional (ET0_EN); site parameters moved to src/mqtt_comm.h
 //
 // ToDo:
 //
@@ -164,6 +220,8 @@
 #define SLEEP_EN true         // enable sleep mode (see notes above!)
 //#define USE_SECUREWIFI        // use secure WIFI
 #define USE_WIFI // use non-secure WIFI
+//#define WAKE_CYCLE_EN         // enable wake cycle accounting ('status/cycles')
+//#define MEM_STATS_EN          // enable heap/stack instrumentation ('status/memory')
 
 // Enter your time zone (https://remotemonitoringsystems.ca/time-zone-abbreviations.php)
 const char *TZ_INFO = "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00";
@@ -208,8 +266,11 @@ const char *TZ_INFO = "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00";
 #include "WeatherUtils.h"
 #include "RainGauge.h"
 #include "Lightning.h"
+#include "AirQuality.h"
+#include "Evapotranspiration.h"
 #include "InitBoard.h"
 #include "src/mqtt_comm.h"
+#include "src/metrics_http.h"
 
 
 const char sketch_id[] = "BresserWeatherSensorMQTT 20250228";
@@ -226,6 +287,16 @@ std::vector<SensorMap> sensor_map = {
     //{0x83750871, "SoilMoisture-1"}
 };
 
+#ifdef AIR_QUALITY_EN
+// PM sensors with NowCast and Air Quality Index (see AIR_QUALITY_EN in src/mqtt_comm.h)
+// - replace by your own IDs!
+// Each sensor needs its own Preferences namespace (max. 15 characters).
+AirQualitySensor airQualitySensors[] = {
+    {0x5680, {nullptr, "BWS-AQ-5680"}}
+};
+const size_t numAirQualitySensors = sizeof(airQualitySensors) / sizeof(airQualitySensors[0]);
+#endif
+
 // enable only one of these below, disabling both is fine too.
 //  #define CHECK_CA_ROOT
 //  #define CHECK_PUB_KEY
@@ -307,21 +378,39 @@ static const char fp[] PROGMEM = "AA:BB:CC:DD:EE:FF:00:11:22:33:44:55:66:77:88:9
 WeatherSensor weatherSensor;
 RainGauge rainGauge;
 Lightning lightning;
+#ifdef ET0_EN
+Evapotranspiration evapotranspiration(SITE_LATITUDE, SITE_ELEVATION, WIND_SENSOR_HEIGHT);
+#endif
+#ifdef WAKE_CYCLE_EN
+WakeCycle wakeCycle;
+#endif
+#ifdef MEM_STATS_EN
+MemStats memStats;
+#endif
+#ifdef NOISE_FLOOR_EN
+NoiseFloor noiseFloor;
+#endif
 
 // MQTT topics - change if needed
 String Hostname = String(HOSTNAME);
 String mqttPubStatus = "status";
+String mqttPubCycles = "status/cycles";
+String mqttPubMemory = "status/memory";
+String mqttPubDiscovery = "status/discovery";
 String mqttPubRadio = "radio";
 String mqttPubData = "data";
 String mqttPubRssi = "rssi";
 String mqttPubExtra = "extra";
 String mqttPubInc = "sensors_inc";
 String mqttPubExc = "sensors_exc";
+String mqttPubCkpt = "checkpoint";
 String mqttSubReset = "reset";
 String mqttSubGetInc = "get_sensors_inc";
 String mqttSubGetExc = "get_sensors_exc";
 String mqttSubSetInc = "set_sensors_inc";
 String mqttSubSetExc = "set_sensors_exc";
+String mqttSubGetCkpt = "get_checkpoint";
+String mqttSubSetCkpt = "set_checkpoint";
 
 //////////////////////////////////////////////////////
 
@@ -408,6 +497,10 @@ void wifi_wait(int wifi_retries, int wifi_delay)
         if (++count == wifi_retries)
         {
             log_e("\nWiFi connection timed out, will restart after %d s", SLEEP_INTERVAL / 1000);
+#ifdef WAKE_CYCLE_EN
+            wakeCycle.mark(WAKE_PHASE_SLEEP);
+            wakeCycle.end(SLEEP_INTERVAL);
+#endif
             ESP.deepSleep(SLEEP_INTERVAL * 1000);
         }
     }
@@ -420,6 +513,9 @@ void wifi_wait(int wifi_retries, int wifi_delay)
  */
 void mqtt_setup(void)
 {
+#ifdef WAKE_CYCLE_EN
+    wakeCycle.mark(WAKE_PHASE_WIFI);
+#endif
     log_i("Attempting to connect to SSID: %s", ssid);
     WiFi.hostname(Hostname.c_str());
     WiFi.mode(WIFI_STA);
@@ -481,6 +577,9 @@ void mqtt_setup(void)
     // do not verify tls certificate
     net.setInsecure();
 #endif
+#endif
+#ifdef WAKE_CYCLE_EN
+    wakeCycle.mark(WAKE_PHASE_MQTT);
 #endif
     client.begin(MQTT_HOST, MQTT_PORT, net);
 
@@ -495,8 +594,14 @@ void mqtt_setup(void)
  */
 void mqtt_connect(void)
 {
+#ifdef WAKE_CYCLE_EN
+    WakePhase phasePrev = wakeCycle.mark(WAKE_PHASE_WIFI);
+#endif
     Serial.print(F("Checking wifi..."));
     wifi_wait(WIFI_RETRIES, WIFI_DELAY);
+#ifdef WAKE_CYCLE_EN
+    wakeCycle.mark(WAKE_PHASE_MQTT);
+#endif
 
     Serial.print(F("\nMQTT connecting... "));
     while (!client.connect(Hostname.c_str(), MQTT_USER, MQTT_PASS))
@@ -511,15 +616,105 @@ void mqtt_connect(void)
     client.subscribe(mqttSubGetExc);
     client.subscribe(mqttSubSetInc);
     client.subscribe(mqttSubSetExc);
+    client.subscribe(mqttSubGetCkpt);
+    client.subscribe(mqttSubSetCkpt);
     log_i("%s: %s\n", mqttPubStatus.c_str(), "online");
     client.publish(mqttPubStatus, "online");
+#ifdef WAKE_CYCLE_EN
+    publishWakeCycle();
+    wakeCycle.mark(phasePrev);
+#endif
+}
+
+/*!
+ * \brief Handle serial console commands
+ *
+ * 'checkpoint'    print checkpoint as hex string
+ * 'restore <hex>' restore checkpoint
+ */
+void serialCommand(void)
+{
+    if (!Serial.available())
+    {
+        return;
+    }
+
+    String cmd = Serial.readStringUntil('\n');
+    cmd.trim();
+    if (cmd == "checkpoint")
+    {
+        char hex[2 * CHECKPOINT_MAX_SIZE + 1];
+        if (saveCheckpointHex(hex, sizeof(hex)))
+        {
+            Serial.println(hex);
+        }
+    }
+    else if (cmd.startsWith("restore "))
+    {
+        CheckpointStatus status = restoreCheckpointHex(cmd.c_str() + 8);
+        Serial.println((status == CKPT_OK) ? F("restored") : F("failed"));
+    }
 }
 
+#ifdef WAKE_CYCLE_EN
+/*!
+ * \brief Publish wake cycle accounting summary
+ */
+void publishWakeCycle(void)
+{
+    char buf[PAYLOAD_SIZE];
+
+    if (wakeCycle.summary(buf, sizeof(buf)))
+    {
+        log_i("%s: %s\n", mqttPubCycles.c_str(), buf);
+        client.publish(mqttPubCycles, buf);
+    }
+}
+#endif
+
+#ifdef MEM_STATS_EN
+/*!
+ * \brief Publish heap/stack statistics
+ */
+void publishMemStats(void)
+{
+    char buf[PAYLOAD_SIZE];
+
+    if (memStats.summary(buf, sizeof(buf)))
+    {
+        log_i("%s: %s\n", mqttPubMemory.c_str(), buf);
+        client.publish(mqttPubMemory, buf);
+    }
+}
+#endif
+
+#if defined(AUTO_DISCOVERY)
+/*!
+ * \brief Publish statistics of last auto discovery cycle
+ */
+void publishDiscoveryStats(void)
+{
+    const struct discovery_stats &stats = getDiscoveryStats();
+    char buf[PAYLOAD_SIZE];
+
+    snprintf(buf, sizeof(buf), "{\"msgs\":%u,\"bytes\":%lu,\"len_max\":%u,\"errors\":%u,\"heap_min\":%lu,\"heap_peak\":%lu,\"ms\":%lu}",
+             stats.messages, (unsigned long)stats.bytes, stats.len_max, stats.errors,
+             (unsigned long)stats.heap_min, (unsigned long)(stats.heap_start - stats.heap_min),
+             (unsigned long)stats.duration_ms);
+    log_i("%s: %s\n", mqttPubDiscovery.c_str(), buf);
+    client.publish(mqttPubDiscovery, buf);
+}
+#endif
+
 //
 // Setup
 //
 void setup()
 {
+#ifdef WAKE_CYCLE_EN
+    // Time since reset is accounted as boot phase
+    wakeCycle.begin();
+#endif
     Serial.begin(115200);
     Serial.setDebugOutput(true);
     initBoard();
@@ -551,19 +746,41 @@ void setup()
     Hostname = Hostname + ChipID;
     // Prepend Hostname to MQTT topics
     mqttPubStatus = Hostname + "/" + mqttPubStatus;
+    mqttPubCycles = Hostname + "/" + mqttPubCycles;
+    mqttPubMemory = Hostname + "/" + mqttPubMemory;
+    mqttPubDiscovery = Hostname + "/" + mqttPubDiscovery;
     mqttPubRadio = Hostname + "/" + mqttPubRadio;
     mqttPubExtra = Hostname + "/" + mqttPubExtra;
     mqttPubInc = Hostname + "/" + mqttPubInc;
     mqttPubExc = Hostname + "/" + mqttPubExc;
+    mqttPubCkpt = Hostname + "/" + mqttPubCkpt;
     mqttSubReset = Hostname + "/" + mqttSubReset;
     mqttSubGetInc = Hostname + "/" + mqttSubGetInc;
     mqttSubGetExc = Hostname + "/" + mqttSubGetExc;
     mqttSubSetInc = Hostname + "/" + mqttSubSetInc;
     mqttSubSetExc = Hostname + "/" + mqttSubSetExc;
+    mqttSubGetCkpt = Hostname + "/" + mqttSubGetCkpt;
+    mqttSubSetCkpt = Hostname + "/" + mqttSubSetCkpt;
 
+#ifdef WAKE_CYCLE_EN
+    weatherSensor.setWakeCycle(&wakeCycle);
+#endif
+#ifdef MEM_STATS_EN
+    weatherSensor.setMemStats(&memStats);
+#endif
+#ifdef NOISE_FLOOR_EN
+    weatherSensor.setNoiseFloor(&noiseFloor);
+#endif
     weatherSensor.begin();
     weatherSensor.setSensorsCfg(MAX_SENSORS, RX_FLAGS);
+    if (SLEEP_EN)
+    {
+        weatherSensor.restoreSlots();
+    }
     mqtt_setup();
+#if defined(METRICS_EN) && defined(ESP32)
+    metrics_setup();
+#endif
 }
 
 /*!
@@ -602,6 +819,13 @@ void loop()
         }
     }
 
+#if defined(METRICS_EN) && defined(ESP32)
+    // Not from clientLoopWrapper() - the response is sent with blocking writes
+    metrics_loop();
+#endif
+
+    serialCommand();
+
     const uint32_t currentMillis = millis();
     if (currentMillis - statusPublishPreviousMillis >= STATUS_INTERVAL)
     {
@@ -610,6 +834,9 @@ void loop()
         log_i("%s: %s\n", mqttPubStatus.c_str(), "online");
         client.publish(mqttPubStatus, "online");
         publishRadio();
+#ifdef MEM_STATS_EN
+        publishMemStats();
+#endif
     }
 
     bool decode_ok = false;
@@ -626,7 +853,19 @@ void loop()
 #endif
 
     // Attempt to receive data set with timeout of <xx> s
+#ifdef WAKE_CYCLE_EN
+    wakeCycle.mark(WAKE_PHASE_RX);
+#endif
+#if defined(METRICS_EN) && defined(ESP32)
+    const uint32_t rxStart = millis();
+#endif
     decode_ok = weatherSensor.getData(RX_TIMEOUT, RX_FLAGS, 0, &clientLoopWrapper);
+#if defined(METRICS_EN) && defined(ESP32)
+    metrics_getData(millis() - rxStart, decode_ok);
+#endif
+#endif
+#ifdef WAKE_CYCLE_EN
+    wakeCycle.mark(WAKE_PHASE_MQTT);
 #endif
 
 #ifdef LED_EN
@@ -646,6 +885,10 @@ void loop()
         lastMillis = millis();
         if (decode_ok)
         {
+#ifdef MEM_STATS_EN
+            MemStatsScope memScope(&memStats, MEM_PHASE_PUBLISH);
+#endif
+            TRACE_SCOPE("publish", TRACE_TID_APP);
             publishWeatherdata(false);
             client.loop();
             published_ok = true;
@@ -658,11 +901,21 @@ void loop()
         (millis() - discoveryPublishPreviousMillis > DISCOVERY_INTERVAL * 60000))
     {
         discoveryPublishPreviousMillis = millis();
+#ifdef MEM_STATS_EN
+        MemStatsScope memScope(&memStats, MEM_PHASE_DISCOVERY);
+#endif
+        TRACE_SCOPE("discovery", TRACE_TID_APP);
         haAutoDiscovery();
         client.loop();
+        publishDiscoveryStats();
     }
 #endif
 
+#ifdef MEM_STATS_EN
+    // Record stack high-water mark of loop task
+    memStats.sampleStack(MEM_STACK_LOOP);
+#endif
+
     bool force_sleep = millis() > AWAKE_TIMEOUT;
 
     // Go to sleep only after complete set of data has been sent
@@ -677,6 +930,9 @@ void loop()
             log_d("Data forwarding completed.");
         }
         log_i("Sleeping for %d ms\n", SLEEP_INTERVAL);
+#ifdef WAKE_CYCLE_EN
+        wakeCycle.mark(WAKE_PHASE_SLEEP);
+#endif
         log_i("%s: %s\n", mqttPubStatus.c_str(), "offline");
         Serial.flush();
         client.publish(mqttPubStatus, "offline", true /* retained */, 0 /* qos */);
@@ -693,6 +949,10 @@ void loop()
         // See
         // https://github.com/jgromes/RadioLib/discussions/1375#discussioncomment-11763846
         weatherSensor.sleep();
+        weatherSensor.saveSlots(SLEEP_INTERVAL);
+#ifdef WAKE_CYCLE_EN
+        wakeCycle.end(SLEEP_INTERVAL);
+#endif
         ESP.deepSleep(SLEEP_INTERVAL * 1000);
     }
 } // loop()
@@ -0,0 +1,155 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// metrics_http.cpp
+//
+// HTTP endpoint for receiver metrics in Prometheus text format (ESP32 only)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250419 Created
+// 20250428 Added radio packet/false trigger counters
+// 20250429 Added noise floor metrics
+// 20250508 Noise floor metrics only with NOISE_FLOOR_EN (see mqtt_comm.h)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "metrics_http.h"
+
+#if defined(METRICS_EN) && defined(ESP32)
+
+#include <WiFi.h>
+#include "RainGauge.h"
+#include "Lightning.h"
+#include "PromMetrics.h"
+#include "mqtt_comm.h"
+
+extern WeatherSensor weatherSensor;
+extern RainGauge rainGauge;
+extern Lightning lightning;
+#ifdef NOISE_FLOOR_EN
+extern NoiseFloor noiseFloor;
+#endif
+
+static PromMetrics metrics;
+static WiFiServer server(METRICS_PORT);
+static WiFiClient pending;          // client waiting for request line
+static uint32_t pendingSince;       // time of connection [ms]
+static char request[64];            // request line (truncated)
+static size_t requestLen;
+
+// Called from WeatherSensor::getMessage() for each received message
+static void onRx(DecodeStatus status, uint32_t id, float rssi)
+{
+    metrics.countStatus(status);
+    if (id)
+        metrics.onPacket(id, rssi, millis());
+}
+
+// Update snapshot values, render and send response
+static void respond(void)
+{
+    char hdr[160];
+    size_t len = 0;
+    int status = PromMetrics::httpStatus(request);
+
+    if (status == 200)
+    {
+        metrics.setRejectStats(weatherSensor.rejectStats);
+        metrics.setSyncStats(weatherSensor.syncStats, STR(RADIO_CHIP));
+#ifdef NOISE_FLOOR_EN
+        metrics.setNoiseFloor(noiseFloor.stats());
+#endif
+        metrics.setHeap(ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
+        metrics.setRain(rainGauge.pastHour(), rainGauge.currentDay(), rainGauge.currentWeek(), rainGauge.currentMonth());
+
+        time_t ts;
+        int events = 0;
+        uint8_t distance = 0;
+        lightning.lastEvent(ts, events, distance);
+        metrics.setLightning(lightning.pastHour(), events, distance);
+
+        len = metrics.render();
+    }
+    size_t hlen = PromMetrics::httpHeader(hdr, sizeof(hdr), status, len);
+    pending.write((const uint8_t *)hdr, hlen);
+    if (len)
+        pending.write((const uint8_t *)metrics.text(), len);
+    log_d("Metrics: [%d] %u bytes", status, len);
+}
+
+void metrics_setup(void)
+{
+    weatherSensor.setRxCallback(onRx);
+    server.begin();
+    log_i("Metrics endpoint on port %d", METRICS_PORT);
+}
+
+void metrics_loop(void)
+{
+    if (!pending)
+    {
+        pending = server.accept();
+        if (!pending)
+            return;
+        pendingSince = millis();
+        requestLen = 0;
+    }
+
+    // Read request line as far as available; remaining header lines are ignored
+    while (pending.available())
+    {
+        char c = pending.read();
+        if (c == '\n')
+        {
+            request[requestLen] = '\0';
+            respond();
+            pending.stop();
+            return;
+        }
+        if (requestLen < sizeof(request) - 1)
+            request[requestLen++] = c;
+    }
+
+    if (millis() - pendingSince > METRICS_HTTP_TIMEOUT)
+    {
+        log_d("Metrics: request time-out");
+        pending.stop();
+    }
+}
+
+void metrics_getData(uint32_t ms, bool ok)
+{
+    metrics.observeGetData(ms, ok);
+}
+
+#endif
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// metrics_http.h
+//
+// HTTP endpoint for receiver metrics in Prometheus text format (ESP32 only)
+//
+// The metrics are served at http://<host>:<METRICS_PORT>/metrics (see PromMetrics.h).
+// The server is polled from loop() and from the getData() callback; it never waits
+// for a client, so radio reception is not stalled by a scrape.
+//
+// Note: The endpoint is only reachable while the device is awake, i.e. SLEEP_EN
+//       should be set to false.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250419 Created
+// 20250507 metrics_loop() must not be called from the getData() callback
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef METRICS_HTTP_H
+#define METRICS_HTTP_H
+
+//#define METRICS_EN            // enable HTTP metrics endpoint (ESP32 only)
+
+#define METRICS_HTTP_TIMEOUT 500 // time-out for receiving the request line [ms]
+
+#include <Arduino.h>
+#include "WeatherSensorCfg.h"
+#include "WeatherSensor.h"
+
+#if defined(METRICS_EN) && defined(ESP32)
+
+/*!
+ * \brief Start HTTP server and register callback for received messages
+ */
+void metrics_setup(void);
+
+/*!
+ * \brief Handle HTTP client
+ *
+ * Call frequently from loop(), but not from the getData() callback - the response
+ * (up to METRICS_BUF_SIZE bytes) is sent with blocking writes, which would stall
+ * the reception of radio messages.
+ */
+void metrics_loop(void);
+
+/*!
+ * \brief Add getData() call to timing histogram
+ *
+ * \param ms    duration [ms]
+ * \param ok    return value of getData()
+ */
+void metrics_getData(uint32_t ms, bool ok);
+
+#endif
+#endif // METRICS_HTTP_H
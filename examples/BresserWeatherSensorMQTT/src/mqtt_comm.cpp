@@ -38,6 +38,20 @@
 // 20250221 Created from BresserWeatherSensorMQTT.ino
 // 20250227 Added publishControlDiscovery()
 // 20250228 Added publishStatusDiscovery(), fixed sensorName()
+// 20250415 Added statistics of sensor data restored from RTC RAM to publishRadio()
+// 20250427 Moved discovery templates to flash resident tables, discovery payloads
+//          assembled chunk-wise (begin/write/end) without String/JsonDocument,
+//          added discovery statistics (getDiscoveryStats())
+// 20250428 Added packet interrupt/false trigger counts to publishRadio()
+// 20250429 Added noise floor statistics to publishRadio()
+// 20250501 publishWeatherdata(): sensor data JSON built with field visitor (SensorFields.h)
+// 20250504 publishWeatherdata(): added PM NowCast and AQI (AirQuality.h)
+// 20250505 publishWeatherdata(): added ET0 and water balance (Evapotranspiration.h)
+// 20250506 Added checkpoint get/set (Checkpoint.h)
+// 20250507 publishWeatherdata(): separate AirQuality object per PM sensor ID
+// 20250508 publishRadio(): noise floor statistics only with NOISE_FLOOR_EN
+// 20250508 PM NowCast/AQI only with AIR_QUALITY_EN
+// 20250508 ET0 and water balance only with ET0_EN
 //
 // ToDo:
 // -
@@ -54,16 +68,25 @@ extern String mqttPubRadio;
 extern String mqttPubExtra;
 extern String mqttPubInc;
 extern String mqttPubExc;
+extern String mqttPubCkpt;
 extern String mqttSubReset;
 extern String mqttSubGetInc;
 extern String mqttSubGetExc;
 extern String mqttSubSetInc;
 extern String mqttSubSetExc;
+extern String mqttSubGetCkpt;
+extern String mqttSubSetCkpt;
 
 extern MQTTClient client;
 extern WeatherSensor weatherSensor;
 extern RainGauge rainGauge;
 extern Lightning lightning;
+#ifdef ET0_EN
+extern Evapotranspiration evapotranspiration;
+#endif
+#ifdef NOISE_FLOOR_EN
+extern NoiseFloor noiseFloor;
+#endif
 extern std::vector<SensorMap> sensor_map;
 
 String sensorName(uint32_t sensor_id)
@@ -93,6 +116,12 @@ void messageReceived(String &topic, String &payload)
         {
             lightning.reset();
         }
+#ifdef ET0_EN
+        if (flags & 0x20)
+        {
+            evapotranspiration.reset();
+        }
+#endif
     }
     else if (topic == mqttSubGetInc)
     {
@@ -114,18 +143,106 @@ void messageReceived(String &topic, String &payload)
         log_d("MQTT msg received: set_sensors_exc");
         weatherSensor.setSensorsExcJson(payload);
     }
+    else if (topic == mqttSubGetCkpt)
+    {
+        log_d("MQTT msg received: get_checkpoint");
+        char hex[2 * CHECKPOINT_MAX_SIZE + 1];
+        if (saveCheckpointHex(hex, sizeof(hex)))
+        {
+            client.publish(mqttPubCkpt, hex);
+        }
+    }
+    else if (topic == mqttSubSetCkpt)
+    {
+        log_d("MQTT msg received: set_checkpoint");
+        restoreCheckpointHex(payload.c_str());
+    }
     else
     {
         log_d("MQTT msg received: %s", topic.c_str());
     }
 }
 
+// Save checkpoint as hex string
+size_t saveCheckpointHex(char *hex, size_t size)
+{
+    uint8_t buf[CHECKPOINT_MAX_SIZE];
+    CheckpointConfig cfg;
+
+    weatherSensor.getCheckpointConfig(cfg);
+    Checkpoint checkpoint(&rainGauge, &lightning, &cfg);
+    size_t len = checkpoint.save(buf, sizeof(buf));
+
+    return (len > 0) ? Checkpoint::toHex(buf, len, hex, size) : 0;
+}
+
+// Restore checkpoint from hex string
+CheckpointStatus restoreCheckpointHex(const char *hex)
+{
+    uint8_t buf[CHECKPOINT_MAX_SIZE];
+    CheckpointConfig cfg;
+    uint8_t restored;
+
+    size_t len = Checkpoint::fromHex(hex, buf, sizeof(buf));
+    Checkpoint checkpoint(&rainGauge, &lightning, &cfg);
+    CheckpointStatus status = checkpoint.restore(buf, len, &restored);
+    if (status != CKPT_OK)
+    {
+        log_w("Checkpoint not restored (%d)", status);
+        return status;
+    }
+    if (restored & CKPT_CONFIG)
+    {
+        weatherSensor.setCheckpointConfig(cfg);
+    }
+    log_i("Checkpoint restored (sections: 0x%02X)", restored);
+    return status;
+}
+
+#ifdef AIR_QUALITY_EN
+// AirQuality object of PM sensor (nullptr if sensor ID is not in airQualitySensors[])
+static AirQuality *airQualityOf(uint32_t sensor_id)
+{
+    for (size_t n = 0; n < numAirQualitySensors; n++)
+    {
+        if (airQualitySensors[n].id == sensor_id)
+        {
+            return &airQualitySensors[n].aq;
+        }
+    }
+    return nullptr;
+}
+#endif
+
+// JSON writer for sensor data; adds rain gauge statistics after the rain gauge level
+class DataJsonWriter : public SensorJsonWriter
+{
+public:
+    DataJsonWriter(char *buf, size_t size, bool complete)
+        : SensorJsonWriter(buf, size, complete, JSON_FLOATS_QUOTED)
+    {
+    }
+
+    template <typename F, typename T>
+    void operator()(F f, T value, bool valid)
+    {
+        SensorJsonWriter::operator()(f, value, valid);
+        if ((F::id() == SF_RAIN) && (valid || complete))
+        {
+            writeFloat("rain_h", rainGauge.pastHour(), 1);
+            writeFloat("rain_d", rainGauge.currentDay(), 1);
+            writeFloat("rain_w", rainGauge.currentWeek(), 1);
+            writeFloat("rain_m", rainGauge.currentMonth(), 1);
+        }
+    }
+};
+
 // Publish weather data as MQTT message
 void publishWeatherdata(bool complete, bool retain)
 {
-    String mqtt_payload;  // sensor data
-    String mqtt_payload2; // calculated extra data
-    String mqtt_topic;    // MQTT topic including ID/name
+    char mqtt_payload[PAYLOAD_SIZE]; // sensor data
+    String mqtt_payload2;            // calculated extra data
+    String mqtt_topic;               // MQTT topic including ID/name
 
     // ArduinoJson does not allow to set number of decimals for floating point data -
     // neither does MQTT Dashboard...
@@ -134,7 +251,6 @@ void publishWeatherdata(bool complete, bool retain)
     for (size_t i = 0; i < weatherSensor.sensor.size(); i++)
     {
         // Reset string buffers
-        mqtt_payload = "";
         mqtt_payload2 = "";
 
         if (!weatherSensor.sensor[i].valid)
@@ -149,24 +265,13 @@ void publishWeatherdata(bool complete, bool retain)
         }
 
         // Example:
-        // {"ch":0,"battery_ok":1,"humidity":44,"wind_gust":1.2,"wind_avg":1.2,"wind_dir":150,"rain":146}
-        mqtt_payload = "{";
+        // {"id":1234,"ch":0,"battery_ok":1,"humidity":44,"wind_gust":1.2,"wind_avg":1.2,"wind_dir":150,"rain":146}
+        DataJsonWriter json(mqtt_payload, sizeof(mqtt_payload), complete);
+        visitSensorFields(weatherSensor.sensor[i], json);
         mqtt_payload2 = "{";
-        mqtt_payload += String("\"id\":") + String(weatherSensor.sensor[i].sensor_id);
-        mqtt_payload += String(",\"ch\":") + String(weatherSensor.sensor[i].chan);
-        mqtt_payload += String(",\"battery_ok\":") + (weatherSensor.sensor[i].battery_ok ? String("1") : String("0"));
 
-        if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_SOIL)
-        {
-            mqtt_payload += String(",\"temp_c\":") + String(weatherSensor.sensor[i].soil.temp_c);
-            mqtt_payload += String(",\"moisture\":") + String(weatherSensor.sensor[i].soil.moisture);
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_LIGHTNING)
+        if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_LIGHTNING)
         {
-            mqtt_payload += String(",\"lightning_count\":") + String(weatherSensor.sensor[i].lgt.strike_count);
-            mqtt_payload += String(",\"lightning_distance_km\":") + String(weatherSensor.sensor[i].lgt.distance_km);
-            mqtt_payload += String(",\"lightning_unknown1\":\"0x") + String(weatherSensor.sensor[i].lgt.unknown1, HEX) + String("\"");
-            mqtt_payload += String(",\"lightning_unknown2\":\"0x") + String(weatherSensor.sensor[i].lgt.unknown2, HEX) + String("\"");
             struct tm timeinfo;
             time_t now = time(nullptr);
             localtime_r(&now, &timeinfo);
@@ -175,7 +280,7 @@ void publishWeatherdata(bool complete, bool retain)
                 weatherSensor.sensor[i].lgt.strike_count,
                 weatherSensor.sensor[i].lgt.distance_km,
                 weatherSensor.sensor[i].startup);
-            mqtt_payload += String(",\"lightning_hr\":") + String(lightning.pastHour());
+            json.writeInt("lightning_hr", lightning.pastHour());
             int events;
             time_t timestamp;
             uint8_t distance;
@@ -185,73 +290,38 @@ void publishWeatherdata(bool complete, bool retain)
                 struct tm timeinfo;
                 gmtime_r(&timestamp, &timeinfo);
                 strftime(tbuf, 25, "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-                mqtt_payload += String(",\"lightning_event_time\":\"") + String(tbuf) + String("\"");
-                mqtt_payload += String(",\"lightning_event_count\":") + String(events);
-                mqtt_payload += String(",\"lightning_event_distance_km\":") + String(distance);
+                json.writeString("lightning_event_time", tbuf);
+                json.writeInt("lightning_event_count", events);
+                json.writeUInt("lightning_event_distance_km", distance);
             }
         }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_LEAKAGE)
-        {
-            // Water Leakage Sensor
-            mqtt_payload += String(",\"leakage\":") + String(weatherSensor.sensor[i].leak.alarm);
-        }
+#ifdef AIR_QUALITY_EN
         else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_AIR_PM)
         {
-            // Air Quality (Particular Matter) Sensor
-            if (!weatherSensor.sensor[i].pm.pm_1_0_init)
-            {
-                mqtt_payload += String(",\"pm1_0_ug_m3\":") + String(weatherSensor.sensor[i].pm.pm_1_0);
-            }
-            if (!weatherSensor.sensor[i].pm.pm_2_5_init)
-            {
-                mqtt_payload += String(",\"pm2_5_ug_m3\":") + String(weatherSensor.sensor[i].pm.pm_2_5);
-            }
-            if (!weatherSensor.sensor[i].pm.pm_10_init)
-            {
-                mqtt_payload += String(",\"pm10_ug_m3\":") + String(weatherSensor.sensor[i].pm.pm_10);
-            }
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_CO2)
-        {
-            // CO2 Sensor
-            if (!weatherSensor.sensor[i].co2.co2_init)
+            AirQuality *airQuality = airQualityOf(weatherSensor.sensor[i].sensor_id);
+            if (airQuality)
             {
-                mqtt_payload += String(",\"co2_ppm\":") + String(weatherSensor.sensor[i].co2.co2_ppm);
-            }
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_HCHO_VOC)
-        {
-            // HCHO / VOC Sensor
-            if (!weatherSensor.sensor[i].voc.hcho_init)
-            {
-                mqtt_payload += String(",\"hcho_ppb\":") + String(weatherSensor.sensor[i].voc.hcho_ppb);
-            }
-            if (!weatherSensor.sensor[i].voc.voc_init)
-            {
-                mqtt_payload += String(",\"voc\":") + String(weatherSensor.sensor[i].voc.voc_level);
+                const struct WeatherSensor::AirPM &pm = weatherSensor.sensor[i].pm;
+                airQuality->update(time(nullptr), pm.pm_1_0, pm.pm_2_5, pm.pm_10,
+                                   pm.pm_1_0_init, pm.pm_2_5_init, pm.pm_10_init);
+                float nowcast = airQuality->nowCast(AQ_PM_2_5);
+                if (nowcast >= 0)
+                    json.writeFloat("pm2_5_nowcast", nowcast, 1);
+                nowcast = airQuality->nowCast(AQ_PM_10);
+                if (nowcast >= 0)
+                    json.writeFloat("pm10_nowcast", nowcast, 0);
+                int aqi = airQuality->aqi();
+                if (aqi >= 0)
+                    json.writeInt("aqi", aqi);
             }
         }
+#endif
         else if ((weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER0) ||
                  (weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER1) ||
                  (weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER2) ||
                  (weatherSensor.sensor[i].s_type == SENSOR_TYPE_THERMO_HYGRO) ||
                  (weatherSensor.sensor[i].s_type == SENSOR_TYPE_POOL_THERMO))
         {
-
-            if (weatherSensor.sensor[i].w.temp_ok || complete)
-            {
-                mqtt_payload += String(",\"temp_c\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.temp_c, 1));
-            }
-            if (weatherSensor.sensor[i].w.humidity_ok || complete)
-            {
-                mqtt_payload += String(",\"humidity\":") + String(weatherSensor.sensor[i].w.humidity);
-            }
-            if (weatherSensor.sensor[i].w.wind_ok || complete)
-            {
-                mqtt_payload += String(",\"wind_gust\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.wind_gust_meter_sec, 1));
-                mqtt_payload += String(",\"wind_avg\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.wind_avg_meter_sec, 1));
-                mqtt_payload += String(",\"wind_dir\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.wind_direction_deg, 1));
-            }
             if (weatherSensor.sensor[i].w.wind_ok)
             {
                 char buf[4];
@@ -274,36 +344,33 @@ void publishWeatherdata(bool complete, bool retain)
                     mqtt_payload2 += String(",\"wgbt\":") + JSON_FLOAT(String(wbgt, 1));
                 }
             }
-            if (weatherSensor.sensor[i].w.uv_ok || complete)
-            {
-                mqtt_payload += String(",\"uv\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.uv, 1));
-            }
-            if (weatherSensor.sensor[i].w.light_ok || complete)
+#ifdef ET0_EN
+            if ((weatherSensor.sensor[i].w.temp_ok) && (weatherSensor.sensor[i].w.humidity_ok) &&
+                (weatherSensor.sensor[i].w.wind_ok) && (weatherSensor.sensor[i].w.light_ok))
             {
-                mqtt_payload += String(",\"light_klx\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.light_klx, 1));
-            }
-            if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER2)
-            {
-                if (weatherSensor.sensor[i].w.tglobe_ok || complete)
+                evapotranspiration.update(time(nullptr),
+                                          weatherSensor.sensor[i].w.temp_c,
+                                          weatherSensor.sensor[i].w.humidity,
+                                          weatherSensor.sensor[i].w.wind_avg_meter_sec,
+                                          weatherSensor.sensor[i].w.light_lux);
+                float et0 = evapotranspiration.currentDay();
+                if (et0 >= 0)
                 {
-                    mqtt_payload += String(",\"t_globe_c\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.tglobe_c, 1));
+                    mqtt_payload2 += String(",\"et0_d\":") + JSON_FLOAT(String(et0, 1));
+                    if (weatherSensor.sensor[i].w.rain_ok)
+                    {
+                        mqtt_payload2 += String(",\"water_balance_d\":") + JSON_FLOAT(String(evapotranspiration.waterBalance(rainGauge.currentDay()), 1));
+                    }
                 }
             }
-            if (weatherSensor.sensor[i].w.rain_ok || complete)
-            {
-                mqtt_payload += String(",\"rain\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.rain_mm, 1));
-                mqtt_payload += String(",\"rain_h\":") + JSON_FLOAT(String(rainGauge.pastHour(), 1));
-                mqtt_payload += String(",\"rain_d\":") + JSON_FLOAT(String(rainGauge.currentDay(), 1));
-                mqtt_payload += String(",\"rain_w\":") + JSON_FLOAT(String(rainGauge.currentWeek(), 1));
-                mqtt_payload += String(",\"rain_m\":") + JSON_FLOAT(String(rainGauge.currentMonth(), 1));
-            }
+#endif
         }
-        mqtt_payload += String("}");
+        json.end();
         mqtt_payload2 += String("}");
 
-        if (mqtt_payload.length() >= PAYLOAD_SIZE)
+        if (json.overflowed())
         {
-            log_e("mqtt_payload (%d) > PAYLOAD_SIZE (%d). Payload will be truncated!", mqtt_payload.length(), PAYLOAD_SIZE);
+            log_e("mqtt_payload (%d) > PAYLOAD_SIZE (%d). Payload is truncated!", (int)json.length(), PAYLOAD_SIZE);
         }
         if (mqtt_payload2.length() >= PAYLOAD_SIZE)
         {
@@ -319,8 +386,8 @@ void publishWeatherdata(bool complete, bool retain)
         // sensor data
         mqtt_topic = mqtt_topic_base + mqttPubData;
 
-        log_i("%s: %s\n", mqtt_topic.c_str(), mqtt_payload.c_str());
-        client.publish(mqtt_topic, mqtt_payload.substring(0, PAYLOAD_SIZE - 1), retain, 0);
+        log_i("%s: %s\n", mqtt_topic.c_str(), mqtt_payload);
+        client.publish(mqtt_topic, mqtt_payload, retain, 0);
 
         // sensor specific RSSI
         mqtt_topic = mqtt_topic_base + mqttPubRssi;
@@ -345,6 +412,24 @@ void publishRadio(void)
     String mqtt_payload;
 
     payload["rssi"] = weatherSensor.rssi;
+    uint32_t completions;
+    uint32_t early;
+    weatherSensor.getRestoreStats(completions, early);
+    payload["rx_compl"] = completions;
+    payload["rx_early"] = early;
+    payload["irqs"] = weatherSensor.syncStats.irqs;
+    payload["false_trig"] = weatherSensor.syncStats.syncErr + weatherSensor.syncStats.invalid;
+#ifdef NOISE_FLOOR_EN
+    const NoiseFloorStats &noise = noiseFloor.stats();
+    if (noise.ready)
+    {
+        payload["noise_floor"] = noise.floor;
+        payload["noise_base"] = noise.baseline;
+    }
+    payload["rssi_margin"] = noise.margin;
+    payload["squelched"] = noise.rejected;
+    payload["jammed"] = noise.jammed;
+#endif
     serializeJson(payload, mqtt_payload);
     log_i("%s: %s\n", mqttPubRadio.c_str(), mqtt_payload.c_str());
     client.publish(mqttPubRadio, mqtt_payload, false, 0);
@@ -352,286 +437,381 @@ void publishRadio(void)
 }
 
 #if defined(AUTO_DISCOVERY)
+// Conditions (availability of sensor values) required by a discovery entry
+#define DISC_TGLOBE     0x01
+#define DISC_UV         0x02
+#define DISC_LIGHT      0x04
+#define DISC_RAIN       0x08
+#define DISC_WIND       0x10
+#define DISC_TEMP       0x20
+#define DISC_HUMIDITY   0x40
+
+// Discovery entries - flash resident, applied per sensor by group
+// Entries of DISC_GROUP_COMMON are published for every sensor.
+static const struct disc_entry discEntries[] PROGMEM = {
+    // name                            device_class       unit          key                      group                    topic             cond
+    {"Battery",                        "battery",         "%",          "battery_ok",            DISC_GROUP_COMMON,       DISC_TOPIC_DATA,  0},
+    {"RSSI",                           "signal_strength", "dBm",        "rssi",                  DISC_GROUP_COMMON,       DISC_TOPIC_RSSI,  0},
+    {"Outside Temperature",            "temperature",     "°C",         "temp_c",                DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  0},
+    {"Outside Humidity",               "humidity",        "%",          "humidity",              DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  0},
+    {"Globe Temperature",              "temperature",     "°C",         "tglobe_c",              DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_TGLOBE},
+    {"UV Index",                       "",                "UV Index",   "uv",                    DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_UV},
+    {"Light Lux",                      "illuminance",     "Lux",        "light_lux",             DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_LIGHT},
+    {"Rainfall",                       "precipitation",   "mm",         "rain",                  DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_RAIN},
+    {"Rainfall Hourly",                "precipitation",   "mm",         "rain_h",                DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_RAIN},
+    {"Rainfall Daily",                 "precipitation",   "mm",         "rain_d",                DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_RAIN},
+    {"Rainfall Weekly",                "precipitation",   "mm",         "rain_w",                DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_RAIN},
+    {"Rainfall Monthly",               "precipitation",   "mm",         "rain_m",                DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_RAIN},
+    {"Wind Direction",                 "",                "°",          "wind_dir",              DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_WIND},
+    {"Wind Gust Speed",                "wind_speed",      "m/s",        "wind_gust",             DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_WIND},
+    {"Wind Average Speed",             "wind_speed",      "m/s",        "wind_avg",              DISC_GROUP_WEATHER,      DISC_TOPIC_DATA,  DISC_WIND},
+    {"Wind Gust Speed (Beaufort)",     "wind_speed",      "Beaufort",   "wind_gust_bft",         DISC_GROUP_WEATHER,      DISC_TOPIC_EXTRA, DISC_WIND},
+    {"Wind Average Speed (Beaufort)",  "wind_speed",      "Beaufort",   "wind_avg_bft",          DISC_GROUP_WEATHER,      DISC_TOPIC_EXTRA, DISC_WIND},
+    {"Wind Direction (Cardinal)",      "enum",            "",           "wind_dir_txt",          DISC_GROUP_WEATHER,      DISC_TOPIC_EXTRA, DISC_WIND},
+    {"Dewpoint",                       "temperature",     "°C",         "dewpoint_c",            DISC_GROUP_WEATHER,      DISC_TOPIC_EXTRA, DISC_WIND | DISC_TEMP | DISC_HUMIDITY},
+    {"Perceived Temperature",          "temperature",     "°C",         "perceived_temp_c",      DISC_GROUP_WEATHER,      DISC_TOPIC_EXTRA, DISC_WIND | DISC_TEMP | DISC_HUMIDITY},
+    {"WGBT",                           "temperature",     "°C",         "wgbt",                  DISC_GROUP_WEATHER,      DISC_TOPIC_EXTRA, DISC_WIND | DISC_TEMP | DISC_HUMIDITY | DISC_TGLOBE},
+#ifdef ET0_EN
+    {"Evapotranspiration Daily",       "precipitation",   "mm",         "et0_d",                 DISC_GROUP_WEATHER,      DISC_TOPIC_EXTRA, DISC_WIND | DISC_TEMP | DISC_HUMIDITY | DISC_LIGHT},
+    {"Water Balance Daily",            "precipitation",   "mm",         "water_balance_d",       DISC_GROUP_WEATHER,      DISC_TOPIC_EXTRA, DISC_WIND | DISC_TEMP | DISC_HUMIDITY | DISC_LIGHT | DISC_RAIN},
+#endif
+    {"Soil Temperature",               "temperature",     "°C",         "temp_c",                DISC_GROUP_SOIL,         DISC_TOPIC_DATA,  0},
+    {"Soil Moisture",                  "moisture",        "%",          "moisture",              DISC_GROUP_SOIL,         DISC_TOPIC_DATA,  0},
+    {"Temperature",                    "temperature",     "°C",         "temp_c",                DISC_GROUP_THERMO_HYGRO, DISC_TOPIC_DATA,  0},
+    {"Humidity",                       "humidity",        "%",          "humidity",              DISC_GROUP_THERMO_HYGRO, DISC_TOPIC_DATA,  0},
+    {"Pool Temperature",               "temperature",     "°C",         "temp_c",                DISC_GROUP_POOL_THERMO,  DISC_TOPIC_DATA,  0},
+    {"PM1.0",                          "pm1",             "µg/m³",      "pm1_0_ug_m3",           DISC_GROUP_AIR_PM,       DISC_TOPIC_DATA,  0},
+    {"PM2.5",                          "pm25",            "µg/m³",      "pm2_5_ug_m3",           DISC_GROUP_AIR_PM,       DISC_TOPIC_DATA,  0},
+    {"PM10",                           "pm10",            "µg/m³",      "pm10_ug_m3",            DISC_GROUP_AIR_PM,       DISC_TOPIC_DATA,  0},
+#ifdef AIR_QUALITY_EN
+    {"PM2.5 NowCast",                  "pm25",            "µg/m³",      "pm2_5_nowcast",         DISC_GROUP_AIR_PM,       DISC_TOPIC_DATA,  0},
+    {"PM10 NowCast",                   "pm10",            "µg/m³",      "pm10_nowcast",          DISC_GROUP_AIR_PM,       DISC_TOPIC_DATA,  0},
+    {"Air Quality Index",              "aqi",             "",           "aqi",                   DISC_GROUP_AIR_PM,       DISC_TOPIC_DATA,  0},
+#endif
+    {"Lightning Count",                "",                "",           "lightning_count",       DISC_GROUP_LIGHTNING,    DISC_TOPIC_DATA,  0},
+    {"Lightning Distance",             "distance",        "km",         "lightning_distance_km", DISC_GROUP_LIGHTNING,    DISC_TOPIC_DATA,  0},
+    {"Lightning Hour",                 "",                "",           "lightning_hr",          DISC_GROUP_LIGHTNING,    DISC_TOPIC_DATA,  0},
+    {"Leakage Alarm",                  "enum",            "",           "leakage",               DISC_GROUP_LEAKAGE,      DISC_TOPIC_DATA,  0},
+    {"CO2",                            "co2",             "ppm",        "co2_ppm",               DISC_GROUP_CO2,          DISC_TOPIC_DATA,  0},
+    {"HCHO",                           "hcho",            "ppb",        "hcho_ppb",              DISC_GROUP_HCHO_VOC,     DISC_TOPIC_DATA,  0},
+    {"VOC",                            "voc",             "",           "voc",                   DISC_GROUP_HCHO_VOC,     DISC_TOPIC_DATA,  0}};
+
+// Discovery device information per sensor type - flash resident
+static const struct disc_device discDevices[] PROGMEM = {
+    {SENSOR_TYPE_WEATHER0,     DISC_GROUP_WEATHER,      "Weather Sensor",                "weather_sensor_1"},
+    {SENSOR_TYPE_WEATHER1,     DISC_GROUP_WEATHER,      "Weather Sensor",                "weather_sensor_1"},
+    {SENSOR_TYPE_WEATHER2,     DISC_GROUP_WEATHER,      "Weather Sensor",                "weather_sensor_1"},
+    {SENSOR_TYPE_SOIL,         DISC_GROUP_SOIL,         "Soil Sensor",                   "soil_sensor_1"},
+    {SENSOR_TYPE_THERMO_HYGRO, DISC_GROUP_THERMO_HYGRO, "Thermo-Hygrometer Sensor",      "thermo_hygrometer_sensor_1"},
+    {SENSOR_TYPE_POOL_THERMO,  DISC_GROUP_POOL_THERMO,  "Pool Thermometer",              "pool_thermometer_1"},
+    {SENSOR_TYPE_AIR_PM,       DISC_GROUP_AIR_PM,       "Air Quality (PM) Sensor",       "air_quality_sensor_1"},
+    {SENSOR_TYPE_LIGHTNING,    DISC_GROUP_LIGHTNING,    "Lightning Sensor",              "lightning_sensor"},
+    {SENSOR_TYPE_LEAKAGE,      DISC_GROUP_LEAKAGE,      "Leakage Sensor",                "leakage_sensor_1"},
+    {SENSOR_TYPE_CO2,          DISC_GROUP_CO2,          "CO2 Sensor",                    "co2_sensor_1"},
+    {SENSOR_TYPE_HCHO_VOC,     DISC_GROUP_HCHO_VOC,     "Air Quality (HCHO/VOC) Sensor", "air_quality_sensor_2"}};
+
+static const char discManufacturer[] PROGMEM = "Bresser";
+
+// Discovery message being assembled
+static struct
+{
+    char topic[DISCOVERY_TOPIC_SIZE];
+    char payload[DISCOVERY_SIZE];
+    size_t len;
+    bool overflow;
+} discMsg;
+
+static struct discovery_stats discStats;
+
+// Start discovery message
+static void discoveryBegin(void)
+{
+    discMsg.len = 0;
+    discMsg.overflow = false;
+}
+
+// Append chunk from RAM
+static void discoveryWrite(const char *chunk, size_t len)
+{
+    if (discMsg.len + len >= sizeof(discMsg.payload))
+    {
+        discMsg.overflow = true;
+        return;
+    }
+    memcpy(&discMsg.payload[discMsg.len], chunk, len);
+    discMsg.len += len;
+}
+
+
+// Append chunk from flash
+static void discoveryWrite_P(PGM_P chunk)
+{
+    size_t len = strlen_P(chunk);
+    if (discMsg.len + len >= sizeof(discMsg.payload))
+    {
+        discMsg.overflow = true;
+        return;
+    }
+    memcpy_P(&discMsg.payload[discMsg.len], chunk, len);
+    discMsg.len += len;
+}
+
+// Append contents of JSON string (with escaping of '"' and '\')
+static void discoveryWriteValue(const char *value)
+{
+    for (const char *p = value; *p; p++)
+    {
+        if ((*p == '"') || (*p == '\\'))
+            discoveryWrite("\\", 1);
+        discoveryWrite(p, 1);
+    }
+}
+
+// Append string value as JSON string
+static void discoveryWriteString(const char *value)
+{
+    discoveryWrite("\"", 1);
+    discoveryWriteValue(value);
+    discoveryWrite("\"", 1);
+}
+
+// Append key/string value pair; key in flash
+static void discoveryWriteField_P(PGM_P key, const char *value)
+{
+    discoveryWrite_P(key);
+    discoveryWriteString(value);
+}
+
+// Publish discovery message
+static bool discoveryEnd(bool retain, int qos = 0)
+{
+    // Peak heap usage occurs while the MQTT client serializes the message
+    uint32_t heap = ESP.getFreeHeap();
+    if (heap < discStats.heap_min)
+        discStats.heap_min = heap;
+
+    if (discMsg.overflow)
+    {
+        log_e("Discovery message exceeds DISCOVERY_SIZE: %s", discMsg.topic);
+        discStats.errors++;
+        return false;
+    }
+    discMsg.payload[discMsg.len] = '\0';
+    log_d("%s: %s", discMsg.topic, discMsg.payload);
+    bool res = client.publish(discMsg.topic, discMsg.payload, discMsg.len, retain, qos);
+    if (!res)
+        discStats.errors++;
+    discStats.messages++;
+    discStats.bytes += discMsg.len;
+    if (discMsg.len > discStats.len_max)
+        discStats.len_max = discMsg.len;
+    return res;
+}
+
+// Get condition flags (DISC_*) fulfilled by sensor
+static uint8_t discoveryFlags(const WeatherSensor::sensor_t &s)
+{
+    if ((s.s_type != SENSOR_TYPE_WEATHER0) &&
+        (s.s_type != SENSOR_TYPE_WEATHER1) &&
+        (s.s_type != SENSOR_TYPE_WEATHER2))
+        return 0;
+
+    uint8_t flags = 0;
+    flags |= s.w.tglobe_ok ? DISC_TGLOBE : 0;
+    flags |= s.w.uv_ok ? DISC_UV : 0;
+    flags |= s.w.light_ok ? DISC_LIGHT : 0;
+    flags |= s.w.rain_ok ? DISC_RAIN : 0;
+    flags |= s.w.wind_ok ? DISC_WIND : 0;
+    flags |= s.w.temp_ok ? DISC_TEMP : 0;
+    flags |= s.w.humidity_ok ? DISC_HUMIDITY : 0;
+    return flags;
+}
+
 // Home Assistant Auto-Discovery
 void haAutoDiscovery(void)
 {
-    String topic;
+    uint32_t startMillis = millis();
+    discStats.messages = 0;
+    discStats.bytes = 0;
+    discStats.len_max = 0;
+    discStats.errors = 0;
+    discStats.heap_start = ESP.getFreeHeap();
+    discStats.heap_min = discStats.heap_start;
+
+    char topicData[DISCOVERY_TOPIC_SIZE];
+    char topicRssi[DISCOVERY_TOPIC_SIZE];
+    char topicExtra[DISCOVERY_TOPIC_SIZE];
+    snprintf_P(topicExtra, sizeof(topicExtra), PSTR("%s/extra"), Hostname.c_str());
 
     for (size_t i = 0; i < weatherSensor.sensor.size(); i++)
     {
-        uint32_t sensor_id = weatherSensor.sensor[i].sensor_id;
+        const WeatherSensor::sensor_t &s = weatherSensor.sensor[i];
 
-        if (!weatherSensor.sensor[i].valid)
+        if (!s.valid)
             continue;
 
-        String sensor_str = sensorName(weatherSensor.sensor[i].sensor_id);
-        String topic = Hostname + "/" + sensor_str + "/data";
-        String rssi = Hostname + "/" + sensor_str + "/rssi";
-        if ((weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER0) ||
-            (weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER1) ||
-            (weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER2))
+        struct disc_device dev;
+        size_t d;
+        for (d = 0; d < sizeof(discDevices) / sizeof(discDevices[0]); d++)
         {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "Weather Sensor",
-                .identifier = "weather_sensor_1"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "Outside Temperature", sensor_id, "temperature", "°C", topic.c_str(), "temp_c");
-            publishAutoDiscovery(info, "Outside Humidity", sensor_id, "humidity", "%", topic.c_str(), "humidity");
-            if (weatherSensor.sensor[i].w.tglobe_ok)
-            {
-                publishAutoDiscovery(info, "Globe Temperature", sensor_id, "temperature", "°C", topic.c_str(), "tglobe_c");
-            }
-            if (weatherSensor.sensor[i].w.uv_ok)
-            {
-                publishAutoDiscovery(info, "UV Index", sensor_id, NULL, "UV Index", topic.c_str(), "uv");
-            }
-            if (weatherSensor.sensor[i].w.light_ok)
-            {
-                publishAutoDiscovery(info, "Light Lux", sensor_id, "illuminance", "Lux", topic.c_str(), "light_lux");
-            }
-            if (weatherSensor.sensor[i].w.rain_ok)
-            {
-                publishAutoDiscovery(info, "Rainfall", sensor_id, "precipitation", "mm", topic.c_str(), "rain");
-                publishAutoDiscovery(info, "Rainfall Hourly", sensor_id, "precipitation", "mm", topic.c_str(), "rain_h");
-                publishAutoDiscovery(info, "Rainfall Daily", sensor_id, "precipitation", "mm", topic.c_str(), "rain_d");
-                publishAutoDiscovery(info, "Rainfall Weekly", sensor_id, "precipitation", "mm", topic.c_str(), "rain_w");
-                publishAutoDiscovery(info, "Rainfall Monthly", sensor_id, "precipitation", "mm", topic.c_str(), "rain_m");
-            }
-            if (weatherSensor.sensor[i].w.wind_ok)
-            {
-                publishAutoDiscovery(info, "Wind Direction", sensor_id, NULL, "°", topic.c_str(), "wind_dir");
-                publishAutoDiscovery(info, "Wind Gust Speed", sensor_id, "wind_speed", "m/s", topic.c_str(), "wind_gust");
-                publishAutoDiscovery(info, "Wind Average Speed", sensor_id, "wind_speed", "m/s", topic.c_str(), "wind_avg");
-                String topic = Hostname + "/extra";
-                publishAutoDiscovery(info, "Wind Gust Speed (Beaufort)", sensor_id, "wind_speed", "Beaufort", topic.c_str(), "wind_gust_bft");
-                publishAutoDiscovery(info, "Wind Average Speed (Beaufort)", sensor_id, "wind_speed", "Beaufort", topic.c_str(), "wind_avg_bft");
-                publishAutoDiscovery(info, "Wind Direction (Cardinal)", sensor_id, "enum", "", topic.c_str(), "wind_dir_txt");
-            }
-            if (weatherSensor.sensor[i].w.wind_ok &&
-                weatherSensor.sensor[i].w.temp_ok &&
-                weatherSensor.sensor[i].w.humidity_ok)
-            {
-                String topic = Hostname + "/extra";
-                publishAutoDiscovery(info, "Dewpoint", sensor_id, "temperature", "°C", topic.c_str(), "dewpoint_c");
-                publishAutoDiscovery(info, "Perceived Temperature", sensor_id, "temperature", "°C", topic.c_str(), "perceived_temp_c");
-                if (weatherSensor.sensor[i].w.tglobe_ok)
-                {
-                    publishAutoDiscovery(info, "WGBT", sensor_id, "temperature", "°C", topic.c_str(), "wgbt");
-                }
-            }
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_SOIL)
-        {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "Soil Sensor",
-                .identifier = "soil_sensor_1"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "Soil Temperature", sensor_id, "temperature", "°C", topic.c_str(), "temp_c");
-            publishAutoDiscovery(info, "Soil Moisture", sensor_id, "moisture", "%", topic.c_str(), "moisture");
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_THERMO_HYGRO)
-        {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "Thermo-Hygrometer Sensor",
-                .identifier = "thermo_hygrometer_sensor_1"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "Temperature", sensor_id, "temperature", "°C", topic.c_str(), "temp_c");
-            publishAutoDiscovery(info, "Humidity", sensor_id, "humidity", "%", topic.c_str(), "humidity");
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_POOL_THERMO)
-        {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "Pool Thermometer",
-                .identifier = "pool_thermometer_1"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "Pool Temperature", sensor_id, "temperature", "°C", topic.c_str(), "temp_c");
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_AIR_PM)
-        {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "Air Quality (PM) Sensor",
-                .identifier = "air_quality_sensor_1"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "PM1.0", sensor_id, "pm1", "µg/m³", topic.c_str(), "pm1_0_ug_m3");
-            publishAutoDiscovery(info, "PM2.5", sensor_id, "pm25", "µg/m³", topic.c_str(), "pm2_5_ug_m3");
-            publishAutoDiscovery(info, "PM10", sensor_id, "pm10", "µg/m³", topic.c_str(), "pm10_ug_m3");
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_LIGHTNING)
-        {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "Lightning Sensor",
-                .identifier = "lightning_sensor"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "Lightning Count", sensor_id, NULL, "", topic.c_str(), "lightning_count");
-            publishAutoDiscovery(info, "Lightning Distance", sensor_id, "distance", "km", topic.c_str(), "lightning_distance_km");
-            publishAutoDiscovery(info, "Lightning Hour", sensor_id, NULL, "", topic.c_str(), "lightning_hr");
+            memcpy_P(&dev, &discDevices[d], sizeof(dev));
+            if (dev.s_type == s.s_type)
+                break;
         }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_LEAKAGE)
-        {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "Leakage Sensor",
-                .identifier = "leakage_sensor_1"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "Leakage Alarm", sensor_id, "enum", "", topic.c_str(), "leakage");
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_CO2)
-        {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "CO2 Sensor",
-                .identifier = "co2_sensor_1"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "CO2", sensor_id, "co2", "ppm", topic.c_str(), "co2_ppm");
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_HCHO_VOC)
+        if (d == sizeof(discDevices) / sizeof(discDevices[0]))
+            continue;
+
+        String sensor_str = sensorName(s.sensor_id);
+        snprintf_P(topicData, sizeof(topicData), PSTR("%s/%s/data"), Hostname.c_str(), sensor_str.c_str());
+        snprintf_P(topicRssi, sizeof(topicRssi), PSTR("%s/%s/rssi"), Hostname.c_str(), sensor_str.c_str());
+        uint8_t flags = discoveryFlags(s);
+
+        for (size_t n = 0; n < sizeof(discEntries) / sizeof(discEntries[0]); n++)
         {
-            struct sensor_info info = {
-                .manufacturer = "Bresser",
-                .model = "Air Quality (HCHO/VOC) Sensor",
-                .identifier = "air_quality_sensor_2"};
-
-            publishAutoDiscovery(info, "Battery", sensor_id, "battery", "%", topic.c_str(), "battery_ok");
-            publishAutoDiscovery(info, "RSSI", sensor_id, "signal_strength", "dBm", rssi.c_str(), "rssi");
-            publishAutoDiscovery(info, "HCHO", sensor_id, "hcho", "ppb", topic.c_str(), "hcho_ppb");
-            publishAutoDiscovery(info, "VOC", sensor_id, "voc", "", topic.c_str(), "voc");
+            struct disc_entry entry;
+            memcpy_P(&entry, &discEntries[n], sizeof(entry));
+
+            if ((entry.group != DISC_GROUP_COMMON) && (entry.group != dev.group))
+                continue;
+            if ((entry.cond & flags) != entry.cond)
+                continue;
+
+            const char *state_topic = (entry.topic == DISC_TOPIC_RSSI) ? topicRssi : (entry.topic == DISC_TOPIC_EXTRA) ? topicExtra
+                                                                                                                    : topicData;
+            publishAutoDiscovery(dev, entry, s.sensor_id, state_topic);
         }
     } // for (int i=0; i<weatherSensor.sensor.size(); i++)
 
     publishControlDiscovery("Sensor Exclude List", "sensors_exc");
     publishControlDiscovery("Sensor Include List", "sensors_inc");
     publishStatusDiscovery("Receiver Status", "status");
+
+    discStats.duration_ms = millis() - startMillis;
+    log_i("Discovery: %u messages, %lu bytes (max. %u), %u errors, heap min. %lu (start %lu), %lu ms",
+          discStats.messages, (unsigned long)discStats.bytes, discStats.len_max, discStats.errors,
+          (unsigned long)discStats.heap_min, (unsigned long)discStats.heap_start, (unsigned long)discStats.duration_ms);
+}
+
+// Get statistics of last discovery cycle
+const struct discovery_stats &getDiscoveryStats(void)
+{
+    return discStats;
+}
+
+// Append receiver device object and close message
+static void discoveryWriteReceiverDevice(void)
+{
+    discoveryWrite_P(PSTR(",\"device\":{\"identifiers\":\""));
+    discoveryWriteValue(Hostname.c_str());
+    discoveryWrite_P(PSTR("_1\",\"name\":\"Weather Sensor Receiver\"}}"));
 }
 
 // Publish discovery message for MQTT node status
-void publishStatusDiscovery(String name, String topic)
+void publishStatusDiscovery(const char *name, const char *topic)
 {
-    String discoveryTopic = "homeassistant/sensor/" + Hostname + "/" + topic + "/config";
-    String discoveryPayload = R"({
-        "name": ")" + name + R"(",
-        "unique_id":")" + Hostname +
-                              "_" + topic + R"(",
-        "state_topic": ")" + Hostname +
-                              R"(/)" + topic + R"(",
-        "value_template": "{{ value }}",
-        "icon": "mdi:wifi",
-        "device": {
-            "identifiers": ")" +
-                              Hostname + R"(_1",
-            "name": "Weather Sensor Receiver"
-        }
-    })";
-    log_d("%s: %s", discoveryTopic.c_str(), discoveryPayload.c_str());
-    client.publish(discoveryTopic.c_str(), discoveryPayload.c_str(), false, 0);
+    snprintf_P(discMsg.topic, sizeof(discMsg.topic), PSTR("homeassistant/sensor/%s/%s/config"), Hostname.c_str(), topic);
+    discoveryBegin();
+    discoveryWriteField_P(PSTR("{\"name\":"), name);
+    discoveryWrite_P(PSTR(",\"unique_id\":\""));
+    discoveryWriteValue(Hostname.c_str());
+    discoveryWrite("_", 1);
+    discoveryWriteValue(topic);
+    discoveryWrite_P(PSTR("\",\"state_topic\":\""));
+    discoveryWriteValue(Hostname.c_str());
+    discoveryWrite("/", 1);
+    discoveryWriteValue(topic);
+    discoveryWrite_P(PSTR("\",\"value_template\":\"{{ value }}\",\"icon\":\"mdi:wifi\""));
+    discoveryWriteReceiverDevice();
+    discoveryEnd(false);
 }
 
 // Publish discovery messages for receiver control
-void publishControlDiscovery(String name, String topic)
+void publishControlDiscovery(const char *name, const char *topic)
 {
-    String discoveryTopic = "homeassistant/sensor/" + Hostname + "/" + topic + "/config";
-    String discoveryPayload = R"({
-        "name": ")" + name + R"(",
-        "unique_id":")" + Hostname +
-                              "_" + topic + R"(",
-        "state_topic": ")" + Hostname +
-                              R"(/)" + topic + R"(",
-        "value_template": "{{ value_json.ids }}",
-        "icon": "mdi:code-array",
-        "device": {
-            "identifiers": ")" +
-                              Hostname + R"(_1",
-            "name": "Weather Sensor Receiver"
-        }
-    })";
-    log_d("%s: %s", discoveryTopic.c_str(), discoveryPayload.c_str());
-    client.publish(discoveryTopic.c_str(), discoveryPayload.c_str(), true, 0);
-
-    discoveryTopic = "homeassistant/button/" + Hostname + "/get_" + topic + "/config";
-    discoveryPayload = R"({
-        "name": "Get )" +
-                       name + R"(",
-        "platform": "button",
-        "unique_id": ")" +
-                       Hostname + "_get_" + topic + R"(",
-        "command_topic": ")" +
-                       Hostname + "/get_" + topic + R"(",
-        "icon": "mdi:information",
-        "retain": true,
-        "qos": 1,
-        "device": {
-            "identifiers": ")" +
-                       Hostname + R"(_1",
-            "name": "Weather Sensor Receiver"
-        }
-    })";
-    log_d("%s: %s", discoveryTopic.c_str(), discoveryPayload.c_str());
-    client.publish(discoveryTopic.c_str(), discoveryPayload.c_str(), false, 0);
+    snprintf_P(discMsg.topic, sizeof(discMsg.topic), PSTR("homeassistant/sensor/%s/%s/config"), Hostname.c_str(), topic);
+    discoveryBegin();
+    discoveryWriteField_P(PSTR("{\"name\":"), name);
+    discoveryWrite_P(PSTR(",\"unique_id\":\""));
+    discoveryWriteValue(Hostname.c_str());
+    discoveryWrite("_", 1);
+    discoveryWriteValue(topic);
+    discoveryWrite_P(PSTR("\",\"state_topic\":\""));
+    discoveryWriteValue(Hostname.c_str());
+    discoveryWrite("/", 1);
+    discoveryWriteValue(topic);
+    discoveryWrite_P(PSTR("\",\"value_template\":\"{{ value_json.ids }}\",\"icon\":\"mdi:code-array\""));
+    discoveryWriteReceiverDevice();
+    discoveryEnd(true);
+
+    snprintf_P(discMsg.topic, sizeof(discMsg.topic), PSTR("homeassistant/button/%s/get_%s/config"), Hostname.c_str(), topic);
+    discoveryBegin();
+    discoveryWrite_P(PSTR("{\"name\":\"Get "));
+    discoveryWriteValue(name);
+    discoveryWrite_P(PSTR("\",\"platform\":\"button\",\"unique_id\":\""));
+    discoveryWriteValue(Hostname.c_str());
+    discoveryWrite_P(PSTR("_get_"));
+    discoveryWriteValue(topic);
+    discoveryWrite_P(PSTR("\",\"command_topic\":\""));
+    discoveryWriteValue(Hostname.c_str());
+    discoveryWrite_P(PSTR("/get_"));
+    discoveryWriteValue(topic);
+    discoveryWrite_P(PSTR("\",\"icon\":\"mdi:information\",\"retain\":true,\"qos\":1"));
+    discoveryWriteReceiverDevice();
+    discoveryEnd(false);
 }
 
 // Publish auto-discovery configuration for Home Assistant
-void publishAutoDiscovery(const struct sensor_info info, const char *sensor_name, const uint32_t sensor_id, const char *device_class, const char *unit, const char *state_topic, const char *value_json)
+void publishAutoDiscovery(const struct disc_device &dev, const struct disc_entry &entry, const uint32_t sensor_id, const char *state_topic)
 {
-    JsonDocument doc;
-
-    doc["name"] = sensor_name;
-    if (device_class != NULL)
-        doc["device_class"] = device_class;
-    doc["unique_id"] = String(sensor_id, HEX) + String("_") + String(value_json);
-    doc["state_topic"] = state_topic;
-    doc["availability_topic"] = Hostname + "/status";
-    doc["payload_not_available"] = "dead"; // default: "offline"
-    doc["unit_of_measurement"] = unit;
-    if (device_class != NULL)
+    char id[12];
+    snprintf_P(id, sizeof(id), PSTR("%lx_"), (unsigned long)sensor_id);
+    snprintf_P(discMsg.topic, sizeof(discMsg.topic), PSTR("homeassistant/sensor/%s%s/config"), id, entry.key);
+
+    discoveryBegin();
+    discoveryWriteField_P(PSTR("{\"name\":"), entry.name);
+    if (entry.device_class[0] != '\0')
+        discoveryWriteField_P(PSTR(",\"device_class\":"), entry.device_class);
+    discoveryWrite_P(PSTR(",\"unique_id\":\""));
+    discoveryWriteValue(id);
+    discoveryWriteValue(entry.key);
+    discoveryWrite("\"", 1);
+    discoveryWriteField_P(PSTR(",\"state_topic\":"), state_topic);
+    discoveryWrite_P(PSTR(",\"availability_topic\":\""));
+    discoveryWriteValue(Hostname.c_str());
+    discoveryWrite_P(PSTR("/status\",\"payload_not_available\":\"dead\"")); // default: "offline"
+    discoveryWriteField_P(PSTR(",\"unit_of_measurement\":"), entry.unit);
+    if (entry.device_class[0] != '\0')
     {
-        if (strcmp(device_class, "battery") == 0)
+        if (strcmp_P(entry.device_class, PSTR("battery")) == 0)
         {
-            doc["value_template"] = String("{{ (value_json.") + value_json + " | float) * 100.0 }}";
+            discoveryWrite_P(PSTR(",\"value_template\":\"{{ (value_json."));
+            discoveryWriteValue(entry.key);
+            discoveryWrite_P(PSTR(" | float) * 100.0 }}\""));
         }
-        else if (strcmp(device_class, "signal_strength") == 0)
+        else if (strcmp_P(entry.device_class, PSTR("signal_strength")) == 0)
         {
-            doc["value_template"] = "{{ value }}";
+            discoveryWrite_P(PSTR(",\"value_template\":\"{{ value }}\""));
         }
         else
         {
-            doc["value_template"] = String("{{ value_json.") + value_json + " }}";
+            discoveryWrite_P(PSTR(",\"value_template\":\"{{ value_json."));
+            discoveryWriteValue(entry.key);
+            discoveryWrite_P(PSTR(" }}\""));
         }
     }
-    JsonObject device = doc["device"].to<JsonObject>();
-    device["identifiers"] = info.identifier;
-    device["name"] = info.manufacturer + " " + info.model;
-    if (info.model != "")
-        device["model"] = info.model;
-    if (info.manufacturer != "")
-        device["manufacturer"] = info.manufacturer;
-
-    char buffer[512];
-    serializeJson(doc, buffer);
-
-    String topic = String("homeassistant/sensor/") + String(sensor_id, HEX) + "_" + String(value_json) + "/config";
-    log_d("Publishing auto-discovery configuration: %s: %s", topic.c_str(), buffer);
-    client.publish(topic, buffer, true /* retained */, 0 /* qos */);
-    log_d("Published auto-discovery configuration for %s", sensor_name);
+    discoveryWrite_P(PSTR(",\"device\":{\"identifiers\":\""));
+    discoveryWriteValue(dev.identifier);
+    discoveryWrite_P(PSTR("\",\"name\":\""));
+    discoveryWrite_P(discManufacturer);
+    discoveryWrite(" ", 1);
+    discoveryWriteValue(dev.model);
+    discoveryWrite_P(PSTR("\",\"model\":\""));
+    discoveryWriteValue(dev.model);
+    discoveryWrite_P(PSTR("\",\"manufacturer\":\""));
+    discoveryWrite_P(discManufacturer);
+    discoveryWrite_P(PSTR("\"}}"));
+
+    if (discoveryEnd(true /* retained */))
+        log_d("Published auto-discovery configuration for %s", entry.name);
 }
 #endif // AUTO_DISCOVERY
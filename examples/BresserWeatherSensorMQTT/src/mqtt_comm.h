@@ -38,6 +38,18 @@
 // 20250221 Created from BresserWeatherSensorMQTT.ino
 // 20250226 Added parameter 'retain' to publishWeatherdata()
 // 20250227 Added publishControlDiscovery()
+// 20250414 Increased PAYLOAD_SIZE for wake cycle summary
+// 20250427 Replaced struct sensor_info by flash resident discovery tables
+//          (struct disc_entry/disc_device), added getDiscoveryStats()
+// 20250501 Added JSON_FLOATS_QUOTED (SensorJsonWriter)
+// 20250504 Added include AirQuality.h
+// 20250505 Added include Evapotranspiration.h
+// 20250506 Increased PAYLOAD_SIZE for checkpoint (hex string),
+//          added saveCheckpointHex()/restoreCheckpointHex()
+// 20250507 Added struct AirQualitySensor
+// 20250508 Added NOISE_FLOOR_EN
+// 20250508 Added AIR_QUALITY_EN
+// 20250508 Added ET0_EN; moved SITE_* from BresserWeatherSensorMQTT.ino
 //
 // ToDo:
 // -
@@ -47,8 +59,20 @@
 #ifndef MQTT_COMM_H
 #define MQTT_COMM_H
 
-#define PAYLOAD_SIZE 300      // maximum MQTT message size
+#define PAYLOAD_SIZE 600      // maximum MQTT message size
 #define AUTO_DISCOVERY        // enable Home Assistant auto discovery
+#define DISCOVERY_SIZE 512    // maximum auto discovery message size
+#define DISCOVERY_TOPIC_SIZE 96 // maximum auto discovery/state topic size
+//#define NOISE_FLOOR_EN        // enable noise floor estimator and adaptive RSSI threshold ('radio' topic)
+//#define AIR_QUALITY_EN        // enable PM NowCast and AQI for the sensors in airQualitySensors[]
+//#define ET0_EN                // enable reference evapotranspiration and water balance ('extra' topic)
+
+#ifdef ET0_EN
+// Site for evapotranspiration (ET0) calculation - replace by your own values!
+#define SITE_LATITUDE 52.5    // latitude [°] (north: positive)
+#define SITE_ELEVATION 34     // elevation above sea level [m]
+#define WIND_SENSOR_HEIGHT 2  // height of wind sensor above ground [m]
+#endif
 
 #include <Arduino.h>
 #include <string>
@@ -61,6 +85,9 @@
 #include "WeatherUtils.h"
 #include "RainGauge.h"
 #include "Lightning.h"
+#include "AirQuality.h"
+#include "Evapotranspiration.h"
+#include "Checkpoint.h"
 
 // See
 // https://stackoverflow.com/questions/19554972/json-standard-floating-point-numbers
@@ -75,19 +102,83 @@
 
 #if defined(JSON_FLOAT_AS_STRING)
 #define JSON_FLOAT(x) String("\"") + x + String("\"")
+#define JSON_FLOATS_QUOTED true
 #else
 #define JSON_FLOAT(x) x
+#define JSON_FLOATS_QUOTED false
+#endif
+
+#ifdef AIR_QUALITY_EN
+// PM sensor with NowCast/AQI (one AirQuality object and Preferences namespace per sensor)
+struct AirQualitySensor
+{
+    uint32_t id;                // sensor ID
+    AirQuality aq;              // hourly averages, NowCast and AQI
+};
+
+extern AirQualitySensor airQualitySensors[];
+extern const size_t numAirQualitySensors;
 #endif
 
 extern void mqtt_setup(void);
 
-// Sensor information for Home Assistant auto discovery
-struct sensor_info
+#if defined(AUTO_DISCOVERY)
+// Sensor groups for Home Assistant auto discovery
+enum disc_group : uint8_t
+{
+    DISC_GROUP_COMMON,          // published for all sensors
+    DISC_GROUP_WEATHER,
+    DISC_GROUP_SOIL,
+    DISC_GROUP_THERMO_HYGRO,
+    DISC_GROUP_POOL_THERMO,
+    DISC_GROUP_AIR_PM,
+    DISC_GROUP_LIGHTNING,
+    DISC_GROUP_LEAKAGE,
+    DISC_GROUP_CO2,
+    DISC_GROUP_HCHO_VOC
+};
+
+// State topic of sensor value
+enum disc_topic : uint8_t
+{
+    DISC_TOPIC_DATA,            // <Hostname>/<sensor>/data
+    DISC_TOPIC_RSSI,            // <Hostname>/<sensor>/rssi
+    DISC_TOPIC_EXTRA            // <Hostname>/extra
+};
+
+// Home Assistant auto discovery template for one sensor value (stored in flash)
+struct disc_entry
+{
+    char name[32];              // sensor name (e.g. "Outside Temperature")
+    char device_class[16];      // device class ("": none)
+    char unit[12];              // unit of measurement
+    char key[24];               // key in MQTT message JSON string
+    uint8_t group;              // sensor group (disc_group)
+    uint8_t topic;              // state topic (disc_topic)
+    uint8_t cond;               // required sensor values (DISC_* flags)
+};
+
+// Sensor information for Home Assistant auto discovery (stored in flash)
+struct disc_device
+{
+    uint8_t s_type;             // sensor type (SENSOR_TYPE_*)
+    uint8_t group;              // sensor group (disc_group)
+    char model[32];             // model
+    char identifier[28];        // device identifier
+};
+
+// Statistics of last auto discovery cycle
+struct discovery_stats
 {
-    String manufacturer;
-    String model;
-    String identifier;
+    uint16_t messages;          // number of messages
+    uint16_t len_max;           // maximum payload size [bytes]
+    uint16_t errors;            // number of messages not published
+    uint32_t bytes;             // total payload size [bytes]
+    uint32_t heap_start;        // free heap at start [bytes]
+    uint32_t heap_min;          // minimum free heap [bytes]
+    uint32_t duration_ms;       // duration [ms]
 };
+#endif
 
 /*!
  * \brief (Re-)Connect to WLAN and connect MQTT broker
@@ -102,6 +193,25 @@ struct sensor_info
  */
 void messageReceived(String &topic, String &payload);
 
+/*!
+ * \brief Save checkpoint of RainGauge, Lightning and receiver configuration as hex string
+ *
+ * \param hex  string buffer
+ * \param size size of string buffer (2 * CHECKPOINT_MAX_SIZE + 1 is sufficient)
+ *
+ * \returns length of string, 0 on error
+ */
+size_t saveCheckpointHex(char *hex, size_t size);
+
+/*!
+ * \brief Restore checkpoint of RainGauge, Lightning and receiver configuration from hex string
+ *
+ * \param hex hex string
+ *
+ * \returns status (see Checkpoint.h)
+ */
+CheckpointStatus restoreCheckpointHex(const char *hex);
+
 /*!
  * \brief Publish weather data as MQTT message
  *
@@ -125,18 +235,26 @@ void publishRadio(void);
  */
 void haAutoDiscovery(void);
 
+/*!
+ * \brief Get statistics of last auto discovery cycle
+ *
+ * heap_start - heap_min is the peak heap usage during discovery; the discovery
+ * message buffer is statically allocated (DISCOVERY_SIZE + DISCOVERY_TOPIC_SIZE).
+ */
+const struct discovery_stats &getDiscoveryStats(void);
+
 /*!
  * \brief Publish auto-discovery configuration for Home Assistant
  *
- * \param info          Sensor information (manufacturer, model, identifier)
- * \param sensor_name   Sensor name (e.g. "Outside Temperature")
+ * The payload is assembled chunk-wise from the flash resident templates
+ * in a static buffer, i.e. without String or JsonDocument.
+ *
+ * \param dev           Sensor information (model, identifier)
+ * \param entry         Discovery template (name, device class, unit, key)
  * \param sensor_id     Sensor ID (unique)
- * \param device_class  Device class (e.g. temperature, humidity, etc.)
- * \param unit          Unit of measurement
  * \param state_topic   State topic; MQTT topic where sensor data is published
- * \param value_json    Sensor value in MQTT message JSON string
  */
-void publishAutoDiscovery(const struct sensor_info info, const char *sensor_name, const uint32_t sensor_id, const char *device_class, const char *unit, const char *state_topic, const char *value_json);
+void publishAutoDiscovery(const struct disc_device &dev, const struct disc_entry &entry, const uint32_t sensor_id, const char *state_topic);
 
 /*!
  * \brief Publish Home Assistant auto discovery for MQTT node status
@@ -144,7 +262,7 @@ void publishAutoDiscovery(const struct sensor_info info, const char *sensor_name
  * \param name  Control name
  * \param topic MQTT topic
  */
-void publishStatusDiscovery(String name, String topic);
+void publishStatusDiscovery(const char *name, const char *topic);
 
 /*!
  * \brief Publish Home Assistant auto discovery for receiver control
@@ -152,7 +270,7 @@ void publishStatusDiscovery(String name, String topic);
  * \param name  Control name
  * \param topic MQTT topic
  */
-void publishControlDiscovery(String name, String topic);
+void publishControlDiscovery(const char *name, const char *topic);
 
 #endif // AUTO_DISCOVERY
 #endif // MQTT_COMM_H
\ No newline at end of file
@@ -38,6 +38,7 @@
 // 20250221 Created from BresserWeatherSensorMQTT.ino
 // 20250226 Added parameter 'retain' to publishWeatherdata()
 // 20250227 Added publishControlDiscovery()
+// 20250507 Added JSON_FLOATS_QUOTED (SensorJsonWriter), include SensorFields.h
 //
 // ToDo:
 // -
@@ -58,6 +59,7 @@
 #include <ArduinoJson.h>
 #include "WeatherSensorCfg.h"
 #include "WeatherSensor.h"
+#include "SensorFields.h"
 #include "WeatherUtils.h"
 #include "RainGauge.h"
 #include "Lightning.h"
@@ -75,8 +77,10 @@
 
 #if defined(JSON_FLOAT_AS_STRING)
 #define JSON_FLOAT(x) String("\"") + x + String("\"")
+#define JSON_FLOATS_QUOTED true
 #else
 #define JSON_FLOAT(x) x
+#define JSON_FLOATS_QUOTED false
 #endif
 
 extern void mqtt_setup(void);
@@ -39,6 +39,7 @@
 // 20250227 Added publishControlDiscovery()
 // 20250228 Added publishStatusDiscovery(), fixed sensorName()
 // 20250420 Added timestamp to measument data,fixed base-topic in extra data
+// 20250507 publishWeatherdata(): sensor data JSON built with field visitor (SensorFields.h)
 //
 // ToDo:
 // -
@@ -121,12 +122,41 @@ void messageReceived(String &topic, String &payload)
     }
 }
 
+// JSON writer for sensor data; adds rain gauge statistics after the rain gauge level
+class DataJsonWriter : public SensorJsonWriter
+{
+public:
+    const char *timestamp = nullptr; // written after header fields if set
+
+    DataJsonWriter(char *buf, size_t size, bool complete)
+        : SensorJsonWriter(buf, size, complete, JSON_FLOATS_QUOTED)
+    {
+    }
+
+    template <typename F, typename T>
+    void operator()(F f, T value, bool valid)
+    {
+        SensorJsonWriter::operator()(f, value, valid);
+        if ((F::id() == SF_BATTERY_OK) && timestamp)
+        {
+            writeString("timestamp", timestamp);
+        }
+        if ((F::id() == SF_RAIN) && (valid || complete))
+        {
+            writeFloat("rain_h", rainGauge.pastHour(), 1);
+            writeFloat("rain_d", rainGauge.currentDay(), 1);
+            writeFloat("rain_w", rainGauge.currentWeek(), 1);
+            writeFloat("rain_m", rainGauge.currentMonth(), 1);
+        }
+    }
+};
+
 // Publish weather data as MQTT message
 void publishWeatherdata(bool complete, bool retain)
 {
-    String mqtt_payload;  // sensor data
-    String mqtt_payload2; // calculated extra data
-    String mqtt_topic;    // MQTT topic including ID/name
+    char mqtt_payload[PAYLOAD_SIZE]; // sensor data
+    String mqtt_payload2;            // calculated extra data
+    String mqtt_topic;               // MQTT topic including ID/name
 
     // ArduinoJson does not allow to set number of decimals for floating point data -
     // neither does MQTT Dashboard...
@@ -135,7 +165,6 @@ void publishWeatherdata(bool complete, bool retain)
     for (size_t i = 0; i < weatherSensor.sensor.size(); i++)
     {
         // Reset string buffers
-        mqtt_payload = "";
         mqtt_payload2 = "";
 
         if (!weatherSensor.sensor[i].valid)
@@ -150,36 +179,22 @@ void publishWeatherdata(bool complete, bool retain)
         }
 
         // Example:
-        // {"ch":0,"battery_ok":1,"humidity":44,"wind_gust":1.2,"wind_avg":1.2,"wind_dir":150,"rain":146}
-        mqtt_payload = "{";
+        // {"id":1234,"ch":0,"battery_ok":1,"humidity":44,"wind_gust":1.2,"wind_avg":1.2,"wind_dir":150,"rain":146}
+        DataJsonWriter json(mqtt_payload, sizeof(mqtt_payload), complete);
+#if defined(DATA_TIMESTAMP)
+        // Timestamp in ISO 8601 format (UTC)
+        char tsbuf[25];
+        time_t ts_now = time(nullptr);
+        struct tm ts_info;
+        gmtime_r(&ts_now, &ts_info);
+        strftime(tsbuf, sizeof(tsbuf), "%Y-%m-%dT%H:%M:%SZ", &ts_info);
+        json.timestamp = tsbuf;
+#endif // DATA_TIMESTAMP
+        visitSensorFields(weatherSensor.sensor[i], json);
         mqtt_payload2 = "{";
-        mqtt_payload += String("\"id\":") + String(weatherSensor.sensor[i].sensor_id);
-        mqtt_payload += String(",\"ch\":") + String(weatherSensor.sensor[i].chan);
-        mqtt_payload += String(",\"battery_ok\":") + (weatherSensor.sensor[i].battery_ok ? String("1") : String("0"));
 
-        #if defined(DATA_TIMESTAMP)
+        if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_LIGHTNING)
         {
-            // Generate timestamp in ISO 8601 format
-            time_t now = time(nullptr);
-            struct tm timeinfo;
-            gmtime_r(&now, &timeinfo); // Convert to UTC time
-            char tbuf[25];
-            strftime(tbuf, sizeof(tbuf), "%Y-%m-%dT%H:%M:%SZ", &timeinfo); // Format as ISO 8601
-            mqtt_payload += String(",\"timestamp\":\"") + String(tbuf) + String("\"");
-        }
-        #endif // DATA_TIMESTAMP
-
-        if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_SOIL)
-        {
-            mqtt_payload += String(",\"temp_c\":") + String(weatherSensor.sensor[i].soil.temp_c);
-            mqtt_payload += String(",\"moisture\":") + String(weatherSensor.sensor[i].soil.moisture);
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_LIGHTNING)
-        {
-            mqtt_payload += String(",\"lightning_count\":") + String(weatherSensor.sensor[i].lgt.strike_count);
-            mqtt_payload += String(",\"lightning_distance_km\":") + String(weatherSensor.sensor[i].lgt.distance_km);
-            mqtt_payload += String(",\"lightning_unknown1\":\"0x") + String(weatherSensor.sensor[i].lgt.unknown1, HEX) + String("\"");
-            mqtt_payload += String(",\"lightning_unknown2\":\"0x") + String(weatherSensor.sensor[i].lgt.unknown2, HEX) + String("\"");
             struct tm timeinfo;
             time_t now = time(nullptr);
             localtime_r(&now, &timeinfo);
@@ -188,7 +203,7 @@ void publishWeatherdata(bool complete, bool retain)
                 weatherSensor.sensor[i].lgt.strike_count,
                 weatherSensor.sensor[i].lgt.distance_km,
                 weatherSensor.sensor[i].startup);
-            mqtt_payload += String(",\"lightning_hr\":") + String(lightning.pastHour());
+            json.writeInt("lightning_hr", lightning.pastHour());
             int events;
             time_t timestamp;
             uint8_t distance;
@@ -198,50 +213,9 @@ void publishWeatherdata(bool complete, bool retain)
                 struct tm timeinfo;
                 gmtime_r(&timestamp, &timeinfo);
                 strftime(tbuf, 25, "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-                mqtt_payload += String(",\"lightning_event_time\":\"") + String(tbuf) + String("\"");
-                mqtt_payload += String(",\"lightning_event_count\":") + String(events);
-                mqtt_payload += String(",\"lightning_event_distance_km\":") + String(distance);
-            }
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_LEAKAGE)
-        {
-            // Water Leakage Sensor
-            mqtt_payload += String(",\"leakage\":") + String(weatherSensor.sensor[i].leak.alarm);
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_AIR_PM)
-        {
-            // Air Quality (Particular Matter) Sensor
-            if (!weatherSensor.sensor[i].pm.pm_1_0_init)
-            {
-                mqtt_payload += String(",\"pm1_0_ug_m3\":") + String(weatherSensor.sensor[i].pm.pm_1_0);
-            }
-            if (!weatherSensor.sensor[i].pm.pm_2_5_init)
-            {
-                mqtt_payload += String(",\"pm2_5_ug_m3\":") + String(weatherSensor.sensor[i].pm.pm_2_5);
-            }
-            if (!weatherSensor.sensor[i].pm.pm_10_init)
-            {
-                mqtt_payload += String(",\"pm10_ug_m3\":") + String(weatherSensor.sensor[i].pm.pm_10);
-            }
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_CO2)
-        {
-            // CO2 Sensor
-            if (!weatherSensor.sensor[i].co2.co2_init)
-            {
-                mqtt_payload += String(",\"co2_ppm\":") + String(weatherSensor.sensor[i].co2.co2_ppm);
-            }
-        }
-        else if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_HCHO_VOC)
-        {
-            // HCHO / VOC Sensor
-            if (!weatherSensor.sensor[i].voc.hcho_init)
-            {
-                mqtt_payload += String(",\"hcho_ppb\":") + String(weatherSensor.sensor[i].voc.hcho_ppb);
-            }
-            if (!weatherSensor.sensor[i].voc.voc_init)
-            {
-                mqtt_payload += String(",\"voc\":") + String(weatherSensor.sensor[i].voc.voc_level);
+                json.writeString("lightning_event_time", tbuf);
+                json.writeInt("lightning_event_count", events);
+                json.writeUInt("lightning_event_distance_km", distance);
             }
         }
         else if ((weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER0) ||
@@ -250,21 +224,6 @@ void publishWeatherdata(bool complete, bool retain)
                  (weatherSensor.sensor[i].s_type == SENSOR_TYPE_THERMO_HYGRO) ||
                  (weatherSensor.sensor[i].s_type == SENSOR_TYPE_POOL_THERMO))
         {
-
-            if (weatherSensor.sensor[i].w.temp_ok || complete)
-            {
-                mqtt_payload += String(",\"temp_c\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.temp_c, 1));
-            }
-            if (weatherSensor.sensor[i].w.humidity_ok || complete)
-            {
-                mqtt_payload += String(",\"humidity\":") + String(weatherSensor.sensor[i].w.humidity);
-            }
-            if (weatherSensor.sensor[i].w.wind_ok || complete)
-            {
-                mqtt_payload += String(",\"wind_gust\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.wind_gust_meter_sec, 1));
-                mqtt_payload += String(",\"wind_avg\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.wind_avg_meter_sec, 1));
-                mqtt_payload += String(",\"wind_dir\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.wind_direction_deg, 1));
-            }
             if (weatherSensor.sensor[i].w.wind_ok)
             {
                 char buf[4];
@@ -287,36 +246,13 @@ void publishWeatherdata(bool complete, bool retain)
                     mqtt_payload2 += String(",\"wgbt\":") + JSON_FLOAT(String(wbgt, 1));
                 }
             }
-            if (weatherSensor.sensor[i].w.uv_ok || complete)
-            {
-                mqtt_payload += String(",\"uv\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.uv, 1));
-            }
-            if (weatherSensor.sensor[i].w.light_ok || complete)
-            {
-                mqtt_payload += String(",\"light_klx\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.light_klx, 1));
-            }
-            if (weatherSensor.sensor[i].s_type == SENSOR_TYPE_WEATHER2)
-            {
-                if (weatherSensor.sensor[i].w.tglobe_ok || complete)
-                {
-                    mqtt_payload += String(",\"t_globe_c\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.tglobe_c, 1));
-                }
-            }
-            if (weatherSensor.sensor[i].w.rain_ok || complete)
-            {
-                mqtt_payload += String(",\"rain\":") + JSON_FLOAT(String(weatherSensor.sensor[i].w.rain_mm, 1));
-                mqtt_payload += String(",\"rain_h\":") + JSON_FLOAT(String(rainGauge.pastHour(), 1));
-                mqtt_payload += String(",\"rain_d\":") + JSON_FLOAT(String(rainGauge.currentDay(), 1));
-                mqtt_payload += String(",\"rain_w\":") + JSON_FLOAT(String(rainGauge.currentWeek(), 1));
-                mqtt_payload += String(",\"rain_m\":") + JSON_FLOAT(String(rainGauge.currentMonth(), 1));
-            }
         }
-        mqtt_payload += String("}");
+        json.end();
         mqtt_payload2 += String("}");
 
-        if (mqtt_payload.length() >= PAYLOAD_SIZE)
+        if (json.overflowed())
         {
-            log_e("mqtt_payload (%d) > PAYLOAD_SIZE (%d). Payload will be truncated!", mqtt_payload.length(), PAYLOAD_SIZE);
+            log_e("mqtt_payload (%d) > PAYLOAD_SIZE (%d). Payload is truncated!", (int)json.length(), PAYLOAD_SIZE);
         }
         if (mqtt_payload2.length() >= PAYLOAD_SIZE)
         {
@@ -332,8 +268,8 @@ void publishWeatherdata(bool complete, bool retain)
         // sensor data
         mqtt_topic = mqtt_topic_base + mqttPubData;
 
-        log_i("%s: %s\n", mqtt_topic.c_str(), mqtt_payload.c_str());
-        client.publish(mqtt_topic, mqtt_payload.substring(0, PAYLOAD_SIZE - 1), retain, 0);
+        log_i("%s: %s\n", mqtt_topic.c_str(), mqtt_payload);
+        client.publish(mqtt_topic, mqtt_payload, retain, 0);
 
         // sensor specific RSSI
         mqtt_topic = mqtt_topic_base + mqttPubRssi;
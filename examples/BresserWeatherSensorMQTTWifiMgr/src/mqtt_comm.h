@@ -39,6 +39,7 @@
 // 20250226 Added parameter 'retain' to publishWeatherdata()
 // 20250227 Added publishControlDiscovery()
 // 20250420 removed AUTO_DISCOVERY here, as it is defined in sketch
+// 20250507 Added JSON_FLOATS_QUOTED (SensorJsonWriter)
 //
 // ToDo:
 // -
@@ -75,8 +76,10 @@
 
 #if defined(JSON_FLOAT_AS_STRING)
 #define JSON_FLOAT(x) String("\"") + x + String("\"")
+#define JSON_FLOATS_QUOTED true
 #else
 #define JSON_FLOAT(x) x
+#define JSON_FLOATS_QUOTED false
 #endif
 
 extern void mqtt_setup(void);
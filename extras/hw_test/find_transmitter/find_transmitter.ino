@@ -6,6 +6,9 @@
 // - BresserWeatherSensorReceiver receives the sensor data and measures the RSSI
 // - An LSM303DLH module is used as an electronic compass and provides the heading
 // - LoRa32-OLED displays heading, RSSI and some sensor data
+// - In addition to the RSSI of received messages, the RSSI is sampled
+//   at a fixed interval (RSSI_SAMPLE_INTERVAL) between messages;
+//   each sample is printed with timestamp and heading for later analysis
 //
 // https://github.com/matthias-bs/BresserWeatherSensorReceiver
 //
@@ -53,6 +56,8 @@
 // History:
 //
 // 20240306 Created
+// 20250413 Added RSSI tracking of a single sensor ID and continuous RSSI sampling
+// 20250508 Added RSSI sample ring buffer (see WeatherSensor::setRssiBuffer())
 //
 // ToDo: 
 // - 
@@ -77,10 +82,26 @@
 #define SCREEN_ADDRESS 0x3C ///< See datasheet for Address; 0x3D for 128x64, 0x3C for 128x32
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 
+// Sensor ID to be tracked; 0: use ID of first message received
+#define TRACK_ID 0
+
+// Continuous RSSI sampling interval in ms; 0: disabled
+#define RSSI_SAMPLE_INTERVAL 50
+
+// Number of continuous RSSI samples averaged for display
+#define RSSI_AVG_SAMPLES 8
+
 Adafruit_LSM303DLH_Mag_Unified mag = Adafruit_LSM303DLH_Mag_Unified(12345);
 
 WeatherSensor ws;
 
+uint32_t trackId = TRACK_ID;
+
+// RSSI sample ring buffer
+RssiSample rssiRing[RSSI_RING_SIZE];
+float rssiPacket = 0;
+float rssiAvg = 0;
+
 void setup() {    
     Serial.begin(115200);
     Serial.setDebugOutput(true);
@@ -101,6 +122,12 @@ void setup() {
 
     display.cp437(true);
     ws.begin();
+    ws.setRssiBuffer(rssiRing, RSSI_RING_SIZE);
+
+    if (trackId) {
+        ws.setRssiTracking(trackId);
+    }
+    ws.setRssiSampling(RSSI_SAMPLE_INTERVAL);
 }
 
 
@@ -130,7 +157,31 @@ void loop()
     // Timeout occurs after a small multiple of expected time-on-air.
     int decode_status = ws.getMessage();
 
-    if (decode_status == DECODE_OK) {
+    if ((decode_status == DECODE_OK) && (trackId == 0)) {
+        trackId = ws.sensor[i].sensor_id;
+        ws.setRssiTracking(trackId);
+        rssiPacket = ws.sensor[i].rssi;
+        Serial.printf("Tracking Id: [%8X]\n", static_cast<int>(trackId));
+    }
+
+    // Process RSSI samples
+    RssiSample sample;
+    bool rssiUpdated = false;
+    while (ws.getRssiSample(sample)) {
+        if (sample.type == RSSI_SAMPLE_PACKET) {
+            rssiPacket = sample.rssi;
+        } else {
+            rssiAvg += (sample.rssi - rssiAvg) / RSSI_AVG_SAMPLES;
+            rssiUpdated = true;
+        }
+        Serial.printf("RSSI; %lu; %3.0f; %c; %6.1f\n",
+            static_cast<unsigned long>(sample.timestamp),
+            heading,
+            (sample.type == RSSI_SAMPLE_PACKET) ? 'P' : 'C',
+            sample.rssi);
+    }
+
+    if ((decode_status == DECODE_OK) && (ws.sensor[i].sensor_id == trackId)) {
         char buf[44];
         Serial.printf("Heading: [%3.0f°] Id: [%8X] Typ: [%X] Ch: [%d] St: [%d] Bat: [%-3s] RSSI: [%6.1fdBm]\n",
             heading,
@@ -157,10 +208,25 @@ void loop()
         snprintf(buf, sizeof(buf)-1, "%03d%c %4d",
             static_cast<int>(heading),
             0xF8, // degree character in cp437
-            static_cast<int>(ws.sensor[i].rssi));
+            static_cast<int>(rssiPacket));
         display.setTextSize(2);              // Draw 2X-scale text
         display.println(buf);
         display.display();
     } // if (decode_status == DECODE_OK)
-    delay(100);
+    else if (rssiUpdated) {
+        // Update heading and averaged continuous RSSI in bottom line
+        char buf[16];
+        snprintf(buf, sizeof(buf)-1, "%03d%c %4d",
+            static_cast<int>(heading),
+            0xF8, // degree character in cp437
+            static_cast<int>(rssiAvg));
+        display.fillRect(0, 16, SCREEN_WIDTH, 16, SSD1306_BLACK);
+        display.setTextSize(2);
+        display.setCursor(0, 16);
+        display.println(buf);
+        display.display();
+    }
+    if (RSSI_SAMPLE_INTERVAL == 0) {
+        delay(100);
+    }
 } // loop()
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UdpRecordReceiver.cpp
+//
+// Host-side receiver of decoded sensor data records sent by UdpSink
+//
+// POSIX sockets (Linux, macOS); records are decoded with SensorRecord.h
+// and checked for losses by their sequence numbers.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250418 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "UdpRecordReceiver.h"
+
+UdpRecordReceiver::UdpRecordReceiver(void)
+{
+    fd = -1;
+    invalid = 0;
+}
+
+UdpRecordReceiver::~UdpRecordReceiver(void)
+{
+    close();
+}
+
+bool UdpRecordReceiver::open(const char *addr, uint16_t port, const char *iface)
+{
+    struct in_addr group;
+    if (inet_pton(AF_INET, addr, &group) != 1)
+        return false;
+
+    close();
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return false;
+
+    // Allow several consumers on the same host
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#ifdef SO_REUSEPORT
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+#endif
+
+    bool multicast = IN_MULTICAST(ntohl(group.s_addr));
+
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    sa.sin_addr.s_addr = multicast ? htonl(INADDR_ANY) : group.s_addr;
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+    {
+        close();
+        return false;
+    }
+
+    if (multicast)
+    {
+        struct ip_mreq mreq;
+        mreq.imr_multiaddr = group;
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (iface && (inet_pton(AF_INET, iface, &mreq.imr_interface) != 1))
+        {
+            close();
+            return false;
+        }
+        if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+        {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void UdpRecordReceiver::close(void)
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+int UdpRecordReceiver::receive(SensorRecord &rec, int timeout_ms)
+{
+    uint8_t buf[SENSOR_RECORD_MAX_SIZE + 16];
+
+    if (fd < 0)
+        return -1;
+
+    for (;;)
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int res = poll(&pfd, 1, timeout_ms);
+        if (res == 0)
+            return 0;
+        if (res < 0)
+            return -1;
+
+        ssize_t len = recv(fd, buf, sizeof(buf), 0);
+        if (len < 0)
+            return -1;
+
+        if (decodeRecord(buf, len, rec))
+        {
+            seq.update(rec.receiver_id, rec.seq);
+            return 1;
+        }
+        invalid++;
+    }
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UdpRecordReceiver.h
+//
+// Host-side receiver of decoded sensor data records sent by UdpSink
+//
+// POSIX sockets (Linux, macOS); records are decoded with SensorRecord.h
+// and checked for losses by their sequence numbers.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250418 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _UDP_RECORD_RECEIVER_H
+#define _UDP_RECORD_RECEIVER_H
+
+#include <stdint.h>
+#include "SensorRecord.h"
+
+#define UDP_RECEIVER_GROUP "239.66.87.83"
+#define UDP_RECEIVER_PORT 47883
+
+
+/**
+ * \class UdpRecordReceiver
+ *
+ * \brief Reception of sensor data records from UdpSink
+ *
+ * Several receivers (processes) on the same host can listen to the same group and port.
+ */
+class UdpRecordReceiver {
+
+private:
+    int fd;
+
+public:
+    RecordSeqTracker seq;   //!< loss detection
+    uint32_t invalid;       //!< number of invalid datagrams
+
+    UdpRecordReceiver(void);
+    ~UdpRecordReceiver(void);
+
+    /**
+     * \brief Open socket and join multicast group
+     *
+     * If addr is not a multicast address, the socket is bound to addr (e.g. "127.0.0.1").
+     *
+     * \param addr      multicast group address (or unicast address)
+     * \param port      UDP port
+     * \param iface     address of local interface for joining the group (nullptr: any)
+     *
+     * \returns true if successful
+     */
+    bool open(const char *addr = UDP_RECEIVER_GROUP, uint16_t port = UDP_RECEIVER_PORT,
+              const char *iface = nullptr);
+
+    /**
+     * \brief Close socket
+     */
+    void close(void);
+
+    /**
+     * \brief Receive record
+     *
+     * Invalid datagrams are skipped (and counted).
+     *
+     * \param rec           record
+     * \param timeout_ms    timeout in ms (-1: wait forever)
+     *
+     * \returns 1: record received, 0: timeout, -1: error
+     */
+    int receive(SensorRecord &rec, int timeout_ms = -1);
+};
+
+#endif // _UDP_RECORD_RECEIVER_H
@@ -0,0 +1,195 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// owner_sim.cpp
+//
+// Simulated receiver for testing sensor ownership election (see SensorOwnership.h)
+// with several processes on one host
+//
+// Each process simulates a receiver which receives the sensors 0x1000, 0x1001, ...
+// with the given mean RSSI (+/-2 dB noise) every second, announces its RSSI summary
+// via UDP multicast and counts the messages it would publish (i.e. owned sensors).
+//
+// Build (from this directory):
+//   g++ -O2 -DOWNER_ANNOUNCE_MS=2000 -I../../src -o owner_sim owner_sim.cpp ../../src/SensorOwnership.cpp
+//
+// Usage:
+//   ./owner_sim <receiver_id> <duration_s> <rssi_sensor_0> [<rssi_sensor_1> ...]
+//
+// Example (loopback, three receivers, three sensors):
+//   ./owner_sim 1 30 -70 -90 -80 & ./owner_sim 2 30 -75 -72 -95 & ./owner_sim 3 30 -90 -85 -60
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250425 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "SensorOwnership.h"
+
+#define OWNER_GROUP "239.66.87.83"
+#define OWNER_PORT 47885
+#define OWNER_IFACE "127.0.0.1"
+#define MAX_SIM_SENSORS 8
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+static int open_socket(struct sockaddr_in &dst)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return -1;
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#ifdef SO_REUSEPORT
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+#endif
+
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(OWNER_PORT);
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+        return -1;
+
+    struct ip_mreq mreq;
+    inet_pton(AF_INET, OWNER_GROUP, &mreq.imr_multiaddr);
+    inet_pton(AF_INET, OWNER_IFACE, &mreq.imr_interface);
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+        return -1;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &mreq.imr_interface, sizeof(mreq.imr_interface));
+    unsigned char loop = 1;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons(OWNER_PORT);
+    dst.sin_addr = mreq.imr_multiaddr;
+    return fd;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4)
+    {
+        fprintf(stderr, "Usage: %s <receiver_id> <duration_s> <rssi_sensor_0> [<rssi_sensor_1> ...]\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t id = strtoul(argv[1], nullptr, 0);
+    uint32_t duration = atoi(argv[2]) * 1000UL;
+    int num = argc - 3;
+    if (num > MAX_SIM_SENSORS)
+        num = MAX_SIM_SENSORS;
+    float rssi[MAX_SIM_SENSORS];
+    for (int i = 0; i < num; i++)
+    {
+        rssi[i] = atof(argv[3 + i]);
+    }
+
+    struct sockaddr_in dst;
+    int fd = open_socket(dst);
+    if (fd < 0)
+    {
+        perror("socket");
+        return 1;
+    }
+
+    SensorOwnership ownership(id);
+    srand(id);
+    uint32_t start = now_ms();
+    uint32_t nextRx = start;
+    uint32_t published[MAX_SIM_SENSORS] = {0};
+    uint32_t received = 0;
+    uint8_t buf[OWNER_MSG_SIZE];
+
+    while (now_ms() - start < duration)
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) > 0)
+        {
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            if (len > 0)
+                ownership.receive(buf, len, now_ms());
+        }
+
+        uint32_t now = now_ms();
+        if ((int32_t)(now - nextRx) >= 0)
+        {
+            // Simulated reception of all sensors
+            nextRx += 1000;
+            for (int i = 0; i < num; i++)
+            {
+                uint32_t sensor_id = 0x1000 + i;
+                ownership.update(sensor_id, rssi[i] + (rand() % 41 - 20) / 10.0f, now);
+                received++;
+                if (ownership.owns(sensor_id, now))
+                    published[i]++;
+            }
+        }
+
+        if (ownership.announceDue(now))
+        {
+            size_t len = ownership.announce(buf, sizeof(buf), now);
+            sendto(fd, buf, len, 0, (struct sockaddr *)&dst, sizeof(dst));
+        }
+    }
+
+    printf("receiver %u: peers: %u, owner changes: %u, published:", id, ownership.numPeers(), ownership.changes);
+    uint32_t total = 0;
+    for (int i = 0; i < num; i++)
+    {
+        printf(" 0x%04X=%u", 0x1000 + i, published[i]);
+        total += published[i];
+    }
+    printf(" (%u of %u)\n", total, received);
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// udp_dump.cpp
+//
+// Print sensor data records sent by UdpSink
+//
+// Build (from this directory):
+//   g++ -O2 -I../../src -o udp_dump udp_dump.cpp UdpRecordReceiver.cpp ../../src/SensorRecord.cpp
+//
+// Usage:
+//   ./udp_dump [group [port]]
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250418 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "UdpRecordReceiver.h"
+
+int main(int argc, char *argv[])
+{
+    const char *group = (argc > 1) ? argv[1] : UDP_RECEIVER_GROUP;
+    uint16_t port = (argc > 2) ? atoi(argv[2]) : UDP_RECEIVER_PORT;
+
+    UdpRecordReceiver receiver;
+    if (!receiver.open(group, port))
+    {
+        fprintf(stderr, "Failed to open %s:%u\n", group, port);
+        return 1;
+    }
+
+    SensorRecord rec;
+    while (receiver.receive(rec) > 0)
+    {
+        printf("rx: %08X seq: %u ts: %u id: %08X type: %u ch: %u rssi: %.1f bat: %s",
+               rec.receiver_id, rec.seq, rec.timestamp, rec.sensor_id, rec.s_type, rec.chan, rec.rssi,
+               (rec.flags & RECORD_FLAG_BATTERY_OK) ? "ok" : "low");
+
+        switch (rec.kind)
+        {
+        case RECORD_KIND_WEATHER:
+            if (rec.ok & RECORD_OK_TEMP)
+                printf(" temp: %.1f", rec.temp_c);
+            if (rec.ok & RECORD_OK_HUMIDITY)
+                printf(" hum: %u", rec.humidity);
+            if (rec.ok & RECORD_OK_WIND)
+                printf(" wgust: %.1f wavg: %.1f wdir: %.1f", rec.wind_gust_meter_sec,
+                       rec.wind_avg_meter_sec, rec.wind_direction_deg);
+            if (rec.ok & RECORD_OK_RAIN)
+                printf(" rain: %.1f", rec.rain_mm);
+            if (rec.ok & RECORD_OK_LIGHT)
+                printf(" light: %u", rec.light_lux);
+            if (rec.ok & RECORD_OK_UV)
+                printf(" uv: %.1f", rec.uv);
+            if (rec.ok & RECORD_OK_TGLOBE)
+                printf(" tglobe: %.1f", rec.tglobe_c);
+            break;
+        case RECORD_KIND_SOIL:
+            printf(" temp: %.1f moisture: %u", rec.temp_c, rec.humidity);
+            break;
+        case RECORD_KIND_LIGHTNING:
+            printf(" strikes: %u distance: %u", rec.strike_count, rec.distance_km);
+            break;
+        case RECORD_KIND_LEAKAGE:
+            printf(" alarm: %u", rec.alarm);
+            break;
+        case RECORD_KIND_AIR_PM:
+            printf(" pm1.0: %u pm2.5: %u pm10: %u", rec.pm_1_0, rec.pm_2_5, rec.pm_10);
+            break;
+        case RECORD_KIND_CO2:
+            printf(" co2: %u", rec.co2_ppm);
+            break;
+        case RECORD_KIND_HCHO_VOC:
+            printf(" hcho: %u voc: %u", rec.hcho_ppb, rec.voc_level);
+            break;
+        default:
+            break;
+        }
+        printf(" (lost: %u)\n", receiver.seq.lost);
+    }
+
+    return 0;
+}
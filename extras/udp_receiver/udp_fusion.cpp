@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// udp_fusion.cpp
+//
+// Fusion of sensor data records sent by several receivers (UdpSink)
+//
+// Records of the same sensor message received by several receivers are combined
+// (see RecordFusion.h); the copy with the best RSSI is sent once to the output group
+// and port with the fusion's receiver ID and sequence numbers.
+//
+// Build (from this directory):
+//   g++ -O2 -I../../src -o udp_fusion udp_fusion.cpp UdpRecordReceiver.cpp ../../src/SensorRecord.cpp ../../src/RecordFusion.cpp
+//
+// Usage:
+//   ./udp_fusion [group [port [out_group [out_port]]]]
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250424 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "UdpRecordReceiver.h"
+#include "RecordFusion.h"
+
+// Receiver ID of fused records
+#define FUSION_RECEIVER_ID 0x46555345
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *group = (argc > 1) ? argv[1] : UDP_RECEIVER_GROUP;
+    uint16_t port = (argc > 2) ? atoi(argv[2]) : UDP_RECEIVER_PORT;
+    const char *out_group = (argc > 3) ? argv[3] : group;
+    uint16_t out_port = (argc > 4) ? atoi(argv[4]) : port + 1;
+
+    UdpRecordReceiver receiver;
+    if (!receiver.open(group, port))
+    {
+        fprintf(stderr, "Failed to open %s:%u\n", group, port);
+        return 1;
+    }
+
+    struct sockaddr_in dst;
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons(out_port);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if ((fd < 0) || (inet_pton(AF_INET, out_group, &dst.sin_addr) != 1))
+    {
+        fprintf(stderr, "Failed to open %s:%u\n", out_group, out_port);
+        return 1;
+    }
+
+    RecordFusion fusion;
+    SensorRecord rec;
+    FusedRecord out;
+    uint32_t seq = 0;
+
+    for (;;)
+    {
+        int res = receiver.receive(rec, 100);
+        if (res < 0)
+            break;
+        if (res > 0)
+            fusion.ingest(rec, now_ms());
+
+        while (fusion.poll(now_ms(), out))
+        {
+            printf("id: %08X type: %u ch: %u copies: %u rssi:", out.rec.sensor_id, out.rec.s_type,
+                   out.rec.chan, out.copies);
+            for (uint8_t i = 0; i < out.receivers; i++)
+            {
+                printf(" %08X=%.1f", out.receiver_id[i], out.rssi[i]);
+            }
+            printf(" (best: %08X)\n", out.rec.receiver_id);
+
+            uint8_t buf[SENSOR_RECORD_MAX_SIZE];
+            out.rec.receiver_id = FUSION_RECEIVER_ID;
+            out.rec.seq = seq++;
+            size_t len = encodeRecord(buf, sizeof(buf), out.rec);
+            if (len)
+                sendto(fd, buf, len, 0, (struct sockaddr *)&dst, sizeof(dst));
+        }
+    }
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,328 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AirQuality.cpp
+//
+// Post-processing of particulate matter (PM) sensor data - NowCast and Air Quality Index
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250504 Created
+//
+// ToDo:
+// -
+//
+// Notes:
+// Technical Assistance Document for the Reporting of Daily Air Quality - the Air Quality
+// Index (AQI), US EPA, EPA-454/B-24-002, May 2024
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <math.h>
+#include "AirQuality.h"
+
+// AQI breakpoints; concentrations in units of the truncated NowCast
+// (PM2.5: 0.1 µg/m³, PM10: 1 µg/m³)
+typedef struct {
+    uint16_t cLo;
+    uint16_t cHi;
+    uint16_t iLo;
+    uint16_t iHi;
+} AqiBreakpoint;
+
+static const AqiBreakpoint aqiPm25[] = {
+    {   0,   90,   0,  50},
+    {  91,  354,  51, 100},
+    { 355,  554, 101, 150},
+    { 555, 1254, 151, 200},
+    {1255, 2254, 201, 300},
+    {2255, 3254, 301, 500}
+};
+
+static const AqiBreakpoint aqiPm10[] = {
+    {  0,  54,   0,  50},
+    { 55, 154,  51, 100},
+    {155, 254, 101, 150},
+    {255, 354, 151, 200},
+    {355, 424, 201, 300},
+    {425, 604, 301, 500}
+};
+
+// Truncate concentration to resolution of AQI breakpoints (units: see above)
+static long truncConc(AqPollutant p, float conc)
+{
+    if (p == AQ_PM_10)
+        return (long)floorf(conc + 1e-4f);
+    return (long)floorf(conc * 10 + 1e-3f);
+}
+
+AirQuality::AirQuality(nvAirQuality_t *storage, const char *prefs)
+{
+    nv = storage ? storage : &nvData;
+    #if defined(AIRQUALITY_USE_PREFS) && !defined(INSIDE_UNITTEST)
+    prefsName = prefs;
+    #else
+    (void)prefs;
+    #endif
+}
+
+void
+AirQuality::reset(void)
+{
+    nv->hour = 0;
+    hist_init();
+
+    #if defined(AIRQUALITY_USE_PREFS) && !defined(INSIDE_UNITTEST)
+        prefs_save();
+    #endif
+}
+
+void
+AirQuality::hist_init(void)
+{
+    for (int p = 0; p < AQ_PM_NUM; p++) {
+        nv->sum[p] = 0;
+        nv->count[p] = 0;
+        for (int i = 0; i < AIRQUALITY_HIST_SIZE; i++) {
+            nv->hist[p][i] = AIRQUALITY_INVALID;
+        }
+    }
+}
+
+#if defined(AIRQUALITY_USE_PREFS) && !defined(INSIDE_UNITTEST)
+void AirQuality::prefs_load(void)
+{
+    preferences.begin(prefsName, false);
+    if (preferences.getBytes("nv", nv, sizeof(nvAirQuality_t)) != sizeof(nvAirQuality_t)) {
+        nv->hour = 0;
+    }
+    log_d("hour         =%u", nv->hour);
+    preferences.end();
+}
+
+void AirQuality::prefs_save(void)
+{
+    preferences.begin(prefsName, false);
+    preferences.putBytes("nv", nv, sizeof(nvAirQuality_t));
+    preferences.end();
+}
+#endif
+
+bool
+AirQuality::update(time_t timestamp, uint16_t pm1_0, uint16_t pm2_5, uint16_t pm10,
+                   bool pm1_0_init, bool pm2_5_init, bool pm10_init)
+{
+    #if defined(AIRQUALITY_USE_PREFS) && !defined(INSIDE_UNITTEST)
+        prefs_load();
+    #endif
+
+    uint32_t hour = timestamp / 3600;
+
+    if (nv->hour == 0) {
+        // Initialize history
+        hist_init();
+        nv->hour = hour;
+    }
+
+    if (hour < nv->hour) {
+        log_w("Timestamp before current hour!?");
+        return false;
+    }
+
+    if (hour > nv->hour) {
+        // Close current hour
+        for (int p = 0; p < AQ_PM_NUM; p++) {
+            uint16_t avg = AIRQUALITY_INVALID;
+            if (nv->count[p] > 0) {
+                uint32_t avg10 = (nv->sum[p] * 10 + nv->count[p] / 2) / nv->count[p];
+                avg = (avg10 < AIRQUALITY_INVALID) ? avg10 : AIRQUALITY_INVALID - 1;
+            }
+            nv->hist[p][nv->hour % AIRQUALITY_HIST_SIZE] = avg;
+            nv->sum[p] = 0;
+            nv->count[p] = 0;
+        }
+
+        // Mark hours without data as invalid (at most the entire history)
+        uint32_t gap = hour - nv->hour - 1;
+        if (gap > AIRQUALITY_HIST_SIZE)
+            gap = AIRQUALITY_HIST_SIZE;
+        for (uint32_t h = hour - gap; h < hour; h++) {
+            for (int p = 0; p < AQ_PM_NUM; p++) {
+                nv->hist[p][h % AIRQUALITY_HIST_SIZE] = AIRQUALITY_INVALID;
+            }
+        }
+        nv->hour = hour;
+    }
+
+    // Accumulate samples of current hour (sensor initialization complete only)
+    const uint16_t pm[AQ_PM_NUM] = {pm1_0, pm2_5, pm10};
+    const bool init[AQ_PM_NUM] = {pm1_0_init, pm2_5_init, pm10_init};
+    for (int p = 0; p < AQ_PM_NUM; p++) {
+        if (!init[p] && (nv->count[p] < UINT16_MAX)) {
+            nv->sum[p] += pm[p];
+            nv->count[p]++;
+        }
+    }
+
+    #if defined(AIRQUALITY_USE_PREFS) && !defined(INSIDE_UNITTEST)
+        prefs_save();
+    #endif
+
+    return true;
+}
+
+float
+AirQuality::hourly(AqPollutant p, int age) const
+{
+    if ((nv->hour == 0) || (age < 1) || (age > AIRQUALITY_HIST_SIZE))
+        return -1;
+
+    uint16_t val = nv->hist[p][(nv->hour - age) % AIRQUALITY_HIST_SIZE];
+    if (val == AIRQUALITY_INVALID)
+        return -1;
+
+    return val / 10.0f;
+}
+
+float
+AirQuality::nowCast(AqPollutant p, bool *valid) const
+{
+    float c[AIRQUALITY_NOWCAST_HOURS];
+    float cMin = 0;
+    float cMax = 0;
+    int recent = 0;
+    int entries = 0;
+
+    for (int i = 0; i < AIRQUALITY_NOWCAST_HOURS; i++) {
+        c[i] = hourly(p, i + 1);
+        if (c[i] < 0)
+            continue;
+        if ((entries == 0) || (c[i] < cMin))
+            cMin = c[i];
+        if ((entries == 0) || (c[i] > cMax))
+            cMax = c[i];
+        entries++;
+        if (i < 3)
+            recent++;
+    }
+
+    if (valid != nullptr)
+        *valid = (recent >= 2);
+
+    if (recent < 2)
+        return -1;
+
+    // Weight factor
+    float w = (cMax > 0) ? cMin / cMax : 1.0f;
+    if (w < 0.5f)
+        w = 0.5f;
+
+    float num = 0;
+    float den = 0;
+    float f = 1;
+    for (int i = 0; i < AIRQUALITY_NOWCAST_HOURS; i++) {
+        if (c[i] >= 0) {
+            num += f * c[i];
+            den += f;
+        }
+        f *= w;
+    }
+
+    long t = truncConc(p, num / den);
+    return (p == AQ_PM_10) ? (float)t : t / 10.0f;
+}
+
+float
+AirQuality::pastDay(AqPollutant p, bool *valid, int *nbins) const
+{
+    int entries = 0;
+    float sum = 0;
+
+    for (int age = 1; age <= 24; age++) {
+        float c = hourly(p, age);
+        if (c >= 0) {
+            sum += c;
+            entries++;
+        }
+    }
+
+    // Optional: return number of valid entries
+    if (nbins != nullptr)
+        *nbins = entries;
+
+    // Optional: return valid flag
+    if (valid != nullptr)
+        *valid = (entries >= AIRQUALITY_DAY_MIN_HOURS);
+
+    return (entries > 0) ? sum / entries : -1;
+}
+
+int
+AirQuality::aqiIndex(AqPollutant p, float conc)
+{
+    const AqiBreakpoint *bp;
+    size_t n;
+
+    if (p == AQ_PM_2_5) {
+        bp = aqiPm25;
+        n = sizeof(aqiPm25) / sizeof(aqiPm25[0]);
+    } else if (p == AQ_PM_10) {
+        bp = aqiPm10;
+        n = sizeof(aqiPm10) / sizeof(aqiPm10[0]);
+    } else {
+        return -1;
+    }
+
+    if (conc < 0)
+        return -1;
+
+    long c = truncConc(p, conc);
+    for (size_t i = 0; i < n; i++) {
+        if (c <= bp[i].cHi) {
+            float index = (float)(bp[i].iHi - bp[i].iLo) / (bp[i].cHi - bp[i].cLo) * (c - bp[i].cLo) + bp[i].iLo;
+            return (int)(index + 0.5f);
+        }
+    }
+
+    // Beyond the AQI
+    return 500;
+}
+
+int
+AirQuality::aqi(AqPollutant *dominant) const
+{
+    int aqi25 = aqiIndex(AQ_PM_2_5, nowCast(AQ_PM_2_5));
+    int aqi10 = aqiIndex(AQ_PM_10, nowCast(AQ_PM_10));
+
+    if (dominant != nullptr)
+        *dominant = (aqi10 > aqi25) ? AQ_PM_10 : AQ_PM_2_5;
+
+    return (aqi10 > aqi25) ? aqi10 : aqi25;
+}
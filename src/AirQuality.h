@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AirQuality.h
+//
+// Post-processing of particulate matter (PM) sensor data - NowCast and Air Quality Index
+//
+// Input:
+//     * Timestamp
+//     * PM1.0, PM2.5 and PM10 concentration [µg/m³]
+//     * Sensor initialization flags (values not yet valid)
+//
+// Output:
+//     * Hourly averages (past 24 hours)
+//     * US EPA NowCast (weighted average of past 12 hours)
+//     * 24-hour average
+//     * US EPA Air Quality Index (AQI) of PM2.5 and PM10
+//
+// Samples are accumulated into the current hour (O(1) per update); hourly averages are
+// stored in a ring buffer of AIRQUALITY_HIST_SIZE hours. NowCast and 24-hour averages are
+// calculated from the complete hours only (i.e. excluding the current hour).
+//
+// NowCast (PM): the weight factor is w = c_min / c_max over the past 12 hours, but at least
+// 0.5; NowCast = sum(w^(i-1) * c_i) / sum(w^(i-1)) over all valid hours i (1: most recent).
+// At least two of the three most recent hours must be valid. The result is truncated
+// to 0.1 µg/m³ (PM2.5) or 1 µg/m³ (PM10).
+//
+// AQI breakpoints: PM2.5 as revised by US EPA in 2024, PM10 as of 2012.
+//
+// Non-volatile data is stored in Preferences (Flash FS) or in memory provided by the
+// application (e.g. in the ESP32's RTC RAM) to allow retention during deep sleep mode.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250504 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _AIR_QUALITY_H
+#define _AIR_QUALITY_H
+
+#include <stdint.h>
+#include "time.h"
+#include "WeatherSensorCfg.h"
+
+#if defined(AIRQUALITY_USE_PREFS) && !defined(INSIDE_UNITTEST)
+#include <Preferences.h>
+#endif
+
+/**
+ * \def
+ *
+ * Number of hourly averages in history (>= 24)
+ */
+#define AIRQUALITY_HIST_SIZE 24
+
+/**
+ * \def
+ *
+ * Number of hours used for NowCast
+ */
+#define AIRQUALITY_NOWCAST_HOURS 12
+
+/**
+ * \def
+ *
+ * Minimum number of valid hours for 24-hour average (75%)
+ */
+#define AIRQUALITY_DAY_MIN_HOURS 18
+
+/**
+ * \def
+ *
+ * Marker of hours without data in history
+ */
+#define AIRQUALITY_INVALID 0xFFFF
+
+
+/**
+ * \enum AqPollutant
+ *
+ * \brief Pollutants (index into history)
+ */
+typedef enum AqPollutant {
+    AQ_PM_1_0 = 0,  //!< PM1.0
+    AQ_PM_2_5 = 1,  //!< PM2.5
+    AQ_PM_10  = 2,  //!< PM10
+    AQ_PM_NUM = 3   //!< number of pollutants
+} AqPollutant;
+
+
+/**
+ * \typedef nvAirQuality_t
+ *
+ * \brief Data structure for PM sensor to be stored in non-volatile memory
+ *
+ * All-zero data (e.g. RTC RAM after power-on) is a valid initial state.
+ */
+typedef struct {
+    uint32_t hour;                                  //!< current hour (UNIX time / 3600), 0: no data
+    uint32_t sum[AQ_PM_NUM];                        //!< sum of samples of current hour [µg/m³]
+    uint16_t count[AQ_PM_NUM];                      //!< number of samples of current hour
+    uint16_t hist[AQ_PM_NUM][AIRQUALITY_HIST_SIZE]; //!< hourly averages [0.1 µg/m³] (index: hour % AIRQUALITY_HIST_SIZE)
+} nvAirQuality_t;
+
+
+/**
+ * \class AirQuality
+ *
+ * \brief Hourly averages, NowCast and Air Quality Index of one PM sensor
+ */
+class AirQuality {
+
+private:
+    nvAirQuality_t  nvData = {};
+    nvAirQuality_t *nv;
+
+    #if defined(AIRQUALITY_USE_PREFS) && !defined(INSIDE_UNITTEST)
+    Preferences preferences;
+    const char *prefsName;
+    #endif
+
+    void hist_init(void);
+
+public:
+    /**
+     * Constructor
+     *
+     * \param storage   non-volatile data (e.g. RTC_DATA_ATTR nvAirQuality_t nvAq;),
+     *                  nullptr: internal (stored in Preferences if AIRQUALITY_USE_PREFS is defined)
+     * \param prefs     Preferences namespace (one per sensor)
+     */
+    AirQuality(nvAirQuality_t *storage = nullptr, const char *prefs = "BWS-AQ");
+
+    /**
+     * Initialize/reset non-volatile data
+     */
+    void reset(void);
+
+    #if defined(AIRQUALITY_USE_PREFS) && !defined(INSIDE_UNITTEST)
+    void prefs_load(void);
+    void prefs_save(void);
+    #endif
+
+    /**
+     * \fn update
+     *
+     * \brief Update with PM sensor data
+     *
+     * Values with init flag set (sensor still initializing) are ignored.
+     *
+     * \param timestamp     timestamp (epoch)
+     * \param pm1_0         PM1.0 [µg/m³]
+     * \param pm2_5         PM2.5 [µg/m³]
+     * \param pm10          PM10 [µg/m³]
+     * \param pm1_0_init    PM1.0 init flag
+     * \param pm2_5_init    PM2.5 init flag
+     * \param pm10_init     PM10 init flag
+     *
+     * \return false if timestamp is before current hour (sample ignored)
+     */
+    bool update(time_t timestamp, uint16_t pm1_0, uint16_t pm2_5, uint16_t pm10,
+                bool pm1_0_init = false, bool pm2_5_init = false, bool pm10_init = false);
+
+    /**
+     * \fn hourly
+     *
+     * \brief Get average of a complete hour
+     *
+     * \param p         pollutant
+     * \param age       1: previous hour ... AIRQUALITY_HIST_SIZE
+     *
+     * \return average [µg/m³], -1 if no data
+     */
+    float hourly(AqPollutant p, int age = 1) const;
+
+    /**
+     * \fn nowCast
+     *
+     * \brief Get NowCast of past 12 hours
+     *
+     * \param p         pollutant
+     * \param valid     at least two of the three most recent hours are valid
+     *
+     * \return NowCast [µg/m³], -1 if not valid
+     */
+    float nowCast(AqPollutant p, bool *valid = nullptr) const;
+
+    /**
+     * \fn pastDay
+     *
+     * \brief Get average of past 24 hours
+     *
+     * \param p         pollutant
+     * \param valid     number of valid hours >= AIRQUALITY_DAY_MIN_HOURS
+     * \param nbins     number of valid hours
+     *
+     * \return average [µg/m³], -1 if no data
+     */
+    float pastDay(AqPollutant p, bool *valid = nullptr, int *nbins = nullptr) const;
+
+    /**
+     * \fn aqi
+     *
+     * \brief Get Air Quality Index based on NowCast of PM2.5 and PM10
+     *
+     * \param dominant  pollutant with highest index
+     *
+     * \return AQI (0...500), -1 if not valid
+     */
+    int aqi(AqPollutant *dominant = nullptr) const;
+
+    /**
+     * \fn aqiIndex
+     *
+     * \brief Convert concentration to Air Quality Index
+     *
+     * \param p         pollutant (AQ_PM_2_5 or AQ_PM_10)
+     * \param conc      concentration [µg/m³], truncated as for NowCast
+     *
+     * \return AQI (0...500), -1 if not defined for pollutant or concentration negative
+     */
+    static int aqiIndex(AqPollutant p, float conc);
+};
+#endif // _AIR_QUALITY_H
@@ -0,0 +1,476 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Checkpoint.cpp
+//
+// Versioned binary checkpoint of post-processing state (RainGauge, Lightning)
+// and receiver configuration
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250506 Created
+//
+// ToDo:
+// -
+//
+// Notes:
+// Section data (type, field; version in which the field was added):
+//
+// RainGauge:
+//     i64 lastUpdate, u8 n, i16 hist[n], u8 startupPrev, f32 rainPreStartup,
+//     u8 tsDayBegin, f32 rainDayBegin, u8 tsWeekBegin, f32 rainWeekBegin, u8 wdayPrev,
+//     u8 tsMonthBegin, f32 rainMonthBegin, f32 rainPrev, f32 rainAcc;
+//     v2: u8 updateRate
+//
+// Lightning:
+//     i64 lastUpdate, u8 startupPrev, i16 preStCount, u32 accCount, i16 prevCount,
+//     i16 events, u8 distance, i64 timestamp, u8 n, i16 hist[n];
+//     v2: u8 updateRate
+//
+// Config:
+//     u8 maxSensors, u8 rxFlags, u8 enDecoders, u8 n, u32 inc[n], u8 m, u32 exc[m]
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <string.h>
+#include "Checkpoint.h"
+
+static const uint8_t ckptMagic[4] = {'B', 'W', 'C', 'P'};
+
+#define CKPT_HEADER_SIZE    8
+#define CKPT_SECTION_HEADER 4
+
+// CRC16 (CCITT, polynomial 0x1021), one byte
+static uint16_t crc16Update(uint16_t crc, uint8_t data)
+{
+    crc ^= (uint16_t)data << 8;
+    for (int i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+// Serialization into buffer (little endian)
+class CkptWriter {
+public:
+    uint8_t *buf;
+    size_t   size;
+    size_t   pos = 0;
+    bool     overflow = false;
+
+    CkptWriter(uint8_t *buf, size_t size) : buf(buf), size(size) {};
+
+    void u8(uint8_t v)
+    {
+        if (pos < size)
+            buf[pos++] = v;
+        else
+            overflow = true;
+    }
+    void u16(uint16_t v)  { u8(v & 0xFF); u8(v >> 8); }
+    void u32(uint32_t v)  { u16(v & 0xFFFF); u16(v >> 16); }
+    void i64(int64_t v)   { u32((uint64_t)v & 0xFFFFFFFF); u32((uint64_t)v >> 32); }
+    void f32(float v)
+    {
+        uint32_t u;
+        memcpy(&u, &v, sizeof(u));
+        u32(u);
+    }
+
+    // Overwrite 16-bit value written before
+    void patch16(size_t at, uint16_t v)
+    {
+        if (at + 2 <= pos) {
+            buf[at] = v & 0xFF;
+            buf[at + 1] = v >> 8;
+        }
+    }
+
+    // Begin section; returns position of section header
+    size_t begin(uint8_t id, uint8_t version)
+    {
+        size_t at = pos;
+        u8(id);
+        u8(version);
+        u16(0);
+        return at;
+    }
+
+    // End section; sets section length
+    void end(size_t at)
+    {
+        patch16(at + 2, pos - at - CKPT_SECTION_HEADER);
+    }
+};
+
+// Deserialization from buffer (little endian) with CRC calculation;
+// reading beyond the limit returns 0 and sets the overrun flag
+class CkptReader {
+public:
+    const uint8_t *buf;
+    size_t   pos = 0;
+    size_t   limit;
+    uint16_t crc = 0xFFFF;
+    bool     overrun = false;
+
+    CkptReader(const uint8_t *buf, size_t len) : buf(buf), limit(len) {};
+
+    uint8_t u8(void)
+    {
+        if (pos >= limit) {
+            overrun = true;
+            return 0;
+        }
+        crc = crc16Update(crc, buf[pos]);
+        return buf[pos++];
+    }
+    uint16_t u16(void)   { uint16_t v = u8(); return v | (uint16_t)u8() << 8; }
+    int16_t  i16(void)   { return (int16_t)u16(); }
+    uint32_t u32(void)   { uint32_t v = u16(); return v | (uint32_t)u16() << 16; }
+    int64_t  i64(void)   { uint64_t v = u32(); return (int64_t)(v | (uint64_t)u32() << 32); }
+    float f32(void)
+    {
+        uint32_t u = u32();
+        float v;
+        memcpy(&v, &u, sizeof(v));
+        return v;
+    }
+
+    // Skip to position (included in CRC)
+    void skip(size_t to)
+    {
+        while (pos < to)
+            u8();
+    }
+};
+
+// Read history buffer; discarded if size differs from current build
+static void readHist(CkptReader &r, int16_t *hist, int size, int16_t init)
+{
+    int n = r.u8();
+    for (int i = 0; i < n; i++) {
+        int16_t v = r.i16();
+        if (n == size)
+            hist[i] = v;
+    }
+    if (n != size) {
+        log_w("History size changed (%d -> %d), discarded", n, size);
+        for (int i = 0; i < size; i++)
+            hist[i] = init;
+    }
+}
+
+static void writeRain(CkptWriter &w, const nvData_t &nv)
+{
+    w.i64(nv.lastUpdate);
+    w.u8(RAIN_HIST_SIZE);
+    for (int i = 0; i < RAIN_HIST_SIZE; i++)
+        w.u16(nv.hist[i]);
+    w.u8(nv.startupPrev);
+    w.f32(nv.rainPreStartup);
+    w.u8(nv.tsDayBegin);
+    w.f32(nv.rainDayBegin);
+    w.u8(nv.tsWeekBegin);
+    w.f32(nv.rainWeekBegin);
+    w.u8(nv.wdayPrev);
+    w.u8(nv.tsMonthBegin);
+    w.f32(nv.rainMonthBegin);
+    w.f32(nv.rainPrev);
+    w.f32(nv.rainAcc);
+    w.u8(nv.updateRate);
+}
+
+static void readRain(CkptReader &r, uint8_t version, nvData_t &nv)
+{
+    nv.lastUpdate = r.i64();
+    readHist(r, nv.hist, RAIN_HIST_SIZE, -1);
+    nv.startupPrev = r.u8();
+    nv.rainPreStartup = r.f32();
+    nv.tsDayBegin = r.u8();
+    nv.rainDayBegin = r.f32();
+    nv.tsWeekBegin = r.u8();
+    nv.rainWeekBegin = r.f32();
+    nv.wdayPrev = r.u8();
+    nv.tsMonthBegin = r.u8();
+    nv.rainMonthBegin = r.f32();
+    nv.rainPrev = r.f32();
+    nv.rainAcc = r.f32();
+    nv.updateRate = (version >= 2) ? r.u8() : RAINGAUGE_UPD_RATE;
+}
+
+static void writeLightning(CkptWriter &w, const nvLightning_t &nv)
+{
+    w.i64(nv.lastUpdate);
+    w.u8(nv.startupPrev);
+    w.u16(nv.preStCount);
+    w.u32(nv.accCount);
+    w.u16(nv.prevCount);
+    w.u16(nv.events);
+    w.u8(nv.distance);
+    w.i64(nv.timestamp);
+    w.u8(LIGHTNING_HIST_SIZE);
+    for (int i = 0; i < LIGHTNING_HIST_SIZE; i++)
+        w.u16(nv.hist[i]);
+    w.u8(nv.updateRate);
+}
+
+static void readLightning(CkptReader &r, uint8_t version, nvLightning_t &nv)
+{
+    nv.lastUpdate = r.i64();
+    nv.startupPrev = r.u8();
+    nv.preStCount = r.i16();
+    nv.accCount = r.u32();
+    nv.prevCount = r.i16();
+    nv.events = r.i16();
+    nv.distance = r.u8();
+    nv.timestamp = r.i64();
+    readHist(r, nv.hist, LIGHTNING_HIST_SIZE, -1);
+    nv.updateRate = (version >= 2) ? r.u8() : LIGHTNING_UPD_RATE;
+}
+
+static void writeConfig(CkptWriter &w, const CheckpointConfig &cfg)
+{
+    w.u8(cfg.maxSensors);
+    w.u8(cfg.rxFlags);
+    w.u8(cfg.enDecoders);
+    w.u8(cfg.incCount);
+    for (int i = 0; i < cfg.incCount; i++)
+        w.u32(cfg.inc[i]);
+    w.u8(cfg.excCount);
+    for (int i = 0; i < cfg.excCount; i++)
+        w.u32(cfg.exc[i]);
+}
+
+// Read list of sensor IDs; entries exceeding MAX_SENSOR_IDS are dropped
+static uint8_t readIds(CkptReader &r, uint32_t *ids)
+{
+    int n = r.u8();
+    for (int i = 0; i < n; i++) {
+        uint32_t id = r.u32();
+        if (i < MAX_SENSOR_IDS)
+            ids[i] = id;
+    }
+    return (n < MAX_SENSOR_IDS) ? n : MAX_SENSOR_IDS;
+}
+
+static void readConfig(CkptReader &r, CheckpointConfig &cfg)
+{
+    cfg.maxSensors = r.u8();
+    cfg.rxFlags = r.u8();
+    cfg.enDecoders = r.u8();
+    cfg.incCount = readIds(r, cfg.inc);
+    cfg.excCount = readIds(r, cfg.exc);
+}
+
+size_t
+Checkpoint::save(uint8_t *buf, size_t size)
+{
+    CkptWriter w(buf, size);
+    uint8_t sections = 0;
+
+    for (size_t i = 0; i < sizeof(ckptMagic); i++)
+        w.u8(ckptMagic[i]);
+    w.u8(CHECKPOINT_VERSION);
+    w.u8(0);
+    w.u16(0);
+
+    if (rainGauge) {
+        nvData_t nv;
+        rainGauge->getState(nv);
+        size_t at = w.begin(CKPT_SEC_RAIN, CKPT_RAIN_VERSION);
+        writeRain(w, nv);
+        w.end(at);
+        sections++;
+    }
+
+    if (lightning) {
+        nvLightning_t nv;
+        lightning->getState(nv);
+        size_t at = w.begin(CKPT_SEC_LIGHTNING, CKPT_LIGHTNING_VERSION);
+        writeLightning(w, nv);
+        w.end(at);
+        sections++;
+    }
+
+    if (config) {
+        size_t at = w.begin(CKPT_SEC_CONFIG, CKPT_CONFIG_VERSION);
+        writeConfig(w, *config);
+        w.end(at);
+        sections++;
+    }
+
+    if (w.overflow || (w.pos + 2 > size)) {
+        log_e("Checkpoint exceeds buffer size");
+        return 0;
+    }
+
+    buf[5] = sections;
+    w.patch16(6, w.pos - CKPT_HEADER_SIZE);
+
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < w.pos; i++)
+        crc = crc16Update(crc, buf[i]);
+    w.u16(crc);
+
+    log_d("Checkpoint: %u bytes", (unsigned)w.pos);
+    return w.pos;
+}
+
+CheckpointStatus
+Checkpoint::restore(const uint8_t *buf, size_t len, uint8_t *restored)
+{
+    if (restored != nullptr)
+        *restored = 0;
+
+    if (len < CKPT_HEADER_SIZE + 2)
+        return CKPT_ERR_SIZE;
+
+    CkptReader r(buf, len);
+    for (size_t i = 0; i < sizeof(ckptMagic); i++) {
+        if (r.u8() != ckptMagic[i])
+            return CKPT_ERR_MAGIC;
+    }
+
+    // Format versions <= CHECKPOINT_VERSION are upgraded section by section
+    uint8_t version = r.u8();
+    if (version > CHECKPOINT_VERSION) {
+        log_w("Checkpoint version %u not supported", version);
+        return CKPT_ERR_VERSION;
+    }
+
+    uint8_t sections = r.u8();
+    size_t end = CKPT_HEADER_SIZE + r.u16();
+    if (end + 2 > len)
+        return CKPT_ERR_SIZE;
+
+    // Decode into temporary storage - applied only if checkpoint is valid
+    nvData_t rain = {};
+    nvLightning_t lgt = {};
+    CheckpointConfig cfg = {};
+    uint8_t found = 0;
+
+    for (uint8_t s = 0; s < sections; s++) {
+        r.limit = end;
+        uint8_t id = r.u8();
+        uint8_t secVersion = r.u8();
+        size_t secLen = r.u16();
+        size_t secEnd = r.pos + secLen;
+        if (r.overrun || (secEnd > end))
+            return CKPT_ERR_FORMAT;
+
+        r.limit = secEnd;
+        if ((id == CKPT_SEC_RAIN) && rainGauge) {
+            readRain(r, secVersion, rain);
+            found |= CKPT_RAIN;
+        } else if ((id == CKPT_SEC_LIGHTNING) && lightning) {
+            readLightning(r, secVersion, lgt);
+            found |= CKPT_LIGHTNING;
+        } else if ((id == CKPT_SEC_CONFIG) && config) {
+            readConfig(r, cfg);
+            found |= CKPT_CONFIG;
+        }
+        if (r.overrun)
+            return CKPT_ERR_FORMAT;
+
+        // Skip fields added in newer section versions and unknown sections
+        r.skip(secEnd);
+    }
+    if (r.pos != end)
+        return CKPT_ERR_FORMAT;
+
+    uint16_t crc = buf[end] | (uint16_t)buf[end + 1] << 8;
+    if (crc != r.crc) {
+        log_w("Checkpoint CRC error");
+        return CKPT_ERR_CRC;
+    }
+
+    if (found & CKPT_RAIN)
+        rainGauge->setState(rain);
+    if (found & CKPT_LIGHTNING)
+        lightning->setState(lgt);
+    if (found & CKPT_CONFIG)
+        *config = cfg;
+
+    if (restored != nullptr)
+        *restored = found;
+
+    log_d("Checkpoint restored (sections: 0x%02X)", found);
+    return CKPT_OK;
+}
+
+size_t
+Checkpoint::toHex(const uint8_t *buf, size_t len, char *hex, size_t size)
+{
+    static const char digits[] = "0123456789ABCDEF";
+
+    if (2 * len + 1 > size)
+        return 0;
+
+    for (size_t i = 0; i < len; i++) {
+        hex[2 * i] = digits[buf[i] >> 4];
+        hex[2 * i + 1] = digits[buf[i] & 0xF];
+    }
+    hex[2 * len] = '\0';
+    return 2 * len;
+}
+
+size_t
+Checkpoint::fromHex(const char *hex, uint8_t *buf, size_t size)
+{
+    size_t len = 0;
+    int nibbles = 0;
+    uint8_t v = 0;
+
+    for (const char *p = hex; *p; p++) {
+        char c = *p;
+        if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'))
+            continue;
+
+        uint8_t d;
+        if ((c >= '0') && (c <= '9'))
+            d = c - '0';
+        else if ((c >= 'A') && (c <= 'F'))
+            d = c - 'A' + 10;
+        else if ((c >= 'a') && (c <= 'f'))
+            d = c - 'a' + 10;
+        else
+            return 0;
+
+        v = (v << 4) | d;
+        if (++nibbles == 2) {
+            if (len >= size)
+                return 0;
+            buf[len++] = v;
+            nibbles = 0;
+            v = 0;
+        }
+    }
+    return (nibbles == 0) ? len : 0;
+}
@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Checkpoint.h
+//
+// Versioned binary checkpoint of post-processing state (RainGauge, Lightning)
+// and receiver configuration
+//
+// Format (all values little endian):
+//
+//     offset  size  content
+//     0       4     magic "BWCP"
+//     4       1     format version (CHECKPOINT_VERSION)
+//     5       1     number of sections
+//     6       2     length of sections [bytes]
+//     8       n     sections
+//     8+n     2     CRC16 (CCITT, init 0xFFFF) of all preceding bytes
+//
+// Section:
+//
+//     0       1     section ID (CKPT_SEC_*)
+//     1       1     section version
+//     2       2     length of section data [bytes]
+//     4       m     section data (fields, see Checkpoint.cpp)
+//
+// The fields of each section are serialized one by one (i.e. independent of the in-memory
+// layout, size of time_t and padding). Fields are only appended to a section; its version
+// is incremented if fields are added. On restore, fields missing in an older version are
+// set to default values (upgrade), fields unknown to the current version and unknown
+// sections are skipped. History buffers with a different number of entries than in the
+// current build are discarded.
+//
+// The checkpoint is restored in a single pass: sections are decoded into temporary
+// storage while the CRC is being calculated; the state is only changed if the complete
+// checkpoint is valid.
+//
+// For transfer via text channels (serial console, MQTT), toHex()/fromHex() are provided.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250506 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CHECKPOINT_H
+#define _CHECKPOINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WeatherSensorCfg.h"
+#include "RainGauge.h"
+#include "Lightning.h"
+
+/**
+ * \def
+ *
+ * Checkpoint format version
+ */
+#define CHECKPOINT_VERSION 1
+
+/**
+ * \def
+ *
+ * Maximum size of checkpoint [bytes]
+ */
+#define CHECKPOINT_MAX_SIZE 256
+
+/**
+ * \defgroup Checkpoint section IDs
+ */
+#define CKPT_SEC_RAIN       1
+#define CKPT_SEC_LIGHTNING  2
+#define CKPT_SEC_CONFIG     3
+
+/**
+ * \defgroup Checkpoint section versions
+ *
+ * Version 1 of RainGauge/Lightning sections: layout without update rate (before 03/2025)
+ */
+#define CKPT_RAIN_VERSION       2
+#define CKPT_LIGHTNING_VERSION  2
+#define CKPT_CONFIG_VERSION     1
+
+/**
+ * \defgroup Flags of restored sections
+ */
+#define CKPT_RAIN       (1 << (CKPT_SEC_RAIN - 1))
+#define CKPT_LIGHTNING  (1 << (CKPT_SEC_LIGHTNING - 1))
+#define CKPT_CONFIG     (1 << (CKPT_SEC_CONFIG - 1))
+
+
+/**
+ * \enum CheckpointStatus
+ *
+ * \brief Result of Checkpoint::restore()
+ */
+typedef enum CheckpointStatus {
+    CKPT_OK = 0,        //!< checkpoint restored
+    CKPT_ERR_SIZE,      //!< checkpoint truncated
+    CKPT_ERR_MAGIC,     //!< not a checkpoint
+    CKPT_ERR_VERSION,   //!< format version not supported
+    CKPT_ERR_FORMAT,    //!< inconsistent section lengths
+    CKPT_ERR_CRC        //!< CRC error
+} CheckpointStatus;
+
+
+/**
+ * \typedef CheckpointConfig
+ *
+ * \brief Receiver configuration (see WeatherSensor::getCheckpointConfig())
+ */
+typedef struct CheckpointConfig {
+    uint8_t  maxSensors;            //!< number of sensor data slots
+    uint8_t  rxFlags;               //!< receive flags
+    uint8_t  enDecoders;            //!< enabled decoders
+    uint8_t  incCount;              //!< number of entries in sensor include list
+    uint32_t inc[MAX_SENSOR_IDS];   //!< sensor include list
+    uint8_t  excCount;              //!< number of entries in sensor exclude list
+    uint32_t exc[MAX_SENSOR_IDS];   //!< sensor exclude list
+} CheckpointConfig;
+
+
+/**
+ * \class Checkpoint
+ *
+ * \brief Save/restore post-processing state and receiver configuration
+ */
+class Checkpoint {
+
+private:
+    RainGauge        *rainGauge;
+    Lightning        *lightning;
+    CheckpointConfig *config;
+
+public:
+    /**
+     * Constructor
+     *
+     * Sections are only saved/restored for objects provided.
+     *
+     * \param rain_gauge    RainGauge object or nullptr
+     * \param lightning     Lightning object or nullptr
+     * \param config        receiver configuration or nullptr
+     */
+    Checkpoint(RainGauge *rain_gauge, Lightning *lightning = nullptr, CheckpointConfig *config = nullptr) :
+        rainGauge(rain_gauge),
+        lightning(lightning),
+        config(config)
+    {};
+
+    /**
+     * \fn save
+     *
+     * \brief Save checkpoint to buffer
+     *
+     * \param buf       buffer
+     * \param size      buffer size (CHECKPOINT_MAX_SIZE is sufficient)
+     *
+     * \return length of checkpoint, 0 if buffer is too small
+     */
+    size_t save(uint8_t *buf, size_t size);
+
+    /**
+     * \fn restore
+     *
+     * \brief Restore checkpoint from buffer
+     *
+     * The state is only changed if CKPT_OK is returned.
+     *
+     * \param buf       buffer
+     * \param len       length of checkpoint
+     * \param restored  flags of restored sections (CKPT_RAIN, CKPT_LIGHTNING, CKPT_CONFIG)
+     *
+     * \return status
+     */
+    CheckpointStatus restore(const uint8_t *buf, size_t len, uint8_t *restored = nullptr);
+
+    /**
+     * \fn toHex
+     *
+     * \brief Convert checkpoint to hex string
+     *
+     * \param buf       checkpoint
+     * \param len       length of checkpoint
+     * \param hex       string buffer
+     * \param size      size of string buffer (>= 2 * len + 1)
+     *
+     * \return length of string, 0 if string buffer is too small
+     */
+    static size_t toHex(const uint8_t *buf, size_t len, char *hex, size_t size);
+
+    /**
+     * \fn fromHex
+     *
+     * \brief Convert hex string to checkpoint
+     *
+     * Whitespace is ignored.
+     *
+     * \param hex       string
+     * \param buf       buffer
+     * \param size      buffer size
+     *
+     * \return length of checkpoint, 0 if string is invalid or buffer is too small
+     */
+    static size_t fromHex(const char *hex, uint8_t *buf, size_t size);
+};
+#endif // _CHECKPOINT_H
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DataPredicate.cpp
+//
+// Completion predicate for WeatherSensor::getData() - set of required sensors
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250421 Created
+// 20250507 update(): incremental, based on number of slots per requirement
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "DataPredicate.h"
+
+DataPredicate::DataPredicate(void)
+{
+    clear();
+}
+
+void
+DataPredicate::clear(void)
+{
+    num = 0;
+    sat = 0;
+    slotMask.assign(slotMask.size(), 0);
+    memset(cnt, 0, sizeof(cnt));
+}
+
+bool
+DataPredicate::add(const Requirement &r)
+{
+    if (num >= DATA_REQ_MAX)
+        return false;
+    req[num++] = r;
+    return true;
+}
+
+bool
+DataPredicate::requireId(uint32_t id, bool complete)
+{
+    Requirement r = {id, 0, 0, true, complete};
+    return add(r);
+}
+
+bool
+DataPredicate::requireType(uint8_t s_type, uint8_t chan, bool complete)
+{
+    Requirement r = {0, s_type, chan, false, complete};
+    return add(r);
+}
+
+uint32_t
+DataPredicate::match(size_t slot, uint32_t id, uint8_t s_type, uint8_t chan, bool valid, bool complete) const
+{
+    uint32_t mask = 0;
+
+    if (!valid)
+        return 0;
+
+    // Requirements fulfilled by this slot so far
+    uint32_t own = (slot < slotMask.size()) ? slotMask[slot] : 0;
+
+    bool typeMatched = false;
+    for (uint8_t n = 0; n < num; n++) {
+        const Requirement &r = req[n];
+        if (r.complete && !complete)
+            continue;
+
+        if (r.byId) {
+            if (r.id == id)
+                mask |= 1UL << n;
+        }
+        // A slot fulfills at most one type/channel requirement - the first one not taken yet
+        else if (!typeMatched && (r.s_type == s_type) && ((r.chan == DATA_REQ_ANY_CHAN) || (r.chan == chan))) {
+            // Not taken by another slot
+            if ((own & (1UL << n)) || (cnt[n] == 0)) {
+                mask |= 1UL << n;
+                typeMatched = true;
+            }
+        }
+    }
+    return mask;
+}
+
+void
+DataPredicate::begin(size_t slots)
+{
+    slotMask.assign(slots, 0);
+    memset(cnt, 0, sizeof(cnt));
+    sat = 0;
+}
+
+bool
+DataPredicate::update(size_t slot, uint32_t mask)
+{
+    if (slot < slotMask.size()) {
+        // Only requirements changed by this slot
+        uint32_t changed = slotMask[slot] ^ mask;
+        slotMask[slot] = mask;
+        for (uint8_t n = 0; changed; n++, changed >>= 1) {
+            if (!(changed & 1))
+                continue;
+            if (mask & (1UL << n)) {
+                cnt[n]++;
+                sat |= 1UL << n;
+            } else if (--cnt[n] == 0) {
+                sat &= ~(1UL << n);
+            }
+        }
+    }
+    return (sat & all()) == all();
+}
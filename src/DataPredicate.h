@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DataPredicate.h
+//
+// Completion predicate for WeatherSensor::getData() - set of required sensors
+//
+// Each requirement is either a sensor ID or a (sensor type, channel) tuple, optionally
+// requiring complete data. When a message updates a slot, only the requirements
+// fulfilled by this slot are evaluated and stored as a bitmask per slot. The number of
+// slots fulfilling each requirement is counted, so an update only touches the bits of
+// the changed slot mask - the cost is independent of the number of slots. The predicate
+// is satisfied when each requirement is fulfilled by at least one slot.
+//
+// Example: one weather station plus soil probes on channels 1 and 2
+//
+//     requireType(SENSOR_TYPE_WEATHER1);
+//     requireType(SENSOR_TYPE_SOIL, 1);
+//     requireType(SENSOR_TYPE_SOIL, 2);
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250421 Created
+// 20250422 Slot masks stored in WsVector (heap-free build profile)
+// 20250507 Count slots per requirement - match()/update() do not scan all slots
+// 20250508 slotMask: WsSlotVector (capacity WEATHERSENSOR_MAX_SLOTS)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DATA_PREDICATE_H
+#define _DATA_PREDICATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WeatherSensorCfg.h"
+#include "FixedVector.h"
+
+#if DATA_REQ_MAX > 32
+#error "DATA_REQ_MAX must not exceed 32"
+#endif
+
+// Channel value matching any channel
+#define DATA_REQ_ANY_CHAN   0xFF
+
+
+/*!
+ * \class DataPredicate
+ *
+ * \brief Set of required sensors, evaluated incrementally per slot
+ */
+class DataPredicate {
+
+private:
+    typedef struct {
+        uint32_t id;        // sensor ID (if byId)
+        uint8_t  s_type;    // sensor type (if !byId)
+        uint8_t  chan;      // channel (if !byId; DATA_REQ_ANY_CHAN: any)
+        bool     byId;      // match by ID or by type/channel
+        bool     complete;  // complete data required
+    } Requirement;
+
+    Requirement                     req[DATA_REQ_MAX];
+    uint8_t                         num;
+    WsSlotVector<uint32_t>          slotMask; // requirements fulfilled per slot
+    uint8_t                         cnt[DATA_REQ_MAX]; // number of slots per requirement
+    uint32_t                        sat;      // requirements fulfilled by any slot
+
+    bool add(const Requirement &r);
+
+public:
+    /*!
+     * \brief Constructor
+     */
+    DataPredicate(void);
+
+    /*!
+     * \brief Remove all requirements
+     */
+    void clear(void);
+
+    /*!
+     * \brief Require sensor with given ID
+     *
+     * \param id        sensor ID
+     * \param complete  complete data required
+     *
+     * \returns false if the maximum number of requirements (DATA_REQ_MAX) is exceeded
+     */
+    bool requireId(uint32_t id, bool complete = true);
+
+    /*!
+     * \brief Require sensor with given type and channel
+     *
+     * Each requirement is fulfilled by one sensor; add the same tuple n times
+     * to require n sensors of this type and channel.
+     *
+     * \param s_type    sensor type (SENSOR_TYPE_*)
+     * \param chan      channel (DATA_REQ_ANY_CHAN: any channel)
+     * \param complete  complete data required
+     *
+     * \returns false if the maximum number of requirements (DATA_REQ_MAX) is exceeded
+     */
+    bool requireType(uint8_t s_type, uint8_t chan = DATA_REQ_ANY_CHAN, bool complete = true);
+
+    /*!
+     * \brief Get number of requirements
+     */
+    uint8_t size(void) const {
+        return num;
+    }
+
+    /*!
+     * \brief Get bitmask of all requirements
+     */
+    uint32_t all(void) const {
+        return (num >= 32) ? 0xFFFFFFFF : ((1UL << num) - 1);
+    }
+
+    /*!
+     * \brief Get bitmask of requirements fulfilled by a slot
+     *
+     * Requirements by type/channel are assigned to slots in order of reception,
+     * i.e. each of them is fulfilled by a different slot.
+     *
+     * \param slot      slot index
+     * \param id        sensor ID of slot
+     * \param s_type    sensor type of slot
+     * \param chan      channel of slot
+     * \param valid     slot is valid
+     * \param complete  slot data is complete
+     *
+     * \returns bitmask of requirements (bit n: n-th requirement)
+     */
+    uint32_t match(size_t slot, uint32_t id, uint8_t s_type, uint8_t chan, bool valid, bool complete) const;
+
+    /*!
+     * \brief Start evaluation
+     *
+     * \param slots     number of slots
+     */
+    void begin(size_t slots);
+
+    /*!
+     * \brief Update slot
+     *
+     * \param slot      slot index
+     * \param mask      requirements fulfilled by slot (see match())
+     *
+     * \returns true if all requirements are fulfilled
+     */
+    bool update(size_t slot, uint32_t mask);
+
+    /*!
+     * \brief Get bitmask of requirements not fulfilled yet
+     */
+    uint32_t missing(void) const {
+        return all() & ~sat;
+    }
+};
+#endif // _DATA_PREDICATE_H
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DecoderPrecheck.cpp
+//
+// Structural early-reject stage for radio message decoders
+//
+// Cheap invariants (known sensor type nibbles, BCD digit ranges, sanity bytes,
+// simple checksums) are checked before the expensive integrity checks
+// (LFSR-16 digest / CRC16) and before a slot is allocated in the sensor data array.
+// Frames failing these checks are either corrupted or not supported by the respective decoder.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250416 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DecoderPrecheck.h"
+
+// Check if sensor type (upper nibble of msg[6]) is known
+static inline bool knownType(const uint8_t *msg, uint16_t types)
+{
+    return (types >> (msg[6] >> 4)) & 1;
+}
+
+bool precheck5In1(const uint8_t *msg, uint8_t msgSize)
+{
+    if (msgSize < 26)
+        return false;
+
+    for (unsigned col = 0; col < 13; ++col)
+    {
+        if ((msg[col] ^ msg[col + 13]) != 0xff)
+            return false;
+    }
+    return true;
+}
+
+bool precheck6In1(const uint8_t *msg, uint8_t msgSize)
+{
+    if ((msgSize < 18) || !knownType(msg, PRECHECK_TYPES_6IN1))
+        return false;
+
+    // Checksum, add with carry (msg[2] to msg[17])
+    unsigned sum = 0;
+    for (unsigned i = 2; i < 18; i++)
+    {
+        sum += msg[i];
+    }
+    return (sum & 0xff) == 0xff;
+}
+
+bool precheck7In1(const uint8_t *msg, uint8_t msgSize)
+{
+    if (msgSize < 25)
+        return false;
+
+    return knownType(msg, PRECHECK_TYPES_7IN1) && (msg[21] != 0x00);
+}
+
+bool precheckLightning(const uint8_t *msg, uint8_t msgSize)
+{
+    if ((msgSize < 10) || !knownType(msg, PRECHECK_TYPES_LIGHTNING))
+        return false;
+
+    // Strike counter: BCD, only the most significant digit counts up to 15
+    uint8_t b4 = msg[4] ^ 0xaa;
+    uint8_t b5 = msg[5] ^ 0xaa;
+    return ((b4 & 0x0f) <= 9) && ((b5 >> 4) <= 9);
+}
+
+bool precheckLeakage(const uint8_t *msg, uint8_t msgSize)
+{
+    if ((msgSize < 8) || !knownType(msg, PRECHECK_TYPES_LEAKAGE))
+        return false;
+
+    bool alarm = (msg[7] & 0x80) == 0x80;
+    bool no_alarm = (msg[7] & 0x40) == 0x40;
+    return (alarm != no_alarm) && ((msg[6] & 0x7) != 0);
+}
@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DecoderPrecheck.h
+//
+// Structural early-reject stage for radio message decoders
+//
+// Cheap invariants (known sensor type nibbles, BCD digit ranges, sanity bytes,
+// simple checksums) are checked before the expensive integrity checks
+// (LFSR-16 digest / CRC16) and before a slot is allocated in the sensor data array.
+// Frames failing these checks are either corrupted or not supported by the respective decoder.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250416 Created
+// 20250419 Moved DECODER_IDX_* and RejectStats from WeatherSensor.h
+// 20250428 Added SYNC_WORD_* and SyncStats
+// 20250508 Documented rejection of unknown 7-in-1 sensor types
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DECODER_PRECHECK_H
+#define _DECODER_PRECHECK_H
+
+#include <stdint.h>
+
+// Indices of decoders in RejectStats
+#define DECODER_IDX_5IN1        0
+#define DECODER_IDX_6IN1        1
+#define DECODER_IDX_7IN1        2
+#define DECODER_IDX_LIGHTNING   3
+#define DECODER_IDX_LEAKAGE     4
+#define DECODER_NUM             5
+
+/*!
+ * \struct RejectStats
+ *
+ * \brief Statistics of rejected messages per decoder (index: DECODER_IDX_*)
+ *
+ * A message is passed to each enabled decoder until one of them accepts it,
+ * i.e. a message from a 5-in-1 sensor is normally rejected by the 7-in-1 and 6-in-1 decoders.
+ */
+typedef struct RejectStats {
+    uint32_t frames;                //!< messages passed to decodeMessage()
+    uint32_t early[DECODER_NUM];    //!< rejected by structural checks (see below)
+    uint32_t integrity[DECODER_NUM]; //!< rejected by digest/CRC/checksum
+} RejectStats;
+
+
+// Sync word: last preamble byte followed by 2D D4
+// Chips which support only 16-bit sync words (CC1101) match AA 2D; in this case
+// the last sync byte is received as 1st payload byte and checked in software.
+#define SYNC_WORD_0             0xAA
+#define SYNC_WORD_1             0x2D
+#define SYNC_WORD_2             0xD4
+
+/*!
+ * \struct SyncStats
+ *
+ * \brief Statistics of packet interrupts (false triggers by noise)
+ *
+ * False triggers are packets rejected by the software sync check (syncErr)
+ * or not accepted by any decoder (invalid).
+ */
+typedef struct SyncStats {
+    uint32_t irqs;                  //!< packets read from the radio
+    uint32_t syncErr;               //!< rejected by software sync check (1st payload byte != SYNC_WORD_2)
+    uint32_t invalid;               //!< passed sync check, rejected by decoders
+    bool     hwSync;                //!< complete sync word matched in hardware
+} SyncStats;
+
+
+// Known sensor type nibbles per decoder (bit n set: type n is accepted),
+// see SENSOR_TYPE_* in WeatherSensor.h
+#define PRECHECK_TYPES_6IN1         0x001E  // 1: weather, 2: thermo/hygro, 3: pool, 4: soil
+#define PRECHECK_TYPES_7IN1         0x2D02  // 1: weather, 8: PM, 10: CO2, 11: HCHO/VOC, 13: weather (8-in-1)
+#define PRECHECK_TYPES_LIGHTNING    0x0200  // 9: lightning
+#define PRECHECK_TYPES_LEAKAGE      0x0020  // 5: water leakage
+
+
+/*!
+ * \brief Early-reject check for BRESSER_5_IN_1 messages
+ *
+ * First 13 bytes must match the inverse of the next 13 bytes.
+ *
+ * \param msg       message buffer
+ * \param msgSize   message size in bytes
+ *
+ * \returns false if the message can be rejected
+ */
+bool precheck5In1(const uint8_t *msg, uint8_t msgSize);
+
+/*!
+ * \brief Early-reject check for BRESSER_6_IN_1 messages
+ *
+ * Known sensor type and checksum (add with carry, bytes 2..17).
+ *
+ * \param msg       message buffer
+ * \param msgSize   message size in bytes
+ *
+ * \returns false if the message can be rejected
+ */
+bool precheck6In1(const uint8_t *msg, uint8_t msgSize);
+
+/*!
+ * \brief Early-reject check for BRESSER_7_IN_1 messages
+ *
+ * Known sensor type and sanity byte 21 (raw data 0x00 is never sent).
+ *
+ * \note Unlike the plain 7-in-1 decoder, which stored messages of any sensor
+ *       type with a valid digest (without measurement data), messages with a
+ *       type nibble not in PRECHECK_TYPES_7IN1 are rejected here and counted
+ *       in RejectStats::early. Add the type to PRECHECK_TYPES_7IN1 to receive
+ *       a new sensor type.
+ *
+ * \param msg       message buffer (raw, i.e. whitened)
+ * \param msgSize   message size in bytes
+ *
+ * \returns false if the message can be rejected
+ */
+bool precheck7In1(const uint8_t *msg, uint8_t msgSize);
+
+/*!
+ * \brief Early-reject check for BRESSER_LIGHTNING messages
+ *
+ * Known sensor type and BCD digits of the strike counter.
+ *
+ * \param msg       message buffer (raw, i.e. whitened)
+ * \param msgSize   message size in bytes
+ *
+ * \returns false if the message can be rejected
+ */
+bool precheckLightning(const uint8_t *msg, uint8_t msgSize);
+
+/*!
+ * \brief Early-reject check for BRESSER_LEAKAGE messages
+ *
+ * Known sensor type, channel != 0 and exactly one of ALARM/NALARM set.
+ *
+ * \param msg       message buffer
+ * \param msgSize   message size in bytes
+ *
+ * \returns false if the message can be rejected
+ */
+bool precheckLeakage(const uint8_t *msg, uint8_t msgSize);
+
+#endif // _DECODER_PRECHECK_H
@@ -0,0 +1,496 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DigestBatch.cpp
+//
+// Bitsliced integrity checks of multiple radio messages (bulk host replay)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250430 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "DigestBatch.h"
+#include "DecoderPrecheck.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DIGEST_BATCH_AVX2
+// 4 x 64 lanes; operators are compiled to AVX2 instructions in functions with target("avx2")
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DIGEST_INLINE inline __attribute__((always_inline))
+#else
+#define DIGEST_INLINE inline
+#endif
+
+// Batches with less messages are checked one at a time (transposition does not pay off)
+#define DIGEST_BATCH_MIN_SLICE  8
+
+// BRESSER_5_IN_1: message size, parity bytes, checksum bytes
+#define CHECK_5IN1_BYTES        26
+#define CHECK_5IN1_PARITY       13
+#define CHECK_5IN1_SUM_FIRST    14
+
+const DigestParams DIGEST_6IN1      = {15, 0x8810, 0x5412, 0x00, 0x0000};
+const DigestParams DIGEST_7IN1      = {23, 0x8810, 0xba95, 0xaa, 0x6df1};
+const DigestParams DIGEST_LIGHTNING = { 8, 0x8810, 0xabf9, 0xaa, 0x899e};
+
+// Bit positions (relative to first digest bit) whose key has digest bit j set
+typedef struct DigestTaps {
+    uint16_t cnt[16];
+    uint8_t  idx[16][DIGEST_BATCH_MAX_BYTES * 8];
+} DigestTaps;
+
+static DigestImpl activeImpl = DIGEST_IMPL_AUTO;
+
+
+//
+// From from rtl_433 project - https://github.com/merbanan/rtl_433/blob/master/src/util.c
+//
+uint16_t lfsrDigest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
+{
+    uint16_t sum = 0;
+    for (unsigned k = 0; k < bytes; ++k)
+    {
+        uint8_t data = message[k];
+        for (int i = 7; i >= 0; --i)
+        {
+            // if data bit is set then xor with key
+            if ((data >> i) & 1)
+                sum ^= key;
+
+            // roll the key right (actually the lsb is dropped here)
+            // and apply the gen (needs to include the dropped lsb as msb)
+            if (key & 1)
+                key = (key >> 1) ^ gen;
+            else
+                key = (key >> 1);
+        }
+    }
+    return sum;
+}
+
+DigestImpl digestBatchSelect(DigestImpl impl)
+{
+    bool avx2 = false;
+#ifdef DIGEST_BATCH_AVX2
+    avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    if ((impl == DIGEST_IMPL_AUTO) || ((impl == DIGEST_IMPL_AVX2) && !avx2))
+    {
+        if (avx2)
+            impl = DIGEST_IMPL_AVX2;
+        else
+            impl = (sizeof(void *) >= 8) ? DIGEST_IMPL_SLICE64 : DIGEST_IMPL_SCALAR;
+    }
+    activeImpl = impl;
+    return impl;
+}
+
+const char *digestBatchName(DigestImpl impl)
+{
+    switch (impl)
+    {
+    case DIGEST_IMPL_SCALAR:
+        return "scalar";
+    case DIGEST_IMPL_SLICE64:
+        return "slice64";
+    case DIGEST_IMPL_AVX2:
+        return "avx2";
+    default:
+        return "auto";
+    }
+}
+
+static DigestImpl currentImpl(void)
+{
+    if (activeImpl == DIGEST_IMPL_AUTO)
+        digestBatchSelect(DIGEST_IMPL_AUTO);
+    return activeImpl;
+}
+
+// Replay LFSR key sequence and sort bit positions by the digest bits they toggle
+static void buildTaps(DigestTaps *taps, unsigned bytes, uint16_t gen, uint16_t key)
+{
+    memset(taps->cnt, 0, sizeof(taps->cnt));
+    for (unsigned b = 0; b < bytes * 8; b++)
+    {
+        for (unsigned j = 0; j < 16; j++)
+        {
+            if ((key >> j) & 1)
+                taps->idx[j][taps->cnt[j]++] = b;
+        }
+        if (key & 1)
+            key = (key >> 1) ^ gen;
+        else
+            key = (key >> 1);
+    }
+}
+
+// Bytes [ofs..ofs+7] of message (big endian, i.e. 1st message bit is MSB), 0 beyond size
+static inline uint64_t loadBe64(const uint8_t *msg, unsigned ofs, unsigned size)
+{
+    if (ofs + 8 <= size)
+    {
+        const uint8_t *p = &msg[ofs];
+        return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) |
+               ((uint64_t)p[3] << 32) | ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+               ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+    }
+    uint64_t v = 0;
+    for (unsigned i = ofs; i < ofs + 8; i++)
+        v = (v << 8) | ((i < size) ? msg[i] : 0);
+    return v;
+}
+
+// Transpose 64x64 bit matrices (one per 64-bit lane) in place, columns counted from MSB
+// see H.S. Warren, Hacker's Delight, 2nd ed., 7-3
+template <typename W>
+static DIGEST_INLINE void transpose64(W a[64])
+{
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (unsigned j = 32; j != 0; j >>= 1, m ^= (m << j))
+    {
+        for (unsigned k = 0; k < 64; k = (k + j + 1) & ~j)
+        {
+            W t = (a[k] ^ (a[k + j] >> j)) & m;
+            a[k] ^= t;
+            a[k + j] ^= (t << j);
+        }
+    }
+}
+
+static DIGEST_INLINE void setLane(uint64_t &w, unsigned, uint64_t v)
+{
+    w = v;
+}
+
+static DIGEST_INLINE uint64_t getLane(const uint64_t &w, unsigned)
+{
+    return w;
+}
+
+#ifdef DIGEST_BATCH_AVX2
+static DIGEST_INLINE void setLane(v4u64 &w, unsigned s, uint64_t v)
+{
+    w[s] = v;
+}
+
+static DIGEST_INLINE uint64_t getLane(const v4u64 &w, unsigned s)
+{
+    return w[s];
+}
+#endif
+
+// Transpose messages into bit planes: bit (63 - l) of lane s of planes[b] is bit b of msgs[64 * s + l]
+template <typename W, unsigned S>
+static DIGEST_INLINE void loadPlanes(W planes[], const uint8_t *const msgs[], size_t n, unsigned bytes)
+{
+    for (unsigned c = 0; c < (bytes + 7) / 8; c++)
+    {
+        W *a = &planes[c * 64];
+        for (unsigned l = 0; l < 64; l++)
+        {
+            for (unsigned s = 0; s < S; s++)
+            {
+                size_t i = s * 64 + l;
+                setLane(a[l], s, (i < n) ? loadBe64(msgs[i], c * 8, bytes) : 0);
+            }
+        }
+        transpose64<W>(a);
+    }
+}
+
+// Digest bit planes from message bit planes starting at bit first
+template <typename W>
+static DIGEST_INLINE void digestPlanes(W out[16], const W planes[], unsigned first, const DigestTaps &taps)
+{
+    for (unsigned j = 0; j < 16; j++)
+    {
+        W acc = planes[0] ^ planes[0];
+        for (unsigned t = 0; t < taps.cnt[j]; t++)
+            acc ^= planes[first + taps.idx[j][t]];
+        out[j] = acc;
+    }
+}
+
+// Store results from lane mask (bit set: check failed)
+template <typename W, unsigned S>
+static DIGEST_INLINE size_t storeResults(const W &bad, size_t n, bool ok[])
+{
+    size_t passed = 0;
+    for (unsigned s = 0; s < S; s++)
+    {
+        uint64_t m = getLane(bad, s);
+        for (unsigned l = 0; (l < 64) && (s * 64 + l < n); l++)
+        {
+            ok[s * 64 + l] = !((m >> (63 - l)) & 1);
+            passed += ok[s * 64 + l];
+        }
+    }
+    return passed;
+}
+
+template <typename W, unsigned S>
+static DIGEST_INLINE void digestBlock(const uint8_t *const msgs[], size_t n, unsigned bytes,
+                                      const DigestTaps &taps, uint16_t out[])
+{
+    W planes[DIGEST_BATCH_MAX_BYTES * 8];
+    W dig[16];
+
+    loadPlanes<W, S>(planes, msgs, n, bytes);
+    digestPlanes<W>(dig, planes, 0, taps);
+
+    // Transpose back; digest bit j in row 15 - j yields digest in bits 63..48
+    for (unsigned s = 0; s < S; s++)
+    {
+        uint64_t a[64] = {};
+        for (unsigned j = 0; j < 16; j++)
+            a[15 - j] = getLane(dig[j], s);
+        transpose64<uint64_t>(a);
+        for (unsigned l = 0; (l < 64) && (s * 64 + l < n); l++)
+            out[s * 64 + l] = a[l] >> 48;
+    }
+}
+
+// check: (msg[0..1] ^ digest) == check for raw message bits
+template <typename W, unsigned S>
+static DIGEST_INLINE size_t verifyDigestBlock(const uint8_t *const msgs[], size_t n, unsigned bytes,
+                                              const DigestTaps &taps, uint16_t check, bool ok[])
+{
+    W planes[DIGEST_BATCH_MAX_BYTES * 8];
+    W dig[16];
+
+    loadPlanes<W, S>(planes, msgs, n, bytes + 2);
+    digestPlanes<W>(dig, planes, 16, taps);
+
+    W bad = planes[0] ^ planes[0];
+    for (unsigned j = 0; j < 16; j++)
+    {
+        W diff = dig[j] ^ planes[15 - j];
+        bad |= ((check >> j) & 1) ? ~diff : diff;
+    }
+    return storeResults<W, S>(bad, n, ok);
+}
+
+template <typename W, unsigned S>
+static DIGEST_INLINE size_t verify5In1Block(const uint8_t *const msgs[], size_t n, bool ok[])
+{
+    W planes[DIGEST_BATCH_MAX_BYTES * 8];
+
+    loadPlanes<W, S>(planes, msgs, n, CHECK_5IN1_BYTES);
+
+    // Parity: bytes 0..12 inverse of bytes 13..25
+    W bad = planes[0] ^ planes[0];
+    for (unsigned b = 0; b < CHECK_5IN1_PARITY * 8; b++)
+        bad |= ~(planes[b] ^ planes[b + CHECK_5IN1_PARITY * 8]);
+
+    // Checksum: bitsliced counter of bits set in bytes 14..25 (max. 96)
+    W cnt[7];
+    for (unsigned k = 0; k < 7; k++)
+        cnt[k] = bad ^ bad;
+    for (unsigned b = CHECK_5IN1_SUM_FIRST * 8; b < CHECK_5IN1_BYTES * 8; b++)
+    {
+        unsigned total = b - CHECK_5IN1_SUM_FIRST * 8 + 1;
+        W carry = planes[b];
+        for (unsigned k = 0; (k < 7) && ((1U << k) <= total); k++)
+        {
+            W t = cnt[k] & carry;
+            cnt[k] ^= carry;
+            carry = t;
+        }
+    }
+
+    // Compare with byte 13 (bit j of value: plane 111 - j)
+    const unsigned last = CHECK_5IN1_PARITY * 8 + 7;
+    for (unsigned j = 0; j < 7; j++)
+        bad |= cnt[j] ^ planes[last - j];
+    bad |= planes[last - 7];
+
+    return storeResults<W, S>(bad, n, ok);
+}
+
+#ifdef DIGEST_BATCH_AVX2
+__attribute__((target("avx2")))
+static void digestAvx2(const uint8_t *const msgs[], size_t n, unsigned bytes,
+                       const DigestTaps &taps, uint16_t out[])
+{
+    digestBlock<v4u64, 4>(msgs, n, bytes, taps, out);
+}
+
+__attribute__((target("avx2")))
+static size_t verifyDigestAvx2(const uint8_t *const msgs[], size_t n, unsigned bytes,
+                               const DigestTaps &taps, uint16_t check, bool ok[])
+{
+    return verifyDigestBlock<v4u64, 4>(msgs, n, bytes, taps, check, ok);
+}
+
+__attribute__((target("avx2")))
+static size_t verify5In1Avx2(const uint8_t *const msgs[], size_t n, bool ok[])
+{
+    return verify5In1Block<v4u64, 4>(msgs, n, ok);
+}
+#endif
+
+static bool verifyDigestScalar(const uint8_t *msg, const DigestParams &params)
+{
+    // data de-whitening
+    uint8_t msgw[2 + 255];
+    for (unsigned i = 0; i < 2U + params.bytes; ++i)
+    {
+        msgw[i] = msg[i] ^ params.whitening;
+    }
+
+    uint16_t chk = (msgw[0] << 8) | msgw[1];
+    uint16_t digest = lfsrDigest16(&msgw[2], params.bytes, params.gen, params.key);
+    return (chk ^ digest) == params.final;
+}
+
+static bool verify5In1Scalar(const uint8_t *msg)
+{
+    if (!precheck5In1(msg, CHECK_5IN1_BYTES))
+        return false;
+
+    uint8_t bitsSet = 0;
+    for (unsigned p = CHECK_5IN1_SUM_FIRST; p < CHECK_5IN1_BYTES; p++)
+    {
+        for (uint8_t currentByte = msg[p]; currentByte; currentByte >>= 1)
+            bitsSet += (currentByte & 1);
+    }
+    return bitsSet == msg[CHECK_5IN1_PARITY];
+}
+
+void lfsrDigest16Batch(const uint8_t *const msgs[], size_t n, unsigned bytes,
+                       uint16_t gen, uint16_t key, uint16_t out[])
+{
+    DigestImpl impl = currentImpl();
+    size_t i = 0;
+
+    if ((impl != DIGEST_IMPL_SCALAR) && (bytes <= DIGEST_BATCH_MAX_BYTES))
+    {
+        DigestTaps taps;
+        buildTaps(&taps, bytes, gen, key);
+
+#ifdef DIGEST_BATCH_AVX2
+        if (impl == DIGEST_IMPL_AVX2)
+        {
+            for (; n - i >= 256; i += 256)
+                digestAvx2(&msgs[i], 256, bytes, taps, &out[i]);
+        }
+#endif
+        while (n - i >= DIGEST_BATCH_MIN_SLICE)
+        {
+            size_t k = (n - i < 64) ? n - i : 64;
+            digestBlock<uint64_t, 1>(&msgs[i], k, bytes, taps, &out[i]);
+            i += k;
+        }
+    }
+
+    for (; i < n; i++)
+        out[i] = lfsrDigest16(msgs[i], bytes, gen, key);
+}
+
+size_t verifyDigest16Batch(const uint8_t *const msgs[], size_t n, const DigestParams &params, bool ok[])
+{
+    DigestImpl impl = currentImpl();
+    size_t passed = 0;
+    size_t i = 0;
+
+    if ((impl != DIGEST_IMPL_SCALAR) && (2U + params.bytes <= DIGEST_BATCH_MAX_BYTES))
+    {
+        DigestTaps taps;
+        buildTaps(&taps, params.bytes, params.gen, params.key);
+
+        // Whitening is linear: fold its contribution into the expected value
+        uint8_t white[DIGEST_BATCH_MAX_BYTES];
+        memset(white, params.whitening, params.bytes);
+        uint16_t check = params.final ^ ((params.whitening << 8) | params.whitening) ^
+                         lfsrDigest16(white, params.bytes, params.gen, params.key);
+
+#ifdef DIGEST_BATCH_AVX2
+        if (impl == DIGEST_IMPL_AVX2)
+        {
+            for (; n - i >= 256; i += 256)
+                passed += verifyDigestAvx2(&msgs[i], 256, params.bytes, taps, check, &ok[i]);
+        }
+#endif
+        while (n - i >= DIGEST_BATCH_MIN_SLICE)
+        {
+            size_t k = (n - i < 64) ? n - i : 64;
+            passed += verifyDigestBlock<uint64_t, 1>(&msgs[i], k, params.bytes, taps, check, &ok[i]);
+            i += k;
+        }
+    }
+
+    for (; i < n; i++)
+    {
+        ok[i] = verifyDigestScalar(msgs[i], params);
+        passed += ok[i];
+    }
+    return passed;
+}
+
+size_t verify5In1Batch(const uint8_t *const msgs[], size_t n, bool ok[])
+{
+    DigestImpl impl = currentImpl();
+    size_t passed = 0;
+    size_t i = 0;
+
+    if (impl != DIGEST_IMPL_SCALAR)
+    {
+#ifdef DIGEST_BATCH_AVX2
+        if (impl == DIGEST_IMPL_AVX2)
+        {
+            for (; n - i >= 256; i += 256)
+                passed += verify5In1Avx2(&msgs[i], 256, &ok[i]);
+        }
+#endif
+        while (n - i >= DIGEST_BATCH_MIN_SLICE)
+        {
+            size_t k = (n - i < 64) ? n - i : 64;
+            passed += verify5In1Block<uint64_t, 1>(&msgs[i], k, &ok[i]);
+            i += k;
+        }
+    }
+
+    for (; i < n; i++)
+    {
+        ok[i] = verify5In1Scalar(msgs[i]);
+        passed += ok[i];
+    }
+    return passed;
+}
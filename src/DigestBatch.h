@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DigestBatch.h
+//
+// Bitsliced integrity checks of multiple radio messages (bulk host replay)
+//
+// The LFSR-16 digest is linear: each message bit which is set toggles the digest by a key
+// which only depends on the bit position. With the message bits transposed into machine
+// words (bit n of word b: bit b of message n), the 16 digest bits of 64 messages are
+// computed by XORing the words of all bit positions whose key has the respective bit set.
+// The same layout is used for the BRESSER_5_IN_1 parity check (bytes 0..12 inverse of
+// bytes 13..25) and for its checksum (number of bits set in bytes 14..25, bitsliced adder).
+//
+// Implementations (selected at runtime, see digestBatchSelect()):
+// - DIGEST_IMPL_SCALAR:  one message at a time (reference, bit-exact with lfsr_digest16())
+// - DIGEST_IMPL_SLICE64: 64 messages per 64-bit word
+// - DIGEST_IMPL_AVX2:    256 messages per 256-bit word (x86-64 with AVX2 only)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250430 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DIGEST_BATCH_H
+#define _DIGEST_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Max. number of bytes covered by a batch check (header + digest data)
+#define DIGEST_BATCH_MAX_BYTES  32
+
+/*!
+ * \enum DigestImpl
+ *
+ * \brief Implementation of batch checks
+ */
+typedef enum DigestImpl {
+    DIGEST_IMPL_AUTO,       //!< fastest implementation supported by the CPU
+    DIGEST_IMPL_SCALAR,     //!< one message at a time
+    DIGEST_IMPL_SLICE64,    //!< bitsliced, 64 messages in parallel
+    DIGEST_IMPL_AVX2        //!< bitsliced, 256 messages in parallel (x86-64 with AVX2)
+} DigestImpl;
+
+/*!
+ * \struct DigestParams
+ *
+ * \brief Parameters of LFSR-16 digest check
+ *
+ * Check passes if (msg[0..1] ^ digest(msg[2..2+bytes-1])) == final, where all message
+ * bytes are XORed with whitening first.
+ */
+typedef struct DigestParams {
+    uint8_t  bytes;         //!< number of bytes covered by digest (starting at msg[2])
+    uint16_t gen;           //!< LFSR generator
+    uint16_t key;           //!< LFSR initial key
+    uint8_t  whitening;     //!< data whitening byte (0x00: none)
+    uint16_t final;         //!< final XOR value
+} DigestParams;
+
+//! Digest check of BRESSER_6_IN_1 messages
+extern const DigestParams DIGEST_6IN1;
+
+//! Digest check of BRESSER_7_IN_1 messages (raw, i.e. whitened)
+extern const DigestParams DIGEST_7IN1;
+
+//! Digest check of BRESSER_LIGHTNING messages (raw, i.e. whitened)
+extern const DigestParams DIGEST_LIGHTNING;
+
+
+/*!
+ * \brief LFSR-16 digest of a single message (bit-exact copy of WeatherSensor::lfsr_digest16())
+ *
+ * \param message   message buffer
+ * \param bytes     number of bytes
+ * \param gen       LFSR generator
+ * \param key       LFSR initial key
+ *
+ * \returns digest
+ */
+uint16_t lfsrDigest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key);
+
+/*!
+ * \brief Select implementation of batch checks
+ *
+ * \param impl      requested implementation
+ *
+ * \returns selected implementation (DIGEST_IMPL_AUTO or an implementation not supported
+ *          by the CPU select the fastest supported implementation)
+ */
+DigestImpl digestBatchSelect(DigestImpl impl = DIGEST_IMPL_AUTO);
+
+/*!
+ * \brief Get name of implementation ("scalar", "slice64", "avx2")
+ */
+const char *digestBatchName(DigestImpl impl);
+
+/*!
+ * \brief LFSR-16 digests of multiple messages
+ *
+ * \param msgs      message buffers (each at least bytes long)
+ * \param n         number of messages
+ * \param bytes     number of bytes (<= DIGEST_BATCH_MAX_BYTES)
+ * \param gen       LFSR generator
+ * \param key       LFSR initial key
+ * \param out       digests (n entries)
+ */
+void lfsrDigest16Batch(const uint8_t *const msgs[], size_t n, unsigned bytes,
+                       uint16_t gen, uint16_t key, uint16_t out[]);
+
+/*!
+ * \brief LFSR-16 digest check of multiple messages
+ *
+ * \param msgs      message buffers (each at least 2 + params.bytes long)
+ * \param n         number of messages
+ * \param params    digest parameters (e.g. DIGEST_6IN1)
+ * \param ok        results (n entries)
+ *
+ * \returns number of messages which passed the check
+ */
+size_t verifyDigest16Batch(const uint8_t *const msgs[], size_t n, const DigestParams &params, bool ok[]);
+
+/*!
+ * \brief BRESSER_5_IN_1 parity and checksum check of multiple messages
+ *
+ * Bytes 0..12 must be the inverse of bytes 13..25 and byte 13 must be the number
+ * of bits set in bytes 14..25 (same checks as in decodeBresser5In1Payload()).
+ *
+ * \param msgs      message buffers (each at least 26 bytes long)
+ * \param n         number of messages
+ * \param ok        results (n entries)
+ *
+ * \returns number of messages which passed the check
+ */
+size_t verify5In1Batch(const uint8_t *const msgs[], size_t n, bool ok[]);
+
+#endif // _DIGEST_BATCH_H
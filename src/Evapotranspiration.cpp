@@ -0,0 +1,301 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Evapotranspiration.cpp
+//
+// Calculation of daily reference evapotranspiration (ET0, FAO-56 Penman-Monteith)
+// from weather sensor data
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250505 Created
+//
+// ToDo:
+// -
+//
+// Notes:
+// Allen, R.G., Pereira, L.S., Raes, D., Smith, M.: Crop evapotranspiration - Guidelines for
+// computing crop water requirements, FAO Irrigation and drainage paper 56, FAO, Rome, 1998
+// (https://www.fao.org/4/x0490e/x0490e00.htm)
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <math.h>
+#include "Evapotranspiration.h"
+
+// Solar constant [MJ/m²/min]
+#define GSC 0.0820f
+
+// Stefan-Boltzmann constant [MJ/K⁴/m²/day]
+#define SIGMA 4.903e-9f
+
+// Local midnight at begin of day of timestamp
+static time_t midnight(time_t ts, int days = 0)
+{
+    struct tm t;
+    localtime_r(&ts, &t);
+    t.tm_mday += days;
+    t.tm_hour = 0;
+    t.tm_min = 0;
+    t.tm_sec = 0;
+    t.tm_isdst = -1;
+    return mktime(&t);
+}
+
+// Saturation vapour pressure [kPa] (eq. 11)
+static float satVapour(float t)
+{
+    return 0.6108f * expf(17.27f * t / (t + 237.3f));
+}
+
+// Extraterrestrial radiation [MJ/m²/day] (eq. 21)
+static float extraterrestrial(float latitude, int doy)
+{
+    float phi = latitude * (float)M_PI / 180;
+    float dr = 1 + 0.033f * cosf(2 * (float)M_PI * doy / 365);
+    float delta = 0.409f * sinf(2 * (float)M_PI * doy / 365 - 1.39f);
+    float x = -tanf(phi) * tanf(delta);
+    // Polar night / midnight sun
+    x = (x < -1) ? -1 : (x > 1) ? 1 : x;
+    float ws = acosf(x);
+
+    return 24 * 60 / (float)M_PI * GSC * dr *
+           (ws * sinf(phi) * sinf(delta) + cosf(phi) * cosf(delta) * sinf(ws));
+}
+
+// ET0 [mm] accumulated during fraction of day (eq. 6);
+// aerodynamic and long-wave terms are scaled by fraction
+static float penmanMonteith(float tMin, float tMax, float rhMin, float rhMax, float u2, float rs,
+                            float latitude, int doy, float elevation, float fraction)
+{
+    float tMean = (tMin + tMax) / 2;
+
+    // Psychrometric constant (eq. 7, 8)
+    float p = 101.3f * powf((293 - 0.0065f * elevation) / 293, 5.26f);
+    float gamma = 0.665e-3f * p;
+
+    // Slope of saturation vapour pressure curve (eq. 13)
+    float delta = 4098 * satVapour(tMean) / ((tMean + 237.3f) * (tMean + 237.3f));
+
+    // Saturation and actual vapour pressure (eq. 12, 17)
+    float es = (satVapour(tMax) + satVapour(tMin)) / 2;
+    float ea = (satVapour(tMin) * rhMax / 100 + satVapour(tMax) * rhMin / 100) / 2;
+
+    // Net radiation (eq. 37, 38, 39, 40); relative long-wave radiation limited as in ASCE-EWRI (2005)
+    float rso = (0.75f + 2e-5f * elevation) * extraterrestrial(latitude, doy) * fraction;
+    float rns = (1 - 0.23f) * rs;
+    float fcd = (rso > 0) ? 1.35f * rs / rso - 0.35f : 1.0f;
+    fcd = (fcd < 0.05f) ? 0.05f : (fcd > 1.0f) ? 1.0f : fcd;
+    float tk4 = (powf(tMax + 273.16f, 4) + powf(tMin + 273.16f, 4)) / 2;
+    float rnl = SIGMA * tk4 * (0.34f - 0.14f * sqrtf(ea)) * fcd * fraction;
+    float rn = rns - rnl;
+
+    return (0.408f * delta * rn + gamma * 900 / (tMean + 273) * u2 * (es - ea) * fraction) /
+           (delta + gamma * (1 + 0.34f * u2));
+}
+
+Evapotranspiration::Evapotranspiration(float latitude, float elevation, float wind_height,
+                                       nvEt0_t *storage, const char *prefs) :
+    latitude(latitude),
+    elevation(elevation)
+{
+    nv = storage ? storage : &nvData;
+    windFactor = windAt2m(1.0f, wind_height);
+    #if defined(ET0_USE_PREFS) && !defined(INSIDE_UNITTEST)
+    prefsName = prefs;
+    #else
+    (void)prefs;
+    #endif
+}
+
+float
+Evapotranspiration::windAt2m(float wind, float height)
+{
+    if (height == 2.0f)
+        return wind;
+    return wind * 4.87f / logf(67.8f * height - 5.42f);
+}
+
+float
+Evapotranspiration::fao56(float tMin, float tMax, float rhMin, float rhMax, float u2, float rs,
+                          float latitude, int doy, float elevation)
+{
+    return penmanMonteith(tMin, tMax, rhMin, rhMax, u2, rs, latitude, doy, elevation, 1.0f);
+}
+
+void
+Evapotranspiration::reset(void)
+{
+    *nv = {};
+
+    #if defined(ET0_USE_PREFS) && !defined(INSIDE_UNITTEST)
+        prefs_save();
+    #endif
+}
+
+#if defined(ET0_USE_PREFS) && !defined(INSIDE_UNITTEST)
+void Evapotranspiration::prefs_load(void)
+{
+    preferences.begin(prefsName, false);
+    if (preferences.getBytes("nv", nv, sizeof(nvEt0_t)) != sizeof(nvEt0_t)) {
+        *nv = {};
+    }
+    log_d("dayStart     =%lld", (long long)nv->dayStart);
+    preferences.end();
+}
+
+void Evapotranspiration::prefs_save(void)
+{
+    preferences.begin(prefsName, false);
+    preferences.putBytes("nv", nv, sizeof(nvEt0_t));
+    preferences.end();
+}
+#endif
+
+void
+Evapotranspiration::day_init(time_t dayStart, float temp_c, float humidity)
+{
+    nv->dayStart = dayStart;
+    nv->tMin = temp_c;
+    nv->tMax = temp_c;
+    nv->rhMin = humidity;
+    nv->rhMax = humidity;
+    nv->radSum = 0;
+    nv->windSum = 0;
+    nv->covered = 0;
+}
+
+void
+Evapotranspiration::integrate(uint32_t dt, float wind, float lux)
+{
+    // Trapezoidal rule
+    nv->radSum += (nv->luxPrev + lux) / 2 * ET0_LUX_TO_WM2 * dt * 1e-6f;
+    nv->windSum += (nv->windPrev + wind) / 2 * dt;
+    nv->covered += dt;
+}
+
+bool
+Evapotranspiration::update(time_t timestamp, float temp_c, float humidity, float wind, float light_lux)
+{
+    #if defined(ET0_USE_PREFS) && !defined(INSIDE_UNITTEST)
+        prefs_load();
+    #endif
+
+    float u2 = wind * windFactor;
+    time_t dayStart = midnight(timestamp);
+
+    if (nv->dayStart == 0) {
+        // First update
+        day_init(dayStart, temp_c, humidity);
+    } else if (timestamp < nv->lastUpdate) {
+        log_w("Timestamp before last update!?");
+        return false;
+    } else {
+        bool gap = (timestamp - nv->lastUpdate) > ET0_MAX_GAP;
+
+        if (dayStart != nv->dayStart) {
+            // Integrate until end of day and finalize
+            time_t dayEnd = midnight(nv->dayStart, 1);
+            if (!gap)
+                integrate(dayEnd - nv->lastUpdate, u2, light_lux);
+
+            nv->et0Prev = calculate(1.0f);
+            nv->prevValid = nv->covered >= ET0_MIN_COVERAGE * (dayEnd - nv->dayStart);
+            nv->prevDayStart = nv->dayStart;
+
+            // Integrate since begin of new day
+            day_init(dayStart, temp_c, humidity);
+            if (!gap)
+                integrate(timestamp - dayStart, u2, light_lux);
+        } else {
+            if (!gap)
+                integrate(timestamp - nv->lastUpdate, u2, light_lux);
+
+            if (temp_c < nv->tMin)
+                nv->tMin = temp_c;
+            if (temp_c > nv->tMax)
+                nv->tMax = temp_c;
+            if (humidity < nv->rhMin)
+                nv->rhMin = humidity;
+            if (humidity > nv->rhMax)
+                nv->rhMax = humidity;
+        }
+    }
+
+    nv->lastUpdate = timestamp;
+    nv->windPrev = u2;
+    nv->luxPrev = light_lux;
+
+    #if defined(ET0_USE_PREFS) && !defined(INSIDE_UNITTEST)
+        prefs_save();
+    #endif
+
+    return true;
+}
+
+float
+Evapotranspiration::calculate(float fraction) const
+{
+    struct tm t;
+    localtime_r(&nv->dayStart, &t);
+    float u2 = (nv->covered > 0) ? nv->windSum / nv->covered : nv->windPrev;
+
+    return penmanMonteith(nv->tMin, nv->tMax, nv->rhMin, nv->rhMax, u2, nv->radSum,
+                          latitude, t.tm_yday + 1, elevation, fraction);
+}
+
+float
+Evapotranspiration::currentDay(bool *valid) const
+{
+    if (valid != nullptr)
+        *valid = false;
+
+    if (nv->dayStart == 0)
+        return -1;
+
+    time_t elapsed = nv->lastUpdate - nv->dayStart;
+    if (valid != nullptr)
+        *valid = (elapsed > 0) && (nv->covered >= ET0_MIN_COVERAGE * elapsed);
+
+    time_t dayLength = midnight(nv->dayStart, 1) - nv->dayStart;
+    return calculate((float)elapsed / dayLength);
+}
+
+float
+Evapotranspiration::previousDay(bool *valid, time_t *day) const
+{
+    if (valid != nullptr)
+        *valid = (nv->prevDayStart != 0) && nv->prevValid;
+
+    if (day != nullptr)
+        *day = nv->prevDayStart;
+
+    return (nv->prevDayStart != 0) ? nv->et0Prev : -1;
+}
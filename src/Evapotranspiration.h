@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Evapotranspiration.h
+//
+// Calculation of daily reference evapotranspiration (ET0, FAO-56 Penman-Monteith)
+// from weather sensor data
+//
+// Input:
+//     * Timestamp
+//     * Temperature [°C]
+//     * Humidity [%]
+//     * Average wind speed [m/s]
+//     * Light intensity [lux] (7-in-1 sensor)
+//
+// Output:
+//     * ET0 of current day (provisional, accumulated since midnight) [mm]
+//     * ET0 of previous day (final) [mm]
+//     * Water balance of current day (rainfall - ET0) [mm]
+//
+// Each update is integrated into the daily aggregates (O(1) time and memory): temperature and
+// humidity extremes, time-weighted sum of wind speed and solar radiation. Solar radiation is
+// estimated from illuminance (ET0_LUX_TO_WM2); wind speed is converted from the sensor's
+// height to 2 m (FAO-56 eq. 47).
+//
+// The daily value is calculated with FAO-56 eq. 6, using the net radiation according to
+// eq. 38/39 (albedo 0.23, soil heat flux G = 0) and the clear-sky radiation according to
+// eq. 37. The provisional value during the day uses the aggregates so far; the aerodynamic and
+// the long-wave radiation terms are weighted with the elapsed fraction of the day.
+//
+// Non-volatile data is stored in Preferences (Flash FS) or in memory provided by the
+// application (e.g. in the ESP32's RTC RAM) to allow retention during deep sleep mode.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250505 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _EVAPOTRANSPIRATION_H
+#define _EVAPOTRANSPIRATION_H
+
+#include <stdint.h>
+#include "time.h"
+#include "WeatherSensorCfg.h"
+
+#if defined(ET0_USE_PREFS) && !defined(INSIDE_UNITTEST)
+#include <Preferences.h>
+#endif
+
+/**
+ * \def
+ *
+ * Conversion of illuminance [lux] to global solar radiation [W/m²] (daylight: ~126.7 lux per W/m²)
+ */
+#define ET0_LUX_TO_WM2 0.0079f
+
+/**
+ * \def
+ *
+ * Maximum interval between updates [s]; longer intervals are not integrated
+ */
+#define ET0_MAX_GAP 1800
+
+/**
+ * \def
+ *
+ * Fraction of time covered by updates required for valid result
+ */
+#define ET0_MIN_COVERAGE 0.75f
+
+
+/**
+ * \typedef nvEt0_t
+ *
+ * \brief Data structure for evapotranspiration to be stored in non-volatile memory
+ *
+ * All-zero data (e.g. RTC RAM after power-on) is a valid initial state.
+ */
+typedef struct {
+    time_t   dayStart;      //!< begin of current day (local midnight), 0: no data
+    time_t   lastUpdate;    //!< timestamp of last update
+    float    tMin;          //!< minimum temperature of current day [°C]
+    float    tMax;          //!< maximum temperature of current day [°C]
+    float    rhMin;         //!< minimum humidity of current day [%]
+    float    rhMax;         //!< maximum humidity of current day [%]
+    float    radSum;        //!< solar radiation of current day [MJ/m²]
+    float    windSum;       //!< time integral of wind speed (at 2 m) of current day [m]
+    uint32_t covered;       //!< time covered by updates during current day [s]
+    float    windPrev;      //!< wind speed (at 2 m) at last update [m/s]
+    float    luxPrev;       //!< illuminance at last update [lux]
+    time_t   prevDayStart;  //!< begin of previous (completed) day, 0: none
+    float    et0Prev;       //!< ET0 of previous day [mm]
+    bool     prevValid;     //!< ET0 of previous day valid
+} nvEt0_t;
+
+
+/**
+ * \class Evapotranspiration
+ *
+ * \brief Daily reference evapotranspiration (ET0) according to FAO-56
+ */
+class Evapotranspiration {
+
+private:
+    nvEt0_t  nvData = {};
+    nvEt0_t *nv;
+    float    latitude;
+    float    elevation;
+    float    windFactor;
+
+    #if defined(ET0_USE_PREFS) && !defined(INSIDE_UNITTEST)
+    Preferences preferences;
+    const char *prefsName;
+    #endif
+
+    void  day_init(time_t dayStart, float temp_c, float humidity);
+    void  integrate(uint32_t dt, float wind, float lux);
+    float calculate(float fraction) const;
+
+public:
+    /**
+     * Constructor
+     *
+     * \param latitude      latitude of site [°] (north: positive, south: negative)
+     * \param elevation     elevation of site above sea level [m]
+     * \param wind_height   height of wind sensor above ground [m]
+     * \param storage       non-volatile data (e.g. RTC_DATA_ATTR nvEt0_t nvEt0;),
+     *                      nullptr: internal (stored in Preferences if ET0_USE_PREFS is defined)
+     * \param prefs         Preferences namespace
+     */
+    Evapotranspiration(float latitude, float elevation = 0, float wind_height = 2.0f,
+                       nvEt0_t *storage = nullptr, const char *prefs = "BWS-ET0");
+
+    /**
+     * Initialize/reset non-volatile data
+     */
+    void reset(void);
+
+    #if defined(ET0_USE_PREFS) && !defined(INSIDE_UNITTEST)
+    void prefs_load(void);
+    void prefs_save(void);
+    #endif
+
+    /**
+     * \fn update
+     *
+     * \brief Update with weather sensor data
+     *
+     * The interval since the previous update is integrated with the average of both
+     * updates' values, unless it exceeds ET0_MAX_GAP. At the begin of a new day, the
+     * ET0 of the previous day is finalized.
+     *
+     * \param timestamp     timestamp (epoch)
+     * \param temp_c        temperature [°C]
+     * \param humidity      humidity [%]
+     * \param wind          average wind speed at sensor height [m/s]
+     * \param light_lux     illuminance [lux]
+     *
+     * \return false if timestamp is before last update (update ignored)
+     */
+    bool update(time_t timestamp, float temp_c, float humidity, float wind, float light_lux);
+
+    /**
+     * \fn currentDay
+     *
+     * \brief Get ET0 of current day (provisional)
+     *
+     * \param valid     updates cover >= ET0_MIN_COVERAGE of the time since midnight
+     *
+     * \return ET0 since begin of day [mm], -1 if no data
+     */
+    float currentDay(bool *valid = nullptr) const;
+
+    /**
+     * \fn previousDay
+     *
+     * \brief Get ET0 of previous (completed) day
+     *
+     * \param valid     updates covered >= ET0_MIN_COVERAGE of the day
+     * \param day       begin of day (local midnight)
+     *
+     * \return ET0 [mm], -1 if no data
+     */
+    float previousDay(bool *valid = nullptr, time_t *day = nullptr) const;
+
+    /**
+     * \fn waterBalance
+     *
+     * \brief Get water balance of current day
+     *
+     * \param rain      rainfall of current day [mm], e.g. RainGauge::currentDay()
+     *
+     * \return rainfall - ET0 [mm]
+     */
+    float waterBalance(float rain) const
+    {
+        float et0 = currentDay();
+        return (et0 < 0) ? rain : rain - et0;
+    }
+
+    /**
+     * \fn fao56
+     *
+     * \brief Calculate daily ET0 (FAO-56 eq. 6) from daily data
+     *
+     * \param tMin      minimum temperature [°C]
+     * \param tMax      maximum temperature [°C]
+     * \param rhMin     minimum humidity [%]
+     * \param rhMax     maximum humidity [%]
+     * \param u2        average wind speed at 2 m [m/s]
+     * \param rs        solar radiation [MJ/m²/day]
+     * \param latitude  latitude [°]
+     * \param doy       day of year (1...366)
+     * \param elevation elevation above sea level [m]
+     *
+     * \return ET0 [mm/day]
+     */
+    static float fao56(float tMin, float tMax, float rhMin, float rhMax, float u2, float rs,
+                       float latitude, int doy, float elevation);
+
+    /**
+     * \fn windAt2m
+     *
+     * \brief Convert wind speed to 2 m above ground (FAO-56 eq. 47)
+     *
+     * \param wind      wind speed [m/s]
+     * \param height    height of measurement above ground [m]
+     *
+     * \return wind speed at 2 m [m/s]
+     */
+    static float windAt2m(float wind, float height);
+};
+#endif // _EVAPOTRANSPIRATION_H
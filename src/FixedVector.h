@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FixedVector.h
+//
+// Statically sized container for the heap-free build profile (WEATHERSENSOR_HEAP_FREE)
+//
+// FixedVector<T, N> provides the subset of the std::vector interface used by the library
+// with storage for N elements embedded in the object, i.e. it never allocates memory.
+// resize() and push_back() beyond the capacity are truncated.
+//
+// WsVector<T, N> is the container type used by the library: FixedVector<T, N> in the
+// heap-free profile, std::vector<T> otherwise (N is ignored).
+// WsSlotVector<T> is the container with one element per sensor data slot
+// (capacity WEATHERSENSOR_MAX_SLOTS in the heap-free profile).
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250422 Created
+// 20250508 Added WsSlotVector (capacity WEATHERSENSOR_MAX_SLOTS)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _FIXED_VECTOR_H
+#define _FIXED_VECTOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <initializer_list>
+#include <vector>
+#include "WeatherSensorCfg.h"
+
+/*!
+ * \class FixedVector
+ *
+ * \brief Vector with static capacity N
+ */
+template <typename T, size_t N>
+class FixedVector {
+
+private:
+    T      items[N];
+    size_t count = 0;
+
+public:
+    FixedVector(void) = default;
+
+    FixedVector(std::initializer_list<T> list)
+    {
+        *this = list;
+    }
+
+    FixedVector &operator=(std::initializer_list<T> list)
+    {
+        count = 0;
+        for (const T &item : list)
+            push_back(item);
+        return *this;
+    }
+
+    size_t size(void) const { return count; }
+    size_t capacity(void) const { return N; }
+    bool   empty(void) const { return count == 0; }
+
+    T       &operator[](size_t i) { return items[i]; }
+    const T &operator[](size_t i) const { return items[i]; }
+
+    T       *data(void) { return items; }
+    T       *begin(void) { return items; }
+    T       *end(void) { return items + count; }
+    const T *begin(void) const { return items; }
+    const T *end(void) const { return items + count; }
+
+    void clear(void) { count = 0; }
+    void shrink_to_fit(void) {}
+
+    /*!
+     * \brief Append element (ignored if capacity is exhausted)
+     */
+    void push_back(const T &item)
+    {
+        if (count < N)
+            items[count++] = item;
+    }
+
+    /*!
+     * \brief Replace contents by n copies of value (limited to capacity)
+     */
+    void assign(size_t n, const T &value)
+    {
+        if (n > N)
+            n = N;
+        for (size_t i = 0; i < n; i++)
+            items[i] = value;
+        count = n;
+    }
+
+    /*!
+     * \brief Change size (limited to capacity); new elements are value-initialized
+     */
+    void resize(size_t n)
+    {
+        if (n > N)
+            n = N;
+        for (size_t i = count; i < n; i++)
+            items[i] = T();
+        count = n;
+    }
+};
+
+#if defined(WEATHERSENSOR_HEAP_FREE)
+template <typename T, size_t N>
+using WsVector = FixedVector<T, N>;
+template <typename T>
+using WsSlotVector = FixedVector<T, WEATHERSENSOR_MAX_SLOTS>;
+#else
+template <typename T, size_t N>
+using WsVector = std::vector<T>;
+template <typename T>
+using WsSlotVector = std::vector<T>;
+#endif
+
+#endif // _FIXED_VECTOR_H
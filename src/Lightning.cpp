@@ -62,7 +62,9 @@
 // 20240125 Added lastCycle()
 // 20240130 Update pastHour() documentation
 // 20250324 Added configuration of expected update rate at run-time
+// 20250422 Debug output of history without String (no heap allocation)
 //          pastHour(): modified parameters
+// 20250506 Added getState()/setState()
 //
 // ToDo:
 // -
@@ -167,6 +169,29 @@ void Lightning::prefs_save(void)
 }
 #endif
 
+void
+Lightning::getState(nvLightning_t &state)
+{
+    #if defined(LIGHTNING_USE_PREFS)  && !defined(INSIDE_UNITTEST)
+        prefs_load();
+    #endif
+    state = nvLightning;
+}
+
+void
+Lightning::setState(const nvLightning_t &state)
+{
+    nvLightning = state;
+    deltaEvents = -1;
+
+    #if defined(LIGHTNING_USE_PREFS)  && !defined(INSIDE_UNITTEST)
+        prefs_save();
+        preferences.begin("BWS-LGT", false);
+        preferences.putUChar("updateRate", nvLightning.updateRate);
+        preferences.end();
+    #endif
+}
+
 void
 Lightning::update(time_t timestamp, int16_t count, uint8_t distance, bool startup)
 {
@@ -304,13 +329,13 @@ Lightning::update(time_t timestamp, int16_t count, uint8_t distance, bool startu
     }
     
     #if CORE_DEBUG_LEVEL == ARDUHAL_LOG_LEVEL_DEBUG
-        String buf;
-        buf = String("hist[]={");
+        char buf[LIGHTNING_HIST_SIZE * 8 + 12];
+        int pos = sprintf(buf, "hist[]={");
         for (size_t i=0; i<LIGHTNING_HIST_SIZE; i++) {
-            buf += String(nvLightning.hist[i]) + String(", ");
+            pos += sprintf(&buf[pos], "%d, ", nvLightning.hist[i]);
         }
-        buf += String("}");
-        log_d("%s", buf.c_str());
+        sprintf(&buf[pos], "}");
+        log_d("%s", buf);
     #endif
 
     nvLightning.lastUpdate = timestamp;
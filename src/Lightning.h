@@ -61,6 +61,7 @@
 // 20240125 Added lastCycle()
 // 20250324 Added configuration of expected update rate at run-time
 //          pastHour(): modified parameters
+// 20250506 Added getState()/setState() (see Checkpoint.h)
 //
 // ToDo:
 // -
@@ -245,6 +246,20 @@ public:
     void prefs_save(void);
     #endif
 
+    /**
+     * Get non-volatile data (e.g. for saving a checkpoint)
+     *
+     * \param state     copy of non-volatile data
+     */
+    void getState(nvLightning_t &state);
+
+    /**
+     * Set non-volatile data (e.g. from a checkpoint) and store it
+     *
+     * \param state     non-volatile data
+     */
+    void setState(const nvLightning_t &state);
+
     /**
      * \fn update
      * 
@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemStats.cpp
+//
+// Heap and stack instrumentation per phase of the receive/publish loop
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250423 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include "MemStats.h"
+
+#if defined(ESP32) && !defined(INSIDE_UNITTEST)
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#elif defined(ESP8266) && !defined(INSIDE_UNITTEST)
+#include <Arduino.h>
+#endif
+
+// Phase names used in summary()
+static const char *phaseNames[MEM_PHASE_NUM] = {
+    "getdata", "decode", "publish", "discovery"
+};
+
+// Platform specific heap probe
+static void platformProbe(MemSample &s)
+{
+    memset(&s, 0, sizeof(s));
+    #if defined(ESP32) && !defined(INSIDE_UNITTEST)
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_DEFAULT);
+    s.free = info.total_free_bytes;
+    s.maxBlock = info.largest_free_block;
+    s.blocks = info.allocated_blocks;
+    #elif defined(ESP8266) && !defined(INSIDE_UNITTEST)
+    uint32_t max_block;
+    ESP.getHeapStats(&s.free, &max_block, nullptr);
+    s.maxBlock = max_block;
+    #endif
+}
+
+MemStats::MemStats(MemProbe mem_probe)
+{
+    setProbe(mem_probe);
+    reset();
+}
+
+void
+MemStats::reset(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.freeMin = 0xFFFFFFFF;
+    stats.maxBlockMin = 0xFFFFFFFF;
+    for (int i = 0; i < MEM_PHASE_NUM; i++) {
+        stats.phase[i].freeMin = 0xFFFFFFFF;
+        stats.phase[i].maxBlockMin = 0xFFFFFFFF;
+    }
+    for (int i = 0; i < MEM_STACK_NUM; i++) {
+        stats.stackMin[i] = 0xFFFFFFFF;
+    }
+    active = 0;
+}
+
+void
+MemStats::setProbe(MemProbe mem_probe)
+{
+    probe = mem_probe ? mem_probe : platformProbe;
+}
+
+void
+MemStats::sample(MemSample &s)
+{
+    probe(s);
+    stats.samples++;
+    stats.free = s.free;
+    if (s.free < stats.freeMin)
+        stats.freeMin = s.free;
+    if (s.maxBlock < stats.maxBlockMin)
+        stats.maxBlockMin = s.maxBlock;
+    if (s.free) {
+        uint8_t frag = 100 - (uint8_t)(((uint64_t)s.maxBlock * 100) / s.free);
+        if (frag > stats.fragMax)
+            stats.fragMax = frag;
+    }
+}
+
+void
+MemStats::enter(MemPhase phase)
+{
+    sample(entry[phase]);
+    active |= 1 << phase;
+}
+
+void
+MemStats::leave(MemPhase phase)
+{
+    if (!(active & (1 << phase)))
+        return;
+    active &= ~(1 << phase);
+
+    MemSample s;
+    sample(s);
+
+    const MemSample &e = entry[phase];
+    MemPhaseStats &p = stats.phase[phase];
+    p.calls++;
+    p.allocs += s.allocs - e.allocs;
+    p.blocks += (int32_t)(s.blocks - e.blocks);
+    p.heap += (int32_t)(s.free - e.free);
+    if (s.free < p.freeMin)
+        p.freeMin = s.free;
+    if (s.maxBlock < p.maxBlockMin)
+        p.maxBlockMin = s.maxBlock;
+}
+
+void
+MemStats::sampleHeap(void)
+{
+    MemSample s;
+    sample(s);
+}
+
+void
+MemStats::sampleStack(MemStack task, uint32_t free_bytes)
+{
+    if (free_bytes < stats.stackMin[task])
+        stats.stackMin[task] = free_bytes;
+}
+
+void
+MemStats::sampleStack(MemStack task)
+{
+    #if defined(ESP32) && !defined(INSIDE_UNITTEST)
+    // High-water mark of current task (in bytes with ESP-IDF)
+    sampleStack(task, uxTaskGetStackHighWaterMark(NULL));
+    #elif defined(ESP8266) && !defined(INSIDE_UNITTEST)
+    sampleStack(task, ESP.getFreeContStack());
+    #else
+    (void)task;
+    #endif
+}
+
+// Value for JSON output (-1: not available)
+static long val(uint32_t v)
+{
+    return (v == 0xFFFFFFFF) ? -1L : (long)v;
+}
+
+size_t
+MemStats::summary(char *buf, size_t size) const
+{
+    if (size)
+        buf[0] = '\0';
+
+    int pos = snprintf(buf, size, "{\"n\":%lu,\"free\":%lu,\"free_min\":%ld,\"blk_min\":%ld,\"frag_max\":%u,\"stack\":[%ld,%ld]",
+                       (unsigned long)stats.samples, (unsigned long)stats.free, val(stats.freeMin), val(stats.maxBlockMin),
+                       stats.fragMax, val(stats.stackMin[MEM_STACK_LOOP]), val(stats.stackMin[MEM_STACK_RX]));
+    if ((pos < 0) || ((size_t)pos >= size))
+        goto overflow;
+
+    for (int i = 0; i < MEM_PHASE_NUM; i++) {
+        const MemPhaseStats &p = stats.phase[i];
+        int res = snprintf(&buf[pos], size - pos, ",\"%s\":[%lu,%lu,%ld,%ld,%ld,%ld]",
+                           phaseNames[i], (unsigned long)p.calls, (unsigned long)p.allocs, (long)p.blocks, (long)p.heap,
+                           val(p.freeMin), val(p.maxBlockMin));
+        if ((res < 0) || ((size_t)(pos + res) >= size))
+            goto overflow;
+        pos += res;
+    }
+
+    if ((size_t)pos + 2 > size)
+        goto overflow;
+    buf[pos++] = '}';
+    buf[pos] = '\0';
+    return pos;
+
+overflow:
+    if (size)
+        buf[0] = '\0';
+    return 0;
+}
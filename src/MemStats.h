@@ -0,0 +1,277 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemStats.h
+//
+// Heap and stack instrumentation per phase of the receive/publish loop
+//
+// The application (and the library) enclose phases (getData(), decoding, publishing,
+// Home Assistant auto discovery) by enter()/leave() (or a MemStatsScope object).
+// For each phase, the number of allocations, the change of allocated blocks and
+// free heap, and the minimum free heap/largest free block at the end of the phase
+// are accumulated in a fixed-size structure. Additionally, the minimum free stack
+// (high-water mark) of the loop task and of an optional receive task is recorded.
+//
+// The heap is sampled by a probe function. The default probe uses
+// - ESP32:   heap_caps_get_info() (free heap, largest free block, allocated blocks)
+// - ESP8266: ESP.getHeapStats() (free heap, largest free block)
+// Allocation counts are only available with a custom probe, e.g. from a counting
+// allocator on the host.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250423 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MEM_STATS_H
+#define _MEM_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/*!
+ * \enum MemPhase
+ *
+ * \brief Instrumented phases
+ */
+typedef enum MemPhase {
+    MEM_PHASE_GETDATA = 0,      //!< WeatherSensor::getData()
+    MEM_PHASE_DECODE = 1,       //!< Message decoding (within getData())
+    MEM_PHASE_PUBLISH = 2,      //!< Publishing of sensor data (application)
+    MEM_PHASE_DISCOVERY = 3,    //!< Home Assistant auto discovery (application)
+    MEM_PHASE_NUM = 4           //!< Number of phases
+} MemPhase;
+
+
+/*!
+ * \enum MemStack
+ *
+ * \brief Tasks with stack high-water mark
+ */
+typedef enum MemStack {
+    MEM_STACK_LOOP = 0,         //!< Arduino loop task (ESP8266: cont stack)
+    MEM_STACK_RX = 1,           //!< Receive task (if any)
+    MEM_STACK_NUM = 2           //!< Number of tasks
+} MemStack;
+
+
+/*!
+ * \struct MemSample
+ *
+ * \brief Heap sample provided by probe function
+ */
+typedef struct MemSample {
+    uint32_t free;              //!< free heap [bytes]
+    uint32_t maxBlock;          //!< largest free block [bytes]
+    uint32_t blocks;            //!< number of allocated blocks (0 if not available)
+    uint32_t allocs;            //!< total number of allocations (0 if not available)
+} MemSample;
+
+
+/*!
+ * \struct MemPhaseStats
+ *
+ * \brief Statistics per phase
+ */
+typedef struct MemPhaseStats {
+    uint32_t calls;             //!< number of completed phases
+    uint32_t allocs;            //!< number of allocations
+    int32_t  blocks;            //!< change of allocated blocks (> 0: potential leak)
+    int32_t  heap;              //!< change of free heap [bytes] (< 0: potential leak)
+    uint32_t freeMin;           //!< minimum free heap at end of phase [bytes]
+    uint32_t maxBlockMin;       //!< minimum largest free block at end of phase [bytes]
+} MemPhaseStats;
+
+
+/*!
+ * \struct MemStatsData
+ *
+ * \brief Heap and stack statistics
+ */
+typedef struct MemStatsData {
+    MemPhaseStats phase[MEM_PHASE_NUM]; //!< statistics per phase
+    uint32_t samples;                   //!< number of heap samples
+    uint32_t free;                      //!< free heap at last sample [bytes]
+    uint32_t freeMin;                   //!< minimum free heap [bytes]
+    uint32_t maxBlockMin;               //!< minimum largest free block [bytes]
+    uint8_t  fragMax;                   //!< maximum fragmentation [%] (100 - largest block / free heap)
+    uint32_t stackMin[MEM_STACK_NUM];   //!< minimum free stack per task [bytes] (0xFFFFFFFF: not sampled)
+} MemStatsData;
+
+
+/*!
+ * \brief Heap probe function
+ *
+ * \param sample   heap sample
+ */
+typedef void (*MemProbe)(MemSample &sample);
+
+
+/*!
+ * \class MemStats
+ *
+ * \brief Heap and stack statistics per phase
+ *
+ * Typical usage:
+ *
+ *     MemStats memStats;
+ *
+ *     setup() {
+ *         weatherSensor.setMemStats(&memStats);   // getData()/decoding marked by library
+ *     }
+ *
+ *     loop() {
+ *         weatherSensor.getData(...);
+ *         {
+ *             MemStatsScope scope(&memStats, MEM_PHASE_PUBLISH);
+ *             publishWeatherdata();
+ *         }
+ *         memStats.sampleStack(MEM_STACK_LOOP);
+ *         memStats.summary(buf, sizeof(buf));      // publish periodically
+ *     }
+ */
+class MemStats {
+
+private:
+    MemStatsData stats;
+    MemSample    entry[MEM_PHASE_NUM];  // sample at enter()
+    uint8_t      active;                // bit n: phase n entered
+    MemProbe     probe;
+
+    void sample(MemSample &s);
+
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param mem_probe    heap probe (nullptr: platform default)
+     */
+    MemStats(MemProbe mem_probe = nullptr);
+
+    /*!
+     * \brief Clear statistics
+     */
+    void reset(void);
+
+    /*!
+     * \brief Set heap probe
+     *
+     * \param mem_probe    heap probe (nullptr: platform default)
+     */
+    void setProbe(MemProbe mem_probe);
+
+    /*!
+     * \brief Enter phase
+     *
+     * Phases may be nested (e.g. decoding within getData()).
+     *
+     * \param phase    phase
+     */
+    void enter(MemPhase phase);
+
+    /*!
+     * \brief Leave phase and update statistics
+     *
+     * \param phase    phase
+     */
+    void leave(MemPhase phase);
+
+    /*!
+     * \brief Sample heap (outside of phases)
+     */
+    void sampleHeap(void);
+
+    /*!
+     * \brief Record free stack of task
+     *
+     * \param task         task
+     * \param free_bytes   free stack (high-water mark) [bytes]
+     */
+    void sampleStack(MemStack task, uint32_t free_bytes);
+
+    /*!
+     * \brief Record free stack of current task (platform specific; no-op on host)
+     *
+     * \param task         task
+     */
+    void sampleStack(MemStack task);
+
+    /*!
+     * \brief Get statistics
+     */
+    const MemStatsData &data(void) const {
+        return stats;
+    }
+
+    /*!
+     * \brief Print statistics as JSON string
+     *
+     * {"n":<samples>,"free":<free>,"free_min":<free_min>,"blk_min":<max_block_min>,"frag_max":<frag_max>,
+     *  "stack":[<loop>,<rx>],"getdata":[<calls>,<allocs>,<blocks>,<heap>,<free_min>,<blk_min>],
+     *  "decode":[...],"publish":[...],"discovery":[...]}
+     *
+     * Stack values of -1 indicate tasks not sampled.
+     *
+     * \param buf      destination buffer
+     * \param size     size of destination buffer
+     *
+     * \returns length of string, 0 if buffer is too small
+     */
+    size_t summary(char *buf, size_t size) const;
+};
+
+
+/*!
+ * \class MemStatsScope
+ *
+ * \brief Encloses the current scope in a phase (no-op if stats is nullptr)
+ */
+class MemStatsScope {
+
+private:
+    MemStats *memStats;
+    MemPhase  memPhase;
+
+public:
+    MemStatsScope(MemStats *stats, MemPhase phase) : memStats(stats), memPhase(phase) {
+        if (memStats)
+            memStats->enter(memPhase);
+    }
+
+    ~MemStatsScope() {
+        if (memStats)
+            memStats->leave(memPhase);
+    }
+};
+#endif // _MEM_STATS_H
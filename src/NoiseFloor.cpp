@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// NoiseFloor.cpp
+//
+// Noise floor estimator and adaptive RSSI threshold
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250429 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "NoiseFloor.h"
+
+// Weight of new noise floor estimate in long-term baseline (1/n)
+#define NOISE_BASELINE_DIV  1024
+
+// Hysteresis of interference/jamming detection [dB]
+#define NOISE_JAM_HYST      3
+
+// Histograms are halved when the total weight exceeds this value
+#define NOISE_HIST_LIMIT    16384
+
+
+NoiseFloor::NoiseFloor(uint16_t interval_ms)
+{
+    interval = interval_ms;
+    reset();
+}
+
+void
+NoiseFloor::reset(void)
+{
+    head = 0;
+    count = 0;
+    lastSample = 0;
+    memset(validHist, 0, sizeof(validHist));
+    memset(invalidHist, 0, sizeof(invalidHist));
+    validTotal = 0;
+    probeCount = 0;
+    probing = false;
+    memset(&st, 0, sizeof(st));
+    st.margin = NOISE_MARGIN_MIN;
+}
+
+void
+NoiseFloor::addSample(uint32_t now, float rssi)
+{
+    float r = rssi * 10.0f;
+    if (r < -32768.0f)
+        r = -32768.0f;
+    else if (r > 32767.0f)
+        r = 32767.0f;
+
+    window[head] = (int16_t)lroundf(r);
+    head = (head + 1) % NOISE_FLOOR_WINDOW;
+    if (count < NOISE_FLOOR_WINDOW)
+        count++;
+    st.samples++;
+    lastSample = now;
+    estimate();
+}
+
+void
+NoiseFloor::estimate(void)
+{
+    if (count < NOISE_FLOOR_MIN_SAMPLES)
+        return;
+
+    // Sort copy of window (insertion sort - small and mostly ordered input)
+    int16_t s[NOISE_FLOOR_WINDOW];
+    memcpy(s, window, count * sizeof(int16_t));
+    for (uint8_t i = 1; i < count; i++) {
+        int16_t v = s[i];
+        int j = i - 1;
+        while ((j >= 0) && (s[j] > v)) {
+            s[j + 1] = s[j];
+            j--;
+        }
+        s[j + 1] = v;
+    }
+
+    float median = (count & 1) ? s[count / 2] : (s[count / 2 - 1] + s[count / 2]) / 2.0f;
+    st.floor = median / 10.0f;
+    st.spread = (s[(3 * count) / 4] - s[count / 4]) / 10.0f;
+
+    if (!st.ready) {
+        st.ready = true;
+        st.baseline = st.floor;
+    }
+
+    if (!st.jammed && (st.floor > st.baseline + NOISE_JAM_DB)) {
+        st.jammed = true;
+        st.jamEvents++;
+    } else if (st.jammed && (st.floor < st.baseline + NOISE_JAM_DB - NOISE_JAM_HYST)) {
+        st.jammed = false;
+    }
+
+    // Baseline follows slow changes only and is frozen during interference
+    if (!st.jammed)
+        st.baseline += (st.floor - st.baseline) / NOISE_BASELINE_DIV;
+}
+
+float
+NoiseFloor::threshold(void) const
+{
+    if (!st.ready || (st.margin == 0))
+        return -INFINITY;
+    return st.floor + st.margin;
+}
+
+bool
+NoiseFloor::accept(float rssi)
+{
+    probing = false;
+
+    if (rssi >= threshold()) {
+        st.accepted++;
+        return true;
+    }
+
+    if (++probeCount >= NOISE_PROBE_RATE) {
+        probeCount = 0;
+        probing = true;
+        st.probes++;
+        st.accepted++;
+        return true;
+    }
+
+    st.rejected++;
+    return false;
+}
+
+void
+NoiseFloor::feedback(float rssi, bool valid)
+{
+    if (valid)
+        st.valid++;
+    else
+        st.invalid++;
+
+    if (!st.ready)
+        return;
+
+    // Probes represent NOISE_PROBE_RATE frames below the threshold
+    uint16_t weight = probing ? NOISE_PROBE_RATE : 1;
+    probing = false;
+
+    float snr = rssi - st.floor;
+    int bin = (snr <= 0) ? 0 : (int)snr;
+    if (bin >= NOISE_SNR_BINS)
+        bin = NOISE_SNR_BINS - 1;
+
+    if (valid) {
+        validHist[bin] += weight;
+        validTotal += weight;
+    } else {
+        invalidHist[bin] += weight;
+    }
+
+    uint32_t total = validTotal;
+    for (int i = 0; i < NOISE_SNR_BINS; i++)
+        total += invalidHist[i];
+
+    // Age histograms
+    if (total > NOISE_HIST_LIMIT) {
+        validTotal = 0;
+        for (int i = 0; i < NOISE_SNR_BINS; i++) {
+            validHist[i] /= 2;
+            invalidHist[i] /= 2;
+            validTotal += validHist[i];
+        }
+    }
+
+    adapt();
+}
+
+void
+NoiseFloor::adapt(void)
+{
+    if (validTotal < NOISE_LEARN_MIN)
+        return;
+
+    // Highest margin losing at most NOISE_YIELD_LOSS/1000 of the valid frames
+    uint32_t allowed = (validTotal * NOISE_YIELD_LOSS) / 1000;
+    uint32_t lost = 0;
+    int margin = 0;
+    while (margin < NOISE_MARGIN_MAX) {
+        lost += validHist[margin];
+        if (lost > allowed)
+            break;
+        margin++;
+    }
+
+    // ...but not above the highest SNR of invalid frames
+    int useful = 0;
+    for (int i = NOISE_SNR_BINS - 1; i >= 0; i--) {
+        if (invalidHist[i]) {
+            useful = i + 1;
+            break;
+        }
+    }
+    if (margin > useful)
+        margin = useful;
+
+    if (margin < NOISE_MARGIN_MIN)
+        margin = NOISE_MARGIN_MIN;
+    st.margin = margin;
+}
+
+size_t
+NoiseFloor::summary(char *buf, size_t size) const
+{
+    int n;
+
+    if (st.ready) {
+        n = snprintf(buf, size, "{\"floor\":%.1f,\"spread\":%.1f,\"base\":%.1f,",
+                     st.floor, st.spread, st.baseline);
+    } else {
+        n = snprintf(buf, size, "{\"floor\":null,\"spread\":null,\"base\":null,");
+    }
+    if ((n < 0) || ((size_t)n >= size))
+        goto overflow;
+
+    {
+        int res = snprintf(&buf[n], size - n,
+                           "\"margin\":%u,\"jam\":%u,\"jam_events\":%lu,\"acc\":%lu,\"rej\":%lu,\"valid\":%lu,\"invalid\":%lu}",
+                           st.margin, st.jammed ? 1 : 0, (unsigned long)st.jamEvents,
+                           (unsigned long)st.accepted, (unsigned long)st.rejected,
+                           (unsigned long)st.valid, (unsigned long)st.invalid);
+        if ((res < 0) || ((size_t)(n + res) >= size))
+            goto overflow;
+        return n + res;
+    }
+
+overflow:
+    if (size)
+        buf[0] = '\0';
+    return 0;
+}
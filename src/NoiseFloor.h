@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// NoiseFloor.h
+//
+// Noise floor estimator and adaptive RSSI threshold
+//
+// The noise floor is the median of the RSSI samples taken between packets (idle samples)
+// within a sliding window of NOISE_FLOOR_WINDOW samples; the median is not affected by
+// the occasional sample taken during a transmission. A long-term baseline of the noise
+// floor is used to detect interference/jamming (noise floor > baseline + NOISE_JAM_DB).
+//
+// Packets with an RSSI below noise floor + margin are rejected before decoding.
+// The margin is tuned from histograms of the SNR (RSSI - noise floor) of frames accepted
+// and rejected by the decoders: it is set to the highest value which loses at most
+// NOISE_YIELD_LOSS/1000 of the valid frames. Every NOISE_PROBE_RATE-th frame below the
+// threshold is decoded anyway (and weighted accordingly) to keep the histograms unbiased.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250429 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _NOISE_FLOOR_H
+#define _NOISE_FLOOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WeatherSensorCfg.h"
+
+// Number of SNR histogram bins (1 dB each, starting at 0 dB)
+#define NOISE_SNR_BINS          (NOISE_MARGIN_MAX + 1)
+
+// Minimum number of idle samples for a valid noise floor estimate
+#define NOISE_FLOOR_MIN_SAMPLES 8
+
+// Minimum number of valid frames before the margin is adapted
+#define NOISE_LEARN_MIN         32
+
+
+/*!
+ * \struct NoiseFloorStats
+ *
+ * \brief Noise floor statistics
+ */
+typedef struct NoiseFloorStats {
+    float    floor;             //!< noise floor (median of idle samples) [dBm]
+    float    spread;            //!< interquartile range of idle samples [dB]
+    float    baseline;          //!< long-term noise floor [dBm]
+    uint8_t  margin;            //!< RSSI threshold above noise floor [dB]
+    bool     ready;             //!< noise floor estimate valid
+    bool     jammed;            //!< noise floor > baseline + NOISE_JAM_DB
+    uint32_t samples;           //!< number of idle samples
+    uint32_t accepted;          //!< frames passed to the decoders (incl. probes)
+    uint32_t rejected;          //!< frames rejected by the RSSI threshold
+    uint32_t probes;            //!< frames below the threshold decoded anyway
+    uint32_t valid;             //!< frames accepted by the decoders
+    uint32_t invalid;           //!< frames rejected by the decoders
+    uint32_t jamEvents;         //!< number of interference/jamming events
+} NoiseFloorStats;
+
+
+/*!
+ * \class NoiseFloor
+ *
+ * \brief Noise floor estimator and adaptive RSSI threshold
+ */
+class NoiseFloor {
+
+private:
+    int16_t         window[NOISE_FLOOR_WINDOW];     // idle samples [0.1 dB]
+    uint8_t         head;
+    uint8_t         count;
+    uint16_t        interval;
+    uint32_t        lastSample;
+    uint16_t        validHist[NOISE_SNR_BINS];      // SNR histogram of valid frames
+    uint16_t        invalidHist[NOISE_SNR_BINS];    // SNR histogram of invalid frames
+    uint32_t        validTotal;
+    uint8_t         probeCount;
+    bool            probing;                        // last frame accepted as probe
+    NoiseFloorStats st;
+
+    void estimate(void);
+    void adapt(void);
+
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param interval_ms   idle RSSI sampling interval [ms]
+     */
+    NoiseFloor(uint16_t interval_ms = NOISE_FLOOR_INTERVAL);
+
+    /*!
+     * \brief Clear samples, histograms and statistics
+     */
+    void reset(void);
+
+    /*!
+     * \brief Check if next idle sample is due
+     *
+     * \param now   current time [ms] (e.g. millis())
+     */
+    bool sampleDue(uint32_t now) const {
+        return (uint32_t)(now - lastSample) >= interval;
+    }
+
+    /*!
+     * \brief Add idle RSSI sample (taken between packets)
+     *
+     * \param now   current time [ms]
+     * \param rssi  RSSI [dBm]
+     */
+    void addSample(uint32_t now, float rssi);
+
+    /*!
+     * \brief Get RSSI threshold (noise floor + margin)
+     *
+     * \returns threshold [dBm], -INFINITY if the noise floor is not known yet
+     */
+    float threshold(void) const;
+
+    /*!
+     * \brief Check received frame against RSSI threshold
+     *
+     * \param rssi  RSSI of frame [dBm]
+     *
+     * \returns true if the frame shall be decoded
+     */
+    bool accept(float rssi);
+
+    /*!
+     * \brief Report decoding result of accepted frame (for tuning of the margin)
+     *
+     * \param rssi  RSSI of frame [dBm]
+     * \param valid frame was accepted by a decoder
+     */
+    void feedback(float rssi, bool valid);
+
+    /*!
+     * \brief Get statistics
+     */
+    const NoiseFloorStats &stats(void) const {
+        return st;
+    }
+
+    /*!
+     * \brief Print statistics as JSON string
+     *
+     * {"floor":<floor>,"spread":<spread>,"base":<baseline>,"margin":<margin>,"jam":<0|1>,
+     *  "jam_events":<n>,"acc":<accepted>,"rej":<rejected>,"valid":<valid>,"invalid":<invalid>}
+     *
+     * \param buf      destination buffer
+     * \param size     size of destination buffer
+     *
+     * \returns length of string, 0 if buffer is too small
+     */
+    size_t summary(char *buf, size_t size) const;
+};
+#endif // _NOISE_FLOOR_H
@@ -0,0 +1,461 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PromMetrics.cpp
+//
+// Receiver metrics in Prometheus text exposition format
+//
+// Collects decoder status counters, per-sensor RSSI and packet rate, getData() timing
+// (histogram), heap statistics and RainGauge/Lightning values, and renders them as
+// Prometheus text format (version 0.0.4) for an HTTP endpoint (e.g. http://<host>:9100/metrics).
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250419 Created
+// 20250428 Added radio packet/false trigger counters
+// 20250429 Added noise floor metrics
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "PromMetrics.h"
+
+// Status label values - same order as DecodeStatus (see WeatherSensor.h)
+static const char *statusNames[METRICS_STATUS_NUM] = {
+    "invalid", "ok", "parity_error", "checksum_error", "digest_error", "skip", "full"
+};
+
+// Decoder label values - index: DECODER_IDX_*
+static const char *decoderNames[DECODER_NUM] = {
+    "5in1", "6in1", "7in1", "lightning", "leakage"
+};
+
+// getData() duration histogram - upper bounds [ms] and 'le' label values [s]
+static const uint32_t bucketBounds[METRICS_BUCKETS_NUM] = {
+    500, 1000, 2000, 5000, 10000, 20000, 30000, 60000, 120000
+};
+static const char *bucketLabels[METRICS_BUCKETS_NUM + 1] = {
+    "0.5", "1", "2", "5", "10", "20", "30", "60", "120", "+Inf"
+};
+
+// Rain gauge 'period' label values
+static const char *rainPeriods[4] = {
+    "past_hour", "day", "week", "month"
+};
+
+// Weight of new sample in smoothed packet interval
+#define METRICS_INTERVAL_ALPHA 0.125f
+
+// Metric family headers
+#define FAMILY(name, type, help) "# HELP " name " " help "\n# TYPE " name " " type "\n"
+
+static const char famRenders[] =
+    FAMILY("bresser_metrics_renders_total", "counter", "Number of rendered scrapes");
+static const char famTruncations[] =
+    FAMILY("bresser_metrics_truncations_total", "counter", "Number of truncated scrapes");
+static const char famDecode[] =
+    FAMILY("bresser_decode_total", "counter", "Received messages by decoding status");
+static const char famFrames[] =
+    FAMILY("bresser_decoder_frames_total", "counter", "Messages passed to the decoders");
+static const char famEarly[] =
+    FAMILY("bresser_decoder_early_rejects_total", "counter", "Messages rejected by structural checks");
+static const char famIntegrity[] =
+    FAMILY("bresser_decoder_integrity_rejects_total", "counter", "Messages rejected by digest/CRC/checksum");
+static const char famRadioPackets[] =
+    FAMILY("bresser_radio_packets_total", "counter", "Packets read from the radio");
+static const char famFalseTriggers[] =
+    FAMILY("bresser_radio_false_triggers_total", "counter", "Packets rejected by sync check or decoders");
+static const char famNoiseFloor[] =
+    FAMILY("bresser_radio_noise_floor_dbm", "gauge", "RSSI noise floor (median of idle samples)");
+static const char famNoiseBaseline[] =
+    FAMILY("bresser_radio_noise_baseline_dbm", "gauge", "Long-term RSSI noise floor");
+static const char famNoiseMargin[] =
+    FAMILY("bresser_radio_rssi_margin_db", "gauge", "Adaptive RSSI threshold above noise floor");
+static const char famSquelched[] =
+    FAMILY("bresser_radio_squelched_total", "counter", "Frames dropped by the adaptive RSSI threshold");
+static const char famJammed[] =
+    FAMILY("bresser_radio_jammed", "gauge", "Noise floor raised by interference/jamming");
+static const char famJamEvents[] =
+    FAMILY("bresser_radio_jam_events_total", "counter", "Interference/jamming events");
+static const char famRssi[] =
+    FAMILY("bresser_sensor_rssi_dbm", "gauge", "RSSI of last message per sensor");
+static const char famPackets[] =
+    FAMILY("bresser_sensor_packets_total", "counter", "Received messages per sensor");
+static const char famRate[] =
+    FAMILY("bresser_sensor_packet_rate_per_minute", "gauge", "Smoothed message rate per sensor");
+static const char famEvictions[] =
+    FAMILY("bresser_sensor_evictions_total", "counter", "Sensors dropped from the metrics table");
+static const char famGetData[] =
+    FAMILY("bresser_getdata_duration_seconds", "histogram", "Duration of getData() calls");
+static const char famGetDataRes[] =
+    FAMILY("bresser_getdata_total", "counter", "getData() calls by result");
+static const char famHeapFree[] =
+    FAMILY("bresser_heap_free_bytes", "gauge", "Free heap");
+static const char famHeapMin[] =
+    FAMILY("bresser_heap_min_free_bytes", "gauge", "Minimum free heap since boot");
+static const char famHeapMax[] =
+    FAMILY("bresser_heap_max_alloc_bytes", "gauge", "Largest allocatable heap block");
+static const char famRain[] =
+    FAMILY("bresser_rain_mm", "gauge", "Rainfall per period");
+static const char famLightningHour[] =
+    FAMILY("bresser_lightning_past_hour_strikes", "gauge", "Lightning strikes during past 60 minutes");
+static const char famLightningEvents[] =
+    FAMILY("bresser_lightning_last_event_strikes", "gauge", "Lightning strikes of last event");
+static const char famLightningDist[] =
+    FAMILY("bresser_lightning_last_event_distance_km", "gauge", "Distance of last lightning event");
+
+
+PromMetrics::PromMetrics(void)
+{
+    reset();
+}
+
+void
+PromMetrics::reset(void)
+{
+    memset(status, 0, sizeof(status));
+    memset(sensors, 0, sizeof(sensors));
+    evictions = 0;
+    memset(buckets, 0, sizeof(buckets));
+    durationSum = 0;
+    getDataOk = 0;
+    getDataTimeout = 0;
+    memset(&rejects, 0, sizeof(rejects));
+    rejectsValid = false;
+    memset(&sync, 0, sizeof(sync));
+    syncChip = "";
+    syncValid = false;
+    memset(&noise, 0, sizeof(noise));
+    noiseValid = false;
+    heapValid = false;
+    rainValid = false;
+    lightningValid = false;
+    renders = 0;
+    truncations = 0;
+    buf[0] = '\0';
+    pos = 0;
+    full = false;
+}
+
+void
+PromMetrics::countStatus(int s)
+{
+    if ((s >= 0) && (s < METRICS_STATUS_NUM))
+        status[s]++;
+}
+
+void
+PromMetrics::onPacket(uint32_t id, float rssi, uint32_t now)
+{
+    SensorEntry *entry = nullptr;
+    SensorEntry *oldest = &sensors[0];
+
+    for (int i = 0; i < METRICS_MAX_SENSORS; i++) {
+        if (sensors[i].id == id) {
+            entry = &sensors[i];
+            break;
+        }
+        if (sensors[i].id == 0) {
+            // Free entry - all subsequent entries are free as well
+            oldest = &sensors[i];
+            break;
+        }
+        if ((now - sensors[i].lastSeen) > (now - oldest->lastSeen))
+            oldest = &sensors[i];
+    }
+
+    if (!entry) {
+        if (oldest->id != 0)
+            evictions++;
+        entry = oldest;
+        entry->id = id;
+        snprintf(entry->label, sizeof(entry->label), "id=\"0x%08X\"", (unsigned)id);
+        entry->packets = 0;
+        entry->interval = 0;
+    } else {
+        float dt = (float)(now - entry->lastSeen);
+        entry->interval = (entry->interval == 0) ? dt :
+                          entry->interval + METRICS_INTERVAL_ALPHA * (dt - entry->interval);
+    }
+    entry->rssi = rssi;
+    entry->lastSeen = now;
+    entry->packets++;
+}
+
+void
+PromMetrics::observeGetData(uint32_t ms, bool ok)
+{
+    int i;
+    for (i = 0; i < METRICS_BUCKETS_NUM; i++) {
+        if (ms <= bucketBounds[i])
+            break;
+    }
+    buckets[i]++;
+    durationSum += ms;
+    if (ok)
+        getDataOk++;
+    else
+        getDataTimeout++;
+}
+
+void
+PromMetrics::setRejectStats(const RejectStats &stats)
+{
+    rejects = stats;
+    rejectsValid = true;
+}
+
+void
+PromMetrics::setSyncStats(const SyncStats &stats, const char *chip)
+{
+    sync = stats;
+    syncChip = chip;
+    syncValid = true;
+}
+
+void
+PromMetrics::setNoiseFloor(const NoiseFloorStats &stats)
+{
+    noise = stats;
+    noiseValid = true;
+}
+
+void
+PromMetrics::setHeap(uint32_t free_bytes, uint32_t min_free, uint32_t max_alloc)
+{
+    heapFree = free_bytes;
+    heapMinFree = min_free;
+    heapMaxAlloc = max_alloc;
+    heapValid = true;
+}
+
+void
+PromMetrics::setRain(float past_hour, float day, float week, float month)
+{
+    rain[0] = past_hour;
+    rain[1] = day;
+    rain[2] = week;
+    rain[3] = month;
+    rainValid = true;
+}
+
+void
+PromMetrics::setLightning(int past_hour, int events, uint8_t distance)
+{
+    lightningHour = past_hour;
+    lightningEvents = events;
+    lightningDistance = distance;
+    lightningValid = true;
+}
+
+bool
+PromMetrics::put(const char *fmt, ...)
+{
+    if (full)
+        return false;
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(&buf[pos], sizeof(buf) - pos, fmt, args);
+    va_end(args);
+
+    if ((n < 0) || ((size_t)n >= sizeof(buf) - pos)) {
+        buf[pos] = '\0';
+        full = true;
+        return false;
+    }
+    pos += n;
+    return true;
+}
+
+size_t
+PromMetrics::render(void)
+{
+    pos = 0;
+    full = false;
+    buf[0] = '\0';
+    renders++;
+
+    put("%s%s %u\n", famRenders, "bresser_metrics_renders_total", (unsigned)renders);
+    put("%s%s %u\n", famTruncations, "bresser_metrics_truncations_total", (unsigned)truncations);
+
+    put("%s", famDecode);
+    for (int i = 0; i < METRICS_STATUS_NUM; i++) {
+        put("bresser_decode_total{status=\"%s\"} %u\n", statusNames[i], (unsigned)status[i]);
+    }
+
+    if (rejectsValid) {
+        put("%s%s %u\n", famFrames, "bresser_decoder_frames_total", (unsigned)rejects.frames);
+        put("%s", famEarly);
+        for (int i = 0; i < DECODER_NUM; i++) {
+            put("bresser_decoder_early_rejects_total{decoder=\"%s\"} %u\n",
+                decoderNames[i], (unsigned)rejects.early[i]);
+        }
+        put("%s", famIntegrity);
+        for (int i = 0; i < DECODER_NUM; i++) {
+            put("bresser_decoder_integrity_rejects_total{decoder=\"%s\"} %u\n",
+                decoderNames[i], (unsigned)rejects.integrity[i]);
+        }
+    }
+
+    if (syncValid) {
+        const char *mode = sync.hwSync ? "hw" : "sw";
+        put("%s", famRadioPackets);
+        put("bresser_radio_packets_total{chip=\"%s\",sync=\"%s\"} %u\n",
+            syncChip, mode, (unsigned)sync.irqs);
+        put("%s", famFalseTriggers);
+        put("bresser_radio_false_triggers_total{chip=\"%s\",sync=\"%s\",stage=\"sync\"} %u\n",
+            syncChip, mode, (unsigned)sync.syncErr);
+        put("bresser_radio_false_triggers_total{chip=\"%s\",sync=\"%s\",stage=\"decode\"} %u\n",
+            syncChip, mode, (unsigned)sync.invalid);
+    }
+
+    if (noiseValid) {
+        if (noise.ready) {
+            put("%s%s %.1f\n", famNoiseFloor, "bresser_radio_noise_floor_dbm", noise.floor);
+            put("%s%s %.1f\n", famNoiseBaseline, "bresser_radio_noise_baseline_dbm", noise.baseline);
+        }
+        put("%s%s %u\n", famNoiseMargin, "bresser_radio_rssi_margin_db", (unsigned)noise.margin);
+        put("%s%s %u\n", famSquelched, "bresser_radio_squelched_total", (unsigned)noise.rejected);
+        put("%s%s %u\n", famJammed, "bresser_radio_jammed", noise.jammed ? 1 : 0);
+        put("%s%s %u\n", famJamEvents, "bresser_radio_jam_events_total", (unsigned)noise.jamEvents);
+    }
+
+    put("%s", famRssi);
+    for (int i = 0; (i < METRICS_MAX_SENSORS) && sensors[i].id; i++) {
+        put("bresser_sensor_rssi_dbm{%s} %.1f\n", sensors[i].label, sensors[i].rssi);
+    }
+    put("%s", famPackets);
+    for (int i = 0; (i < METRICS_MAX_SENSORS) && sensors[i].id; i++) {
+        put("bresser_sensor_packets_total{%s} %u\n", sensors[i].label, (unsigned)sensors[i].packets);
+    }
+    put("%s", famRate);
+    for (int i = 0; (i < METRICS_MAX_SENSORS) && sensors[i].id; i++) {
+        if (sensors[i].interval > 0)
+            put("bresser_sensor_packet_rate_per_minute{%s} %.2f\n", sensors[i].label, 60000.0f / sensors[i].interval);
+    }
+    put("%s%s %u\n", famEvictions, "bresser_sensor_evictions_total", (unsigned)evictions);
+
+    put("%s", famGetData);
+    uint32_t cumulative = 0;
+    for (int i = 0; i <= METRICS_BUCKETS_NUM; i++) {
+        cumulative += buckets[i];
+        put("bresser_getdata_duration_seconds_bucket{le=\"%s\"} %u\n", bucketLabels[i], (unsigned)cumulative);
+    }
+    put("bresser_getdata_duration_seconds_sum %u.%03u\n", (unsigned)(durationSum / 1000), (unsigned)(durationSum % 1000));
+    put("bresser_getdata_duration_seconds_count %u\n", (unsigned)cumulative);
+    put("%s", famGetDataRes);
+    put("bresser_getdata_total{result=\"ok\"} %u\n", (unsigned)getDataOk);
+    put("bresser_getdata_total{result=\"timeout\"} %u\n", (unsigned)getDataTimeout);
+
+    if (heapValid) {
+        put("%s%s %u\n", famHeapFree, "bresser_heap_free_bytes", (unsigned)heapFree);
+        put("%s%s %u\n", famHeapMin, "bresser_heap_min_free_bytes", (unsigned)heapMinFree);
+        put("%s%s %u\n", famHeapMax, "bresser_heap_max_alloc_bytes", (unsigned)heapMaxAlloc);
+    }
+
+    if (rainValid) {
+        put("%s", famRain);
+        for (int i = 0; i < 4; i++) {
+            put("bresser_rain_mm{period=\"%s\"} %.1f\n", rainPeriods[i], rain[i]);
+        }
+    }
+
+    if (lightningValid) {
+        put("%s%s %d\n", famLightningHour, "bresser_lightning_past_hour_strikes", lightningHour);
+        put("%s%s %d\n", famLightningEvents, "bresser_lightning_last_event_strikes", lightningEvents);
+        put("%s%s %u\n", famLightningDist, "bresser_lightning_last_event_distance_km", (unsigned)lightningDistance);
+    }
+
+    if (full)
+        truncations++;
+
+    return pos;
+}
+
+int
+PromMetrics::httpStatus(const char *request)
+{
+    static const char path[] = "/metrics";
+
+    if (strncmp(request, "GET ", 4) != 0)
+        return 405;
+
+    const char *p = &request[4];
+    if ((strncmp(p, path, sizeof(path) - 1) != 0))
+        return 404;
+
+    // Path must end here (query string is ignored)
+    char c = p[sizeof(path) - 1];
+    if ((c != ' ') && (c != '?') && (c != '\0') && (c != '\r') && (c != '\n'))
+        return 404;
+
+    return 200;
+}
+
+size_t
+PromMetrics::httpHeader(char *dst, size_t size, int status, size_t length)
+{
+    const char *reason;
+    const char *type = "text/plain; charset=utf-8";
+
+    switch (status) {
+        case 200:
+            reason = "OK";
+            type = "text/plain; version=0.0.4; charset=utf-8";
+            break;
+        case 404:
+            reason = "Not Found";
+            break;
+        default:
+            status = 405;
+            reason = "Method Not Allowed";
+            break;
+    }
+
+    int n = snprintf(dst, size,
+                     "HTTP/1.1 %d %s\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %u\r\n"
+                     "Connection: close\r\n"
+                     "\r\n",
+                     status, reason, type, (unsigned)length);
+
+    if ((n < 0) || ((size_t)n >= size)) {
+        if (size)
+            dst[0] = '\0';
+        return 0;
+    }
+    return n;
+}
@@ -0,0 +1,282 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PromMetrics.h
+//
+// Receiver metrics in Prometheus text exposition format
+//
+// Collects decoder status counters, per-sensor RSSI and packet rate, getData() timing
+// (histogram), heap statistics and RainGauge/Lightning values, and renders them as
+// Prometheus text format (version 0.0.4) for an HTTP endpoint (e.g. http://<host>:9100/metrics).
+//
+// All data - including the text buffer - is allocated statically; metric names and
+// sensor ID labels are precomputed, so rendering does not allocate memory.
+// Rendering is a single pass over fixed-size tables and can be done from
+// the getData() callback.
+//
+// The HTTP helpers are transport-agnostic; see examples/BresserWeatherSensorMQTT/src/metrics_http.cpp
+// for a non-blocking server based on WiFiServer.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250419 Created
+// 20250428 Added setSyncStats()
+// 20250429 Added setNoiseFloor()
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _PROM_METRICS_H
+#define _PROM_METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WeatherSensorCfg.h"
+#include "DecoderPrecheck.h"
+#include "NoiseFloor.h"
+
+// Number of decoding status values (see DecodeStatus in WeatherSensor.h)
+#define METRICS_STATUS_NUM      7
+
+// Number of getData() duration histogram buckets (excluding +Inf)
+#define METRICS_BUCKETS_NUM     9
+
+
+/*!
+ * \class PromMetrics
+ *
+ * \brief Collection and rendering of receiver metrics in Prometheus text format
+ *
+ * Typical usage:
+ *
+ *     PromMetrics metrics;
+ *
+ *     void onRx(DecodeStatus status, uint32_t id, float rssi) {
+ *         metrics.countStatus(status);
+ *         if (id)
+ *             metrics.onPacket(id, rssi, millis());
+ *     }
+ *
+ *     setup() {
+ *         weatherSensor.setRxCallback(onRx);
+ *     }
+ *
+ *     loop() {
+ *         uint32_t t = millis();
+ *         bool ok = weatherSensor.getData(...);
+ *         metrics.observeGetData(millis() - t, ok);
+ *         ...
+ *         // on request
+ *         size_t len = metrics.render();
+ *         send(metrics.text(), len);
+ *     }
+ */
+class PromMetrics {
+
+private:
+    typedef struct {
+        uint32_t id;            // sensor ID (0: unused)
+        char     label[16];     // precomputed label 'id="0x%08X"'
+        float    rssi;          // RSSI of last packet [dBm]
+        uint32_t packets;       // number of packets
+        uint32_t lastSeen;      // timestamp of last packet [ms]
+        float    interval;      // smoothed packet interval [ms] (0: unknown)
+    } SensorEntry;
+
+    uint32_t    status[METRICS_STATUS_NUM];
+    SensorEntry sensors[METRICS_MAX_SENSORS];
+    uint32_t    evictions;
+
+    uint32_t    buckets[METRICS_BUCKETS_NUM + 1];   // non-cumulative, last: +Inf
+    uint32_t    durationSum;                         // [ms]
+    uint32_t    getDataOk;
+    uint32_t    getDataTimeout;
+
+    RejectStats rejects;
+    bool        rejectsValid;
+
+    SyncStats   sync;
+    const char *syncChip;
+    bool        syncValid;
+
+    NoiseFloorStats noise;
+    bool        noiseValid;
+
+    uint32_t    heapFree;
+    uint32_t    heapMinFree;
+    uint32_t    heapMaxAlloc;
+    bool        heapValid;
+
+    float       rain[4];        // past hour, current day, week, month [mm]
+    bool        rainValid;
+
+    int         lightningHour;
+    int         lightningEvents;
+    uint8_t     lightningDistance;
+    bool        lightningValid;
+
+    uint32_t    renders;
+    uint32_t    truncations;
+
+    char        buf[METRICS_BUF_SIZE];
+    size_t      pos;
+    bool        full;
+
+    // Append formatted text; on overflow, the partial line is discarded
+    bool put(const char *fmt, ...);
+
+public:
+    /*!
+     * \brief Constructor
+     */
+    PromMetrics(void);
+
+    /*!
+     * \brief Clear all metrics
+     */
+    void reset(void);
+
+    /*!
+     * \brief Count received message by decoding status
+     *
+     * \param status    decoding status (DecodeStatus, see WeatherSensor.h)
+     */
+    void countStatus(int status);
+
+    /*!
+     * \brief Update per-sensor metrics from received message
+     *
+     * If the table is full, the sensor which has not been seen for the longest time is replaced.
+     *
+     * \param id        sensor ID
+     * \param rssi      RSSI [dBm]
+     * \param now       current time [ms] (e.g. millis())
+     */
+    void onPacket(uint32_t id, float rssi, uint32_t now);
+
+    /*!
+     * \brief Add getData() call to timing histogram
+     *
+     * \param ms        duration [ms]
+     * \param ok        true if data was received, false on timeout
+     */
+    void observeGetData(uint32_t ms, bool ok);
+
+    /*!
+     * \brief Set decoder reject statistics
+     *
+     * \param stats     statistics (see WeatherSensor::rejectStats)
+     */
+    void setRejectStats(const RejectStats &stats);
+
+    /*!
+     * \brief Set packet interrupt (false trigger) statistics
+     *
+     * \param stats     statistics (see WeatherSensor::syncStats)
+     * \param chip      radio chip name (label value, e.g. "SX1276")
+     */
+    void setSyncStats(const SyncStats &stats, const char *chip);
+
+    /*!
+     * \brief Set noise floor statistics
+     *
+     * \param stats     statistics (see NoiseFloor::stats())
+     */
+    void setNoiseFloor(const NoiseFloorStats &stats);
+
+    /*!
+     * \brief Set heap statistics
+     *
+     * \param free_bytes    current free heap [bytes]
+     * \param min_free      minimum free heap since boot [bytes]
+     * \param max_alloc     largest allocatable block [bytes]
+     */
+    void setHeap(uint32_t free_bytes, uint32_t min_free, uint32_t max_alloc);
+
+    /*!
+     * \brief Set rain gauge values (see RainGauge)
+     *
+     * \param past_hour     rainfall during past 60 minutes [mm]
+     * \param day           rainfall during current day [mm]
+     * \param week          rainfall during current week [mm]
+     * \param month         rainfall during current month [mm]
+     */
+    void setRain(float past_hour, float day, float week, float month);
+
+    /*!
+     * \brief Set lightning values (see Lightning)
+     *
+     * \param past_hour     number of strikes during past 60 minutes
+     * \param events        number of strikes of last event
+     * \param distance      distance of last event [km]
+     */
+    void setLightning(int past_hour, int events, uint8_t distance);
+
+    /*!
+     * \brief Render metrics into text buffer
+     *
+     * If the buffer (METRICS_BUF_SIZE) is too small, the output is truncated
+     * at a line boundary and bresser_metrics_truncations_total is incremented.
+     *
+     * \returns length of text in bytes (excluding terminating null)
+     */
+    size_t render(void);
+
+    /*!
+     * \brief Get text buffer (valid after render())
+     */
+    const char *text(void) const {
+        return buf;
+    }
+
+    /*!
+     * \brief Get HTTP status code for request line
+     *
+     * \param request   HTTP request line, e.g. "GET /metrics HTTP/1.1"
+     *
+     * \returns 200 for GET /metrics, 405 for other methods, 404 for other paths
+     */
+    static int httpStatus(const char *request);
+
+    /*!
+     * \brief Print HTTP response header
+     *
+     * \param dst       destination buffer
+     * \param size      size of buffer
+     * \param status    HTTP status code (200, 404 or 405)
+     * \param length    content length [bytes]
+     *
+     * \returns number of characters written (excluding terminating null),
+     *          or 0 if buffer too small
+     */
+    static size_t httpHeader(char *dst, size_t size, int status, size_t length);
+};
+#endif // _PROM_METRICS_H
@@ -54,7 +54,9 @@
 //          Improvements
 // 20240130 Update pastHour() documentation
 // 20250323 Added configuration of expected update rate at run-time
+// 20250422 Debug output of history without String (no heap allocation)
 //          pastHour(): modified parameters
+// 20250506 Added getState()/setState()
 //
 // ToDo: 
 // -
@@ -237,6 +239,31 @@ RainGauge::prefs_save(void)
 }
 #endif
 
+void
+RainGauge::getState(nvData_t &state)
+{
+    #if defined(RAINGAUGE_USE_PREFS) && !defined(INSIDE_UNITTEST)
+        prefs_load();
+    #endif
+    state = nvData;
+}
+
+void
+RainGauge::setState(const nvData_t &state)
+{
+    nvData = state;
+    if (nvData.rainPrev != -1) {
+        rainCurr = nvData.rainPrev;
+    }
+
+    #if defined(RAINGAUGE_USE_PREFS) && !defined(INSIDE_UNITTEST)
+        prefs_save();
+        preferences.begin("BWS-RAIN", false);
+        preferences.putUChar("updateRate", nvData.updateRate);
+        preferences.end();
+    #endif
+}
+
 
 void
 RainGauge::update(time_t timestamp, float rain, bool startup)
@@ -378,13 +405,13 @@ RainGauge::update(time_t timestamp, float rain, bool startup)
 
 
     #if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
-        String buf;
-        buf = String("hist[]={");
+        char buf[RAIN_HIST_SIZE * 8 + 12];
+        int pos = sprintf(buf, "hist[]={");
         for (size_t i=0; i<RAIN_HIST_SIZE; i++) {
-            buf += String(nvData.hist[i]) + String(", ");
+            pos += sprintf(&buf[pos], "%d, ", nvData.hist[i]);
         }
-        buf += String("}");
-        log_d("%s", buf.c_str());
+        sprintf(&buf[pos], "}");
+        log_d("%s", buf);
     #endif
     
     // Check if day of the week has changed
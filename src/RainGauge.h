@@ -55,6 +55,7 @@
 //          Using Preferences, Unit Tests: class member
 // 20250323 Added configuration of expected update rate at run-time
 //          pastHour(): modified parameters
+// 20250506 Added getState()/setState() (see Checkpoint.h)
 //
 // ToDo: 
 // -
@@ -263,6 +264,20 @@ public:
     void prefs_save(void);
     #endif
 
+    /**
+     * Get non-volatile data (e.g. for saving a checkpoint)
+     *
+     * \param state     copy of non-volatile data
+     */
+    void getState(nvData_t &state);
+
+    /**
+     * Set non-volatile data (e.g. from a checkpoint) and store it
+     *
+     * \param state     non-volatile data
+     */
+    void setState(const nvData_t &state);
+
     /**
      * \fn update
      * 
@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordFusion.cpp
+//
+// Fusion of sensor data records received by several receivers (gateways)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250424 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "RecordFusion.h"
+
+RecordFusion::RecordFusion(uint32_t window_ms) : window(window_ms)
+{
+    reset();
+}
+
+void
+RecordFusion::reset(void)
+{
+    for (int i = 0; i < FUSION_BUCKETS; i++) {
+        buckets[i] = -1;
+    }
+    for (int i = 0; i < FUSION_ENTRIES; i++) {
+        entries[i].next = (i < FUSION_ENTRIES - 1) ? i + 1 : -1;
+    }
+    freeList = 0;
+    head = 0;
+    count = 0;
+    readyValid = false;
+    received = 0;
+    published = 0;
+    duplicates = 0;
+    evicted = 0;
+    dropped = 0;
+}
+
+uint32_t
+RecordFusion::payloadHash(const SensorRecord &rec)
+{
+    uint8_t buf[SENSOR_RECORD_MAX_SIZE];
+    size_t len = encodeRecord(buf, sizeof(buf), rec);
+
+    // Skip receiver_id, seq, timestamp (bytes 4..15) and rssi (bytes 20..21)
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+        if (((i >= 4) && (i < 16)) || (i == 20) || (i == 21))
+            continue;
+        hash = (hash ^ buf[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+uint32_t
+RecordFusion::bucket(uint32_t sensor_id, uint32_t hash) const
+{
+    return ((hash ^ (sensor_id * 2654435761UL)) >> 8) & (FUSION_BUCKETS - 1);
+}
+
+void
+RecordFusion::merge(FusedRecord &fused, const SensorRecord &rec)
+{
+    fused.copies++;
+    if (rec.rssi > fused.rec.rssi)
+        fused.rec = rec;
+
+    for (uint8_t i = 0; i < fused.receivers; i++) {
+        if (fused.receiver_id[i] == rec.receiver_id) {
+            if (rec.rssi > fused.rssi[i])
+                fused.rssi[i] = rec.rssi;
+            return;
+        }
+    }
+    if (fused.receivers < SENSOR_RECORD_MAX_RECEIVERS) {
+        fused.receiver_id[fused.receivers] = rec.receiver_id;
+        fused.rssi[fused.receivers] = rec.rssi;
+        fused.receivers++;
+    }
+}
+
+bool
+RecordFusion::ingest(const SensorRecord &rec, uint32_t now)
+{
+    received++;
+    uint32_t hash = payloadHash(rec);
+    uint32_t b = bucket(rec.sensor_id, hash);
+
+    for (int16_t idx = buckets[b]; idx >= 0; idx = entries[idx].next) {
+        Entry &e = entries[idx];
+        if ((e.hash == hash) && (e.fused.rec.sensor_id == rec.sensor_id) && (now - e.first < window)) {
+            merge(e.fused, rec);
+            duplicates++;
+            return false;
+        }
+    }
+
+    if (freeList < 0) {
+        // Pool full - close oldest group early; it is provided by the next poll()
+        if (readyValid) {
+            dropped++;
+            return false;
+        }
+        take(ready);
+        readyValid = true;
+        evicted++;
+    }
+
+    int16_t idx = freeList;
+    Entry &e = entries[idx];
+    freeList = e.next;
+    e.hash = hash;
+    e.first = now;
+    e.next = buckets[b];
+    buckets[b] = idx;
+    memset(&e.fused, 0, sizeof(e.fused));
+    e.fused.rec = rec;
+    e.fused.rec.rssi = -1000.0f;
+    merge(e.fused, rec);
+    order[(head + count) % FUSION_ENTRIES] = idx;
+    count++;
+    return true;
+}
+
+void
+RecordFusion::unlink(int16_t idx)
+{
+    Entry &e = entries[idx];
+    int16_t *p = &buckets[bucket(e.fused.rec.sensor_id, e.hash)];
+    while (*p != idx) {
+        p = &entries[*p].next;
+    }
+    *p = e.next;
+    e.next = freeList;
+    freeList = idx;
+}
+
+void
+RecordFusion::take(FusedRecord &out)
+{
+    int16_t idx = order[head];
+    out = entries[idx].fused;
+    unlink(idx);
+    head = (head + 1) % FUSION_ENTRIES;
+    count--;
+}
+
+bool
+RecordFusion::poll(uint32_t now, FusedRecord &out)
+{
+    if (readyValid || ((count > 0) && (now - entries[order[head]].first >= window)))
+        return flush(out);
+
+    return false;
+}
+
+bool
+RecordFusion::flush(FusedRecord &out)
+{
+    if (readyValid) {
+        out = ready;
+        readyValid = false;
+    } else if (count > 0) {
+        take(out);
+    } else {
+        return false;
+    }
+    published++;
+    return true;
+}
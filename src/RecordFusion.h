@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordFusion.h
+//
+// Fusion of sensor data records received by several receivers (gateways)
+//
+// Records of the same sensor message forwarded by several receivers (see UdpSink)
+// are combined into a single record: copies with the same sensor ID and the same
+// payload hash arriving within FUSION_WINDOW_MS after the first copy form a group.
+// When the window has expired, the copy with the best RSSI is provided by poll(),
+// together with the RSSI per receiver.
+//
+// Groups are stored in a fixed-size pool and found via a hash table (chained);
+// expiry is handled in order of creation, i.e. the work per record is O(1).
+// No memory is allocated.
+//
+// The payload hash (FNV-1a) covers the encoded record (see encodeRecord()) without
+// the receiver specific fields receiver_id, seq, timestamp and rssi.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250424 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _RECORD_FUSION_H
+#define _RECORD_FUSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SensorRecord.h"
+
+// Time window for copies of the same message [ms]
+// (must be less than the sensors' transmit interval)
+#ifndef FUSION_WINDOW_MS
+#define FUSION_WINDOW_MS 3000
+#endif
+
+// Maximum number of groups (messages) within time window
+#ifndef FUSION_ENTRIES
+#define FUSION_ENTRIES 32
+#endif
+
+// Number of hash buckets (power of 2)
+#ifndef FUSION_BUCKETS
+#define FUSION_BUCKETS 64
+#endif
+
+#if (FUSION_BUCKETS & (FUSION_BUCKETS - 1)) != 0
+#error "FUSION_BUCKETS must be a power of 2"
+#endif
+
+
+/*!
+ * \struct FusedRecord
+ *
+ * \brief Record with best RSSI and RSSI per receiver
+ */
+typedef struct FusedRecord {
+    SensorRecord rec;       //!< copy with best RSSI
+    uint8_t  copies;        //!< number of copies received
+    uint8_t  receivers;     //!< number of receivers (entries in receiver_id[]/rssi[])
+    uint32_t receiver_id[SENSOR_RECORD_MAX_RECEIVERS]; //!< receiver IDs
+    float    rssi[SENSOR_RECORD_MAX_RECEIVERS];        //!< best RSSI per receiver in dBm
+} FusedRecord;
+
+
+/*!
+ * \class RecordFusion
+ *
+ * \brief Deduplication of records from several receivers, selection of best copy
+ *
+ * Typical usage (host):
+ *
+ *     RecordFusion fusion;
+ *     UdpRecordReceiver receiver;
+ *     SensorRecord rec;
+ *     FusedRecord out;
+ *
+ *     while (true) {
+ *         if (receiver.receive(rec, 100) > 0)
+ *             fusion.ingest(rec, now_ms());
+ *         while (fusion.poll(now_ms(), out))
+ *             publish(out.rec);
+ *     }
+ */
+class RecordFusion {
+
+private:
+    typedef struct {
+        uint32_t    hash;       // payload hash
+        uint32_t    first;      // time of first copy [ms]
+        int16_t     next;       // next entry in bucket chain (-1: none)
+        FusedRecord fused;
+    } Entry;
+
+    Entry    entries[FUSION_ENTRIES];
+    int16_t  buckets[FUSION_BUCKETS];   // first entry per bucket (-1: none)
+    int16_t  freeList;                  // first unused entry (-1: none)
+    int16_t  order[FUSION_ENTRIES];     // entries in order of creation (ring buffer)
+    uint8_t  head;                      // order[] - index of oldest entry
+    uint8_t  count;                     // order[] - number of entries
+    FusedRecord ready;                  // group closed early (pool full)
+    bool     readyValid;
+    uint32_t window;
+
+    uint32_t bucket(uint32_t sensor_id, uint32_t hash) const;
+    void     unlink(int16_t idx);
+    void     merge(FusedRecord &fused, const SensorRecord &rec);
+    void     take(FusedRecord &out);
+
+public:
+    uint32_t received;      //!< number of records ingested
+    uint32_t published;     //!< number of fused records provided by poll()
+    uint32_t duplicates;    //!< number of copies merged into existing groups
+    uint32_t evicted;       //!< number of groups closed before end of window (pool full)
+    uint32_t dropped;       //!< number of records dropped (pool full and poll() not called)
+
+    /*!
+     * \brief Constructor
+     *
+     * \param window_ms    time window for copies of the same message [ms]
+     */
+    RecordFusion(uint32_t window_ms = FUSION_WINDOW_MS);
+
+    /*!
+     * \brief Remove all groups and reset statistics
+     */
+    void reset(void);
+
+    /*!
+     * \brief Payload hash of record (without receiver specific fields)
+     *
+     * \param rec      record
+     *
+     * \returns hash value
+     */
+    static uint32_t payloadHash(const SensorRecord &rec);
+
+    /*!
+     * \brief Ingest record
+     *
+     * If no group is available, the oldest group is closed early and provided
+     * by the next poll() call. poll() shall be called after each ingest() call.
+     *
+     * \param rec      record
+     * \param now      current time [ms]
+     *
+     * \returns true if record is the first copy of a message
+     */
+    bool ingest(const SensorRecord &rec, uint32_t now);
+
+    /*!
+     * \brief Get next fused record whose time window has expired
+     *
+     * \param now      current time [ms]
+     * \param out      fused record
+     *
+     * \returns true if a record was provided
+     */
+    bool poll(uint32_t now, FusedRecord &out);
+
+    /*!
+     * \brief Get fused record of oldest group regardless of time window (e.g. on shutdown)
+     *
+     * \param out      fused record
+     *
+     * \returns true if a record was provided
+     */
+    bool flush(FusedRecord &out);
+
+    /*!
+     * \brief Get number of pending groups
+     */
+    uint8_t pending(void) const {
+        return count + (readyValid ? 1 : 0);
+    }
+};
+
+#endif // _RECORD_FUSION_H
@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorBus.cpp
+//
+// In-process publish/subscribe bus of decoded sensor data records
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250502 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "SensorBus.h"
+
+#define SLOT_MASK (SENSOR_BUS_SIZE - 1)
+
+SensorBus::SensorBus(void)
+{
+    for (size_t i = 0; i < SENSOR_BUS_SIZE; i++)
+    {
+        slots[i].seq.store(0, std::memory_order_relaxed);
+        for (size_t w = 0; w < WORDS; w++)
+            slots[i].data[w].store(0, std::memory_order_relaxed);
+    }
+    head.store(0, std::memory_order_release);
+}
+
+void SensorBus::publish(const SensorRecord &rec)
+{
+    uint32_t words[WORDS] = {0};
+    memcpy(words, &rec, sizeof(rec));
+
+    // Single producer - no concurrent modification of head
+    uint32_t pos = head.load(std::memory_order_relaxed);
+    Slot &slot = slots[pos & SLOT_MASK];
+
+    slot.seq.store(pos * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t w = 0; w < WORDS; w++)
+        slot.data[w].store(words[w], std::memory_order_relaxed);
+    slot.seq.store(pos * 2 + 2, std::memory_order_release);
+
+    head.store(pos + 1, std::memory_order_release);
+}
+
+bool SensorBus::read(uint32_t pos, SensorRecord &rec) const
+{
+    const Slot &slot = slots[pos & SLOT_MASK];
+    const uint32_t seq = pos * 2 + 2;
+    uint32_t words[WORDS];
+
+    if (slot.seq.load(std::memory_order_acquire) != seq)
+        return false;
+    for (size_t w = 0; w < WORDS; w++)
+        words[w] = slot.data[w].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq)
+        return false;
+
+    memcpy(&rec, words, sizeof(rec));
+    return true;
+}
+
+
+SensorBusConsumer::SensorBusConsumer(const SensorBus &sensor_bus, BusOverflowPolicy overflow, bool oldest)
+    : bus(sensor_bus)
+{
+    policy = overflow;
+    numPending = 0;
+    received = 0;
+    dropped = 0;
+    coalesced = 0;
+
+    uint32_t head = bus.published();
+    if (!oldest)
+        cursor = head;
+    else
+        cursor = (head > SENSOR_BUS_SIZE) ? head - SENSOR_BUS_SIZE : 0;
+}
+
+bool SensorBusConsumer::next(SensorRecord &rec)
+{
+    while (true)
+    {
+        uint32_t head = bus.published();
+        if (head == cursor)
+            return false;
+
+        if (head - cursor > SENSOR_BUS_SIZE)
+        {
+            // Skip records which have already been overwritten
+            dropped += head - cursor - SENSOR_BUS_SIZE;
+            cursor = head - SENSOR_BUS_SIZE;
+        }
+
+        bool ok = bus.read(cursor, rec);
+        cursor++;
+        if (ok)
+            return true;
+
+        // Overwritten while reading - never wait for the producer
+        dropped++;
+    }
+}
+
+void SensorBusConsumer::coalesce(const SensorRecord &rec)
+{
+    for (uint8_t i = 0; i < numPending; i++)
+    {
+        if ((pending[i].sensor_id == rec.sensor_id) && (pending[i].kind == rec.kind))
+        {
+            pending[i] = rec;
+            coalesced++;
+            return;
+        }
+    }
+
+    if (numPending == SENSOR_BUS_COALESCE_SLOTS)
+    {
+        // Table full - drop oldest record
+        memmove(&pending[0], &pending[1], (numPending - 1) * sizeof(SensorRecord));
+        numPending--;
+        dropped++;
+    }
+    pending[numPending++] = rec;
+}
+
+bool SensorBusConsumer::poll(SensorRecord &rec)
+{
+    if (policy == BUS_DROP_OLDEST)
+    {
+        if (!next(rec))
+            return false;
+        received++;
+        return true;
+    }
+
+    // BUS_COALESCE: drain ring buffer, then provide oldest pending record
+    SensorRecord tmp;
+    while (next(tmp))
+        coalesce(tmp);
+
+    if (numPending == 0)
+        return false;
+
+    rec = pending[0];
+    numPending--;
+    memmove(&pending[0], &pending[1], numPending * sizeof(SensorRecord));
+    received++;
+    return true;
+}
@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorBus.h
+//
+// In-process publish/subscribe bus of decoded sensor data records
+//
+// A single producer (the receive path) publishes records into a ring buffer; any number of
+// consumers (e.g. MQTT, display, SD card logger, alarm logic) read the ring with their own
+// cursor and at their own pace. The producer never waits for consumers: a consumer which
+// falls behind by more than SENSOR_BUS_SIZE records loses records according to its
+// overflow policy (see BusOverflowPolicy). No memory is allocated.
+//
+// Each slot is protected by a sequence counter (seqlock): the producer marks the slot
+// as being written (odd counter), copies the record and marks it as complete (even counter).
+// A consumer copies the record and accepts it only if the counter has the expected value
+// before and after copying. Only atomic loads and stores are used (no read-modify-write
+// operations), so publishing is lock-free and wait-free on all targets.
+//
+// Threading: publish() must only be called from one task/thread at a time; each
+// SensorBusConsumer must only be used from one task/thread at a time.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250502 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SENSOR_BUS_H
+#define _SENSOR_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "SensorRecord.h"
+
+// Number of records in ring buffer (power of 2)
+#ifndef SENSOR_BUS_SIZE
+#define SENSOR_BUS_SIZE 16
+#endif
+
+// Number of sensors distinguished by a consumer with policy BUS_COALESCE
+#ifndef SENSOR_BUS_COALESCE_SLOTS
+#define SENSOR_BUS_COALESCE_SLOTS 8
+#endif
+
+#if (SENSOR_BUS_SIZE & (SENSOR_BUS_SIZE - 1)) != 0
+#error "SENSOR_BUS_SIZE must be a power of 2"
+#endif
+
+
+/*!
+ * \enum BusOverflowPolicy
+ *
+ * \brief Handling of records a consumer could not keep up with
+ */
+typedef enum BusOverflowPolicy {
+    BUS_DROP_OLDEST,    //!< all records in order; if behind by more than SENSOR_BUS_SIZE records, the oldest are lost
+    BUS_COALESCE        //!< only the latest pending record per sensor (sensor ID and record kind)
+} BusOverflowPolicy;
+
+
+/*!
+ * \class SensorBus
+ *
+ * \brief Ring buffer of decoded sensor data records (single producer, multiple consumers)
+ *
+ * Typical usage:
+ *
+ *     SensorBus bus;
+ *
+ *     // receive task
+ *     ws.getData(...);
+ *     for (size_t i = 0; i < ws.sensor.size(); i++) {
+ *         if (ws.sensor[i].valid) {
+ *             UdpSink::toRecord(ws.sensor[i], rec);
+ *             rec.timestamp = time(nullptr);
+ *             bus.publish(rec);
+ *         }
+ *     }
+ *
+ *     // display task
+ *     SensorBusConsumer display(bus, BUS_COALESCE);
+ *     while (display.poll(rec))
+ *         show(rec);
+ */
+class SensorBus {
+
+    friend class SensorBusConsumer;
+
+private:
+    static const size_t WORDS = (sizeof(SensorRecord) + 3) / 4;
+
+    typedef struct {
+        std::atomic<uint32_t> seq;          // 2 * position + 1: being written, 2 * position + 2: valid
+        std::atomic<uint32_t> data[WORDS];  // record
+    } Slot;
+
+    Slot slots[SENSOR_BUS_SIZE];
+    std::atomic<uint32_t> head;             // number of records published
+
+    /*
+     * Copy record at position pos
+     *
+     * Returns false if the record has been overwritten (or is being overwritten).
+     */
+    bool read(uint32_t pos, SensorRecord &rec) const;
+
+public:
+    /*!
+     * \brief Constructor
+     */
+    SensorBus(void);
+
+    /*!
+     * \brief Publish record
+     *
+     * Never blocks; the oldest record in the ring buffer is overwritten.
+     *
+     * \param rec      record
+     */
+    void publish(const SensorRecord &rec);
+
+    /*!
+     * \brief Get number of records published
+     */
+    uint32_t published(void) const {
+        return head.load(std::memory_order_acquire);
+    }
+};
+
+
+/*!
+ * \class SensorBusConsumer
+ *
+ * \brief Read cursor of a SensorBus consumer
+ */
+class SensorBusConsumer {
+
+private:
+    const SensorBus  &bus;
+    BusOverflowPolicy policy;
+    uint32_t          cursor;   // position of next record to be read
+
+    // BUS_COALESCE: latest record per sensor, in order of arrival
+    SensorRecord pending[SENSOR_BUS_COALESCE_SLOTS];
+    uint8_t      numPending;
+
+    bool next(SensorRecord &rec);
+    void coalesce(const SensorRecord &rec);
+
+public:
+    uint32_t received;      //!< number of records provided by poll()
+    uint32_t dropped;       //!< number of records lost (overwritten before being read, coalescing table full)
+    uint32_t coalesced;     //!< number of records replaced by a newer record of the same sensor (BUS_COALESCE)
+
+    /*!
+     * \brief Constructor
+     *
+     * \param sensor_bus    bus
+     * \param overflow      overflow policy
+     * \param oldest        true: start with oldest record in ring buffer, false: start with next record published
+     */
+    SensorBusConsumer(const SensorBus &sensor_bus, BusOverflowPolicy overflow = BUS_DROP_OLDEST, bool oldest = false);
+
+    /*!
+     * \brief Get next record
+     *
+     * \param rec      record
+     *
+     * \returns true if a record was provided
+     */
+    bool poll(SensorRecord &rec);
+
+    /*!
+     * \brief Get number of records published but not yet read from the ring buffer
+     *
+     * Records waiting in the coalescing table (BUS_COALESCE) are not included.
+     */
+    uint32_t lag(void) const {
+        return bus.published() - cursor;
+    }
+};
+
+#endif // _SENSOR_BUS_H
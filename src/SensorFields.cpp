@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorFields.cpp
+//
+// Compile-time field visitor for sensor data - JSON writer
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250501 Created
+// 20250507 Added putFloat() for SF_FMT_NUMBER
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "SensorFields.h"
+
+// Largest value (scaled by 10^decimals) formatted without snprintf()
+#define JSON_FAST_MAX   2147483647.0
+
+static const uint32_t decPow10[] = {1, 10, 100, 1000, 10000};
+
+
+SensorJsonWriter::SensorJsonWriter(char *buf, size_t size, bool complete, bool quoteFloats)
+    : buf(buf), size(size), complete(complete), quoteFloats(quoteFloats)
+{
+    begin();
+}
+
+void
+SensorJsonWriter::put(const char *str, size_t n)
+{
+    if (overflow)
+        return;
+
+    if (len + n >= size) {
+        // Keep the truncated string terminated
+        n = size - 1 - len;
+        overflow = true;
+    }
+    memcpy(&buf[len], str, n);
+    len += n;
+    buf[len] = '\0';
+}
+
+void
+SensorJsonWriter::putUInt(unsigned long value, uint8_t width)
+{
+    char tmp[20];
+    size_t n = 0;
+    do {
+        tmp[sizeof(tmp) - 1 - n++] = '0' + (value % 10);
+        value /= 10;
+    } while ((value != 0) || (n < width));
+    put(&tmp[sizeof(tmp) - n], n);
+}
+
+void
+SensorJsonWriter::begin(void)
+{
+    len = 0;
+    first = true;
+    overflow = (size == 0);
+    if (!overflow)
+        buf[0] = '\0';
+    put("{", 1);
+}
+
+size_t
+SensorJsonWriter::end(void)
+{
+    put("}", 1);
+    return len;
+}
+
+void
+SensorJsonWriter::key(const char *name)
+{
+    put(first ? "\"" : ",\"", first ? 1 : 2);
+    put(name, strlen(name));
+    put("\":", 2);
+    first = false;
+}
+
+void
+SensorJsonWriter::writeUInt(const char *name, unsigned long value)
+{
+    key(name);
+    putUInt(value);
+}
+
+void
+SensorJsonWriter::writeInt(const char *name, long value)
+{
+    key(name);
+    if (value < 0) {
+        put("-", 1);
+        putUInt(0UL - (unsigned long)value);
+    } else {
+        putUInt(value);
+    }
+}
+
+void
+SensorJsonWriter::writeFloat(const char *name, float value, uint8_t decimals)
+{
+    putFloat(name, value, decimals, quoteFloats);
+}
+
+// Same result as printf("%.<decimals>f") (round half to even of the exact binary value)
+void
+SensorJsonWriter::putFloat(const char *name, float value, uint8_t decimals, bool quoted)
+{
+    key(name);
+    if (quoted)
+        put("\"", 1);
+
+    double scaled = fabs((double)value) * decPow10[decimals < 4 ? decimals : 4];
+    if ((decimals > 4) || !(scaled < JSON_FAST_MAX)) {
+        // Large values, NaN and infinity
+        char tmp[48];
+        int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, value);
+        put(tmp, (n < 0) ? 0 : ((size_t)n < sizeof(tmp) ? n : sizeof(tmp) - 1));
+    } else {
+        // Exact for float values (24 bit mantissa * 10^4 < 2^53)
+        double fl = floor(scaled);
+        uint32_t q = (uint32_t)fl;
+        double frac = scaled - fl;
+        if ((frac > 0.5) || ((frac == 0.5) && (q & 1)))
+            q++;
+
+        if (signbit(value))
+            put("-", 1);
+        putUInt(q / decPow10[decimals]);
+        if (decimals) {
+            put(".", 1);
+            putUInt(q % decPow10[decimals], decimals);
+        }
+    }
+
+    if (quoted)
+        put("\"", 1);
+}
+
+void
+SensorJsonWriter::writeHex(const char *name, unsigned long value)
+{
+    static const char digits[] = "0123456789abcdef";
+    char tmp[2 * sizeof(unsigned long)];
+    size_t n = 0;
+    do {
+        tmp[sizeof(tmp) - 1 - n++] = digits[value & 0xf];
+        value >>= 4;
+    } while (value != 0);
+
+    key(name);
+    put("\"0x", 3);
+    put(&tmp[sizeof(tmp) - n], n);
+    put("\"", 1);
+}
+
+void
+SensorJsonWriter::writeString(const char *name, const char *value)
+{
+    key(name);
+    put("\"", 1);
+    put(value, strlen(value));
+    put("\"", 1);
+}
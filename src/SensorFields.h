@@ -0,0 +1,379 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorFields.h
+//
+// Compile-time field visitor for sensor data (WeatherSensor::Sensor)
+//
+// visitSensorFields() calls a visitor for each field of a sensor data slot which is
+// provided by the slot's sensor type - with a field descriptor (SensorField<ID>: ID, name,
+// unit, format, decimals, group), the value and its validity (xxx_ok / !xxx_init).
+// The descriptors are types, so a visitor with a template operator() is resolved and
+// inlined at compile time; there is no table lookup and no virtual call.
+//
+// Example:
+//
+//   struct Printer {
+//       template <typename F, typename T>
+//       void operator()(F, T value, bool valid) {
+//           if (valid)
+//               Serial.printf("%s: %s %s\n", F::name(), String(value).c_str(), F::unit());
+//       }
+//   } printer;
+//   visitSensorFields(weatherSensor.sensor[i], printer);
+//
+// SensorJsonWriter is a visitor which writes the fields as JSON object into a char buffer
+// (format as in BresserWeatherSensorMQTT's <base_topic>/<ID|Name>/data).
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250501 Created, moved SENSOR_TYPE_* from WeatherSensor.h
+// 20250507 Added SF_FMT_NUMBER; soil temp_c is not quoted (as before)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SENSOR_FIELDS_H
+#define _SENSOR_FIELDS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WeatherSensorCfg.h"
+
+// Sensor Types / Decoders / Part Numbers
+// 0 - Weather Station                  5-in-1; PN 7002510..12/7902510..12
+// 1 - Weather Station                  6-in-1; PN 7002585
+//   - Professional Wind Gauge          6-in-1; PN 7002531
+//   - Weather Station                  7-in-1; PN 7003300
+// 2 - Thermo-/Hygro-Sensor             6-in-1; PN 7009999
+// 3 - Pool / Spa Thermometer           6-in-1; PN 7000073
+// 4 - Soil Moisture Sensor             6-in-1; PN 7009972
+// 5 - Water Leakage Sensor             6-in-1; PN 7009975
+// 8 - Air Quality Sensor PM2.5/PM10    7-in-1; P/N 7009970
+// 9 - Professional Rain Gauge  (5-in-1 decoder)
+// 9 - Lightning Sensor                 PN 7009976
+// 10 - CO2 Sensor                      7-in-1; PN 7009977
+// 11 - HCHO/VCO Sensor                 7-in-1; PN 7009978
+// 13 - Weather Station (8-in-1)        7-in-1; PN 7003150
+#define SENSOR_TYPE_WEATHER0        0 // Weather Station
+#define SENSOR_TYPE_WEATHER1        1 // Weather Station
+#define SENSOR_TYPE_THERMO_HYGRO    2 // Thermo-/Hygro-Sensor
+#define SENSOR_TYPE_POOL_THERMO     3 // Pool / Spa Thermometer
+#define SENSOR_TYPE_SOIL            4 // Soil Temperature and Moisture (from 6-in-1 decoder)
+#define SENSOR_TYPE_LEAKAGE         5 // Water Leakage
+#define SENSOR_TYPE_AIR_PM          8 // Air Quality Sensor (Particle Matter)
+#define SENSOR_TYPE_RAIN            9 // Professional Rain Gauge (from 5-in-1 decoder)
+#define SENSOR_TYPE_LIGHTNING       9 // Lightning Sensor
+#define SENSOR_TYPE_CO2             10 // CO2 Sensor
+#define SENSOR_TYPE_HCHO_VOC        11 // Air Quality Sensor (HCHO and VOC)
+#define SENSOR_TYPE_WEATHER2        13 // Weather Station (8-in-1)
+
+
+/*!
+ * \enum SensorFieldId
+ *
+ * \brief Sensor data fields (in order of visiting)
+ */
+typedef enum SensorFieldId : uint8_t {
+    SF_SENSOR_ID,
+    SF_CHAN,
+    SF_BATTERY_OK,
+    SF_TEMP_C,
+    SF_HUMIDITY,
+    SF_WIND_GUST,
+    SF_WIND_AVG,
+    SF_WIND_DIR,
+    SF_UV,
+    SF_LIGHT_KLX,
+    SF_TGLOBE_C,
+    SF_RAIN,
+    SF_SOIL_TEMP_C,
+    SF_MOISTURE,
+    SF_LGT_COUNT,
+    SF_LGT_DISTANCE,
+    SF_LGT_UNKNOWN1,
+    SF_LGT_UNKNOWN2,
+    SF_LEAKAGE,
+    SF_PM_1_0,
+    SF_PM_2_5,
+    SF_PM_10,
+    SF_CO2,
+    SF_HCHO,
+    SF_VOC,
+    SF_NUM
+} SensorFieldId;
+
+/*!
+ * \enum SensorFieldFormat
+ *
+ * \brief Text representation of field values
+ */
+typedef enum SensorFieldFormat : uint8_t {
+    SF_FMT_UINT,        //!< unsigned integer (bool: 0/1)
+    SF_FMT_FLOAT,       //!< floating point with SensorField<ID>::decimals()
+    SF_FMT_NUMBER,      //!< floating point as SF_FMT_FLOAT, but never quoted
+    SF_FMT_HEX          //!< hexadecimal string, e.g. "0x1f"
+} SensorFieldFormat;
+
+/*!
+ * \enum SensorFieldGroup
+ *
+ * \brief Group of field
+ */
+typedef enum SensorFieldGroup : uint8_t {
+    SF_GROUP_HEADER,    //!< all sensor types
+    SF_GROUP_WEATHER,   //!< weather stations, thermo-/hygrometers, pool thermometers
+    SF_GROUP_SOIL,
+    SF_GROUP_LIGHTNING,
+    SF_GROUP_LEAKAGE,
+    SF_GROUP_AIR        //!< PM, CO2 and HCHO/VOC sensors
+} SensorFieldGroup;
+
+
+/*!
+ * \struct SensorField
+ *
+ * \brief Field descriptor (compile-time constants)
+ */
+template <SensorFieldId ID>
+struct SensorField;
+
+#define SENSOR_FIELD(ID, NAME, UNIT, FMT, DEC, GROUP)                                 \
+    template <>                                                                       \
+    struct SensorField<ID> {                                                          \
+        static constexpr SensorFieldId id(void) { return ID; }                        \
+        static constexpr const char *name(void) { return NAME; }                      \
+        static constexpr const char *unit(void) { return UNIT; }                      \
+        static constexpr SensorFieldFormat format(void) { return FMT; }               \
+        static constexpr uint8_t decimals(void) { return DEC; }                       \
+        static constexpr SensorFieldGroup group(void) { return GROUP; }               \
+    }
+
+//           ID               name (JSON key)           unit       format        dec group
+SENSOR_FIELD(SF_SENSOR_ID,    "id",                     "",        SF_FMT_UINT,  0, SF_GROUP_HEADER);
+SENSOR_FIELD(SF_CHAN,         "ch",                     "",        SF_FMT_UINT,  0, SF_GROUP_HEADER);
+SENSOR_FIELD(SF_BATTERY_OK,   "battery_ok",             "",        SF_FMT_UINT,  0, SF_GROUP_HEADER);
+SENSOR_FIELD(SF_TEMP_C,       "temp_c",                 "°C",      SF_FMT_FLOAT, 1, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_HUMIDITY,     "humidity",               "%",       SF_FMT_UINT,  0, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_WIND_GUST,    "wind_gust",              "m/s",     SF_FMT_FLOAT, 1, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_WIND_AVG,     "wind_avg",               "m/s",     SF_FMT_FLOAT, 1, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_WIND_DIR,     "wind_dir",               "°",       SF_FMT_FLOAT, 1, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_UV,           "uv",                     "",        SF_FMT_FLOAT, 1, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_LIGHT_KLX,    "light_klx",              "klx",     SF_FMT_FLOAT, 1, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_TGLOBE_C,     "t_globe_c",              "°C",      SF_FMT_FLOAT, 1, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_RAIN,         "rain",                   "mm",      SF_FMT_FLOAT, 1, SF_GROUP_WEATHER);
+SENSOR_FIELD(SF_SOIL_TEMP_C,  "temp_c",                 "°C",      SF_FMT_NUMBER,2, SF_GROUP_SOIL);
+SENSOR_FIELD(SF_MOISTURE,     "moisture",               "%",       SF_FMT_UINT,  0, SF_GROUP_SOIL);
+SENSOR_FIELD(SF_LGT_COUNT,    "lightning_count",        "",        SF_FMT_UINT,  0, SF_GROUP_LIGHTNING);
+SENSOR_FIELD(SF_LGT_DISTANCE, "lightning_distance_km",  "km",      SF_FMT_UINT,  0, SF_GROUP_LIGHTNING);
+SENSOR_FIELD(SF_LGT_UNKNOWN1, "lightning_unknown1",     "",        SF_FMT_HEX,   0, SF_GROUP_LIGHTNING);
+SENSOR_FIELD(SF_LGT_UNKNOWN2, "lightning_unknown2",     "",        SF_FMT_HEX,   0, SF_GROUP_LIGHTNING);
+SENSOR_FIELD(SF_LEAKAGE,      "leakage",                "",        SF_FMT_UINT,  0, SF_GROUP_LEAKAGE);
+SENSOR_FIELD(SF_PM_1_0,       "pm1_0_ug_m3",            "µg/m³",   SF_FMT_UINT,  0, SF_GROUP_AIR);
+SENSOR_FIELD(SF_PM_2_5,       "pm2_5_ug_m3",            "µg/m³",   SF_FMT_UINT,  0, SF_GROUP_AIR);
+SENSOR_FIELD(SF_PM_10,        "pm10_ug_m3",             "µg/m³",   SF_FMT_UINT,  0, SF_GROUP_AIR);
+SENSOR_FIELD(SF_CO2,          "co2_ppm",                "ppm",     SF_FMT_UINT,  0, SF_GROUP_AIR);
+SENSOR_FIELD(SF_HCHO,         "hcho_ppb",               "ppb",     SF_FMT_UINT,  0, SF_GROUP_AIR);
+SENSOR_FIELD(SF_VOC,          "voc",                    "",        SF_FMT_UINT,  0, SF_GROUP_AIR);
+
+#undef SENSOR_FIELD
+
+
+/*!
+ * \brief Visit the fields provided by the sensor type of a sensor data slot
+ *
+ * The visitor is called as v(SensorField<ID>(), value, valid) with the value's
+ * native type (bool, uint8_t, uint16_t, uint32_t or float). With lazy field decoding,
+ * sensor[] is up-to-date after getData(); within getMessage() (e.g. in a callback),
+ * pass the slot returned by WeatherSensor::fields().
+ *
+ * \param s     sensor data slot (WeatherSensor::Sensor)
+ * \param v     visitor
+ */
+template <typename S, typename V>
+inline void visitSensorFields(const S &s, V &v)
+{
+    v(SensorField<SF_SENSOR_ID>(), s.sensor_id, true);
+    v(SensorField<SF_CHAN>(), s.chan, true);
+    v(SensorField<SF_BATTERY_OK>(), s.battery_ok, true);
+
+    switch (s.s_type)
+    {
+    case SENSOR_TYPE_SOIL:
+        v(SensorField<SF_SOIL_TEMP_C>(), s.soil.temp_c, true);
+        v(SensorField<SF_MOISTURE>(), s.soil.moisture, true);
+        break;
+
+    case SENSOR_TYPE_LIGHTNING:
+        v(SensorField<SF_LGT_COUNT>(), s.lgt.strike_count, true);
+        v(SensorField<SF_LGT_DISTANCE>(), s.lgt.distance_km, true);
+        v(SensorField<SF_LGT_UNKNOWN1>(), s.lgt.unknown1, true);
+        v(SensorField<SF_LGT_UNKNOWN2>(), s.lgt.unknown2, true);
+        break;
+
+    case SENSOR_TYPE_LEAKAGE:
+        v(SensorField<SF_LEAKAGE>(), s.leak.alarm, true);
+        break;
+
+    case SENSOR_TYPE_AIR_PM:
+        v(SensorField<SF_PM_1_0>(), s.pm.pm_1_0, !s.pm.pm_1_0_init);
+        v(SensorField<SF_PM_2_5>(), s.pm.pm_2_5, !s.pm.pm_2_5_init);
+        v(SensorField<SF_PM_10>(), s.pm.pm_10, !s.pm.pm_10_init);
+        break;
+
+    case SENSOR_TYPE_CO2:
+        v(SensorField<SF_CO2>(), s.co2.co2_ppm, !s.co2.co2_init);
+        break;
+
+    case SENSOR_TYPE_HCHO_VOC:
+        v(SensorField<SF_HCHO>(), s.voc.hcho_ppb, !s.voc.hcho_init);
+        v(SensorField<SF_VOC>(), s.voc.voc_level, !s.voc.voc_init);
+        break;
+
+    case SENSOR_TYPE_WEATHER0:
+    case SENSOR_TYPE_WEATHER1:
+    case SENSOR_TYPE_WEATHER2:
+    case SENSOR_TYPE_THERMO_HYGRO:
+    case SENSOR_TYPE_POOL_THERMO:
+        v(SensorField<SF_TEMP_C>(), s.w.temp_c, s.w.temp_ok);
+        v(SensorField<SF_HUMIDITY>(), s.w.humidity, s.w.humidity_ok);
+#ifdef WIND_DATA_FLOATINGPOINT
+        v(SensorField<SF_WIND_GUST>(), s.w.wind_gust_meter_sec, s.w.wind_ok);
+        v(SensorField<SF_WIND_AVG>(), s.w.wind_avg_meter_sec, s.w.wind_ok);
+        v(SensorField<SF_WIND_DIR>(), s.w.wind_direction_deg, s.w.wind_ok);
+#else
+        v(SensorField<SF_WIND_GUST>(), s.w.wind_gust_meter_sec_fp1 / 10.0f, s.w.wind_ok);
+        v(SensorField<SF_WIND_AVG>(), s.w.wind_avg_meter_sec_fp1 / 10.0f, s.w.wind_ok);
+        v(SensorField<SF_WIND_DIR>(), s.w.wind_direction_deg_fp1 / 10.0f, s.w.wind_ok);
+#endif
+        v(SensorField<SF_UV>(), s.w.uv, s.w.uv_ok);
+        v(SensorField<SF_LIGHT_KLX>(), s.w.light_klx, s.w.light_ok);
+        if (s.s_type == SENSOR_TYPE_WEATHER2)
+            v(SensorField<SF_TGLOBE_C>(), s.w.tglobe_c, s.w.tglobe_ok);
+        v(SensorField<SF_RAIN>(), s.w.rain_mm, s.w.rain_ok);
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+/*!
+ * \class SensorJsonWriter
+ *
+ * \brief Visitor writing the valid fields as JSON object into a buffer
+ *
+ * {"id":<id>,"ch":<ch>,"battery_ok":<0|1>,"temp_c":21.5,...}
+ *
+ * Fields of SF_GROUP_WEATHER are also written if invalid with 'complete'.
+ * Further (e.g. derived) values can be added with the write*() methods.
+ * The output is truncated if the buffer is too small (see overflowed()).
+ */
+class SensorJsonWriter {
+protected:
+    char   *buf;
+    size_t  size;
+    size_t  len;
+    bool    first;
+    bool    overflow;
+    bool    complete;
+    bool    quoteFloats;
+
+    void put(const char *str, size_t n);
+    void putUInt(unsigned long value, uint8_t width = 1);
+    void putFloat(const char *name, float value, uint8_t decimals, bool quoted);
+    void key(const char *name);
+
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param buf           destination buffer
+     * \param size          size of destination buffer
+     * \param complete      write invalid weather fields, too
+     * \param quoteFloats   write floating point values as strings (e.g. "temp_c":"21.5")
+     */
+    SensorJsonWriter(char *buf, size_t size, bool complete = false, bool quoteFloats = false);
+
+    /*!
+     * \brief Start JSON object
+     */
+    void begin(void);
+
+    /*!
+     * \brief Terminate JSON object
+     *
+     * \returns length of JSON string
+     */
+    size_t end(void);
+
+    /*!
+     * \brief Get length of JSON string
+     */
+    size_t length(void) const {
+        return len;
+    }
+
+    /*!
+     * \brief Check if output was truncated
+     */
+    bool overflowed(void) const {
+        return overflow;
+    }
+
+    void writeUInt(const char *name, unsigned long value);              //!< "name":value
+    void writeInt(const char *name, long value);                        //!< "name":value
+    void writeFloat(const char *name, float value, uint8_t decimals);   //!< "name":value
+    void writeHex(const char *name, unsigned long value);               //!< "name":"0x<value>"
+    void writeString(const char *name, const char *value);              //!< "name":"value" (not escaped)
+
+    /*!
+     * \brief Field visitor (see visitSensorFields())
+     */
+    template <typename F, typename T>
+    void operator()(F, T value, bool valid)
+    {
+        if (!valid && !(complete && (F::group() == SF_GROUP_WEATHER)))
+            return;
+
+        if (F::format() == SF_FMT_FLOAT)
+            writeFloat(F::name(), value, F::decimals());
+        else if (F::format() == SF_FMT_NUMBER)
+            putFloat(F::name(), value, F::decimals(), false);
+        else if (F::format() == SF_FMT_HEX)
+            writeHex(F::name(), value);
+        else
+            writeUInt(F::name(), value);
+    }
+};
+
+#endif // _SENSOR_FIELDS_H
@@ -0,0 +1,346 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorIdentity.cpp
+//
+// Stable logical sensor identity across sensor ID changes
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250420 Created
+// 20250507 Learning after LOGICAL_ID_LEARN_MIN receptions, replacement of expired entries,
+//          remap restricted to sensors seen since begin() or configured; age saved (version 2)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "SensorIdentity.h"
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool contains(const uint32_t *list, size_t n, uint32_t id)
+{
+    for (size_t i = 0; list && (i < n); i++) {
+        if (list[i] == id)
+            return true;
+    }
+    return false;
+}
+
+SensorIdentity::SensorIdentity(void)
+{
+    clear();
+}
+
+void
+SensorIdentity::clear(void)
+{
+    memset(table, 0, sizeof(table));
+    evHead = 0;
+    evCount = 0;
+    remapCount = 0;
+    startTime = 0;
+    dirty = false;
+}
+
+void
+SensorIdentity::begin(uint32_t now)
+{
+    startTime = now;
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        table[i].seen = false;
+    }
+}
+
+uint32_t
+SensorIdentity::silence(const Entry &e, uint32_t now) const
+{
+    if (e.seen)
+        return now - e.lastSeen;
+
+    // Not received since begin() - add time without reception before begin()
+    uint64_t t = (uint64_t)(uint32_t)(now - startTime) + (uint64_t)e.age * 60000;
+    return (t > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)t;
+}
+
+int
+SensorIdentity::replaceable(uint32_t now) const
+{
+    int idx = -1;
+
+    // Least recently received candidate
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        const Entry &e = table[i];
+        if (learned(e))
+            continue;
+        if ((idx < 0) || (silence(e, now) > silence(table[idx], now)))
+            idx = i;
+    }
+    if (idx >= 0)
+        return idx;
+
+    // Learned sensor not received for the longest time, if expired
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        uint32_t t = silence(table[i], now);
+        if ((t >= LOGICAL_ID_EXPIRE) && ((idx < 0) || (t > silence(table[idx], now))))
+            idx = i;
+    }
+    return idx;
+}
+
+int
+SensorIdentity::find(uint32_t physical)
+{
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        if (table[i].logical && (table[i].physical == physical))
+            return i;
+    }
+    return -1;
+}
+
+uint32_t
+SensorIdentity::map(uint32_t id, uint8_t decoder, uint8_t s_type, uint8_t chan, bool startup, bool pinned, uint32_t now,
+                    const uint32_t *inc, size_t n_inc)
+{
+    int idx = find(id);
+    if (idx >= 0) {
+        table[idx].seen = true;
+        table[idx].lastSeen = now;
+        return table[idx].logical;
+    }
+
+    if (!startup || pinned)
+        return id;
+
+    // Exactly one silent logical sensor with same decoder, type and channel is required
+    int candidate = -1;
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        const Entry &e = table[i];
+        if (!learned(e) || (e.decoder != decoder) || (e.s_type != s_type) || (e.chan != chan))
+            continue;
+
+        // Silence measured while listening only
+        uint32_t t = e.seen ? (now - e.lastSeen) : (now - startTime);
+        if (t < LOGICAL_ID_SILENCE)
+            continue;
+
+        // Not received since begin() - the sensor may have disappeared long ago,
+        // unless it is configured explicitly
+        if (!e.seen && !contains(inc, n_inc, e.logical))
+            continue;
+
+        if (candidate >= 0)
+            return id; // ambiguous
+        candidate = i;
+    }
+
+    if (candidate < 0)
+        return id;
+
+    Entry &e = table[candidate];
+
+    // Record event (oldest event is overwritten if full)
+    uint8_t pos = (evHead + evCount) % LOGICAL_ID_EVENTS;
+    events[pos].logical_id = e.logical;
+    events[pos].old_id = e.physical;
+    events[pos].new_id = id;
+    events[pos].decoder = decoder;
+    events[pos].s_type = s_type;
+    events[pos].chan = chan;
+    if (evCount < LOGICAL_ID_EVENTS)
+        evCount++;
+    else
+        evHead = (evHead + 1) % LOGICAL_ID_EVENTS;
+    remapCount++;
+
+    e.physical = id;
+    e.seen = true;
+    e.lastSeen = now;
+    dirty = true;
+
+    return e.logical;
+}
+
+bool
+SensorIdentity::learn(uint32_t id, uint8_t decoder, uint8_t s_type, uint8_t chan, uint32_t now)
+{
+    if (id == 0)
+        return false;
+
+    // Known as logical ID (possibly with different physical ID)?
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        Entry &e = table[i];
+        if (e.logical != id)
+            continue;
+        if (learned(e))
+            return false;
+
+        // Candidate received again
+        e.seen = true;
+        e.lastSeen = now;
+        if (++e.hits < LOGICAL_ID_LEARN_MIN)
+            return false;
+        dirty = true;
+        return true;
+    }
+
+    int idx = -1;
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        if (!table[i].logical) {
+            idx = i;
+            break;
+        }
+    }
+    if (idx < 0) {
+        idx = replaceable(now);
+        if (idx < 0)
+            return false;
+        if (learned(table[idx]))
+            dirty = true;
+    }
+
+    Entry &e = table[idx];
+    e.logical = id;
+    e.physical = id;
+    e.decoder = decoder;
+    e.s_type = s_type;
+    e.chan = chan;
+    e.seen = true;
+    e.lastSeen = now;
+    e.age = 0;
+    e.hits = 1;
+    if (!learned(e))
+        return false;
+    dirty = true;
+    return true;
+}
+
+bool
+SensorIdentity::getRemap(IdRemap &ev)
+{
+    if (evCount == 0)
+        return false;
+
+    ev = events[evHead];
+    evHead = (evHead + 1) % LOGICAL_ID_EVENTS;
+    evCount--;
+    return true;
+}
+
+uint8_t
+SensorIdentity::count(void) const
+{
+    uint8_t n = 0;
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        if (learned(table[i]))
+            n++;
+    }
+    return n;
+}
+
+bool
+SensorIdentity::changed(void)
+{
+    bool res = dirty;
+    dirty = false;
+    return res;
+}
+
+size_t
+SensorIdentity::save(uint8_t *buf, size_t size, uint32_t now) const
+{
+    uint8_t n = count();
+    size_t len = 2 + n * LOGICAL_ID_ENTRY_SIZE;
+    if (size < len)
+        return 0;
+
+    buf[0] = LOGICAL_ID_VERSION;
+    buf[1] = n;
+    uint8_t *p = &buf[2];
+    for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+        const Entry &e = table[i];
+        if (!learned(e))
+            continue;
+        uint32_t age = silence(e, now) / 60000;
+        if (age > 0xFFFF)
+            age = 0xFFFF;
+        put32(&p[0], e.logical);
+        put32(&p[4], e.physical);
+        p[8] = e.decoder;
+        p[9] = e.s_type;
+        p[10] = e.chan;
+        p[11] = age & 0xFF;
+        p[12] = age >> 8;
+        p += LOGICAL_ID_ENTRY_SIZE;
+    }
+    return len;
+}
+
+bool
+SensorIdentity::load(const uint8_t *buf, size_t size)
+{
+    if (size < 2)
+        return false;
+
+    // Version 1: without age
+    size_t entrySize = (buf[0] == 1) ? LOGICAL_ID_ENTRY_SIZE_V1 : LOGICAL_ID_ENTRY_SIZE;
+    if (((buf[0] != 1) && (buf[0] != LOGICAL_ID_VERSION)) || (buf[1] > LOGICAL_IDS_MAX) ||
+        (size != (size_t)(2 + buf[1] * entrySize)))
+        return false;
+
+    memset(table, 0, sizeof(table));
+    const uint8_t *p = &buf[2];
+    for (int i = 0; i < buf[1]; i++) {
+        Entry &e = table[i];
+        e.logical = get32(&p[0]);
+        e.physical = get32(&p[4]);
+        e.decoder = p[8];
+        e.s_type = p[9];
+        e.chan = p[10];
+        e.age = (entrySize == LOGICAL_ID_ENTRY_SIZE) ? (p[11] | (p[12] << 8)) : 0;
+        e.hits = LOGICAL_ID_LEARN_MIN;
+        p += entrySize;
+    }
+    dirty = false;
+    return true;
+}
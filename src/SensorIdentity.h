@@ -0,0 +1,240 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorIdentity.h
+//
+// Stable logical sensor identity across sensor ID changes
+//
+// Bresser sensors select a new random ID after power-on/reset (e.g. battery change).
+// Without further measures, the new ID occupies a new slot, include lists do not
+// match anymore and the application's state (names, rain gauge history) is orphaned.
+//
+// This table maps the physical sensor IDs to logical IDs - the ID under which a sensor
+// was first seen - keyed by (decoder, sensor type, channel). A sensor is only added
+// after LOGICAL_ID_LEARN_MIN receptions; sensors heard only occasionally (e.g. passing
+// or distant neighbours' sensors) remain candidates, which are replaced first if the
+// table is full. Sensors not received for LOGICAL_ID_EXPIRE ms are replaced by new ones
+// if the table is full; the time since the last reception is saved with the table.
+//
+// A new physical ID is remapped to an existing logical sensor if
+// - the message has the startup flag set (i.e. the sensor has been reset recently),
+// - the new ID is not configured explicitly (include/exclude list),
+// - exactly one logical sensor with the same decoder, type and channel exists,
+// - that sensor has not been received for at least LOGICAL_ID_SILENCE ms
+//   of continuous reception, and
+// - that sensor has been received since begin() (i.e. it fell silent while listening)
+//   or its logical ID is in the include list. After a restart, a foreign sensor is thus
+//   not remapped onto an entry of a sensor which may have disappeared long ago.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250420 Created
+// 20250507 Learn sensors after repeated reception, replace expired entries,
+//          remap only sensors seen since begin() or configured; save age of entries
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SENSOR_IDENTITY_H
+#define _SENSOR_IDENTITY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WeatherSensorCfg.h"
+
+// Version of serialized table
+#define LOGICAL_ID_VERSION      2
+
+// Size of serialized table entry
+#define LOGICAL_ID_ENTRY_SIZE   13
+
+// Size of serialized table entry (version 1, without age)
+#define LOGICAL_ID_ENTRY_SIZE_V1 11
+
+// Size of serialized table (header: version, count)
+#define LOGICAL_ID_IMAGE_SIZE   (2 + LOGICAL_IDS_MAX * LOGICAL_ID_ENTRY_SIZE)
+
+
+/*!
+ * \struct IdRemap
+ *
+ * \brief Remap event - a new physical ID has been assigned to a logical sensor
+ */
+typedef struct IdRemap {
+    uint32_t logical_id;    //!< logical sensor ID (as reported in sensor data)
+    uint32_t old_id;        //!< previous physical ID
+    uint32_t new_id;        //!< new physical ID
+    uint8_t  decoder;       //!< decoder (DECODER_*)
+    uint8_t  s_type;        //!< sensor type
+    uint8_t  chan;          //!< channel
+} IdRemap;
+
+
+/*!
+ * \class SensorIdentity
+ *
+ * \brief Mapping of physical sensor IDs to stable logical IDs
+ */
+class SensorIdentity {
+
+private:
+    typedef struct {
+        uint32_t logical;   // logical ID (0: entry unused)
+        uint32_t physical;  // current physical ID
+        uint8_t  decoder;
+        uint8_t  s_type;
+        uint8_t  chan;
+        bool     seen;      // received since begin()
+        uint32_t lastSeen;  // time of last reception [ms] (valid if seen)
+        uint16_t age;       // time without reception before begin() [min] (if !seen)
+        uint8_t  hits;      // number of receptions (< LOGICAL_ID_LEARN_MIN: candidate)
+    } Entry;
+
+    Entry    table[LOGICAL_IDS_MAX];
+    IdRemap  events[LOGICAL_ID_EVENTS];
+    uint8_t  evHead;
+    uint8_t  evCount;
+    uint32_t remapCount;
+    uint32_t startTime;
+    bool     dirty;
+
+    int find(uint32_t physical);
+    bool learned(const Entry &e) const {
+        return e.logical && (e.hits >= LOGICAL_ID_LEARN_MIN);
+    }
+    uint32_t silence(const Entry &e, uint32_t now) const;
+    int replaceable(uint32_t now) const;
+
+public:
+    /*!
+     * \brief Constructor
+     */
+    SensorIdentity(void);
+
+    /*!
+     * \brief Clear table and events
+     */
+    void clear(void);
+
+    /*!
+     * \brief Start of reception - reference for silence period
+     *
+     * \param now   current time [ms]
+     */
+    void begin(uint32_t now);
+
+    /*!
+     * \brief Map physical ID to logical ID
+     *
+     * Remaps the ID to an existing logical sensor if the conditions described above are met.
+     *
+     * \param id        physical ID from message
+     * \param decoder   decoder (DECODER_*)
+     * \param s_type    sensor type
+     * \param chan      channel
+     * \param startup   startup flag from message
+     * \param pinned    ID is configured explicitly (include/exclude list) - never remapped
+     * \param now       current time [ms]
+     * \param inc       include list - logical sensors which may be remapped even if
+     *                  not received since begin()
+     * \param n_inc     number of entries in include list
+     *
+     * \returns logical ID (physical ID if unknown)
+     */
+    uint32_t map(uint32_t id, uint8_t decoder, uint8_t s_type, uint8_t chan, bool startup, bool pinned, uint32_t now,
+                 const uint32_t *inc = nullptr, size_t n_inc = 0);
+
+    /*!
+     * \brief Count reception of sensor; add sensor to table after LOGICAL_ID_LEARN_MIN receptions
+     *
+     * Call after the sensor has been accepted (i.e. a slot has been assigned).
+     * If the table is full, the least recently received candidate or else the sensor
+     * not received for the longest time (at least LOGICAL_ID_EXPIRE ms) is replaced;
+     * otherwise, the sensor is not added.
+     *
+     * \param id        logical ID returned by map()
+     * \param decoder   decoder (DECODER_*)
+     * \param s_type    sensor type
+     * \param chan      channel
+     * \param now       current time [ms]
+     *
+     * \returns true if the sensor has been added to the table by this call
+     */
+    bool learn(uint32_t id, uint8_t decoder, uint8_t s_type, uint8_t chan, uint32_t now);
+
+    /*!
+     * \brief Get (and remove) oldest remap event
+     *
+     * \param ev    remap event
+     *
+     * \returns true if an event was available
+     */
+    bool getRemap(IdRemap &ev);
+
+    /*!
+     * \brief Get total number of remap events
+     */
+    uint32_t remaps(void) const {
+        return remapCount;
+    }
+
+    /*!
+     * \brief Get number of table entries (learned sensors, without candidates)
+     */
+    uint8_t count(void) const;
+
+    /*!
+     * \brief Check if the table has changed since last call (e.g. to persist it)
+     */
+    bool changed(void);
+
+    /*!
+     * \brief Serialize table (learned sensors with time since last reception)
+     *
+     * \param buf   destination buffer (LOGICAL_ID_IMAGE_SIZE bytes)
+     * \param size  size of buffer
+     * \param now   current time [ms]
+     *
+     * \returns number of bytes written, or 0 if buffer too small
+     */
+    size_t save(uint8_t *buf, size_t size, uint32_t now) const;
+
+    /*!
+     * \brief Restore table from serialized data (version 1 or 2)
+     *
+     * \param buf   data
+     * \param size  size of data
+     *
+     * \returns true if valid
+     */
+    bool load(const uint8_t *buf, size_t size);
+};
+#endif // _SENSOR_IDENTITY_H
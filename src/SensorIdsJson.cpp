@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorIdsJson.cpp
+//
+// Allocation-free JSON conversion of sensor ID include/exclude lists
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250422 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SensorIdsJson.h"
+
+size_t sensorIdsToJson(const uint32_t *ids, size_t n, char *buf, size_t size)
+{
+    if (size < SENSOR_IDS_JSON_SIZE(n))
+    {
+        if (size)
+            buf[0] = '\0';
+        return 0;
+    }
+
+    char *p = buf;
+    p += sprintf(p, "{\"ids\":[");
+    for (size_t i = 0; i < n; i++)
+    {
+        p += sprintf(p, "%s\"0x%08x\"", i ? "," : "", (unsigned int)ids[i]);
+    }
+    p += sprintf(p, "]}");
+    return p - buf;
+}
+
+size_t sensorIdsFromJson(const char *json, uint8_t *buf, size_t max_ids)
+{
+    const char *p = strstr(json, "\"ids\"");
+    if (!p)
+        return 0;
+    p = strchr(p, '[');
+    if (!p)
+        return 0;
+
+    size_t n = 0;
+    for (p++; *p && (*p != ']') && (n < max_ids); p++)
+    {
+        if (*p != '"')
+            continue;
+
+        // String element
+        const char *end = strchr(p + 1, '"');
+        if (!end)
+            break;
+        char *parsed;
+        uint32_t id = strtoul(p + 1, &parsed, 16);
+        if ((parsed > p + 1) && (parsed == end))
+        {
+            *buf++ = (id >> 24) & 0xFF;
+            *buf++ = (id >> 16) & 0xFF;
+            *buf++ = (id >> 8) & 0xFF;
+            *buf++ = id & 0xFF;
+            n++;
+        }
+        p = end;
+    }
+    return n * 4;
+}
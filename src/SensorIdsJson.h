@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorIdsJson.h
+//
+// Allocation-free JSON conversion of sensor ID include/exclude lists
+//
+// Format (compatible with WeatherSensor::getSensorsIncJson() etc. using ArduinoJson):
+//
+//     {"ids":["0x39582376","0x83750871"]}
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250422 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SENSOR_IDS_JSON_H
+#define _SENSOR_IDS_JSON_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Size of JSON string for n sensor IDs (incl. terminating null character)
+#define SENSOR_IDS_JSON_SIZE(n) (11 + (n) * 13)
+
+/*!
+ * \brief Convert sensor IDs to JSON string
+ *
+ * \param ids     sensor IDs
+ * \param n       number of sensor IDs
+ * \param buf     destination buffer
+ * \param size    size of destination buffer (see SENSOR_IDS_JSON_SIZE())
+ *
+ * \returns length of JSON string, 0 if buffer is too small
+ */
+size_t sensorIdsToJson(const uint32_t *ids, size_t n, char *buf, size_t size);
+
+/*!
+ * \brief Convert JSON string to sensor IDs as byte array (big endian, 4 bytes per ID)
+ *
+ * Elements which are not hexadecimal strings are skipped.
+ *
+ * \param json    JSON string
+ * \param buf     destination buffer (max_ids * 4 bytes)
+ * \param max_ids maximum number of sensor IDs
+ *
+ * \returns number of bytes written
+ */
+size_t sensorIdsFromJson(const char *json, uint8_t *buf, size_t max_ids);
+
+#endif // _SENSOR_IDS_JSON_H
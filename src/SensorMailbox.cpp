@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorMailbox.cpp
+//
+// Latest-value-wins mailbox of decoded sensor data records (one entry per sensor)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250503 Created
+// 20250508 Dirty state derived from sequence counters (no atomic read-modify-write)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "SensorMailbox.h"
+
+SensorMailbox::SensorMailbox(void)
+{
+    clear();
+}
+
+void SensorMailbox::clear(void)
+{
+    for (size_t i = 0; i < SENSOR_MAILBOX_SLOTS; i++)
+    {
+        slots[i].seq.store(0, std::memory_order_relaxed);
+        for (size_t w = 0; w < WORDS; w++)
+            slots[i].data[w].store(0, std::memory_order_relaxed);
+        keyId[i] = 0;
+        keyKind[i] = 0;
+        lastPosts[i] = 0;
+        overwritten[i] = 0;
+    }
+    keyUsed = 0;
+    taking = 0;
+    posted = 0;
+    rejected = 0;
+    taken = 0;
+}
+
+int SensorMailbox::lookup(uint32_t sensor_id, uint8_t kind)
+{
+    // Fibonacci hashing of sensor ID and kind, linear probing
+    uint32_t h = (sensor_id ^ ((uint32_t)kind << 24)) * 2654435761UL;
+    unsigned idx = (h >> 16) % SENSOR_MAILBOX_SLOTS;
+
+    for (unsigned n = 0; n < SENSOR_MAILBOX_SLOTS; n++)
+    {
+        if (!(keyUsed & (1UL << idx)))
+        {
+            // Sensor not found - assign free entry
+            keyUsed |= 1UL << idx;
+            keyId[idx] = sensor_id;
+            keyKind[idx] = kind;
+            return idx;
+        }
+        if ((keyId[idx] == sensor_id) && (keyKind[idx] == kind))
+            return idx;
+        idx = (idx + 1) % SENSOR_MAILBOX_SLOTS;
+    }
+    return -1;
+}
+
+bool SensorMailbox::post(const SensorRecord &rec)
+{
+    int idx = lookup(rec.sensor_id, rec.kind);
+    if (idx < 0)
+    {
+        rejected++;
+        return false;
+    }
+
+    uint32_t words[WORDS] = {0};
+    memcpy(words, &rec, sizeof(rec));
+
+    // Single producer - no concurrent modification of seq
+    Slot &slot = slots[idx];
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t w = 0; w < WORDS; w++)
+        slot.data[w].store(words[w], std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+
+    posted++;
+    return true;
+}
+
+uint32_t SensorMailbox::pending(void) const
+{
+    uint32_t mask = 0;
+
+    // Entry updated since taken last (or being written)
+    for (size_t i = 0; i < SENSOR_MAILBOX_SLOTS; i++)
+    {
+        if (slots[i].seq.load(std::memory_order_acquire) != lastPosts[i] * 2)
+            mask |= 1UL << i;
+    }
+    return mask;
+}
+
+bool SensorMailbox::take(SensorRecord &rec, uint8_t *slot)
+{
+    uint32_t words[WORDS];
+    bool snapshot = false;
+
+    while (true)
+    {
+        // At most one new snapshot per call - never spin while the producer is writing
+        if (taking == 0)
+        {
+            if (snapshot)
+                return false;
+            taking = pending();
+            snapshot = true;
+            if (taking == 0)
+                return false;
+        }
+        unsigned idx = __builtin_ctz(taking);
+        taking &= taking - 1;
+
+        // Entry being written or overwritten while reading: skip,
+        // it is still dirty and will be taken by a later call
+        const Slot &s = slots[idx];
+        uint32_t seq = s.seq.load(std::memory_order_acquire);
+        if (seq & 1)
+            continue;
+        for (size_t w = 0; w < WORDS; w++)
+            words[w] = s.data[w].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.seq.load(std::memory_order_relaxed) != seq)
+            continue;
+
+        // Latest record has already been taken
+        uint32_t posts = seq / 2;
+        if (posts == lastPosts[idx])
+            continue;
+
+        overwritten[idx] += posts - lastPosts[idx] - 1;
+        lastPosts[idx] = posts;
+        taken++;
+        memcpy(&rec, words, sizeof(rec));
+        if (slot)
+            *slot = idx;
+        return true;
+    }
+}
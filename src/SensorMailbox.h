@@ -0,0 +1,186 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorMailbox.h
+//
+// Latest-value-wins mailbox of decoded sensor data records (one entry per sensor)
+//
+// Decouples reception from publishing if publishing is slower than reception (e.g. MQTT
+// via a flaky WiFi link): each record overwrites the pending entry of its sensor, the
+// publisher only takes the entries which have been updated since they were taken last. Instead of a growing backlog, the publisher gets the latest value of
+// each sensor; the number of values overwritten before being taken is counted per sensor.
+//
+// Sensors (sensor ID and record kind) are assigned to SENSOR_MAILBOX_SLOTS entries
+// via a hash table with linear probing, i.e. posting a record is O(1) (expected).
+// No memory is allocated.
+//
+// Each entry is protected by a sequence counter (seqlock, see SensorBus.h). An entry is
+// dirty if its counter differs from the value seen by the consumer when it was taken last,
+// i.e. there is no shared dirty bitmap. Only atomic loads and stores are used (no
+// read-modify-write operations), so the mailbox also works on targets without atomic
+// read-modify-write support. Posting never waits for the consumer.
+//
+// Threading: post() must only be called from one task/thread at a time; take(), pending()
+// and overwrites() must only be called from one task/thread at a time.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250503 Created
+// 20250508 Dirty state derived from sequence counters (no atomic read-modify-write)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SENSOR_MAILBOX_H
+#define _SENSOR_MAILBOX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "SensorRecord.h"
+
+// Number of entries (sensors), max. 32
+#ifndef SENSOR_MAILBOX_SLOTS
+#define SENSOR_MAILBOX_SLOTS 16
+#endif
+
+#if (SENSOR_MAILBOX_SLOTS < 1) || (SENSOR_MAILBOX_SLOTS > 32)
+#error "SENSOR_MAILBOX_SLOTS must be in the range 1...32"
+#endif
+
+
+/*!
+ * \class SensorMailbox
+ *
+ * \brief Latest record per sensor (single producer, single consumer)
+ *
+ * Typical usage:
+ *
+ *     SensorMailbox mailbox;
+ *
+ *     // receive task
+ *     ws.getData(...);
+ *     for (size_t i = 0; i < ws.sensor.size(); i++) {
+ *         if (ws.sensor[i].valid) {
+ *             UdpSink::toRecord(ws.sensor[i], rec);
+ *             mailbox.post(rec);
+ *         }
+ *     }
+ *
+ *     // publishing task
+ *     uint8_t slot;
+ *     while (mailbox.take(rec, &slot))
+ *         publish(rec, mailbox.overwrites(slot));
+ */
+class SensorMailbox {
+
+private:
+    static const size_t WORDS = (sizeof(SensorRecord) + 3) / 4;
+
+    typedef struct {
+        std::atomic<uint32_t> seq;          // 2 * number of posts (+1 while being written)
+        std::atomic<uint32_t> data[WORDS];  // record
+    } Slot;
+
+    Slot slots[SENSOR_MAILBOX_SLOTS];
+
+    // Producer: assignment of sensors to entries
+    uint32_t keyId[SENSOR_MAILBOX_SLOTS];
+    uint8_t  keyKind[SENSOR_MAILBOX_SLOTS];
+    uint32_t keyUsed;
+
+    // Consumer
+    uint32_t taking;                        // dirty entries (snapshot) not yet taken
+    uint32_t lastPosts[SENSOR_MAILBOX_SLOTS];   // number of posts when taken last
+    uint32_t overwritten[SENSOR_MAILBOX_SLOTS];
+
+    int lookup(uint32_t sensor_id, uint8_t kind);
+
+public:
+    uint32_t posted;        //!< number of records posted (producer)
+    uint32_t rejected;      //!< number of records rejected, all entries assigned to other sensors (producer)
+    uint32_t taken;         //!< number of records taken (consumer)
+
+    /*!
+     * \brief Constructor
+     */
+    SensorMailbox(void);
+
+    /*!
+     * \brief Remove all entries and reset statistics
+     *
+     * Must not be called concurrently with post() or take().
+     */
+    void clear(void);
+
+    /*!
+     * \brief Post record, overwriting the pending record of the same sensor
+     *
+     * \param rec      record
+     *
+     * \returns false if no entry is available for the sensor
+     */
+    bool post(const SensorRecord &rec);
+
+    /*!
+     * \brief Get dirty bitmap (bit n: entry n has been updated since taken last)
+     *
+     * Consumer only. An entry being written is included.
+     */
+    uint32_t pending(void) const;
+
+    /*!
+     * \brief Take next updated record
+     *
+     * Entries being written while reading are skipped (never waits for the producer)
+     * and are taken by a later call.
+     *
+     * \param rec      record
+     * \param slot     entry index (optional)
+     *
+     * \returns true if a record was provided
+     */
+    bool take(SensorRecord &rec, uint8_t *slot = nullptr);
+
+    /*!
+     * \brief Get number of records of an entry overwritten before being taken
+     *
+     * Updated by take(), i.e. the count includes the records overwritten before the
+     * latest record taken from this entry.
+     *
+     * \param slot     entry index
+     */
+    uint32_t overwrites(uint8_t slot) const {
+        return (slot < SENSOR_MAILBOX_SLOTS) ? overwritten[slot] : 0;
+    }
+};
+
+#endif // _SENSOR_MAILBOX_H
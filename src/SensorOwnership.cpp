@@ -0,0 +1,310 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorOwnership.cpp
+//
+// Decentralized election of one receiver (owner) per sensor among several receivers
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250425 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "SensorOwnership.h"
+
+// Weight of new sample in RSSI moving average
+#define RSSI_ALPHA 0.25f
+
+// Entry flags
+#define ENTRY_OWNED 0x01
+
+static inline void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// RSSI with resolution of 0.1 dB (as transferred)
+static inline int16_t rssiFp1(float rssi)
+{
+    return (int16_t)(rssi * 10.0f + ((rssi < 0) ? -0.5f : 0.5f));
+}
+
+SensorOwnership::SensorOwnership(uint32_t receiver_id)
+{
+    begin(receiver_id);
+}
+
+void
+SensorOwnership::begin(uint32_t receiver_id)
+{
+    self = receiver_id;
+    memset(local, 0, sizeof(local));
+    memset(peers, 0, sizeof(peers));
+    lastAnnounce = 0;
+    changes = 0;
+    invalid = 0;
+}
+
+SensorOwnership::Local *
+SensorOwnership::findLocal(uint32_t sensor_id)
+{
+    for (int i = 0; i < OWNER_MAX_SENSORS; i++) {
+        if (local[i].sensorId == sensor_id)
+            return &local[i];
+    }
+    return nullptr;
+}
+
+int
+SensorOwnership::peerEntry(const Peer &peer, uint32_t sensor_id) const
+{
+    for (int i = 0; i < peer.num; i++) {
+        if (peer.sensorId[i] == sensor_id)
+            return i;
+    }
+    return -1;
+}
+
+void
+SensorOwnership::expire(uint32_t now)
+{
+    for (int i = 0; i < OWNER_MAX_SENSORS; i++) {
+        if (local[i].sensorId && (now - local[i].lastSeen > OWNER_TIMEOUT_MS))
+            memset(&local[i], 0, sizeof(Local));
+    }
+    for (int i = 0; i < OWNER_MAX_PEERS; i++) {
+        if (peers[i].receiverId && (now - peers[i].lastSeen > OWNER_TIMEOUT_MS))
+            memset(&peers[i], 0, sizeof(Peer));
+    }
+}
+
+void
+SensorOwnership::update(uint32_t sensor_id, float rssi, uint32_t now)
+{
+    Local *l = findLocal(sensor_id);
+    if (l) {
+        l->rssi += RSSI_ALPHA * (rssi - l->rssi);
+        l->lastSeen = now;
+        return;
+    }
+
+    // New sensor - use free entry or replace least recently seen one
+    l = &local[0];
+    for (int i = 0; i < OWNER_MAX_SENSORS; i++) {
+        if (local[i].sensorId == 0) {
+            l = &local[i];
+            break;
+        }
+        if (now - local[i].lastSeen > now - l->lastSeen)
+            l = &local[i];
+    }
+    memset(l, 0, sizeof(Local));
+    l->sensorId = sensor_id;
+    l->rssi = rssi;
+    l->lastSeen = now;
+}
+
+bool
+SensorOwnership::announceDue(uint32_t now) const
+{
+    return (lastAnnounce == 0) || (now - lastAnnounce >= OWNER_ANNOUNCE_MS);
+}
+
+size_t
+SensorOwnership::announce(uint8_t *buf, size_t size, uint32_t now)
+{
+    expire(now);
+
+    uint8_t n = 0;
+    for (int i = 0; i < OWNER_MAX_SENSORS; i++) {
+        if (local[i].sensorId)
+            n++;
+    }
+    size_t len = OWNER_HDR_SIZE + n * OWNER_ENTRY_SIZE;
+    if (size < len)
+        return 0;
+
+    buf[0] = 'B';
+    buf[1] = 'O';
+    buf[2] = OWNER_VERSION;
+    buf[3] = n;
+    put32(&buf[4], self);
+    uint8_t *p = &buf[OWNER_HDR_SIZE];
+    for (int i = 0; i < OWNER_MAX_SENSORS; i++) {
+        Local &l = local[i];
+        if (!l.sensorId)
+            continue;
+        int16_t rssi = rssiFp1(l.rssi);
+        l.announced = rssi / 10.0f;
+        l.hasAnnounced = true;
+        put32(&p[0], l.sensorId);
+        p[4] = rssi & 0xFF;
+        p[5] = (rssi >> 8) & 0xFF;
+        p[6] = (elect(l, now) == self) ? ENTRY_OWNED : 0;
+        p += OWNER_ENTRY_SIZE;
+    }
+    lastAnnounce = now ? now : 1;
+    return len;
+}
+
+bool
+SensorOwnership::receive(const uint8_t *buf, size_t size, uint32_t now)
+{
+    if ((size < OWNER_HDR_SIZE) || (buf[0] != 'B') || (buf[1] != 'O') || (buf[2] != OWNER_VERSION) ||
+        (buf[3] > OWNER_MAX_SENSORS) || (size != (size_t)(OWNER_HDR_SIZE + buf[3] * OWNER_ENTRY_SIZE))) {
+        invalid++;
+        return false;
+    }
+
+    uint32_t id = get32(&buf[4]);
+    if ((id == 0) || (id == self))
+        return id != 0;
+
+    expire(now);
+
+    // Find peer - use free entry or replace least recently seen one
+    Peer *peer = nullptr;
+    for (int i = 0; i < OWNER_MAX_PEERS; i++) {
+        if (peers[i].receiverId == id) {
+            peer = &peers[i];
+            break;
+        }
+    }
+    if (!peer) {
+        peer = &peers[0];
+        for (int i = 0; i < OWNER_MAX_PEERS; i++) {
+            if (peers[i].receiverId == 0) {
+                peer = &peers[i];
+                break;
+            }
+            if (now - peers[i].lastSeen > now - peer->lastSeen)
+                peer = &peers[i];
+        }
+    }
+
+    peer->receiverId = id;
+    peer->lastSeen = now;
+    peer->num = buf[3];
+    const uint8_t *p = &buf[OWNER_HDR_SIZE];
+    for (int i = 0; i < peer->num; i++) {
+        peer->sensorId[i] = get32(&p[0]);
+        peer->rssi[i] = (int16_t)(p[4] | (p[5] << 8)) / 10.0f;
+        peer->claim[i] = p[6] & ENTRY_OWNED;
+        p += OWNER_ENTRY_SIZE;
+
+        // Adopt claimed owner if none is known; resolve conflicting claims
+        Local *l = findLocal(peer->sensorId[i]);
+        if (l && peer->claim[i]) {
+            if (l->owner == 0)
+                l->owner = id;
+            else if (l->owner != id)
+                l->owner = 0;
+        }
+    }
+    return true;
+}
+
+uint32_t
+SensorOwnership::elect(Local &l, uint32_t now)
+{
+    // Best candidate (ties: lowest receiver ID) and RSSI of current owner
+    uint32_t best = self;
+    float bestRssi = l.hasAnnounced ? l.announced : l.rssi;
+    bool ownerValid = (l.owner == self);
+    float ownerRssi = bestRssi;
+
+    for (int i = 0; i < OWNER_MAX_PEERS; i++) {
+        const Peer &peer = peers[i];
+        if (!peer.receiverId || (now - peer.lastSeen > OWNER_TIMEOUT_MS))
+            continue;
+        int idx = peerEntry(peer, l.sensorId);
+        if (idx < 0)
+            continue;
+        float rssi = peer.rssi[idx];
+        if ((rssi > bestRssi) || ((rssi == bestRssi) && (peer.receiverId < best))) {
+            best = peer.receiverId;
+            bestRssi = rssi;
+        }
+        if (peer.receiverId == l.owner) {
+            ownerValid = true;
+            ownerRssi = rssi;
+        }
+    }
+
+    // Hysteresis
+    if (ownerValid && !(bestRssi > ownerRssi + OWNER_HYSTERESIS_DB))
+        return l.owner;
+
+    if (l.owner && (l.owner != best))
+        changes++;
+    l.owner = best;
+    return best;
+}
+
+uint32_t
+SensorOwnership::owner(uint32_t sensor_id, uint32_t now)
+{
+    Local *l = findLocal(sensor_id);
+    if (!l)
+        return 0;
+    return elect(*l, now);
+}
+
+bool
+SensorOwnership::owns(uint32_t sensor_id, uint32_t now)
+{
+    Local *l = findLocal(sensor_id);
+    if (!l)
+        return true;
+    return elect(*l, now) == self;
+}
+
+uint8_t
+SensorOwnership::numPeers(void) const
+{
+    uint8_t n = 0;
+    for (int i = 0; i < OWNER_MAX_PEERS; i++) {
+        if (peers[i].receiverId)
+            n++;
+    }
+    return n;
+}
@@ -0,0 +1,252 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorOwnership.h
+//
+// Decentralized election of one receiver (owner) per sensor among several receivers
+//
+// Each receiver maintains an RSSI summary (moving average) of the sensors it receives
+// and periodically announces it via UDP multicast (see OwnershipUdp.h). From its own
+// and the peers' announcements, each receiver elects the owner of each sensor ID:
+// - the receiver with the best announced RSSI (ties: lowest receiver ID),
+// - the current owner is only replaced if another receiver's RSSI is better by
+//   OWNER_HYSTERESIS_DB or if the owner's announcement has expired (OWNER_TIMEOUT_MS).
+// The receiver's own summary is taken into account as announced (not as measured since),
+// so all receivers evaluate the same data and elect the same owner. Each announcement
+// also flags the sensors owned by the sender; a receiver without an owner for a sensor
+// (e.g. after restart) adopts the flagged owner, and if two receivers claim the same
+// sensor, both re-elect without hysteresis.
+//
+// A receiver publishes a sensor only if it owns it (owns()), i.e. N receivers produce
+// roughly the publish load of a single receiver. Sensors not announced by any peer are
+// owned by the receiver.
+//
+// Announcement format (little endian):
+//   0..1   magic "BO"
+//   2      version
+//   3      number of entries n
+//   4..7   receiver ID
+//   8..    n * {sensor ID (4), RSSI in 0.1 dBm (int16), flags (1): bit 0 - owned by sender}
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250425 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SENSOR_OWNERSHIP_H
+#define _SENSOR_OWNERSHIP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define OWNER_VERSION 1
+
+// Maximum number of sensors per receiver
+#ifndef OWNER_MAX_SENSORS
+#define OWNER_MAX_SENSORS 16
+#endif
+
+// Maximum number of peers (other receivers)
+#ifndef OWNER_MAX_PEERS
+#define OWNER_MAX_PEERS 7
+#endif
+
+// Announcement interval [ms]
+#ifndef OWNER_ANNOUNCE_MS
+#define OWNER_ANNOUNCE_MS 30000
+#endif
+
+// Announcement/local reception timeout [ms]
+#ifndef OWNER_TIMEOUT_MS
+#define OWNER_TIMEOUT_MS (3 * OWNER_ANNOUNCE_MS)
+#endif
+
+// Hysteresis for change of owner [dB]
+#ifndef OWNER_HYSTERESIS_DB
+#define OWNER_HYSTERESIS_DB 3.0f
+#endif
+
+// Size of announcement header
+#define OWNER_HDR_SIZE 8
+
+// Size of announcement entry
+#define OWNER_ENTRY_SIZE 7
+
+// Maximum size of announcement
+#define OWNER_MSG_SIZE (OWNER_HDR_SIZE + OWNER_MAX_SENSORS * OWNER_ENTRY_SIZE)
+
+
+/*!
+ * \class SensorOwnership
+ *
+ * \brief Sensor ownership election based on announced RSSI summaries
+ *
+ * Typical usage:
+ *
+ *     SensorOwnership ownership(receiver_id);
+ *
+ *     // on reception of sensor data
+ *     ownership.update(sensor_id, rssi, millis());
+ *     if (ownership.owns(sensor_id, millis()))
+ *         publish(...);
+ *
+ *     // periodically
+ *     if (ownership.announceDue(millis()))
+ *         send(buf, ownership.announce(buf, sizeof(buf), millis()));
+ *
+ *     // on reception of announcement
+ *     ownership.receive(buf, len, millis());
+ */
+class SensorOwnership {
+
+private:
+    typedef struct {
+        uint32_t sensorId;      // 0: unused
+        float    rssi;          // moving average [dBm]
+        float    announced;     // RSSI as announced [dBm]
+        bool     hasAnnounced;  // announced is valid
+        uint32_t lastSeen;      // time of last reception [ms]
+        uint32_t owner;         // elected owner (0: none)
+    } Local;
+
+    typedef struct {
+        uint32_t receiverId;    // 0: unused
+        uint32_t lastSeen;      // time of last announcement [ms]
+        uint8_t  num;
+        uint32_t sensorId[OWNER_MAX_SENSORS];
+        float    rssi[OWNER_MAX_SENSORS];
+        bool     claim[OWNER_MAX_SENSORS];
+    } Peer;
+
+    uint32_t self;
+    Local    local[OWNER_MAX_SENSORS];
+    Peer     peers[OWNER_MAX_PEERS];
+    uint32_t lastAnnounce;
+
+    Local   *findLocal(uint32_t sensor_id);
+    int      peerEntry(const Peer &peer, uint32_t sensor_id) const;
+    void     expire(uint32_t now);
+    uint32_t elect(Local &l, uint32_t now);
+
+public:
+    uint32_t changes;       //!< number of owner changes
+    uint32_t invalid;       //!< number of invalid announcements
+
+    /*!
+     * \brief Constructor
+     *
+     * \param receiver_id  ID of this receiver (must be unique and != 0)
+     */
+    SensorOwnership(uint32_t receiver_id = 0);
+
+    /*!
+     * \brief Set receiver ID and clear all data
+     *
+     * \param receiver_id  ID of this receiver (must be unique and != 0)
+     */
+    void begin(uint32_t receiver_id);
+
+    /*!
+     * \brief Get receiver ID
+     */
+    uint32_t id(void) const {
+        return self;
+    }
+
+    /*!
+     * \brief Update RSSI summary with locally received message
+     *
+     * \param sensor_id    sensor ID
+     * \param rssi         RSSI [dBm]
+     * \param now          current time [ms]
+     */
+    void update(uint32_t sensor_id, float rssi, uint32_t now);
+
+    /*!
+     * \brief Check if announcement is due (OWNER_ANNOUNCE_MS)
+     *
+     * \param now          current time [ms]
+     */
+    bool announceDue(uint32_t now) const;
+
+    /*!
+     * \brief Encode announcement of local RSSI summary
+     *
+     * \param buf          destination buffer
+     * \param size         size of buffer (OWNER_MSG_SIZE is always sufficient)
+     * \param now          current time [ms]
+     *
+     * \returns size of announcement, 0 if buffer is too small
+     */
+    size_t announce(uint8_t *buf, size_t size, uint32_t now);
+
+    /*!
+     * \brief Process announcement from peer
+     *
+     * Own announcements (e.g. multicast loopback) are ignored.
+     *
+     * \param buf          announcement
+     * \param size         size of announcement
+     * \param now          current time [ms]
+     *
+     * \returns true if valid
+     */
+    bool receive(const uint8_t *buf, size_t size, uint32_t now);
+
+    /*!
+     * \brief Get owner of sensor
+     *
+     * \param sensor_id    sensor ID
+     * \param now          current time [ms]
+     *
+     * \returns receiver ID of owner, 0 if sensor is unknown
+     */
+    uint32_t owner(uint32_t sensor_id, uint32_t now);
+
+    /*!
+     * \brief Check if this receiver shall publish the sensor's data
+     *
+     * \param sensor_id    sensor ID
+     * \param now          current time [ms]
+     *
+     * \returns true if this receiver owns the sensor (or the sensor is unknown)
+     */
+    bool owns(uint32_t sensor_id, uint32_t now);
+
+    /*!
+     * \brief Get number of active peers
+     */
+    uint8_t numPeers(void) const;
+};
+
+#endif // _SENSOR_OWNERSHIP_H
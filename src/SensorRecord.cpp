@@ -0,0 +1,348 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorRecord.cpp
+//
+// Compact binary encoding of decoded sensor data records
+//
+// Used for distributing decoded sensor data to local consumers (see UdpSink.h);
+// the decoder is used by the host-side receiver (see extras/udp_receiver).
+//
+// Encoding/decoding is allocation-free and independent of the byte order
+// of the host (all multi-byte values are little-endian).
+//
+// Record layout (version 1):
+//
+//  Offset Size Content
+//   0     2    Magic (0x42, 0x57; "BW")
+//   2     1    Version (SENSOR_RECORD_VERSION)
+//   3     1    Kind (RECORD_KIND_*)
+//   4     4    Receiver ID
+//   8     4    Sequence number (per receiver, incremented for each record)
+//  12     4    Timestamp (application defined, e.g. UNIX time)
+//  16     4    Sensor ID
+//  20     2    RSSI (dBm * 10, signed)
+//  22     1    Sensor type
+//  23     1    Channel
+//  24     1    Decoder
+//  25     1    Flags (RECORD_FLAG_*)
+//  26     ...  Payload (depending on kind)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250418 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "SensorRecord.h"
+
+// Distance of sequence number behind expected value regarded as receiver restart
+#define SEQ_RESTART_THRESHOLD 1000
+
+static inline void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static inline void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, v & 0xffff);
+    put16(&p[2], v >> 16);
+}
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    return get16(p) | ((uint32_t)get16(&p[2]) << 16);
+}
+
+// Fixed point with one decimal, rounded and saturated
+static inline int16_t fp1s(float v)
+{
+    float x = v * 10.0f + ((v < 0) ? -0.5f : 0.5f);
+    if (x > INT16_MAX)
+        return INT16_MAX;
+    if (x < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t)x;
+}
+
+static inline uint16_t fp1u(float v)
+{
+    float x = v * 10.0f + 0.5f;
+    if (x < 0)
+        return 0;
+    if (x > UINT16_MAX)
+        return UINT16_MAX;
+    return (uint16_t)x;
+}
+
+static inline uint32_t fp1u32(float v)
+{
+    float x = v * 10.0f + 0.5f;
+    if (x < 0)
+        return 0;
+    return (uint32_t)x;
+}
+
+// Payload size per kind
+static size_t payloadSize(uint8_t kind)
+{
+    switch (kind)
+    {
+    case RECORD_KIND_NONE:
+        return 0;
+    case RECORD_KIND_WEATHER:
+        return 22;
+    case RECORD_KIND_SOIL:
+        return 3;
+    case RECORD_KIND_LIGHTNING:
+        return 7;
+    case RECORD_KIND_LEAKAGE:
+        return 1;
+    case RECORD_KIND_AIR_PM:
+        return 7;
+    case RECORD_KIND_CO2:
+        return 3;
+    case RECORD_KIND_HCHO_VOC:
+        return 4;
+    default:
+        return SIZE_MAX;
+    }
+}
+
+size_t encodeRecord(uint8_t *buf, size_t size, const SensorRecord &rec)
+{
+    size_t len = payloadSize(rec.kind);
+    if ((len == SIZE_MAX) || (size < SENSOR_RECORD_HDR_SIZE + len))
+        return 0;
+
+    buf[0] = 0x42;
+    buf[1] = 0x57;
+    buf[2] = SENSOR_RECORD_VERSION;
+    buf[3] = rec.kind;
+    put32(&buf[4], rec.receiver_id);
+    put32(&buf[8], rec.seq);
+    put32(&buf[12], rec.timestamp);
+    put32(&buf[16], rec.sensor_id);
+    put16(&buf[20], (uint16_t)fp1s(rec.rssi));
+    buf[22] = rec.s_type;
+    buf[23] = rec.chan;
+    buf[24] = rec.decoder;
+    buf[25] = rec.flags;
+
+    uint8_t *p = &buf[SENSOR_RECORD_HDR_SIZE];
+    switch (rec.kind)
+    {
+    case RECORD_KIND_WEATHER:
+        p[0] = rec.ok;
+        put16(&p[1], (uint16_t)fp1s(rec.temp_c));
+        p[3] = rec.humidity;
+        put16(&p[4], fp1u(rec.wind_direction_deg));
+        put16(&p[6], fp1u(rec.wind_gust_meter_sec));
+        put16(&p[8], fp1u(rec.wind_avg_meter_sec));
+        put32(&p[10], fp1u32(rec.rain_mm));
+        put32(&p[14], rec.light_lux);
+        put16(&p[18], fp1u(rec.uv));
+        put16(&p[20], (uint16_t)fp1s(rec.tglobe_c));
+        break;
+    case RECORD_KIND_SOIL:
+        put16(&p[0], (uint16_t)fp1s(rec.temp_c));
+        p[2] = rec.humidity;
+        break;
+    case RECORD_KIND_LIGHTNING:
+        put16(&p[0], rec.strike_count);
+        p[2] = rec.distance_km;
+        put16(&p[3], rec.unknown1);
+        put16(&p[5], rec.unknown2);
+        break;
+    case RECORD_KIND_LEAKAGE:
+        p[0] = rec.alarm ? 1 : 0;
+        break;
+    case RECORD_KIND_AIR_PM:
+        p[0] = rec.ok;
+        put16(&p[1], rec.pm_1_0);
+        put16(&p[3], rec.pm_2_5);
+        put16(&p[5], rec.pm_10);
+        break;
+    case RECORD_KIND_CO2:
+        p[0] = rec.ok;
+        put16(&p[1], rec.co2_ppm);
+        break;
+    case RECORD_KIND_HCHO_VOC:
+        p[0] = rec.ok;
+        put16(&p[1], rec.hcho_ppb);
+        p[3] = rec.voc_level;
+        break;
+    default:
+        break;
+    }
+
+    return SENSOR_RECORD_HDR_SIZE + len;
+}
+
+bool decodeRecord(const uint8_t *buf, size_t size, SensorRecord &rec)
+{
+    if ((size < SENSOR_RECORD_HDR_SIZE) || (buf[0] != 0x42) || (buf[1] != 0x57) ||
+        (buf[2] != SENSOR_RECORD_VERSION))
+        return false;
+
+    size_t len = payloadSize(buf[3]);
+    if ((len == SIZE_MAX) || (size < SENSOR_RECORD_HDR_SIZE + len))
+        return false;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.kind = buf[3];
+    rec.receiver_id = get32(&buf[4]);
+    rec.seq = get32(&buf[8]);
+    rec.timestamp = get32(&buf[12]);
+    rec.sensor_id = get32(&buf[16]);
+    rec.rssi = (int16_t)get16(&buf[20]) * 0.1f;
+    rec.s_type = buf[22];
+    rec.chan = buf[23];
+    rec.decoder = buf[24];
+    rec.flags = buf[25];
+
+    const uint8_t *p = &buf[SENSOR_RECORD_HDR_SIZE];
+    switch (rec.kind)
+    {
+    case RECORD_KIND_WEATHER:
+        rec.ok = p[0];
+        rec.temp_c = (int16_t)get16(&p[1]) * 0.1f;
+        rec.humidity = p[3];
+        rec.wind_direction_deg = get16(&p[4]) * 0.1f;
+        rec.wind_gust_meter_sec = get16(&p[6]) * 0.1f;
+        rec.wind_avg_meter_sec = get16(&p[8]) * 0.1f;
+        rec.rain_mm = get32(&p[10]) * 0.1f;
+        rec.light_lux = get32(&p[14]);
+        rec.uv = get16(&p[18]) * 0.1f;
+        rec.tglobe_c = (int16_t)get16(&p[20]) * 0.1f;
+        break;
+    case RECORD_KIND_SOIL:
+        rec.temp_c = (int16_t)get16(&p[0]) * 0.1f;
+        rec.humidity = p[2];
+        break;
+    case RECORD_KIND_LIGHTNING:
+        rec.strike_count = get16(&p[0]);
+        rec.distance_km = p[2];
+        rec.unknown1 = get16(&p[3]);
+        rec.unknown2 = get16(&p[5]);
+        break;
+    case RECORD_KIND_LEAKAGE:
+        rec.alarm = p[0] != 0;
+        break;
+    case RECORD_KIND_AIR_PM:
+        rec.ok = p[0];
+        rec.pm_1_0 = get16(&p[1]);
+        rec.pm_2_5 = get16(&p[3]);
+        rec.pm_10 = get16(&p[5]);
+        break;
+    case RECORD_KIND_CO2:
+        rec.ok = p[0];
+        rec.co2_ppm = get16(&p[1]);
+        break;
+    case RECORD_KIND_HCHO_VOC:
+        rec.ok = p[0];
+        rec.hcho_ppb = get16(&p[1]);
+        rec.voc_level = p[3];
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+void RecordSeqTracker::reset(void)
+{
+    num = 0;
+    received = 0;
+    lost = 0;
+    late = 0;
+    restarts = 0;
+}
+
+uint32_t RecordSeqTracker::update(uint32_t receiver_id, uint32_t seq)
+{
+    received++;
+
+    uint8_t i;
+    for (i = 0; i < num; i++)
+    {
+        if (ids[i] == receiver_id)
+            break;
+    }
+
+    if (i == num)
+    {
+        // New receiver (table full: replace last entry)
+        if (num < SENSOR_RECORD_MAX_RECEIVERS)
+            num++;
+        else
+            i = num - 1;
+        ids[i] = receiver_id;
+        next[i] = seq + 1;
+        return 0;
+    }
+
+    uint32_t gap = seq - next[i];
+    if (gap == 0)
+    {
+        next[i]++;
+        return 0;
+    }
+
+    if ((int32_t)gap < 0)
+    {
+        if ((uint32_t)(next[i] - seq) > SEQ_RESTART_THRESHOLD)
+        {
+            // Receiver restarted
+            restarts++;
+            next[i] = seq + 1;
+        }
+        else
+        {
+            late++;
+        }
+        return 0;
+    }
+
+    lost += gap;
+    next[i] = seq + 1;
+    return gap;
+}
@@ -0,0 +1,225 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorRecord.h
+//
+// Compact binary encoding of decoded sensor data records
+//
+// Used for distributing decoded sensor data to local consumers (see UdpSink.h);
+// the decoder is used by the host-side receiver (see extras/udp_receiver).
+//
+// Encoding/decoding is allocation-free and independent of the byte order
+// of the host (all multi-byte values are little-endian).
+//
+// Record layout (version 1):
+//
+//  Offset Size Content
+//   0     2    Magic (0x42, 0x57; "BW")
+//   2     1    Version (SENSOR_RECORD_VERSION)
+//   3     1    Kind (RECORD_KIND_*)
+//   4     4    Receiver ID
+//   8     4    Sequence number (per receiver, incremented for each record)
+//  12     4    Timestamp (application defined, e.g. UNIX time)
+//  16     4    Sensor ID
+//  20     2    RSSI (dBm * 10, signed)
+//  22     1    Sensor type
+//  23     1    Channel
+//  24     1    Decoder
+//  25     1    Flags (RECORD_FLAG_*)
+//  26     ...  Payload (depending on kind)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250418 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SENSOR_RECORD_H
+#define _SENSOR_RECORD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SENSOR_RECORD_VERSION   1
+
+// Size of record header
+#define SENSOR_RECORD_HDR_SIZE  26
+
+// Maximum size of encoded record
+#define SENSOR_RECORD_MAX_SIZE  48
+
+// Maximum number of receivers distinguished by RecordSeqTracker
+#define SENSOR_RECORD_MAX_RECEIVERS 8
+
+// Record kinds (payload formats)
+#define RECORD_KIND_NONE        0   // header only
+#define RECORD_KIND_WEATHER     1
+#define RECORD_KIND_SOIL        2
+#define RECORD_KIND_LIGHTNING   3
+#define RECORD_KIND_LEAKAGE     4
+#define RECORD_KIND_AIR_PM      5
+#define RECORD_KIND_CO2         6
+#define RECORD_KIND_HCHO_VOC    7
+
+// Header flags
+#define RECORD_FLAG_BATTERY_OK  0x01
+#define RECORD_FLAG_STARTUP     0x02
+#define RECORD_FLAG_COMPLETE    0x04
+
+// Validity flags (RECORD_KIND_WEATHER: SensorRecord::ok)
+#define RECORD_OK_TEMP          0x01
+#define RECORD_OK_HUMIDITY      0x02
+#define RECORD_OK_WIND          0x04
+#define RECORD_OK_RAIN          0x08
+#define RECORD_OK_LIGHT         0x10
+#define RECORD_OK_UV            0x20
+#define RECORD_OK_TGLOBE        0x40
+
+// Initialization flags (RECORD_KIND_AIR_PM/CO2/HCHO_VOC: SensorRecord::ok)
+#define RECORD_INIT_PM_1_0      0x01
+#define RECORD_INIT_PM_2_5      0x02
+#define RECORD_INIT_PM_10       0x04
+#define RECORD_INIT_CO2         0x01
+#define RECORD_INIT_HCHO        0x01
+#define RECORD_INIT_VOC         0x02
+
+
+/*!
+ * \struct SensorRecord
+ *
+ * \brief Decoded sensor data record (independent of WeatherSensor's data layout)
+ *
+ * Values are transferred with the resolution provided by the sensors
+ * (temperatures, wind, rain and UV: 0.1).
+ */
+typedef struct SensorRecord {
+    uint32_t receiver_id;   //!< receiver ID
+    uint32_t seq;           //!< sequence number
+    uint32_t timestamp;     //!< timestamp (application defined)
+    uint32_t sensor_id;     //!< sensor ID
+    float    rssi;          //!< RSSI in dBm
+    uint8_t  kind;          //!< record kind (RECORD_KIND_*)
+    uint8_t  s_type;        //!< sensor type
+    uint8_t  chan;          //!< channel
+    uint8_t  decoder;       //!< decoder
+    uint8_t  flags;         //!< header flags (RECORD_FLAG_*)
+    uint8_t  ok;            //!< validity flags (RECORD_OK_*) / initialization flags (RECORD_INIT_*)
+    float    temp_c;        //!< temperature in degC (weather, soil)
+    float    tglobe_c;      //!< globe temperature in degC (weather)
+    uint8_t  humidity;      //!< humidity in % (weather) / moisture in % (soil)
+    float    wind_direction_deg;    //!< wind direction in deg (weather)
+    float    wind_gust_meter_sec;   //!< wind speed (gusts) in m/s (weather)
+    float    wind_avg_meter_sec;    //!< wind speed (avg) in m/s (weather)
+    float    rain_mm;       //!< rain gauge level in mm (weather)
+    uint32_t light_lux;     //!< light in lux (weather)
+    float    uv;            //!< UV index (weather)
+    uint16_t strike_count;  //!< lightning strike counter (lightning)
+    uint8_t  distance_km;   //!< lightning distance in km (lightning)
+    uint16_t unknown1;      //!< unknown part 1 (lightning)
+    uint16_t unknown2;      //!< unknown part 2 (lightning)
+    bool     alarm;         //!< water leakage alarm (leakage)
+    uint16_t pm_1_0;        //!< PM1.0 in µg/m³ (PM)
+    uint16_t pm_2_5;        //!< PM2.5 in µg/m³ (PM)
+    uint16_t pm_10;         //!< PM10 in µg/m³ (PM)
+    uint16_t co2_ppm;       //!< CO2 in ppm (CO2)
+    uint16_t hcho_ppb;      //!< HCHO in ppb (HCHO/VOC)
+    uint8_t  voc_level;     //!< VOC level 1..5 (HCHO/VOC)
+} SensorRecord;
+
+
+/*!
+ * \brief Encode record
+ *
+ * \param buf       destination buffer
+ * \param size      size of buffer (SENSOR_RECORD_MAX_SIZE is always sufficient)
+ * \param rec       record
+ *
+ * \returns size of encoded record in bytes, 0 if buffer too small or kind unknown
+ */
+size_t encodeRecord(uint8_t *buf, size_t size, const SensorRecord &rec);
+
+/*!
+ * \brief Decode record
+ *
+ * Fields not contained in the record's kind are set to zero.
+ *
+ * \param buf       source buffer
+ * \param size      size of data in buffer
+ * \param rec       record
+ *
+ * \returns true if valid
+ */
+bool decodeRecord(const uint8_t *buf, size_t size, SensorRecord &rec);
+
+
+/*!
+ * \class RecordSeqTracker
+ *
+ * \brief Detection of lost records by sequence numbers (per receiver)
+ *
+ * A sequence number lower than or equal to the previous one is counted as
+ * duplicate/late record, unless it is far behind (restart of the receiver).
+ */
+class RecordSeqTracker {
+private:
+    uint32_t ids[SENSOR_RECORD_MAX_RECEIVERS];
+    uint32_t next[SENSOR_RECORD_MAX_RECEIVERS];
+    uint8_t  num;
+
+public:
+    uint32_t received;      //!< number of records received
+    uint32_t lost;          //!< number of records lost (gaps in sequence numbers)
+    uint32_t late;          //!< number of duplicate/late records
+    uint32_t restarts;      //!< number of detected receiver restarts
+
+    RecordSeqTracker(void)
+    {
+        reset();
+    };
+
+    /*!
+     * \brief Reset statistics and receiver table
+     */
+    void reset(void);
+
+    /*!
+     * \brief Update with received record
+     *
+     * \param receiver_id   receiver ID
+     * \param seq           sequence number
+     *
+     * \returns number of records lost since previous record of this receiver
+     */
+    uint32_t update(uint32_t receiver_id, uint32_t seq);
+};
+
+#endif // _SENSOR_RECORD_H
@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Trace.cpp
+//
+// Event tracing with export in Chrome trace format (JSON, viewable in Perfetto/chrome://tracing)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250426 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Trace.h"
+
+#if defined(WEATHERSENSOR_TRACE)
+
+#include <stdio.h>
+#include <string.h>
+#include <Arduino.h>
+
+Trace wsTrace;
+
+// Track names (Chrome trace "thread_name" metadata)
+static const char *trackNames[] = {"radio", "app"};
+
+Trace::Trace(void)
+{
+    clock = nullptr;
+    enabled = true;
+    clear();
+}
+
+void
+Trace::clear(void)
+{
+    head = 0;
+    count = 0;
+    overwritten = 0;
+}
+
+void
+Trace::record(char ph, const char *name, uint8_t tid, int32_t arg)
+{
+    if (!enabled)
+        return;
+
+    TraceEvent *ev;
+    if (count < TRACE_RING_SIZE) {
+        ev = &ring[(head + count) % TRACE_RING_SIZE];
+        count++;
+    } else {
+        ev = &ring[head];
+        head = (head + 1) % TRACE_RING_SIZE;
+        overwritten++;
+    }
+    ev->name = name;
+    ev->ts = clock ? clock() : micros();
+    ev->arg = arg;
+    ev->ph = ph;
+    ev->tid = tid;
+}
+
+void
+Trace::exportJson(TraceWriter writer, void *ctx) const
+{
+    char buf[128];
+    int len;
+
+    static const char *header = "{\"traceEvents\":[";
+    static const char *trailer = "],\"displayTimeUnit\":\"ms\"}";
+
+    writer(header, strlen(header), ctx);
+    for (uint8_t tid = 0; tid < sizeof(trackNames) / sizeof(trackNames[0]); tid++) {
+        len = snprintf(buf, sizeof(buf), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                       tid ? "," : "", tid, trackNames[tid]);
+        writer(buf, len, ctx);
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        const TraceEvent &ev = event(i);
+        len = snprintf(buf, sizeof(buf), ",{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%u",
+                       ev.name, ev.ph, (unsigned long)ev.ts, ev.tid);
+        if ((len < 0) || ((size_t)len >= sizeof(buf)))
+            continue;
+        if (ev.ph == 'i') {
+            len += snprintf(&buf[len], sizeof(buf) - len, ",\"s\":\"t\",\"args\":{\"arg\":%ld}}", (long)ev.arg);
+        } else if (ev.ph == 'C') {
+            len += snprintf(&buf[len], sizeof(buf) - len, ",\"args\":{\"value\":%ld}}", (long)ev.arg);
+        } else {
+            len += snprintf(&buf[len], sizeof(buf) - len, "}");
+        }
+        if ((size_t)len < sizeof(buf))
+            writer(buf, len, ctx);
+    }
+    writer(trailer, strlen(trailer), ctx);
+}
+
+// Context of exportJson() into buffer
+typedef struct {
+    char  *buf;
+    size_t size;
+    size_t pos;
+    bool   overflow;
+} BufWriter;
+
+static void bufWrite(const char *str, size_t len, void *ctx)
+{
+    BufWriter *w = (BufWriter *)ctx;
+    if (w->overflow || (w->pos + len >= w->size)) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(&w->buf[w->pos], str, len);
+    w->pos += len;
+    w->buf[w->pos] = '\0';
+}
+
+size_t
+Trace::exportJson(char *buf, size_t size) const
+{
+    BufWriter w = {buf, size, 0, false};
+    if (size)
+        buf[0] = '\0';
+    exportJson(bufWrite, &w);
+    if (w.overflow) {
+        if (size)
+            buf[0] = '\0';
+        return 0;
+    }
+    return w.pos;
+}
+
+TraceScope::TraceScope(const char *scope_name, uint8_t scope_tid) : name(scope_name), tid(scope_tid)
+{
+    wsTrace.record('B', name, tid);
+}
+
+TraceScope::~TraceScope()
+{
+    wsTrace.record('E', name, tid);
+}
+
+#endif // defined(WEATHERSENSOR_TRACE)
@@ -0,0 +1,213 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Trace.h
+//
+// Event tracing with export in Chrome trace format (JSON, viewable in Perfetto/chrome://tracing)
+//
+// Begin/end, instant and counter events are recorded with timestamps in microseconds
+// (micros() - i.e. virtual time in the host build with TimeMock - or a custom clock)
+// into a ring buffer of TRACE_RING_SIZE events; if full, the oldest events are overwritten.
+// exportJson() writes the events in Chrome trace event format.
+//
+// The TRACE_* macros are used for instrumentation. Without WEATHERSENSOR_TRACE (see
+// WeatherSensorCfg.h), they expand to nothing and no trace buffer is allocated.
+//
+// Event names must be string literals (they are stored as pointers and not escaped).
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250426 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WeatherSensorCfg.h"
+
+// Trace tracks (Chrome trace "tid")
+#define TRACE_TID_RADIO     0   //!< radio reception and decoding
+#define TRACE_TID_APP       1   //!< application (callbacks, publishing)
+
+#if defined(WEATHERSENSOR_TRACE)
+
+/*!
+ * \struct TraceEvent
+ *
+ * \brief Trace event
+ */
+typedef struct TraceEvent {
+    const char *name;   //!< event name (string literal)
+    uint32_t    ts;     //!< timestamp [us]
+    int32_t     arg;    //!< argument (instant: "arg", counter: value)
+    char        ph;     //!< phase: 'B' - begin, 'E' - end, 'i' - instant, 'C' - counter
+    uint8_t     tid;    //!< track (TRACE_TID_*)
+} TraceEvent;
+
+/*!
+ * \brief Trace clock function
+ *
+ * \returns current time [us]
+ */
+typedef uint32_t (*TraceClock)(void);
+
+/*!
+ * \brief Writer function for exportJson()
+ *
+ * \param str      string
+ * \param len      length of string
+ * \param ctx      user context
+ */
+typedef void (*TraceWriter)(const char *str, size_t len, void *ctx);
+
+
+/*!
+ * \class Trace
+ *
+ * \brief Event ring buffer with Chrome trace JSON export
+ */
+class Trace {
+
+private:
+    TraceEvent ring[TRACE_RING_SIZE];
+    uint16_t   head;
+    uint16_t   count;
+    TraceClock clock;
+    bool       enabled;
+
+public:
+    uint32_t overwritten;   //!< number of events overwritten (ring buffer full)
+
+    Trace(void);
+
+    /*!
+     * \brief Remove all events
+     */
+    void clear(void);
+
+    /*!
+     * \brief Enable/disable recording
+     */
+    void enable(bool en) {
+        enabled = en;
+    }
+
+    /*!
+     * \brief Set clock (nullptr: micros())
+     */
+    void setClock(TraceClock trace_clock) {
+        clock = trace_clock;
+    }
+
+    /*!
+     * \brief Record event
+     *
+     * \param ph       phase ('B', 'E', 'i', 'C')
+     * \param name     event name (string literal)
+     * \param tid      track (TRACE_TID_*)
+     * \param arg      argument
+     */
+    void record(char ph, const char *name, uint8_t tid, int32_t arg = 0);
+
+    /*!
+     * \brief Get number of recorded events
+     */
+    uint16_t size(void) const {
+        return count;
+    }
+
+    /*!
+     * \brief Get recorded event (0: oldest)
+     */
+    const TraceEvent &event(uint16_t idx) const {
+        return ring[(head + idx) % TRACE_RING_SIZE];
+    }
+
+    /*!
+     * \brief Export events in Chrome trace JSON format
+     *
+     * \param writer   writer function, called for each chunk of the output
+     * \param ctx      user context passed to writer
+     */
+    void exportJson(TraceWriter writer, void *ctx) const;
+
+    /*!
+     * \brief Export events in Chrome trace JSON format into buffer
+     *
+     * \param buf      destination buffer
+     * \param size     size of destination buffer
+     *
+     * \returns length of JSON string, 0 if buffer is too small
+     */
+    size_t exportJson(char *buf, size_t size) const;
+};
+
+/*!
+ * \class TraceScope
+ *
+ * \brief Records begin/end events for the enclosing scope
+ */
+class TraceScope {
+
+private:
+    const char *name;
+    uint8_t     tid;
+
+public:
+    TraceScope(const char *scope_name, uint8_t scope_tid);
+    ~TraceScope();
+};
+
+extern Trace wsTrace;
+
+#define TRACE_BEGIN(name, tid)          wsTrace.record('B', name, tid)
+#define TRACE_END(name, tid)            wsTrace.record('E', name, tid)
+#define TRACE_INSTANT(name, tid, arg)   wsTrace.record('i', name, tid, (int32_t)(arg))
+#define TRACE_COUNTER(name, value)      wsTrace.record('C', name, TRACE_TID_APP, (int32_t)(value))
+#define TRACE_CAT_(a, b)                a##b
+#define TRACE_CAT(a, b)                 TRACE_CAT_(a, b)
+#define TRACE_SCOPE(name, tid)          TraceScope TRACE_CAT(traceScope_, __LINE__)(name, tid)
+
+#else
+
+#define TRACE_BEGIN(name, tid)          do {} while (0)
+#define TRACE_END(name, tid)            do {} while (0)
+#define TRACE_INSTANT(name, tid, arg)   do {} while (0)
+#define TRACE_COUNTER(name, value)      do {} while (0)
+#define TRACE_SCOPE(name, tid)          do {} while (0)
+
+#endif // defined(WEATHERSENSOR_TRACE)
+
+#endif // _TRACE_H
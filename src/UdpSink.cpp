@@ -0,0 +1,325 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UdpSink.cpp
+//
+// UDP multicast sink of decoded sensor data records
+//
+// Decoded sensor data is encoded into compact binary records (see SensorRecord.h)
+// with receiver ID, sequence number, timestamp and RSSI and sent to a multicast group
+// on the local network. Any number of local consumers (logger, display, bridge)
+// can receive the records without a broker (see extras/udp_receiver).
+//
+// publish() only encodes the record into a fixed-size queue; the records are sent
+// by process(), which should be called when no radio message is expected
+// (e.g. from loop() after getData() or from getData()'s callback function).
+// No dynamic memory is used.
+//
+// Supported on ESP32 and ESP8266.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250418 Created
+// 20250425 Added sensor ownership election (enableOwnership())
+// 20250507 publish(): RSSI added to ownership summary only once per received packet
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "UdpSink.h"
+
+#if defined(ESP32) || defined(ESP8266)
+
+#if defined(ESP32)
+// Sequence number is retained during deep sleep to allow loss detection across wake cycles
+RTC_DATA_ATTR uint32_t udpSinkSeq = 0;
+#else
+static uint32_t udpSinkSeq = 0;
+#endif
+
+UdpSink::UdpSink(void)
+{
+    port = UDP_SINK_PORT;
+    ttl = 1;
+    receiverId = 0;
+    head = 0;
+    count = 0;
+    sent = 0;
+    dropped = 0;
+    errors = 0;
+    filtered = 0;
+    ownership = nullptr;
+    ownerPort = UDP_SINK_OWNER_PORT;
+    memset(lastRx, 0, sizeof(lastRx));
+    lastRxNext = 0;
+}
+
+void UdpSink::begin(IPAddress group_addr, uint16_t port_no, uint32_t receiver_id, uint8_t ttl_)
+{
+    group = group_addr;
+    port = port_no;
+    ttl = ttl_;
+    if (receiver_id == 0)
+    {
+        #if defined(ESP32)
+        receiver_id = (uint32_t)ESP.getEfuseMac();
+        #else
+        receiver_id = ESP.getChipId();
+        #endif
+    }
+    receiverId = receiver_id;
+    log_d("UDP sink: %s:%u, receiver ID: 0x%08X", group.toString().c_str(), port, receiverId);
+}
+
+void UdpSink::toRecord(const WeatherSensor::sensor_t &sensor, SensorRecord &rec)
+{
+    memset(&rec, 0, sizeof(rec));
+    rec.sensor_id = sensor.sensor_id;
+    rec.rssi = sensor.rssi;
+    rec.s_type = sensor.s_type;
+    rec.chan = sensor.chan;
+    rec.decoder = sensor.decoder;
+    rec.flags = (sensor.battery_ok ? RECORD_FLAG_BATTERY_OK : 0) |
+                (sensor.startup ? RECORD_FLAG_STARTUP : 0) |
+                (sensor.complete ? RECORD_FLAG_COMPLETE : 0);
+
+    if (sensor.decoder == DECODER_LIGHTNING)
+    {
+        rec.kind = RECORD_KIND_LIGHTNING;
+        rec.strike_count = sensor.lgt.strike_count;
+        rec.distance_km = sensor.lgt.distance_km;
+        rec.unknown1 = sensor.lgt.unknown1;
+        rec.unknown2 = sensor.lgt.unknown2;
+    }
+    else if (sensor.s_type == SENSOR_TYPE_LEAKAGE)
+    {
+        rec.kind = RECORD_KIND_LEAKAGE;
+        rec.alarm = sensor.leak.alarm;
+    }
+    else if (sensor.s_type == SENSOR_TYPE_SOIL)
+    {
+        rec.kind = RECORD_KIND_SOIL;
+        rec.temp_c = sensor.soil.temp_c;
+        rec.humidity = sensor.soil.moisture;
+    }
+    else if (sensor.s_type == SENSOR_TYPE_AIR_PM)
+    {
+        rec.kind = RECORD_KIND_AIR_PM;
+        rec.ok = (sensor.pm.pm_1_0_init ? RECORD_INIT_PM_1_0 : 0) |
+                 (sensor.pm.pm_2_5_init ? RECORD_INIT_PM_2_5 : 0) |
+                 (sensor.pm.pm_10_init ? RECORD_INIT_PM_10 : 0);
+        rec.pm_1_0 = sensor.pm.pm_1_0;
+        rec.pm_2_5 = sensor.pm.pm_2_5;
+        rec.pm_10 = sensor.pm.pm_10;
+    }
+    else if (sensor.s_type == SENSOR_TYPE_CO2)
+    {
+        rec.kind = RECORD_KIND_CO2;
+        rec.ok = sensor.co2.co2_init ? RECORD_INIT_CO2 : 0;
+        rec.co2_ppm = sensor.co2.co2_ppm;
+    }
+    else if (sensor.s_type == SENSOR_TYPE_HCHO_VOC)
+    {
+        rec.kind = RECORD_KIND_HCHO_VOC;
+        rec.ok = (sensor.voc.hcho_init ? RECORD_INIT_HCHO : 0) |
+                 (sensor.voc.voc_init ? RECORD_INIT_VOC : 0);
+        rec.hcho_ppb = sensor.voc.hcho_ppb;
+        rec.voc_level = sensor.voc.voc_level;
+    }
+    else
+    {
+        // Any other (weather-like) sensor
+        const struct WeatherSensor::Weather &w = sensor.w;
+        rec.kind = RECORD_KIND_WEATHER;
+        rec.ok = (w.temp_ok ? RECORD_OK_TEMP : 0) |
+                 (w.humidity_ok ? RECORD_OK_HUMIDITY : 0) |
+                 (w.wind_ok ? RECORD_OK_WIND : 0) |
+                 (w.rain_ok ? RECORD_OK_RAIN : 0) |
+                 (w.light_ok ? RECORD_OK_LIGHT : 0) |
+                 (w.uv_ok ? RECORD_OK_UV : 0) |
+                 (w.tglobe_ok ? RECORD_OK_TGLOBE : 0);
+        rec.temp_c = w.temp_c;
+        rec.tglobe_c = w.tglobe_c;
+        rec.humidity = w.humidity;
+        #ifdef WIND_DATA_FLOATINGPOINT
+        rec.wind_direction_deg = w.wind_direction_deg;
+        rec.wind_gust_meter_sec = w.wind_gust_meter_sec;
+        rec.wind_avg_meter_sec = w.wind_avg_meter_sec;
+        #else
+        rec.wind_direction_deg = w.wind_direction_deg_fp1 * 0.1f;
+        rec.wind_gust_meter_sec = w.wind_gust_meter_sec_fp1 * 0.1f;
+        rec.wind_avg_meter_sec = w.wind_avg_meter_sec_fp1 * 0.1f;
+        #endif
+        rec.rain_mm = w.rain_mm;
+        rec.light_lux = (uint32_t)w.light_lux;
+        rec.uv = w.uv;
+    }
+}
+
+void UdpSink::enableOwnership(SensorOwnership *owner, uint16_t port_no)
+{
+    ownership = owner;
+    ownerPort = port_no;
+    ownership->begin(receiverId);
+    #if defined(ESP8266)
+    udp.beginMulticast(WiFi.localIP(), group, ownerPort);
+    #else
+    udp.beginMulticast(group, ownerPort);
+    #endif
+}
+
+bool UdpSink::publish(const WeatherSensor::sensor_t &sensor, uint32_t timestamp)
+{
+    bool ok = true;
+
+    if (ownership)
+    {
+        if (newPacket(sensor.sensor_id, sensor.rx_time))
+            ownership->update(sensor.sensor_id, sensor.rssi, millis());
+        if (!ownership->owns(sensor.sensor_id, millis()))
+        {
+            filtered++;
+            return true;
+        }
+    }
+
+    if (count == UDP_SINK_QUEUE_SIZE)
+    {
+        // Drop oldest record
+        head = (head + 1) % UDP_SINK_QUEUE_SIZE;
+        count--;
+        dropped++;
+        ok = false;
+    }
+
+    SensorRecord rec;
+    toRecord(sensor, rec);
+    rec.receiver_id = receiverId;
+    rec.seq = udpSinkSeq++;
+    rec.timestamp = timestamp;
+
+    uint8_t idx = (head + count) % UDP_SINK_QUEUE_SIZE;
+    length[idx] = encodeRecord(queue[idx], SENSOR_RECORD_MAX_SIZE, rec);
+    count++;
+
+    return ok;
+}
+
+bool UdpSink::newPacket(uint32_t sensor_id, uint32_t rx_time)
+{
+    for (int i = 0; i < OWNER_MAX_SENSORS; i++)
+    {
+        if (lastRx[i].id == sensor_id)
+        {
+            if (lastRx[i].rxTime == rx_time)
+                return false;
+            lastRx[i].rxTime = rx_time;
+            return true;
+        }
+    }
+
+    // Unknown sensor - replace oldest entry
+    lastRx[lastRxNext].id = sensor_id;
+    lastRx[lastRxNext].rxTime = rx_time;
+    lastRxNext = (lastRxNext + 1) % OWNER_MAX_SENSORS;
+    return true;
+}
+
+void UdpSink::processOwnership(void)
+{
+    uint8_t buf[OWNER_MSG_SIZE];
+
+    // Announcements of other receivers
+    while (udp.parsePacket() > 0)
+    {
+        int len = udp.read(buf, sizeof(buf));
+        if (len > 0)
+            ownership->receive(buf, len, millis());
+        udp.flush();
+    }
+
+    if (!ownership->announceDue(millis()))
+        return;
+
+    size_t len = ownership->announce(buf, sizeof(buf), millis());
+    #if defined(ESP8266)
+    int res = udp.beginPacketMulticast(group, ownerPort, WiFi.localIP(), ttl);
+    #else
+    int res = udp.beginPacket(group, ownerPort);
+    #endif
+    if (res)
+    {
+        udp.write(buf, len);
+        res = udp.endPacket();
+    }
+    if (!res)
+        errors++;
+}
+
+uint8_t UdpSink::process(uint8_t max_records)
+{
+    uint8_t n = 0;
+
+    if (!WiFi.isConnected())
+        return 0;
+
+    if (ownership)
+        processOwnership();
+
+    while ((count > 0) && (n < max_records))
+    {
+        #if defined(ESP8266)
+        int res = udp.beginPacketMulticast(group, port, WiFi.localIP(), ttl);
+        #else
+        int res = udp.beginPacket(group, port);
+        #endif
+        if (res)
+        {
+            udp.write(queue[head], length[head]);
+            res = udp.endPacket();
+        }
+        if (res)
+        {
+            sent++;
+        }
+        else
+        {
+            errors++;
+        }
+        head = (head + 1) % UDP_SINK_QUEUE_SIZE;
+        count--;
+        n++;
+    }
+
+    return n;
+}
+
+#endif // defined(ESP32) || defined(ESP8266)
@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UdpSink.h
+//
+// UDP multicast sink of decoded sensor data records
+//
+// Decoded sensor data is encoded into compact binary records (see SensorRecord.h)
+// with receiver ID, sequence number, timestamp and RSSI and sent to a multicast group
+// on the local network. Any number of local consumers (logger, display, bridge)
+// can receive the records without a broker (see extras/udp_receiver).
+//
+// publish() only encodes the record into a fixed-size queue; the records are sent
+// by process(), which should be called when no radio message is expected
+// (e.g. from loop() after getData() or from getData()'s callback function).
+// No dynamic memory is used.
+//
+// With several receivers, enableOwnership() restricts the records sent by each receiver
+// to the sensors it receives best (see SensorOwnership.h).
+//
+// Supported on ESP32 and ESP8266.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250418 Created
+// 20250425 Added sensor ownership election (enableOwnership())
+// 20250507 publish(): RSSI added to ownership summary only once per received packet
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _UDP_SINK_H
+#define _UDP_SINK_H
+
+#if defined(ESP32) || defined(ESP8266)
+
+#include <Arduino.h>
+#if defined(ESP32)
+#include <WiFi.h>
+#else
+#include <ESP8266WiFi.h>
+#endif
+#include <WiFiUdp.h>
+#include "WeatherSensorCfg.h"
+#include "WeatherSensor.h"
+#include "SensorRecord.h"
+#include "SensorOwnership.h"
+
+
+/**
+ * \class UdpSink
+ *
+ * \brief Multicast of decoded sensor data records
+ *
+ * Typical usage:
+ *
+ *     UdpSink udpSink;
+ *
+ *     setup() {
+ *         // connect to WiFi
+ *         udpSink.begin();
+ *     }
+ *
+ *     loop() {
+ *         ws.getData(...);
+ *         for (size_t i = 0; i < ws.sensor.size(); i++) {
+ *             if (ws.sensor[i].valid)
+ *                 udpSink.publish(ws.sensor[i], time(nullptr));
+ *         }
+ *         udpSink.process();
+ *     }
+ */
+class UdpSink {
+
+private:
+    WiFiUDP udp;
+    IPAddress group;
+    uint16_t port;
+    uint8_t ttl;
+    uint32_t receiverId;
+    uint8_t queue[UDP_SINK_QUEUE_SIZE][SENSOR_RECORD_MAX_SIZE];
+    uint8_t length[UDP_SINK_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    SensorOwnership *ownership;
+    uint16_t ownerPort;
+    struct {
+        uint32_t id;
+        uint32_t rxTime;
+    } lastRx[OWNER_MAX_SENSORS];    // reception time of last packet per sensor (ownership)
+    uint8_t lastRxNext;
+
+    void processOwnership(void);
+    bool newPacket(uint32_t sensor_id, uint32_t rx_time);
+
+public:
+    uint32_t sent;      //!< number of records sent
+    uint32_t dropped;   //!< number of records dropped due to full queue
+    uint32_t errors;    //!< number of send errors
+    uint32_t filtered;  //!< number of records not sent (sensor owned by other receiver)
+
+    /**
+     * Constructor
+     */
+    UdpSink(void);
+
+    /**
+     * \brief Set destination and receiver ID
+     *
+     * \param group_addr    multicast group address
+     * \param port_no       UDP port
+     * \param receiver_id   receiver ID (0: derived from chip ID)
+     * \param ttl_          multicast time-to-live (ESP8266 only)
+     */
+    void begin(IPAddress group_addr = IPAddress(UDP_SINK_GROUP), uint16_t port_no = UDP_SINK_PORT,
+               uint32_t receiver_id = 0, uint8_t ttl_ = 1);
+
+    /**
+     * \brief Encode sensor data and append record to queue
+     *
+     * If the queue is full, the oldest record is dropped.
+     *
+     * \param sensor        sensor data
+     * \param timestamp     timestamp (application defined, e.g. UNIX time)
+     *
+     * \returns true if the record has been queued without dropping another record
+     */
+    bool publish(const WeatherSensor::sensor_t &sensor, uint32_t timestamp);
+
+    /**
+     * \brief Enable sensor ownership election among receivers
+     *
+     * The RSSI of each received packet of a published sensor is added to the ownership's
+     * summary once, even if the same slot is published repeatedly; records of sensors
+     * owned by other receivers are not sent. process() sends announcements
+     * to the group at port_no and processes the other receivers' announcements.
+     * Call after begin(); the ownership's receiver ID is set to this sink's receiver ID.
+     *
+     * \param owner         sensor ownership election
+     * \param port_no       UDP port for announcements
+     */
+    void enableOwnership(SensorOwnership *owner, uint16_t port_no = UDP_SINK_OWNER_PORT);
+
+    /**
+     * \brief Send queued records
+     *
+     * \param max_records   maximum number of records to be sent
+     *
+     * \returns number of records sent
+     */
+    uint8_t process(uint8_t max_records = UDP_SINK_BURST);
+
+    /**
+     * \brief Get number of queued records
+     */
+    uint8_t pending(void)
+    {
+        return count;
+    };
+
+    /**
+     * \brief Convert sensor data to record (without receiver ID/sequence number)
+     *
+     * \param sensor        sensor data
+     * \param rec           record
+     */
+    static void toRecord(const WeatherSensor::sensor_t &sensor, SensorRecord &rec);
+};
+
+#endif // defined(ESP32) || defined(ESP8266)
+#endif // _UDP_SINK_H
@@ -0,0 +1,303 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WakeCycle.cpp
+//
+// Per-wake-cycle time and energy accounting
+//
+// The duration of each wake cycle is split into phases (boot, begin(), radio reception,
+// decoding, WiFi, MQTT, sleep entry, other). The application (and the library) switch
+// between phases by calling mark(); at the end of the cycle, the per-phase durations
+// are stored in a ring buffer in RTC RAM, which is retained during deep sleep.
+//
+// Optionally, the charge used per wake cycle is estimated from configurable
+// current figures per phase.
+//
+// Non-volatile data is stored in the ESP32's RTC RAM or in the ESP8266's
+// RTC user memory to allow retention during deep sleep mode.
+// On other architectures, the data is only kept in RAM.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250414 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include "WakeCycle.h"
+
+
+#if defined(ESP32) && !defined(INSIDE_UNITTEST)
+RTC_DATA_ATTR nvWakeCycle_t nvWakeCycle = {
+    .magic = 0,
+    .cycles = 0,
+    .head = 0,
+    .count = 0,
+    .reserved = 0,
+    .hist = {}
+};
+#endif
+
+// Phase names used in summary()
+static const char *phaseNames[WAKE_PHASE_NUM] = {
+    "boot", "begin", "rx", "decode", "wifi", "mqtt", "sleep", "other"
+};
+
+WakeCycle::WakeCycle(void)
+{
+    const float defaults[WAKE_PHASE_NUM] = {
+        WAKE_CURRENT_BOOT,
+        WAKE_CURRENT_BEGIN,
+        WAKE_CURRENT_RX,
+        WAKE_CURRENT_DECODE,
+        WAKE_CURRENT_WIFI,
+        WAKE_CURRENT_MQTT,
+        WAKE_CURRENT_SLEEP,
+        WAKE_CURRENT_OTHER
+    };
+    for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+        acc[i] = 0;
+        current[i] = defaults[i];
+    }
+    currentSleep = WAKE_CURRENT_DEEP_SLEEP;
+    tPrev = 0;
+    curr = WAKE_PHASE_BOOT;
+    #if !defined(ESP32) || defined(INSIDE_UNITTEST)
+    nvWakeCycle.magic = 0;
+    #endif
+}
+
+void
+WakeCycle::nv_load(void)
+{
+    #if defined(ESP8266) && !defined(INSIDE_UNITTEST)
+    ESP.rtcUserMemoryRead(WAKE_CYCLE_RTC_OFFSET, (uint32_t *)&nvWakeCycle, sizeof(nvWakeCycle));
+    #endif
+
+    // Discard invalid data (power-on reset or layout change)
+    if ((nvWakeCycle.magic != WAKE_CYCLE_MAGIC) ||
+        (nvWakeCycle.head >= WAKE_CYCLE_HIST_SIZE) ||
+        (nvWakeCycle.count > WAKE_CYCLE_HIST_SIZE)) {
+        log_d("Wake cycle data invalid - reset");
+        reset();
+    }
+}
+
+void
+WakeCycle::nv_save(void)
+{
+    #if defined(ESP8266) && !defined(INSIDE_UNITTEST)
+    ESP.rtcUserMemoryWrite(WAKE_CYCLE_RTC_OFFSET, (uint32_t *)&nvWakeCycle, sizeof(nvWakeCycle));
+    #endif
+}
+
+void
+WakeCycle::reset(void)
+{
+    nvWakeCycle.magic = WAKE_CYCLE_MAGIC;
+    nvWakeCycle.cycles = 0;
+    nvWakeCycle.head = 0;
+    nvWakeCycle.count = 0;
+    nvWakeCycle.reserved = 0;
+}
+
+void
+WakeCycle::begin(void)
+{
+    nv_load();
+
+    for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+        acc[i] = 0;
+    }
+
+    // Time since reset
+    tPrev = micros();
+    acc[WAKE_PHASE_BOOT] = tPrev;
+    curr = WAKE_PHASE_OTHER;
+}
+
+void
+WakeCycle::end(uint32_t sleep_ms)
+{
+    mark(curr);
+
+    uint8_t idx = (nvWakeCycle.head + nvWakeCycle.count) % WAKE_CYCLE_HIST_SIZE;
+    wakeCycleRec_t &rec = nvWakeCycle.hist[idx];
+
+    for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+        uint32_t ms = (acc[i] + 500) / 1000;
+        rec.phase[i] = (ms > UINT16_MAX) ? UINT16_MAX : ms;
+    }
+    uint32_t s = sleep_ms / 1000;
+    rec.sleep = (s > UINT16_MAX) ? UINT16_MAX : s;
+
+    if (nvWakeCycle.count < WAKE_CYCLE_HIST_SIZE) {
+        nvWakeCycle.count++;
+    } else {
+        // Overwrite oldest entry
+        nvWakeCycle.head = (nvWakeCycle.head + 1) % WAKE_CYCLE_HIST_SIZE;
+    }
+    nvWakeCycle.cycles++;
+
+    nv_save();
+}
+
+uint32_t
+WakeCycle::elapsed(WakePhase phase)
+{
+    uint32_t us = acc[phase];
+    if (phase == curr) {
+        us += micros() - tPrev;
+    }
+    return us / 1000;
+}
+
+uint32_t
+WakeCycle::cycles(void)
+{
+    return nvWakeCycle.cycles;
+}
+
+uint8_t
+WakeCycle::count(void)
+{
+    return nvWakeCycle.count;
+}
+
+bool
+WakeCycle::getRecord(uint8_t index, wakeCycleRec_t &rec)
+{
+    if (index >= nvWakeCycle.count)
+        return false;
+
+    uint8_t idx = (nvWakeCycle.head + nvWakeCycle.count - 1 - index) % WAKE_CYCLE_HIST_SIZE;
+    rec = nvWakeCycle.hist[idx];
+    return true;
+}
+
+float
+WakeCycle::charge(const wakeCycleRec_t &rec)
+{
+    // 1 mA * 1 ms = 1 uAs = 1/3600 uAh
+    float uAs = 0;
+    for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+        uAs += current[i] * rec.phase[i];
+    }
+    uAs += currentSleep * rec.sleep * 1000.0;
+
+    return uAs / 3600.0;
+}
+
+// Print record as JSON object; returns number of characters or -1 if truncated
+static int printRecord(char *buf, size_t size, const char *name, const uint32_t *phase, float uAh)
+{
+    size_t pos = 0;
+    uint32_t total = 0;
+    int n;
+
+    n = snprintf(buf, size, "\"%s\":{", name);
+    if ((n < 0) || ((size_t)n >= size))
+        return -1;
+    pos += n;
+
+    for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+        total += phase[i];
+        n = snprintf(&buf[pos], size - pos, "\"%s\":%u,", phaseNames[i], (unsigned)phase[i]);
+        if ((n < 0) || ((size_t)n >= size - pos))
+            return -1;
+        pos += n;
+    }
+
+    n = snprintf(&buf[pos], size - pos, "\"total\":%u,\"uAh\":%.1f}", (unsigned)total, uAh);
+    if ((n < 0) || ((size_t)n >= size - pos))
+        return -1;
+
+    return pos + n;
+}
+
+size_t
+WakeCycle::summary(char *buf, size_t size)
+{
+    uint32_t last[WAKE_PHASE_NUM] = {0};
+    uint32_t avg[WAKE_PHASE_NUM] = {0};
+    float lastCharge = 0;
+    float avgCharge = 0;
+    wakeCycleRec_t rec;
+
+    if (getRecord(0, rec)) {
+        for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+            last[i] = rec.phase[i];
+        }
+        lastCharge = charge(rec);
+    }
+
+    uint8_t n = nvWakeCycle.count;
+    for (uint8_t j = 0; j < n; j++) {
+        getRecord(j, rec);
+        for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+            avg[i] += rec.phase[i];
+        }
+        avgCharge += charge(rec);
+    }
+    if (n) {
+        for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+            avg[i] = (avg[i] + n / 2) / n;
+        }
+        avgCharge /= n;
+    }
+
+    if (size)
+        buf[0] = '\0';
+
+    int pos = snprintf(buf, size, "{\"cycles\":%u,\"n\":%u,", (unsigned)nvWakeCycle.cycles, n);
+    if ((pos < 0) || ((size_t)pos >= size))
+        return 0;
+
+    int res = printRecord(&buf[pos], size - pos, "last", last, lastCharge);
+    if ((res < 0) || ((size_t)(pos + res) + 1 >= size)) {
+        buf[0] = '\0';
+        return 0;
+    }
+    pos += res;
+    buf[pos++] = ',';
+
+    res = printRecord(&buf[pos], size - pos, "avg", avg, avgCharge);
+    if ((res < 0) || ((size_t)(pos + res) + 1 >= size)) {
+        buf[0] = '\0';
+        return 0;
+    }
+    pos += res;
+    buf[pos++] = '}';
+    buf[pos] = '\0';
+
+    return pos;
+}
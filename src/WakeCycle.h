@@ -0,0 +1,291 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WakeCycle.h
+//
+// Per-wake-cycle time and energy accounting
+//
+// The duration of each wake cycle is split into phases (boot, begin(), radio reception,
+// decoding, WiFi, MQTT, sleep entry, other). The application (and the library) switch
+// between phases by calling mark(); at the end of the cycle, the per-phase durations
+// are stored in a ring buffer in RTC RAM, which is retained during deep sleep.
+//
+// Optionally, the charge used per wake cycle is estimated from configurable
+// current figures per phase.
+//
+// Non-volatile data is stored in the ESP32's RTC RAM or in the ESP8266's
+// RTC user memory to allow retention during deep sleep mode.
+// On other architectures, the data is only kept in RAM.
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250414 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WAKECYCLE_H
+#define _WAKECYCLE_H
+
+#include <Arduino.h>
+#include "WeatherSensorCfg.h"
+
+
+/**
+ * \def
+ *
+ * Magic number for validation of non-volatile data
+ */
+#define WAKE_CYCLE_MAGIC 0x57434131 // "WCA1"
+
+
+/**
+ * \enum WakePhase
+ *
+ * \brief Phases of a wake cycle
+ */
+typedef enum WakePhase {
+    WAKE_PHASE_BOOT = 0,    //!< Reset until WakeCycle::begin()
+    WAKE_PHASE_BEGIN = 1,   //!< WeatherSensor::begin() (radio initialization)
+    WAKE_PHASE_RX = 2,      //!< Radio reception (listening)
+    WAKE_PHASE_DECODE = 3,  //!< Message decoding
+    WAKE_PHASE_WIFI = 4,    //!< WiFi association
+    WAKE_PHASE_MQTT = 5,    //!< MQTT connection/publishing
+    WAKE_PHASE_SLEEP = 6,   //!< Sleep entry
+    WAKE_PHASE_OTHER = 7,   //!< Anything else
+    WAKE_PHASE_NUM = 8      //!< Number of phases
+} WakePhase;
+
+
+/**
+ * \typedef wakeCycleRec_t
+ *
+ * \brief Record of a single wake cycle
+ */
+typedef struct {
+    uint16_t phase[WAKE_PHASE_NUM]; //!< Duration per phase [ms] (saturated)
+    uint16_t sleep;                 //!< Subsequent sleep interval [s] (saturated)
+} wakeCycleRec_t;
+
+
+/**
+ * \typedef nvWakeCycle_t
+ *
+ * \brief Data structure for wake cycle accounting to be stored in non-volatile memory
+ *
+ * On ESP32, this data is stored in the RTC RAM.
+ * On ESP8266, this data is stored in the RTC user memory at WAKE_CYCLE_RTC_OFFSET.
+ */
+typedef struct {
+    uint32_t       magic;                          //!< Validation marker
+    uint32_t       cycles;                         //!< Total number of recorded cycles
+    uint8_t        head;                           //!< Index of oldest entry in hist
+    uint8_t        count;                          //!< Number of valid entries in hist
+    uint16_t       reserved;                       //!< Padding
+    wakeCycleRec_t hist[WAKE_CYCLE_HIST_SIZE];     //!< Ring buffer of recent cycles
+} nvWakeCycle_t;
+
+
+/**
+ * \class WakeCycle
+ *
+ * \brief Accounting of time and estimated charge per wake cycle
+ *
+ * Typical usage:
+ *
+ *     WakeCycle wakeCycle;
+ *
+ *     setup() {
+ *         wakeCycle.begin();                      // boot phase ends here
+ *         weatherSensor.setWakeCycle(&wakeCycle); // begin()/decoding marked by library
+ *         weatherSensor.begin();
+ *         wakeCycle.mark(WAKE_PHASE_WIFI);
+ *         ...
+ *         wakeCycle.mark(WAKE_PHASE_RX);
+ *         weatherSensor.getData(...);
+ *         wakeCycle.mark(WAKE_PHASE_MQTT);
+ *         ...
+ *         wakeCycle.mark(WAKE_PHASE_SLEEP);
+ *         wakeCycle.end(SLEEP_INTERVAL);
+ *         ESP.deepSleep(...);
+ *     }
+ */
+class WakeCycle {
+
+private:
+    uint32_t acc[WAKE_PHASE_NUM]; // accumulated time in current cycle [us]
+    uint32_t tPrev;               // timestamp of last mark [us]
+    WakePhase curr;               // current phase
+    float current[WAKE_PHASE_NUM];
+    float currentSleep;
+
+    #if !defined(ESP32) || defined(INSIDE_UNITTEST)
+    nvWakeCycle_t nvWakeCycle;
+    #endif
+
+    void nv_load(void);
+    void nv_save(void);
+
+public:
+    /**
+     * Constructor
+     *
+     * Current figures are initialized from WAKE_CURRENT_* (see WeatherSensorCfg.h).
+     */
+    WakeCycle(void);
+
+
+    /**
+     * \brief Start accounting of wake cycle
+     *
+     * Restores (and validates) the ring buffer from non-volatile memory;
+     * the time since reset is accounted as WAKE_PHASE_BOOT.
+     */
+    void begin(void);
+
+
+    /**
+     * \brief Switch to another phase
+     *
+     * The time since the previous mark is accounted to the current phase.
+     *
+     * \param phase     new phase
+     *
+     * \returns previous phase
+     */
+    inline WakePhase mark(WakePhase phase) {
+        uint32_t now = micros();
+        WakePhase prev = curr;
+        acc[curr] += now - tPrev;
+        tPrev = now;
+        curr = phase;
+        return prev;
+    }
+
+
+    /**
+     * \brief Finish accounting of wake cycle and store record
+     *
+     * \param sleep_ms  subsequent sleep interval in ms (only used for charge estimation)
+     */
+    void end(uint32_t sleep_ms = 0);
+
+
+    /**
+     * \brief Clear all records
+     */
+    void reset(void);
+
+
+    /**
+     * \brief Set current figure for charge estimation
+     *
+     * \param phase     phase
+     * \param mA        average current during phase [mA]
+     */
+    void setCurrent(WakePhase phase, float mA) {
+        current[phase] = mA;
+    }
+
+
+    /**
+     * \brief Set deep sleep current figure for charge estimation
+     *
+     * \param mA        average current during deep sleep [mA]
+     */
+    void setSleepCurrent(float mA) {
+        currentSleep = mA;
+    }
+
+
+    /**
+     * \brief Get duration of phase in current (unfinished) cycle
+     *
+     * \param phase     phase
+     *
+     * \returns duration [ms]
+     */
+    uint32_t elapsed(WakePhase phase);
+
+
+    /**
+     * \brief Get total number of recorded cycles
+     */
+    uint32_t cycles(void);
+
+
+    /**
+     * \brief Get number of records in ring buffer
+     */
+    uint8_t count(void);
+
+
+    /**
+     * \brief Get record from ring buffer
+     *
+     * \param index     0: most recent record, 1: previous record, ...
+     * \param rec       record
+     *
+     * \returns true if valid
+     */
+    bool getRecord(uint8_t index, wakeCycleRec_t &rec);
+
+
+    /**
+     * \brief Estimate charge of wake cycle
+     *
+     * \param rec       record
+     *
+     * \returns estimated charge [uAh]
+     */
+    float charge(const wakeCycleRec_t &rec);
+
+
+    /**
+     * \brief Print summary of last and average cycle as JSON string
+     *
+     * Example:
+     *
+     *     {"cycles":42,"n":8,
+     *      "last":{"boot":80,"begin":15,"rx":25012,"decode":3,"wifi":1800,"mqtt":250,"sleep":5,"other":40,"total":27205,"uAh":1123.4},
+     *      "avg":{...}}
+     *
+     * Durations in ms, charge in uAh.
+     *
+     * \param buf       destination buffer
+     * \param size      size of buffer
+     *
+     * \returns number of characters written (excluding terminating null),
+     *          or 0 if buffer too small
+     */
+    size_t summary(char *buf, size_t size);
+};
+#endif // _WAKECYCLE_H
@@ -105,6 +105,25 @@
 // 20241205 Added radio LR1121
 // 20241227 Added LilyGo T3 S3 LR1121 RF switch and TCXO configuration
 // 20250127 Added SENSOR_TYPE_WEATHER2 (8-in-1 Weather Sensor) to 7-in-1 decoder
+// 20250413 Added RSSI sampling for transmitter direction finding
+// 20250414 Added wake cycle accounting of begin() and decoding
+// 20250415 Added time of reception and restore statistics
+// 20250416 genMessage(): discard pending fields (lazy decoding)
+// 20250419 Added optional callback for received messages (setRxCallback())
+// 20250421 getData(): added DATA_REQUIRED
+// 20250422 begin(): heap-free build profile - default lists w/o copies, slots limited to MAX_SENSORS
+// 20250423 getData(): added heap/stack instrumentation (MEM_PHASE_GETDATA, MEM_PHASE_DECODE)
+// 20250426 getData()/getMessage(): added trace events
+// 20250428 begin(): complete sync word matched in hardware if supported (SYNC_WORD_HW)
+//          getMessage(): added false trigger statistics (syncStats)
+// 20250429 getMessage(): added noise floor sampling and adaptive RSSI threshold (NoiseFloor)
+// 20250507 readRssiInst(): not supported with CC1101 (RSSI latched for last packet)
+// 20250507 getData(): return immediately if DATA_REQUIRED is already fulfilled on entry
+// 20250507 getData(): decode pending fields of valid slots before return (lazy decoding)
+// 20250507 getData(): store changed table of logical sensors before return
+// 20250508 pushRssiSample(): ring buffer provided by the application (see setRssiBuffer())
+// 20250508 getData(): DATA_REQUIRED only with WEATHERSENSOR_DATA_REQUIRED
+//          (otherwise any message is sufficient, as with an empty set of requirements)
 //
 // ToDo:
 // -
@@ -121,6 +140,13 @@ RADIO_CHIP radio = new Module(PIN_RECEIVER_CS, PIN_RECEIVER_IRQ, RADIOLIB_NC, PI
 RADIO_CHIP radio = new Module(PIN_RECEIVER_CS, PIN_RECEIVER_IRQ, PIN_RECEIVER_RST, PIN_RECEIVER_GPIO);
 #endif
 
+// Last sync byte received as 1st payload byte (checked in software)
+#if defined(SYNC_WORD_HW) && !defined(USE_CC1101)
+#define SYNC_IN_PAYLOAD 0
+#else
+#define SYNC_IN_PAYLOAD 1
+#endif
+
 #if defined(ARDUINO_LILYGO_T3S3_SX1262) || defined(ARDUINO_LILYGO_T3S3_SX1276) || defined(ARDUINO_LILYGO_T3S3_LR1121)
 SPIClass *spi = nullptr;
 #endif
@@ -160,22 +186,31 @@ void setFlag(void)
 
 int16_t WeatherSensor::begin(uint8_t max_sensors_default, bool init_filters, double frequency_offset)
 {
+    WakePhase phasePrev = WAKE_PHASE_OTHER;
+    if (wakeCycle)
+        phasePrev = wakeCycle->mark(WAKE_PHASE_BEGIN);
+
     uint8_t maxSensors = max_sensors_default;
     getSensorsCfg(maxSensors, rxFlags, enDecoders);
     log_d("max_sensors: %u", maxSensors);
     log_d("rx_flags: %u", rxFlags);
     log_d("en_decoders: %u", enDecoders);
+    #if defined(WEATHERSENSOR_HEAP_FREE)
+    if (maxSensors > WEATHERSENSOR_MAX_SLOTS)
+    {
+        log_w("max_sensors limited to %u (WEATHERSENSOR_MAX_SLOTS)", WEATHERSENSOR_MAX_SLOTS);
+        maxSensors = WEATHERSENSOR_MAX_SLOTS;
+    }
+    #endif
     sensor.resize(maxSensors);
 
     if (init_filters)
     {
         // List of sensor IDs to be excluded - can be empty
-        std::vector<uint32_t> sensor_ids_exc_def = SENSOR_IDS_EXC;
-        initList(sensor_ids_exc, sensor_ids_exc_def, "exc");
+        initList(sensor_ids_exc, SENSOR_IDS_EXC, "exc");
 
         // List of sensor IDs to be included - if zero, handle all available sensors
-        std::vector<uint32_t> sensor_ids_inc_def = SENSOR_IDS_INC;
-        initList(sensor_ids_inc, sensor_ids_inc_def, "inc");
+        initList(sensor_ids_inc, SENSOR_IDS_INC, "inc");
     }
     
     #if defined(ARDUINO_LILYGO_T3S3_SX1262) || defined(ARDUINO_LILYGO_T3S3_SX1276) || defined(ARDUINO_LILYGO_T3S3_LR1121)
@@ -219,7 +254,8 @@ int16_t WeatherSensor::begin(uint8_t max_sensors_default, bool init_filters, dou
     if (state == RADIOLIB_ERR_NONE)
     {
         log_d("success!");
-        state = radio.fixedPacketLengthMode(MSG_BUF_SIZE);
+        // With the complete sync word matched in hardware, the last sync byte is not part of the payload
+        state = radio.fixedPacketLengthMode(MSG_BUF_SIZE - SYNC_IN_PAYLOAD);
         if (state != RADIOLIB_ERR_NONE)
         {
             log_e("%s Error setting fixed packet length: [%d]", RECEIVER_CHIP, state);
@@ -244,12 +280,18 @@ int16_t WeatherSensor::begin(uint8_t max_sensors_default, bool init_filters, dou
 // so we use a preamble of 32 bits and then use the sync as AA 2D
 // which then uses the last byte of the preamble - we recieve the last sync byte
 // as the 1st byte of the payload.
+// SX1276/SX1262/LR1121 support longer sync words - with SYNC_WORD_HW, AA 2D D4 is
+// matched in hardware, which avoids interrupts triggered by noise matching AA 2D.
 #if defined(USE_CC1101)
-        state = radio.setSyncWord(0xAA, 0x2D, 0, false);
-#else
-        uint8_t sync_word[] = {0xAA, 0x2D};
+        state = radio.setSyncWord(SYNC_WORD_0, SYNC_WORD_1, 0, false);
+#elif SYNC_IN_PAYLOAD
+        uint8_t sync_word[] = {SYNC_WORD_0, SYNC_WORD_1};
         state = radio.setSyncWord(sync_word, 2);
+#else
+        uint8_t sync_word[] = {SYNC_WORD_0, SYNC_WORD_1, SYNC_WORD_2};
+        state = radio.setSyncWord(sync_word, 3);
 #endif
+        syncStats.hwSync = !SYNC_IN_PAYLOAD;
         if (state != RADIOLIB_ERR_NONE)
         {
             log_e("%s Error setting sync words: [%d]", RECEIVER_CHIP, state);
@@ -277,6 +319,9 @@ int16_t WeatherSensor::begin(uint8_t max_sensors_default, bool init_filters, dou
             delay(10);
     }
 
+    if (wakeCycle)
+        wakeCycle->mark(phasePrev);
+
     return state;
 }
 
@@ -293,6 +338,41 @@ void WeatherSensor::sleep(void)
 bool WeatherSensor::getData(uint32_t timeout, uint8_t flags, uint8_t type, void (*func)())
 {
     const uint32_t timestamp = millis();
+    MemStatsScope memScope(memStats, MEM_PHASE_GETDATA);
+    TRACE_SCOPE("getData", TRACE_TID_RADIO);
+
+    // On any return:
+    // - lazy decoding: convert pending fields of valid slots,
+    //   so the application never reads stale measurement values from sensor[]
+    // - store changed table of logical sensors (flash write outside of the receive path)
+    struct ExitScope {
+        WeatherSensor *ws;
+        ~ExitScope() {
+            ws->decodePending();
+            ws->flushLogicalIds();
+        }
+    } exitScope = {this};
+
+#if defined(WEATHERSENSOR_DATA_REQUIRED)
+    if (flags & DATA_REQUIRED)
+    {
+        // Initial state from slots already valid
+        bool done = false;
+        required.begin(sensor.size());
+        for (size_t i = 0; i < sensor.size(); i++)
+        {
+            done = required.update(i, required.match(i, sensor[i].sensor_id, sensor[i].s_type, sensor[i].chan,
+                                                     sensor[i].valid, sensor[i].complete));
+        }
+
+        // Already fulfilled on entry (an empty set requires any message)
+        if (done && required.size())
+        {
+            countCompletion(-1);
+            return true;
+        }
+    }
+#endif
 
     radio.startReceive();
 
@@ -303,10 +383,27 @@ bool WeatherSensor::getData(uint32_t timeout, uint8_t flags, uint8_t type, void
         // Callback function (see https://www.geeksforgeeks.org/callbacks-in-c/)
         if (func)
         {
+            TRACE_SCOPE("callback", TRACE_TID_APP);
             (*func)();
         }
 
-        if (decode_status == DECODE_OK)
+        if ((decode_status == DECODE_OK) && (flags & DATA_REQUIRED))
+        {
+            // Only the slot updated by this message has to be evaluated
+            if (rxSlot > -1)
+            {
+#if defined(WEATHERSENSOR_DATA_REQUIRED)
+                const sensor_t &s = sensor[rxSlot];
+                if (required.update(rxSlot, required.match(rxSlot, s.sensor_id, s.s_type, s.chan, s.valid, s.complete)))
+#endif
+                {
+                    radio.standby();
+                    countCompletion(-1);
+                    return true;
+                }
+            }
+        }
+        else if (decode_status == DECODE_OK)
         {
             bool all_slots_valid = true;
             bool all_slots_complete = true;
@@ -323,6 +420,7 @@ bool WeatherSensor::getData(uint32_t timeout, uint8_t flags, uint8_t type, void
                 if (flags == 0)
                 {
                     radio.standby();
+                    countCompletion(i);
                     return true;
                 }
 
@@ -332,6 +430,7 @@ bool WeatherSensor::getData(uint32_t timeout, uint8_t flags, uint8_t type, void
                     if (sensor[i].complete || !(flags & DATA_COMPLETE))
                     {
                         radio.standby();
+                        countCompletion(i);
                         return true;
                     }
                 }
@@ -345,6 +444,7 @@ bool WeatherSensor::getData(uint32_t timeout, uint8_t flags, uint8_t type, void
                 else if (sensor[i].complete)
                 {
                     radio.standby();
+                    countCompletion(i);
                     return true;
                 }
             } // for (size_t i=0; i<sensor.size(); i++)
@@ -353,6 +453,7 @@ bool WeatherSensor::getData(uint32_t timeout, uint8_t flags, uint8_t type, void
             if ((flags & DATA_ALL_SLOTS) && all_slots_valid && all_slots_complete)
             {
                 radio.standby();
+                countCompletion(-1);
                 return true;
             }
 
@@ -374,14 +475,34 @@ DecodeStatus WeatherSensor::getMessage(void)
     {
         receivedFlag = false;
 
+        uint32_t rx_millis = millis();
+#if SYNC_IN_PAYLOAD
         int state = radio.readData(recvData, MSG_BUF_SIZE);
+#else
+        // Last sync byte has been matched in hardware - keep buffer layout
+        recvData[0] = SYNC_WORD_2;
+        int state = radio.readData(&recvData[1], MSG_BUF_SIZE - 1);
+#endif
         rssi = radio.getRSSI();
         state = radio.startReceive();
+        TRACE_INSTANT("packet", TRACE_TID_RADIO, rssi);
 
         if (state == RADIOLIB_ERR_NONE)
         {
+            syncStats.irqs++;
+
             // Verify last syncword is 1st byte of payload (see setSyncWord() above)
-            if (recvData[0] == 0xD4)
+            if (recvData[0] != SYNC_WORD_2)
+            {
+                syncStats.syncErr++;
+            }
+            // RSSI below adaptive threshold - most likely triggered by noise
+            else if (noiseFloor && !noiseFloor->accept(rssi))
+            {
+                log_v("%s RSSI %0.1f below threshold %0.1f", RECEIVER_CHIP, rssi, noiseFloor->threshold());
+                TRACE_INSTANT("squelch", TRACE_TID_RADIO, rssi);
+            }
+            else
             {
 #if CORE_DEBUG_LEVEL == ARDUHAL_LOG_LEVEL_VERBOSE
                 char buf[128];
@@ -394,8 +515,59 @@ DecodeStatus WeatherSensor::getMessage(void)
 #endif
                 log_d("%s R [%02X] RSSI: %0.1f", RECEIVER_CHIP, recvData[0], rssi);
 
+                WakePhase phasePrev = WAKE_PHASE_RX;
+                if (wakeCycle)
+                    phasePrev = wakeCycle->mark(WAKE_PHASE_DECODE);
+                if (memStats)
+                    memStats->enter(MEM_PHASE_DECODE);
+                TRACE_BEGIN("decode", TRACE_TID_RADIO);
+
                 decode_res = decodeMessage(&recvData[1], sizeof(recvData) - 1);
-            } // if (recvData[0] == 0xD4)
+
+                TRACE_END("decode", TRACE_TID_RADIO);
+                bool invalid = (decode_res == DECODE_INVALID) || (decode_res == DECODE_PAR_ERR) ||
+                               (decode_res == DECODE_CHK_ERR) || (decode_res == DECODE_DIG_ERR);
+                if (invalid)
+                {
+                    syncStats.invalid++;
+                }
+                if (noiseFloor)
+                {
+                    noiseFloor->feedback(rssi, !invalid);
+                }
+                if (memStats)
+                    memStats->leave(MEM_PHASE_DECODE);
+                if (wakeCycle)
+                    wakeCycle->mark(phasePrev);
+
+                if ((decode_res == DECODE_OK) && (rxSlot > -1))
+                {
+                    TRACE_INSTANT("slot", TRACE_TID_RADIO, rxSlot);
+                    sensor[rxSlot].rx_time = rx_millis;
+
+                    // Completion relied on data restored from RTC RAM only if
+                    // the first new message completed a split 6-in-1 weather sensor data set
+                    if (sensor[rxSlot].restored)
+                    {
+                        sensor[rxSlot].restored = (sensor[rxSlot].decoder == DECODER_6IN1) &&
+                                                  (sensor[rxSlot].s_type == SENSOR_TYPE_WEATHER1) &&
+                                                  sensor[rxSlot].complete && !rxSlotComplete;
+                    }
+                }
+
+                // The sensor ID is known as soon as the message passed the integrity check -
+                // this is independent of include/exclude lists and available slots
+                if (rssiTrackEn && rxIdValid && (rxId == rssiTrackId))
+                {
+                    pushRssiSample(rx_millis, rssi, RSSI_SAMPLE_PACKET);
+                }
+
+                if (rxCallback)
+                {
+                    TRACE_SCOPE("rxCallback", TRACE_TID_APP);
+                    rxCallback(decode_res, rxIdValid ? rxId : 0, rssi);
+                }
+            } // if (recvData[0] == SYNC_WORD_2)
         } // if (state == RADIOLIB_ERR_NONE)
         else if (state == RADIOLIB_ERR_RX_TIMEOUT)
         {
@@ -407,10 +579,109 @@ DecodeStatus WeatherSensor::getMessage(void)
             log_d("%s Receive failed: [%d]", RECEIVER_CHIP, state);
         }
     }
+    else
+    {
+        if (rssiInterval)
+        {
+            sampleRssi();
+        }
+        if (noiseFloor && noiseFloor->sampleDue(millis()))
+        {
+            float rssi_inst;
+            if (readRssiInst(rssi_inst))
+                noiseFloor->addSample(millis(), rssi_inst);
+        }
+    }
 
     return decode_res;
 }
 
+//
+// Sample current RSSI at fixed interval
+//
+void WeatherSensor::sampleRssi(void)
+{
+    uint32_t now = millis();
+
+    if ((rssiInterval == 0) || ((now - rssiSampleMillis) < rssiInterval))
+        return;
+
+    // Keep fixed sampling grid even if called late
+    rssiSampleMillis += rssiInterval;
+    if ((now - rssiSampleMillis) >= rssiInterval)
+    {
+        rssiSampleMillis = now;
+    }
+
+    float rssi_inst;
+    if (!readRssiInst(rssi_inst))
+        return;
+    pushRssiSample(now, rssi_inst, RSSI_SAMPLE_CONT);
+}
+
+//
+// Read instantaneous RSSI
+//
+bool WeatherSensor::readRssiInst(float &rssi_inst)
+{
+#if defined(USE_SX1276)
+    // FSK mode: current RSSI value
+    rssi_inst = radio.getRSSI(false, true);
+#elif defined(USE_SX1262)
+    rssi_inst = radio.getRSSI(false);
+#elif defined(USE_LR1121)
+    if (radio.getRssiInst(&rssi_inst) != RADIOLIB_ERR_NONE)
+        return false;
+#else
+    // CC1101: in packet mode, getRSSI() returns the RSSI latched for the last packet,
+    // not the current channel RSSI - continuous sampling is not supported
+    (void)rssi_inst;
+    return false;
+#endif
+    return true;
+}
+
+//
+// Store RSSI sample in ring buffer
+//
+void WeatherSensor::pushRssiSample(uint32_t timestamp, float rssi, uint8_t type)
+{
+    if (rssiRingSize == 0)
+        return;
+
+    uint8_t idx = (rssiHead + rssiCount) % rssiRingSize;
+
+    rssiRing[idx].timestamp = timestamp;
+    rssiRing[idx].rssi = rssi;
+    rssiRing[idx].type = type;
+
+    if (rssiCount < rssiRingSize)
+    {
+        rssiCount++;
+    }
+    else
+    {
+        // Overwrite oldest entry
+        rssiHead = (rssiHead + 1) % rssiRingSize;
+        rssiOverruns++;
+    }
+}
+
+//
+// Get oldest RSSI sample from ring buffer
+//
+bool WeatherSensor::getRssiSample(RssiSample &sample)
+{
+    if (rssiCount == 0)
+        return false;
+
+    sample = rssiRing[rssiHead];
+    rssiHead = (rssiHead + 1) % rssiRingSize;
+    rssiCount--;
+
+    return true;
+}
+
 //
 // Generate sample data for testing
 //
@@ -424,6 +695,7 @@ bool WeatherSensor::genMessage(int i, uint32_t id, uint8_t s_type, uint8_t chann
     sensor[i].rssi = 88.8;
     sensor[i].valid = true;
     sensor[i].complete = true;
+    clearPending(i);
 
     if ((s_type == SENSOR_TYPE_WEATHER0) || (s_type == SENSOR_TYPE_WEATHER1))
     {
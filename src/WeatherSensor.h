@@ -85,6 +85,32 @@
 // 20240716 Added option to skip initialization of filters in begin()
 // 20241113 Added getting/setting of sensor include/exclude list from JSON strings
 // 20250127 Added SENSOR_TYPE_WEATHER2 (8-in-1 Weather Sensor)
+// 20250413 Added RSSI sampling for transmitter direction finding
+// 20250414 Added setWakeCycle() for wake cycle accounting
+// 20250415 Added persistence of sensor data slots in RTC RAM during deep sleep
+// 20250416 Added lazy field decoding with raw payload retention
+// 20250417 Added early-reject statistics (RejectStats)
+// 20250419 Added setRxCallback(); moved RejectStats to DecoderPrecheck.h
+// 20250420 Added logical sensor IDs (setLogicalIds(), getIdRemap())
+// 20250421 Added DATA_REQUIRED (requireId(), requireType())
+// 20250422 Added heap-free build profile (WsVector, JSON lists in char buffers)
+// 20250423 Added setMemStats() for heap/stack instrumentation
+// 20250426 Added event tracing (Trace.h)
+// 20250428 Added syncStats (false packet interrupts)
+// 20250429 Added setNoiseFloor() for noise floor estimation and adaptive RSSI threshold
+// 20250501 Moved SENSOR_TYPE_* to SensorFields.h (field visitor)
+// 20250506 Added getCheckpointConfig()/setCheckpointConfig() (see Checkpoint.h)
+// 20250507 clearSlots(): reset 'restored' flag of updated slots
+// 20250507 Added RSSI_INST_SUPPORTED; setRssiSampling() not supported with CC1101
+// 20250507 setNoiseFloor(): not supported with CC1101
+// 20250507 Added decodePending() - no stale values after getData() with lazy decoding
+// 20250507 Added flushLogicalIds() - table of logical sensors not saved in receive path
+// 20250508 Added setRssiBuffer() - RSSI sample ring buffer provided by the application
+// 20250508 Added setSlotImage(); RAM copy of SlotImage only on ESP8266
+// 20250508 Raw payloads (lazy decoding) only with WEATHERSENSOR_LAZY_DECODING
+// 20250508 Logical sensor IDs only with WEATHERSENSOR_LOGICAL_IDS
+// 20250508 Required sensors (DATA_REQUIRED) only with WEATHERSENSOR_DATA_REQUIRED
+// 20250508 Slot containers sized by WEATHERSENSOR_MAX_SLOTS (WsSlotVector)
 //
 // ToDo:
 // -
@@ -99,35 +125,20 @@
 #include <string>
 #include <Preferences.h>
 #include <RadioLib.h>
+#include "WakeCycle.h"
+#include "MemStats.h"
+#include "NoiseFloor.h"
+#include "Trace.h"
+#include "DecoderPrecheck.h"
+#include "SensorIdentity.h"
+#include "DataPredicate.h"
+#include "FixedVector.h"
+#include "SensorFields.h"
 
+struct CheckpointConfig;
 
-// Sensor Types / Decoders / Part Numbers
-// 0 - Weather Station                  5-in-1; PN 7002510..12/7902510..12
-// 1 - Weather Station                  6-in-1; PN 7002585
-//   - Professional Wind Gauge          6-in-1; PN 7002531
-//   - Weather Station                  7-in-1; PN 7003300
-// 2 - Thermo-/Hygro-Sensor             6-in-1; PN 7009999
-// 3 - Pool / Spa Thermometer           6-in-1; PN 7000073 
-// 4 - Soil Moisture Sensor             6-in-1; PN 7009972
-// 5 - Water Leakage Sensor             6-in-1; PN 7009975
-// 8 - Air Quality Sensor PM2.5/PM10    7-in-1; P/N 7009970
-// 9 - Professional Rain Gauge  (5-in-1 decoder)
-// 9 - Lightning Sensor                 PN 7009976
-// 10 - CO2 Sensor                      7-in-1; PN 7009977
-// 11 - HCHO/VCO Sensor                 7-in-1; PN 7009978
-// 13 - Weather Station (8-in-1)        7-in-1; PN 7003150
-#define SENSOR_TYPE_WEATHER0        0 // Weather Station
-#define SENSOR_TYPE_WEATHER1        1 // Weather Station
-#define SENSOR_TYPE_THERMO_HYGRO    2 // Thermo-/Hygro-Sensor
-#define SENSOR_TYPE_POOL_THERMO     3 // Pool / Spa Thermometer
-#define SENSOR_TYPE_SOIL            4 // Soil Temperature and Moisture (from 6-in-1 decoder)
-#define SENSOR_TYPE_LEAKAGE         5 // Water Leakage
-#define SENSOR_TYPE_AIR_PM          8 // Air Quality Sensor (Particle Matter)
-#define SENSOR_TYPE_RAIN            9 // Professional Rain Gauge (from 5-in-1 decoder)
-#define SENSOR_TYPE_LIGHTNING       9 // Lightning Sensor
-#define SENSOR_TYPE_CO2             10 // CO2 Sensor
-#define SENSOR_TYPE_HCHO_VOC        11 // Air Quality Sensor (HCHO and VOC)
-#define SENSOR_TYPE_WEATHER2        13 // Weather Station (8-in-1)
+
+// Sensor Types (SENSOR_TYPE_*): see SensorFields.h
 
 
 // Sensor specific rain gauge overflow threshold (mm)
@@ -139,6 +150,7 @@
 #define DATA_COMPLETE           0x1     // only completed slots (as opposed to partially filled)
 #define DATA_TYPE               0x2     // at least one slot with specific sensor type
 #define DATA_ALL_SLOTS          0x8     // all slots completed
+#define DATA_REQUIRED           0x10    // set of required sensors completed (see requireId()/requireType())
 
 // Flags for checking enabled decoders
 #define DECODER_5IN1            0x01
@@ -150,6 +162,27 @@
 // Message buffer size
 #define MSG_BUF_SIZE            27
 
+// Field groups for lazy decoding (see WeatherSensor::fields())
+#define FIELD_TEMP              0x0001  // temperature
+#define FIELD_HUMIDITY          0x0002  // humidity
+#define FIELD_WIND              0x0004  // wind speed/direction
+#define FIELD_RAIN              0x0008  // rain gauge
+#define FIELD_LIGHT             0x0010  // light intensity
+#define FIELD_UV                0x0020  // UV index
+#define FIELD_TGLOBE            0x0040  // globe temperature
+#define FIELD_AIR               0x0080  // PM / CO2 / HCHO/VOC values
+#define FIELD_ALL               0xFFFF  // all field groups
+
+// RSSI sample types
+#define RSSI_SAMPLE_PACKET      0x1     // RSSI of received packet from tracked sensor
+#define RSSI_SAMPLE_CONT        0x2     // continuous RSSI sample taken between packets
+
+// Instantaneous RSSI (between packets) available from radio chip
+// (CC1101 in packet mode only provides the RSSI latched for the last packet)
+#if defined(USE_SX1276) || defined(USE_SX1262) || defined(USE_LR1121)
+#define RSSI_INST_SUPPORTED
+#endif
+
 // Radio message decoding status
 typedef enum DecodeStatus {
     DECODE_INVALID, DECODE_OK, DECODE_PAR_ERR, DECODE_CHK_ERR, DECODE_DIG_ERR, DECODE_SKIP, DECODE_FULL
@@ -168,6 +201,18 @@ typedef struct SensorMap {
 
 
 
+/*!
+ * \struct RssiSample
+ *
+ * \brief RSSI sample (see WeatherSensor::setRssiTracking()/setRssiSampling())
+ */
+typedef struct RssiSample {
+    uint32_t        timestamp; //!< time of reception/sampling in ms (millis())
+    float           rssi;      //!< received signal strength indicator in dBm
+    uint8_t         type;      //!< RSSI_SAMPLE_PACKET / RSSI_SAMPLE_CONT
+} RssiSample;
+
+
 /*!
   \class WeatherSensor
 
@@ -177,8 +222,8 @@ typedef struct SensorMap {
 class WeatherSensor {
     private:
         Preferences cfgPrefs; //!< Preferences (stored in flash memory)
-        std::vector<uint32_t> sensor_ids_inc;
-        std::vector<uint32_t> sensor_ids_exc;
+        WsVector<uint32_t, MAX_SENSOR_IDS> sensor_ids_inc;
+        WsVector<uint32_t, MAX_SENSOR_IDS> sensor_ids_exc;
 
     public:
         /*!
@@ -205,10 +250,17 @@ class WeatherSensor {
 
         \param timeout timeout in ms.
 
-        \param flags    DATA_COMPLETE / DATA_TYPE / DATA_ALL_SLOTS
+        \param flags    DATA_COMPLETE / DATA_TYPE / DATA_ALL_SLOTS / DATA_REQUIRED
 
         \param type     sensor type (combined with FLAGS==DATA_TYPE)
 
+        With DATA_REQUIRED, getData() returns as soon as all sensors added with requireId()/
+        requireType() have been received (other flags are ignored), or immediately if they are
+        already fulfilled by valid slots on entry. Only the slot updated by each message is
+        evaluated. After a timeout, getMissing() provides the requirements not fulfilled.
+        Only available if WEATHERSENSOR_DATA_REQUIRED is defined (see WeatherSensorCfg.h) -
+        otherwise, any message is sufficient.
+
         \param func     Callback function for each loop iteration. (default: NULL)
 
         \returns false: Timeout occurred.
@@ -316,6 +368,8 @@ class WeatherSensor {
             bool     battery_ok;       //!< battery o.k.
             bool     valid;            //!< data valid (but not necessarily complete)
             bool     complete;         //!< data is split into two separate messages is complete (only 6-in-1 WS)
+            bool     restored;         //!< restored from RTC RAM and not yet updated (see restoreSlots())
+            uint32_t rx_time;          //!< time of last update (millis())
             union {
                 struct Weather      w;
                 struct Soil         soil;
@@ -336,10 +390,331 @@ class WeatherSensor {
         };
 
         typedef struct Sensor sensor_t;            //!< Shortcut for struct Sensor
-        std::vector<sensor_t> sensor;              //!< sensor data array
+        WsSlotVector<sensor_t> sensor;             //!< sensor data array
         float   rssi = 0.0;                        //!< received signal strength indicator in dBm
         uint8_t rxFlags;                           //!< receive flags (see getData())
         uint8_t enDecoders = 0xFF;                 //!< enabled Decoders                     
+        uint32_t rssiOverruns = 0;                 //!< number of RSSI samples lost due to full ring buffer
+        RejectStats rejectStats = {};              //!< statistics of rejected messages
+        SyncStats syncStats = {};                  //!< statistics of packet interrupts (false triggers)
+
+        /*!
+         * \brief Enable/disable RSSI tracking of a specific sensor
+         *
+         * If enabled, an RSSI sample (RSSI_SAMPLE_PACKET) is stored for each packet received
+         * from the sensor with the given ID - regardless of include/exclude lists, free slots
+         * or completeness of data.
+         *
+         * \param id       sensor ID
+         * \param enable   enable/disable tracking
+         */
+        void setRssiTracking(uint32_t id, bool enable = true)
+        {
+            rssiTrackId = id;
+            rssiTrackEn = enable;
+        };
+
+        /*!
+         * \brief Set continuous RSSI sampling interval
+         *
+         * If enabled, the current RSSI is sampled (RSSI_SAMPLE_CONT) with the given interval
+         * between packets. Sampling is done in getMessage() (and thus in getData()).
+         *
+         * Not supported with CC1101 (see RSSI_INST_SUPPORTED) - sampling remains disabled.
+         *
+         * \param interval sampling interval in ms (0: disabled)
+         */
+        void setRssiSampling(uint16_t interval)
+        {
+            #if !defined(RSSI_INST_SUPPORTED)
+            if (interval) {
+                log_w("%s Continuous RSSI sampling not supported", RECEIVER_CHIP);
+                interval = 0;
+            }
+            #endif
+            rssiInterval = interval;
+            rssiSampleMillis = millis();
+        };
+
+        /*!
+         * \brief Set RSSI sample ring buffer
+         *
+         * The samples of setRssiTracking()/setRssiSampling() are stored in a ring buffer
+         * provided by the application (e.g. RSSI_RING_SIZE entries). Without ring buffer,
+         * no samples are stored.
+         *
+         * \param buf      ring buffer (nullptr: none)
+         * \param size     number of entries
+         */
+        void setRssiBuffer(RssiSample *buf, uint8_t size)
+        {
+            rssiRing = buf;
+            rssiRingSize = buf ? size : 0;
+            rssiHead = 0;
+            rssiCount = 0;
+        };
+
+        /*!
+         * \brief Sample current RSSI if sampling interval has elapsed
+         *
+         * Called from getMessage(); may be called additionally by the application.
+         */
+        void sampleRssi(void);
+
+        /*!
+         * \brief Get oldest RSSI sample from ring buffer
+         *
+         * \param sample   RSSI sample
+         *
+         * \returns true if sample was available, false if ring buffer is empty
+         */
+        bool getRssiSample(RssiSample &sample);
+
+        /*!
+         * \brief Attach wake cycle accounting
+         *
+         * If attached, the time spent in begin() and in message decoding is accounted
+         * as WAKE_PHASE_BEGIN and WAKE_PHASE_DECODE, respectively.
+         *
+         * \param wake_cycle  pointer to WakeCycle object (nullptr: detach)
+         */
+        void setWakeCycle(WakeCycle *wake_cycle)
+        {
+            wakeCycle = wake_cycle;
+        };
+
+        /*!
+         * \brief Attach heap/stack instrumentation
+         *
+         * If attached, getData() and message decoding are recorded as
+         * MEM_PHASE_GETDATA and MEM_PHASE_DECODE, respectively.
+         *
+         * \param mem_stats   pointer to MemStats object (nullptr: detach)
+         */
+        void setMemStats(MemStats *mem_stats)
+        {
+            memStats = mem_stats;
+        };
+
+        /*!
+         * \brief Attach noise floor estimator and adaptive RSSI threshold
+         *
+         * If attached, the RSSI is sampled between packets at the estimator's interval
+         * and frames with an RSSI below the adaptive threshold are dropped before decoding.
+         *
+         * Not supported with CC1101 (see RSSI_INST_SUPPORTED) - the estimator is not attached,
+         * since the noise floor would be estimated from the RSSI of the last packet.
+         *
+         * \param noise_floor pointer to NoiseFloor object (nullptr: detach)
+         */
+        void setNoiseFloor(NoiseFloor *noise_floor)
+        {
+            #if !defined(RSSI_INST_SUPPORTED)
+            if (noise_floor) {
+                log_w("%s Noise floor estimation not supported", RECEIVER_CHIP);
+                noise_floor = nullptr;
+            }
+            #endif
+            noiseFloor = noise_floor;
+        };
+
+        /*!
+         * \brief Set callback function for received messages
+         *
+         * The callback is invoked from getMessage() after decoding of each received message,
+         * e.g. for collection of statistics. It must return quickly.
+         *
+         * \param func  callback function (nullptr: remove);
+         *              status: decoding status,
+         *              id: sensor ID if the message passed the integrity check, otherwise 0,
+         *              rssi: RSSI of received message in dBm
+         */
+        void setRxCallback(void (*func)(DecodeStatus status, uint32_t id, float rssi))
+        {
+            rxCallback = func;
+        };
+
+        /*!
+         * \struct RawPayload
+         *
+         * \brief Validated raw message payload retained per slot for lazy decoding
+         */
+        typedef struct RawPayload {
+            uint8_t  data[MSG_BUF_SIZE];  //!< payload (after integrity check and de-whitening)
+            uint8_t  size;                //!< payload size in bytes
+            uint8_t  decoder;             //!< decoder (DECODER_*)
+            uint16_t pending;             //!< field groups not yet decoded (FIELD_*)
+        } RawPayload;
+
+        /*!
+         * \brief Enable/disable logical sensor IDs
+         *
+         * Sensors select a new random ID after power-on/reset (e.g. battery change).
+         * If enabled, a new ID is mapped to the ID under which the sensor was known before
+         * (see SensorIdentity.h), i.e. sensor_id, the slot, include/exclude lists and
+         * the application's state remain valid. The table of logical sensors is stored
+         * in Preferences when it has changed - before getData() returns or with
+         * flushLogicalIds(), never while a message is being received.
+         * Only available if WEATHERSENSOR_LOGICAL_IDS is defined (see WeatherSensorCfg.h).
+         *
+         * \param enable   enable/disable logical sensor IDs
+         */
+        void setLogicalIds(bool enable);
+
+        /*!
+         * \brief Store table of logical sensors in Preferences if it has changed
+         *
+         * Called by getData(); call explicitly if getMessage() is used instead.
+         */
+        void flushLogicalIds(void);
+
+        /*!
+         * \brief Clear table of logical sensors (RAM and Preferences)
+         */
+        void clearLogicalIds(void);
+
+        /*!
+         * \brief Get (and remove) oldest sensor ID remap event
+         *
+         * \param ev       remap event
+         *
+         * \returns true if an event was available
+         */
+        bool getIdRemap(IdRemap &ev)
+        {
+            #if defined(WEATHERSENSOR_LOGICAL_IDS)
+            return logicalIds.getRemap(ev);
+            #else
+            (void)ev;
+            return false;
+            #endif
+        };
+
+        /*!
+         * \brief Remove all required sensors (see getData(), DATA_REQUIRED)
+         */
+        void clearRequired(void)
+        {
+            #if defined(WEATHERSENSOR_DATA_REQUIRED)
+            required.clear();
+            #endif
+        };
+
+        /*!
+         * \brief Add sensor ID to required sensors (see getData(), DATA_REQUIRED)
+         *
+         * \param id       sensor ID
+         * \param complete complete data required
+         *
+         * \returns false if the maximum number of requirements (DATA_REQ_MAX) is exceeded
+         */
+        bool requireId(uint32_t id, bool complete = true)
+        {
+            #if defined(WEATHERSENSOR_DATA_REQUIRED)
+            return required.requireId(id, complete);
+            #else
+            (void)id;
+            (void)complete;
+            log_w("Required sensors not available (WEATHERSENSOR_DATA_REQUIRED)");
+            return false;
+            #endif
+        };
+
+        /*!
+         * \brief Add sensor type/channel to required sensors (see getData(), DATA_REQUIRED)
+         *
+         * Add the same type/channel n times to require n different sensors.
+         *
+         * \param s_type   sensor type (SENSOR_TYPE_*)
+         * \param chan     channel (DATA_REQ_ANY_CHAN: any channel)
+         * \param complete complete data required
+         *
+         * \returns false if the maximum number of requirements (DATA_REQ_MAX) is exceeded
+         */
+        bool requireType(uint8_t s_type, uint8_t chan = DATA_REQ_ANY_CHAN, bool complete = true)
+        {
+            #if defined(WEATHERSENSOR_DATA_REQUIRED)
+            return required.requireType(s_type, chan, complete);
+            #else
+            (void)s_type;
+            (void)chan;
+            (void)complete;
+            log_w("Required sensors not available (WEATHERSENSOR_DATA_REQUIRED)");
+            return false;
+            #endif
+        };
+
+        /*!
+         * \brief Get required sensors not received in last getData() call
+         *
+         * \returns bitmask of requirements (bit n: n-th call of requireId()/requireType())
+         */
+        uint32_t getMissing(void) const
+        {
+            #if defined(WEATHERSENSOR_DATA_REQUIRED)
+            return required.missing();
+            #else
+            return 0;
+            #endif
+        };
+
+        /*!
+         * \brief Enable/disable lazy field decoding
+         *
+         * If enabled, the decoders only set the header (ID, type, channel, startup,
+         * battery, RSSI) and the validity flags (xxx_ok, xxx_init) of a slot and retain
+         * the validated raw payload. Measurement values are converted on first access
+         * via fields().
+         * This saves CPU time per frame if many frames are received but only
+         * few are actually used (e.g. on gateways with high message rates).
+         *
+         * Supported by the 5-in-1 and 7-in-1 decoders; other decoders always decode
+         * eagerly.
+         *
+         * Frames superseded while getData() is receiving are never converted; the pending
+         * fields of all valid slots are converted before getData() returns, i.e. sensor[]
+         * and its consumers (e.g. visitSensorFields(), UdpSink) never see stale values
+         * after getData(). Within getMessage() (e.g. in the getData() or rx callback),
+         * use fields().
+         *
+         * Requires WEATHERSENSOR_LAZY_DECODING (see WeatherSensorCfg.h), otherwise lazy
+         * decoding remains disabled.
+         *
+         * \param enable   enable/disable lazy decoding
+         */
+        void setLazyDecoding(bool enable);
+
+        /*!
+         * \brief Get sensor data with (lazily decoded) measurement values
+         *
+         * Converts the field groups in mask which have not been decoded yet
+         * from the retained raw payload; the result is memoized until the slot is
+         * updated by the next message. Without lazy decoding, sensor[slot] is returned as-is.
+         *
+         * \param slot     slot in sensor data array
+         * \param mask     field groups to be decoded (FIELD_*)
+         *
+         * \returns reference to sensor[slot]
+         */
+        sensor_t &fields(int slot, uint16_t mask = FIELD_ALL);
+
+        /*!
+         * \brief Get raw payload retained for a slot
+         *
+         * \param slot     slot in sensor data array
+         *
+         * \returns pointer to raw payload or nullptr if not available
+         */
+        const RawPayload *getRaw(int slot);
+
+        /*!
+         * \brief Decode all fields of a slot again from the retained raw payload
+         *
+         * \param slot     slot in sensor data array
+         *
+         * \returns true if raw payload was available
+         */
+        bool redecode(int slot);
 
         /*!
         \brief Generates data otherwise received and decoded from a radio message.
@@ -360,6 +735,12 @@ class WeatherSensor {
         void clearSlots(uint8_t type = 0xFF)
         {
             for (size_t i=0; i<sensor.size(); i++) {
+                // Keep data restored from RTC RAM until updated
+                if (sensor[i].restored && !sensor[i].valid) {
+                    continue;
+                }
+                // Slot has been updated - restored data must not be used any further
+                sensor[i].restored = false;
                 if ((type == 0xFF) || (sensor[i].s_type == type)) {
                     sensor[i].valid    = false;
                     sensor[i].complete = false;
@@ -375,6 +756,94 @@ class WeatherSensor {
             }
         };
 
+        /*!
+         * \struct SlotImage
+         *
+         * \brief Image of sensor data slots retained in RTC RAM during deep sleep
+         *
+         * Sensor data is stored as raw bytes to avoid (re-)initialization by constructors.
+         */
+        typedef struct SlotImage {
+            uint32_t magic;                               //!< validation marker
+            uint32_t clock;                               //!< time at save plus sleep interval [ms]
+            uint32_t completions;                         //!< number of successful getData() calls
+            uint32_t early;                               //!< ... thereof completed early due to restored data
+            uint16_t slotSize;                            //!< sizeof(Sensor) - layout check
+            uint8_t  count;                               //!< number of entries
+            uint8_t  reserved;                            //!< padding
+            uint16_t crc;                                 //!< CRC16 of image (with crc = 0)
+            uint16_t reserved2;                           //!< padding
+            uint8_t  slots[SLOTS_RTC_MAX][sizeof(Sensor)]; //!< sensor data
+        } SlotImage;
+
+        /*!
+         * \brief Set storage of sensor data slot image
+         *
+         * By default, the image is kept in RTC RAM on ESP32 (RTC_DATA_ATTR) and
+         * in RTC user memory on ESP8266 (via a RAM copy). On other targets, saveSlots()/
+         * restoreSlots() only work with storage provided by the application which is
+         * retained as needed.
+         *
+         * \param img      slot image (nullptr: default)
+         */
+        void setSlotImage(SlotImage *img)
+        {
+            slotImg = img;
+            rtcImageValid = false;
+        };
+
+        /*!
+         * \brief Save sensor data slots to RTC RAM
+         *
+         * Valid slots (i.e. received in the current wake cycle) are stored,
+         * including partial completeness flags and time of reception.
+         * Call before entering deep sleep.
+         *
+         * \param sleep_ms   sleep interval in ms (used for age calculation after wake-up)
+         */
+        void saveSlots(uint32_t sleep_ms = 0);
+
+        /*!
+         * \brief Restore sensor data slots from RTC RAM
+         *
+         * Call after begin()/setSensorsCfg(). The image is discarded if it is invalid
+         * (power-on reset, CRC error, changed data layout). Entries are discarded if they
+         * are older than max_age, if they are excluded by the include/exclude lists
+         * or if their decoder is disabled.
+         *
+         * Restored slots are not valid (i.e. not visible in getData()) until updated
+         * by a new message from the same sensor. This allows to combine a 6-in-1 weather
+         * sensor message received in the previous wake cycle with one received now.
+         * Restored slots are kept by clearSlots() until updated.
+         *
+         * \param max_age    maximum age of entries in s
+         *
+         * \returns number of restored slots
+         */
+        uint8_t restoreSlots(uint32_t max_age = SLOTS_RTC_MAX_AGE);
+
+        /*!
+         * \brief Get sensor data of previous wake cycle from RTC RAM
+         *
+         * Available after restoreSlots() until saveSlots() is called.
+         *
+         * \param id     sensor ID
+         * \param prev   sensor data
+         *
+         * \returns true if found
+         */
+        bool getPrevious(uint32_t id, sensor_t &prev);
+
+        /*!
+         * \brief Get statistics of getData() completion with restored data
+         *
+         * Counters are retained in RTC RAM by saveSlots() and restored by restoreSlots().
+         *
+         * \param completions    number of successful getData() calls
+         * \param early          number of getData() calls completed early due to restored data
+         */
+        void getRestoreStats(uint32_t &completions, uint32_t &early);
+
         /*!
          * Find slot of required data set by ID
          *
@@ -447,7 +916,8 @@ class WeatherSensor {
          * 
          * \returns size in bytes
          */
-        uint8_t convSensorsJson(std::vector<uint32_t> &ids, String json, uint8_t *buf);
+        #if !defined(WEATHERSENSOR_HEAP_FREE)
+        uint8_t convSensorsJson(WsVector<uint32_t, MAX_SENSOR_IDS> &ids, String json, uint8_t *buf);
 
         /*!
          * Set sensors include list from JSON string
@@ -470,7 +940,7 @@ class WeatherSensor {
          * 
          * \returns JSON string
          */
-        String getSensorsJson(std::vector<uint32_t> &ids);
+        String getSensorsJson(WsVector<uint32_t, MAX_SENSOR_IDS> &ids);
 
         /*!
          * Get sensors include list as JSON string
@@ -485,6 +955,41 @@ class WeatherSensor {
          * \returns JSON string
          */
         String getSensorsExcJson(void);
+        #endif
+
+        /*!
+         * Set sensors include list from JSON string (allocation-free)
+         *
+         * \param json JSON string
+         */
+        void setSensorsIncJson(const char *json);
+
+        /*!
+         * Set sensors exclude list from JSON string (allocation-free)
+         *
+         * \param json JSON string
+         */
+        void setSensorsExcJson(const char *json);
+
+        /*!
+         * Get sensors include list as JSON string (allocation-free)
+         *
+         * \param buf  destination buffer (see SENSOR_IDS_JSON_SIZE())
+         * \param size size of destination buffer
+         *
+         * \returns length of JSON string, 0 if buffer is too small
+         */
+        size_t getSensorsIncJson(char *buf, size_t size);
+
+        /*!
+         * Get sensors exclude list as JSON string (allocation-free)
+         *
+         * \param buf  destination buffer (see SENSOR_IDS_JSON_SIZE())
+         * \param size size of destination buffer
+         *
+         * \returns length of JSON string, 0 if buffer is too small
+         */
+        size_t getSensorsExcJson(char *buf, size_t size);
 
         /*!
          * Get maximum number of  sensors from Preferences
@@ -495,8 +1000,121 @@ class WeatherSensor {
          */
         void getSensorsCfg(uint8_t &max_sensors, uint8_t &rx_flags, uint8_t &en_decoders);
 
+        /*!
+         * Get receiver configuration for checkpoint (see Checkpoint.h)
+         *
+         * \param cfg receiver configuration
+         */
+        void getCheckpointConfig(CheckpointConfig &cfg);
+
+        /*!
+         * Set receiver configuration from checkpoint and store in Preferences
+         *
+         * \param cfg receiver configuration
+         */
+        void setCheckpointConfig(const CheckpointConfig &cfg);
+
     private:
         struct Sensor *pData; //!< pointer to slot in sensor data array
+        uint32_t rxId;        //!< sensor ID of last message which passed integrity check
+        bool     rxIdValid;   //!< rxId is valid
+        bool     rssiTrackEn = false;             //!< RSSI tracking enabled
+        uint32_t rssiTrackId;                     //!< ID of sensor for RSSI tracking
+        uint16_t rssiInterval = 0;                //!< continuous RSSI sampling interval in ms
+        uint32_t rssiSampleMillis;                //!< timestamp of last continuous RSSI sample
+        RssiSample *rssiRing = nullptr;           //!< RSSI sample ring buffer (optional)
+        uint8_t  rssiRingSize = 0;                //!< RSSI ring buffer - number of entries
+        uint8_t  rssiHead = 0;                    //!< RSSI ring buffer - index of oldest entry
+        uint8_t  rssiCount = 0;                   //!< RSSI ring buffer - number of samples
+        WakeCycle *wakeCycle = nullptr;           //!< wake cycle accounting (optional)
+        MemStats *memStats = nullptr;             //!< heap/stack instrumentation (optional)
+        NoiseFloor *noiseFloor = nullptr;         //!< noise floor estimator (optional)
+        void (*rxCallback)(DecodeStatus, uint32_t, float) = nullptr; //!< callback for received messages (optional)
+        int      rxSlot = -1;                     //!< slot selected by findSlot() for last message
+        bool     rxSlotComplete;                  //!< slot was complete before update
+        uint32_t rtcClock = 0;                    //!< time at boot (see SlotImage::clock) [ms]
+        bool     rtcImageValid = false;           //!< SlotImage has been validated
+        uint32_t rtcCompletions = 0;              //!< number of successful getData() calls
+        uint32_t rtcEarly = 0;                    //!< ... thereof completed early due to restored data
+        bool     lazyDecoding = false;            //!< lazy field decoding enabled
+        bool     logicalIdsEn = false;            //!< logical sensor IDs enabled
+        #if defined(WEATHERSENSOR_LOGICAL_IDS)
+        SensorIdentity logicalIds;                //!< table of logical sensors
+        #endif
+        #if defined(WEATHERSENSOR_DATA_REQUIRED)
+        DataPredicate required;                   //!< required sensors (see DATA_REQUIRED)
+        #endif
+        #if defined(WEATHERSENSOR_LAZY_DECODING)
+        WsSlotVector<RawPayload> rawPayload; //!< raw payload per slot (only with lazy decoding)
+        #endif
+        SlotImage *slotImg = nullptr;             //!< slot image provided by the application (optional)
+        #if defined(ESP8266)
+        SlotImage rtcSlotImage;                   //!< RAM copy of RTC user memory
+        #endif
+
+        /*!
+         * \brief Update restore statistics after successful getData()
+         *
+         * \param slot       slot which completed reception (-1: all slots)
+         */
+        void countCompletion(int slot);
+
+        /*!
+         * \brief Get pointer to SlotImage (application, RTC RAM or RAM copy; nullptr: none)
+         */
+        SlotImage *slotImage(void);
+
+        /*!
+         * \brief Retain raw payload for lazy decoding
+         *
+         * \param slot       slot in sensor data array
+         * \param msg        validated (and de-whitened) payload
+         * \param msgSize    payload size in bytes
+         * \param decoder    decoder (DECODER_*)
+         */
+        void storeRaw(int slot, const uint8_t *msg, uint8_t msgSize, uint8_t decoder);
+
+        /*!
+         * \brief Decode pending fields of all valid slots (lazy decoding)
+         *
+         * Called before getData() returns, so sensor[] can be read directly afterwards.
+         */
+        void decodePending(void);
+
+        /*!
+         * \brief Mark all fields of a slot as decoded (e.g. after an eager update)
+         *
+         * \param slot       slot in sensor data array
+         */
+        void clearPending(int slot)
+        {
+            #if defined(WEATHERSENSOR_LAZY_DECODING)
+            if ((slot >= 0) && ((size_t)slot < rawPayload.size()))
+                rawPayload[slot].pending = 0;
+            #else
+            (void)slot;
+            #endif
+        };
+
+        /*!
+         * \brief Store RSSI sample in ring buffer
+         *
+         * If the ring buffer is full, the oldest entry is overwritten.
+         *
+         * \param timestamp    time of sampling in ms
+         * \param rssi         RSSI in dBm
+         * \param type         RSSI_SAMPLE_PACKET / RSSI_SAMPLE_CONT
+         */
+        void pushRssiSample(uint32_t timestamp, float rssi, uint8_t type);
+
+        /*!
+         * \brief Read instantaneous RSSI (between packets)
+         *
+         * \param rssi         RSSI in dBm
+         *
+         * \returns true if successful, false if failed or not supported by radio chip
+         */
+        bool readRssiInst(float &rssi);
 
         /*!
          * Initialize list from Preferences or array
@@ -507,7 +1125,7 @@ class WeatherSensor {
          * \param list_def default list of sensor IDs
          * \param key keyword in Preferences
          */
-        void initList(std::vector<uint32_t> &list, const std::vector<uint32_t> list_def, const char *key);
+        void initList(WsVector<uint32_t, MAX_SENSOR_IDS> &list, std::initializer_list<uint32_t> list_def, const char *key);
 
         /*!
          * \brief Find slot in sensor data array
@@ -528,6 +1146,30 @@ class WeatherSensor {
          */
         int findSlot(uint32_t id, DecodeStatus * status);
 
+        /*!
+         * \brief Find slot for logical sensor ID
+         *
+         * Maps the sensor ID to the logical sensor ID (if enabled, see setLogicalIds())
+         * and calls findSlot(); the sensor is added to the table of logical sensors
+         * if a slot has been assigned.
+         *
+         * \param id       sensor ID from current message; replaced by logical sensor ID
+         * \param decoder  decoder (DECODER_*)
+         * \param s_type   sensor type
+         * \param chan     channel
+         * \param startup  startup flag from current message
+         * \param status   decoding status
+         *
+         * \returns slot in sensor data array or -1 if ID is not wanted or
+         *          no free slot is available.
+         */
+        int findLogicalSlot(uint32_t &id, uint8_t decoder, uint8_t s_type, uint8_t chan, bool startup, DecodeStatus *status);
+
+        /*!
+         * \brief Store table of logical sensors in Preferences
+         */
+        void saveLogicalIds(void);
+
 
         #ifdef BRESSER_5_IN_1
             /*!
@@ -540,6 +1182,17 @@ class WeatherSensor {
             \returns Decode status.
             */
             DecodeStatus decodeBresser5In1Payload(const uint8_t *msg, uint8_t msgSize);
+
+            /*!
+            \brief Convert BRESSER_5_IN_1 measurement values.
+
+            \param slot    Slot in sensor data array.
+
+            \param msg     Message buffer (validated).
+
+            \param mask    Field groups to be converted (FIELD_*).
+            */
+            void decodeBresser5In1Fields(int slot, const uint8_t *msg, uint16_t mask);
         #endif
         #ifdef BRESSER_6_IN_1
             /*!
@@ -566,6 +1219,17 @@ class WeatherSensor {
             \returns Decode status.
             */
             DecodeStatus decodeBresser7In1Payload(const uint8_t *msg, uint8_t msgSize);
+
+            /*!
+            \brief Convert BRESSER_7_IN_1 measurement values.
+
+            \param slot    Slot in sensor data array.
+
+            \param msgw    Message buffer (validated and de-whitened).
+
+            \param mask    Field groups to be converted (FIELD_*).
+            */
+            void decodeBresser7In1Fields(int slot, const uint8_t *msgw, uint16_t mask);
         #endif
         #ifdef BRESSER_LIGHTNING
              /*!
@@ -69,6 +69,26 @@
 // 20241130 Added pin definitions for Heltec Vision Master T190
 // 20241205 Added pin definitions for Lilygo T3-S3 (SX1262/SX1276/LR1121)
 // 20241227 Improved maintainability of board definitions
+// 20250413 Added RSSI_RING_SIZE
+// 20250414 Added wake cycle accounting configuration
+// 20250415 Added sensor data slot persistence configuration
+// 20250418 Added UDP multicast sink configuration
+// 20250419 Added metrics configuration
+// 20250420 Added logical sensor ID configuration
+// 20250421 Added DATA_REQ_MAX
+// 20250422 Added heap-free build profile (WEATHERSENSOR_HEAP_FREE, MAX_SENSORS)
+// 20250425 Added UDP_SINK_OWNER_PORT
+// 20250426 Added WEATHERSENSOR_TRACE, TRACE_RING_SIZE
+// 20250428 Added SYNC_WORD_HW
+// 20250429 Added noise floor estimator configuration (NOISE_*)
+// 20250504 Added AIRQUALITY_USE_PREFS
+// 20250505 Added ET0_USE_PREFS
+// 20250507 Added LOGICAL_ID_LEARN_MIN, LOGICAL_ID_EXPIRE
+// 20250508 RSSI_RING_SIZE: size of ring buffer provided by the application
+// 20250508 Added WEATHERSENSOR_LAZY_DECODING
+// 20250508 Added WEATHERSENSOR_LOGICAL_IDS
+// 20250508 Added WEATHERSENSOR_DATA_REQUIRED
+// 20250508 Renamed MAX_SENSORS to WEATHERSENSOR_MAX_SLOTS (only defined in heap-free build profile)
 //
 // ToDo:
 // -
@@ -96,10 +116,62 @@
 // Maximum number of sensor IDs in include/exclude list
 #define MAX_SENSOR_IDS 12
 
+// Heap-free build profile (recommended for ESP8266 with long uptime)
+// - sensor data slots and include/exclude lists are statically sized (WEATHERSENSOR_MAX_SLOTS, MAX_SENSOR_IDS)
+// - JSON include/exclude lists are handled in char buffers instead of ArduinoJson/String
+// - no heap allocation by the library after WeatherSensor::begin()
+//#define WEATHERSENSOR_HEAP_FREE
+
+#if defined(WEATHERSENSOR_HEAP_FREE)
+// Maximum number of sensor data slots in heap-free build profile
+#define WEATHERSENSOR_MAX_SLOTS 8
+#endif
+
+// Lazy field decoding (see WeatherSensor::setLazyDecoding()) - compiled out if not defined
+// (raw payload buffer of MSG_BUF_SIZE bytes per slot)
+//#define WEATHERSENSOR_LAZY_DECODING
+
+// Logical sensor IDs (see WeatherSensor::setLogicalIds()) - compiled out if not defined
+// (table of LOGICAL_IDS_MAX entries, see SensorIdentity.h)
+//#define WEATHERSENSOR_LOGICAL_IDS
+
+// Required sensors in getData() (see DATA_REQUIRED) - compiled out if not defined
+// (DATA_REQ_MAX requirements and counters per slot, see DataPredicate.h)
+//#define WEATHERSENSOR_DATA_REQUIRED
+
+// Event tracing in Chrome trace format (see Trace.h) - compiled out if not defined
+//#define WEATHERSENSOR_TRACE
+
+// Number of events in trace ring buffer
+#define TRACE_RING_SIZE 256
+
 // Disable data type which will not be used to save RAM
 #define WIND_DATA_FLOATINGPOINT
 #define WIND_DATA_FIXEDPOINT
 
+// Size of RSSI sample ring buffer provided by the application (see WeatherSensor::setRssiBuffer())
+#define RSSI_RING_SIZE 32
+
+// Noise floor estimator and adaptive RSSI threshold (see NoiseFloor.h)
+// Number of idle RSSI samples (median window)
+#define NOISE_FLOOR_WINDOW 32
+
+// Default idle RSSI sampling interval [ms]
+#define NOISE_FLOOR_INTERVAL 250
+
+// Range of RSSI threshold above noise floor [dB]
+#define NOISE_MARGIN_MIN 0
+#define NOISE_MARGIN_MAX 20
+
+// Fraction of valid frames which may be lost by the threshold [1/1000]
+#define NOISE_YIELD_LOSS 10
+
+// Every n-th frame below the threshold is decoded anyway to keep learning
+#define NOISE_PROBE_RATE 8
+
+// Noise floor rise above long-term baseline indicating interference/jamming [dB]
+#define NOISE_JAM_DB 10
+
 // Select appropriate sensor message format(s)
 // Comment out unused decoders to save operation time/power
 #define BRESSER_5_IN_1
@@ -110,7 +182,7 @@
 
 
 // ------------------------------------------------------------------------------------------------
-// --- Rain Gauge / Lightning sensor data retention during deep sleep ---
+// --- Rain Gauge / Lightning / Air Quality / Evapotranspiration sensor data retention during deep sleep ---
 // ------------------------------------------------------------------------------------------------
 
 #if !defined(INSIDE_UNITTEST)
@@ -121,13 +193,114 @@
         // and currently not implemented here
         #define RAINGAUGE_USE_PREFS
         #define LIGHTNING_USE_PREFS
+        #define AIRQUALITY_USE_PREFS
+        #define ET0_USE_PREFS
     #else
         // Using Preferences is mandatory on other architectures (e.g. RP2040)
         #define RAINGAUGE_USE_PREFS
         #define LIGHTNING_USE_PREFS
+        #define AIRQUALITY_USE_PREFS
+        #define ET0_USE_PREFS
     #endif
 #endif
 
+// ------------------------------------------------------------------------------------------------
+// --- Wake cycle accounting (see WakeCycle.h) ---
+// ------------------------------------------------------------------------------------------------
+
+// Number of wake cycle records retained in RTC RAM
+#define WAKE_CYCLE_HIST_SIZE 8
+
+// ESP8266: Offset in RTC user memory [4-byte blocks]
+#define WAKE_CYCLE_RTC_OFFSET 0
+
+// Average current per phase [mA] for charge estimation - adjust to your hardware
+#define WAKE_CURRENT_BOOT   40.0
+#define WAKE_CURRENT_BEGIN  40.0
+#define WAKE_CURRENT_RX     55.0
+#define WAKE_CURRENT_DECODE 50.0
+#define WAKE_CURRENT_WIFI  120.0
+#define WAKE_CURRENT_MQTT  100.0
+#define WAKE_CURRENT_SLEEP  40.0
+#define WAKE_CURRENT_OTHER  50.0
+
+// Deep sleep current [mA]
+#define WAKE_CURRENT_DEEP_SLEEP 0.15
+
+// ------------------------------------------------------------------------------------------------
+// --- Sensor data retention during deep sleep (see WeatherSensor::saveSlots()/restoreSlots()) ---
+// ------------------------------------------------------------------------------------------------
+
+#if defined(ESP8266)
+    // RTC user memory is 512 bytes; WakeCycle data is located at WAKE_CYCLE_RTC_OFFSET
+    #define SLOTS_RTC_MAX 4
+
+    // Offset in RTC user memory [4-byte blocks]
+    #define SLOTS_RTC_OFFSET 40
+#else
+    // ESP32: RTC slow memory is 8 KB
+    #define SLOTS_RTC_MAX 16
+#endif
+
+// Maximum age of restored sensor data [s]
+#define SLOTS_RTC_MAX_AGE 900
+
+// ------------------------------------------------------------------------------------------------
+// --- UDP multicast sink of decoded records (see UdpSink.h) ---
+// ------------------------------------------------------------------------------------------------
+
+// Multicast group address and port
+#define UDP_SINK_GROUP 239, 66, 87, 83
+#define UDP_SINK_PORT 47883
+
+// Number of records queued for sending
+#define UDP_SINK_QUEUE_SIZE 8
+
+// Maximum number of records sent per UdpSink::process() call
+#define UDP_SINK_BURST 4
+
+// UDP port for sensor ownership announcements (see SensorOwnership.h)
+#define UDP_SINK_OWNER_PORT 47885
+
+// ------------------------------------------------------------------------------------------------
+// --- Metrics in Prometheus text format (see PromMetrics.h) ---
+// ------------------------------------------------------------------------------------------------
+
+// Size of text buffer for rendering [bytes]
+#define METRICS_BUF_SIZE 8192
+
+// Maximum number of sensor IDs with RSSI/packet rate metrics
+#define METRICS_MAX_SENSORS 16
+
+// TCP port of HTTP endpoint
+#define METRICS_PORT 9100
+
+// ------------------------------------------------------------------------------------------------
+// --- Logical sensor IDs (see SensorIdentity.h) ---
+// ------------------------------------------------------------------------------------------------
+
+// Maximum number of logical sensors
+#define LOGICAL_IDS_MAX 8
+
+// Minimum time without reception of a logical sensor before its ID may be remapped [ms]
+#define LOGICAL_ID_SILENCE 300000
+
+// Number of remap events retained until read by WeatherSensor::getIdRemap()
+#define LOGICAL_ID_EVENTS 4
+
+// Number of receptions before a sensor is added to the table of logical sensors
+#define LOGICAL_ID_LEARN_MIN 3
+
+// Time without reception after which a logical sensor may be replaced by a new one [ms]
+#define LOGICAL_ID_EXPIRE 604800000UL
+
+// ------------------------------------------------------------------------------------------------
+// --- Required sensors in getData() (see DataPredicate.h) ---
+// ------------------------------------------------------------------------------------------------
+
+// Maximum number of requirements (max. 32)
+#define DATA_REQ_MAX 16
+
 // ------------------------------------------------------------------------------------------------
 // --- Board ---
 // ------------------------------------------------------------------------------------------------
@@ -441,6 +614,12 @@
 #pragma message("No radio chip selected!")
 #endif
 
+// Match complete sync word (AA 2D D4) in hardware - SX1276, SX1262 and LR1121 only
+// (the CC1101 supports only 16-bit sync words; the last sync byte is checked in software).
+// Reduces false packet interrupts triggered by noise; see WeatherSensor::syncStats.
+// Comment out to use the software check on all chips.
+#define SYNC_WORD_HW
+
 
 // ------------------------------------------------------------------------------------------------
 // --- Debug Logging Output ---
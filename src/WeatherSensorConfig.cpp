@@ -41,6 +41,13 @@
 // 20240609 Fixed implementation of maximum number of sensors
 // 20240702 Fixed handling of empty list of IDs / 0x00000000 in Preferences
 // 20241113 Added getting/setting of sensor include/exclude list from JSON strings
+// 20250420 Added logical sensor IDs (setLogicalIds(), clearLogicalIds())
+// 20250422 Added heap-free build profile - allocation-free JSON lists, no list copies
+// 20250506 Added getCheckpointConfig()/setCheckpointConfig()
+// 20250507 Added flushLogicalIds(); saveLogicalIds(): save age of entries
+// 20250508 Logical sensor IDs only with WEATHERSENSOR_LOGICAL_IDS;
+//          setLogicalIds(): discard oversized table in Preferences
+// 20250508 setCheckpointConfig(): include/exclude list size limited to MAX_SENSOR_IDS
 //
 //
 // ToDo:
@@ -48,12 +55,16 @@
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-#include <ArduinoJson.h>
 #include "WeatherSensorCfg.h"
+#if !defined(WEATHERSENSOR_HEAP_FREE)
+#include <ArduinoJson.h>
+#endif
 #include "WeatherSensor.h"
+#include "SensorIdsJson.h"
+#include "Checkpoint.h"
 
 // Initialize list of sensor IDs
-void WeatherSensor::initList(std::vector<uint32_t> &list, const std::vector<uint32_t> list_def, const char *key)
+void WeatherSensor::initList(WsVector<uint32_t, MAX_SENSOR_IDS> &list, std::initializer_list<uint32_t> list_def, const char *key)
 {
     list.clear();
     cfgPrefs.begin("BWS-CFG", false);
@@ -168,8 +179,9 @@ uint8_t WeatherSensor::getSensorsExc(uint8_t *payload)
     return sensor_ids_exc.size() * 4;
 }
 
+#if !defined(WEATHERSENSOR_HEAP_FREE)
 // Get sensors include/exclude list as JSON string
-String WeatherSensor::getSensorsJson(std::vector<uint32_t> &ids)
+String WeatherSensor::getSensorsJson(WsVector<uint32_t, MAX_SENSOR_IDS> &ids)
 {
     JsonDocument doc;
 
@@ -208,7 +220,7 @@ String WeatherSensor::getSensorsExcJson(void)
 }
 
 // Convert JSON string to sensor IDs as byte array
-uint8_t WeatherSensor::convSensorsJson(std::vector<uint32_t> &ids, String json, uint8_t *buf)
+uint8_t WeatherSensor::convSensorsJson(WsVector<uint32_t, MAX_SENSOR_IDS> &ids, String json, uint8_t *buf)
 {
     JsonDocument doc;
     deserializeJson(doc, json);
@@ -242,6 +254,35 @@ void WeatherSensor::setSensorsExcJson(String json)
     uint8_t size = convSensorsJson(sensor_ids_exc, json, buf);
     setSensorsExc(buf, size);
 }
+#endif // !defined(WEATHERSENSOR_HEAP_FREE)
+
+// Set sensors include list from JSON string (allocation-free)
+void WeatherSensor::setSensorsIncJson(const char *json)
+{
+    uint8_t buf[MAX_SENSOR_IDS * 4] = {0};
+    uint8_t size = sensorIdsFromJson(json, buf, MAX_SENSOR_IDS);
+    setSensorsInc(buf, size);
+}
+
+// Set sensors exclude list from JSON string (allocation-free)
+void WeatherSensor::setSensorsExcJson(const char *json)
+{
+    uint8_t buf[MAX_SENSOR_IDS * 4] = {0};
+    uint8_t size = sensorIdsFromJson(json, buf, MAX_SENSOR_IDS);
+    setSensorsExc(buf, size);
+}
+
+// Get sensors include list as JSON string (allocation-free)
+size_t WeatherSensor::getSensorsIncJson(char *buf, size_t size)
+{
+    return sensorIdsToJson(sensor_ids_inc.data(), sensor_ids_inc.size(), buf, size);
+}
+
+// Get sensors exclude list as JSON string (allocation-free)
+size_t WeatherSensor::getSensorsExcJson(char *buf, size_t size)
+{
+    return sensorIdsToJson(sensor_ids_exc.data(), sensor_ids_exc.size(), buf, size);
+}
 
 // Set sensor configuration and store in Preferences
 void WeatherSensor::setSensorsCfg(uint8_t max_sensors, uint8_t rx_flags, uint8_t en_decoders)
@@ -256,6 +297,10 @@ void WeatherSensor::setSensorsCfg(uint8_t max_sensors, uint8_t rx_flags, uint8_t
     log_d("max_sensors: %u", max_sensors);
     log_d("rx_flags: %u", rxFlags);
     log_d("enabled_decoders: %u", enDecoders);
+    #if defined(WEATHERSENSOR_HEAP_FREE)
+    if (max_sensors > WEATHERSENSOR_MAX_SLOTS)
+        log_w("max_sensors limited to %u (WEATHERSENSOR_MAX_SLOTS)", WEATHERSENSOR_MAX_SLOTS);
+    #endif
     sensor.resize(max_sensors);
 }
 
@@ -267,4 +312,128 @@ void WeatherSensor::getSensorsCfg(uint8_t &max_sensors, uint8_t &rx_flags, uint8
     rx_flags = cfgPrefs.getUChar("rxflags", DATA_COMPLETE);
     en_decoders = cfgPrefs.getUChar("endec", 0xFF);
     cfgPrefs.end();
-}
\ No newline at end of file
+}
+
+// Get receiver configuration for checkpoint
+void WeatherSensor::getCheckpointConfig(CheckpointConfig &cfg)
+{
+    cfg.maxSensors = sensor.size();
+    cfg.rxFlags = rxFlags;
+    cfg.enDecoders = enDecoders;
+    cfg.incCount = sensor_ids_inc.size();
+    for (size_t i = 0; i < sensor_ids_inc.size(); i++)
+    {
+        cfg.inc[i] = sensor_ids_inc[i];
+    }
+    cfg.excCount = sensor_ids_exc.size();
+    for (size_t i = 0; i < sensor_ids_exc.size(); i++)
+    {
+        cfg.exc[i] = sensor_ids_exc[i];
+    }
+}
+
+// Set receiver configuration from checkpoint and store in Preferences
+void WeatherSensor::setCheckpointConfig(const CheckpointConfig &cfg)
+{
+    uint8_t buf[MAX_SENSOR_IDS * 4];
+    uint8_t incCount = (cfg.incCount > MAX_SENSOR_IDS) ? MAX_SENSOR_IDS : cfg.incCount;
+    uint8_t excCount = (cfg.excCount > MAX_SENSOR_IDS) ? MAX_SENSOR_IDS : cfg.excCount;
+
+    // Empty list: 4 zero bytes (see setSensorsInc()/setSensorsExc())
+    memset(buf, 0, 4);
+    for (int i = 0; i < incCount; i++)
+    {
+        for (int j = 3; j >= 0; j--)
+        {
+            buf[i * 4 + 3 - j] = (cfg.inc[i] >> (j * 8)) & 0xFF;
+        }
+    }
+    setSensorsInc(buf, incCount ? incCount * 4 : 4);
+
+    memset(buf, 0, 4);
+    for (int i = 0; i < excCount; i++)
+    {
+        for (int j = 3; j >= 0; j--)
+        {
+            buf[i * 4 + 3 - j] = (cfg.exc[i] >> (j * 8)) & 0xFF;
+        }
+    }
+    setSensorsExc(buf, excCount ? excCount * 4 : 4);
+
+    setSensorsCfg(cfg.maxSensors, cfg.rxFlags, cfg.enDecoders);
+}
+
+// Enable/disable logical sensor IDs - restore table from Preferences
+void WeatherSensor::setLogicalIds(bool enable)
+{
+#if defined(WEATHERSENSOR_LOGICAL_IDS)
+    logicalIdsEn = enable;
+    if (!enable)
+        return;
+
+    uint8_t buf[LOGICAL_ID_IMAGE_SIZE];
+    size_t size = 0;
+
+    cfgPrefs.begin("BWS-CFG", false);
+    if (cfgPrefs.isKey("logids"))
+    {
+        size = cfgPrefs.getBytesLength("logids");
+        if (size > sizeof(buf))
+        {
+            log_w("Table of logical sensors in Preferences too large (%u bytes)", (unsigned)size);
+            size = 0;
+        }
+        else
+        {
+            cfgPrefs.getBytes("logids", buf, size);
+        }
+    }
+    cfgPrefs.end();
+
+    if ((size == 0) || !logicalIds.load(buf, size))
+    {
+        log_d("No valid table of logical sensors in Preferences");
+        logicalIds.clear();
+    }
+    log_d("Logical sensors: %u", logicalIds.count());
+    logicalIds.begin(millis());
+#else
+    if (enable)
+        log_w("Logical sensor IDs not available (WEATHERSENSOR_LOGICAL_IDS)");
+    logicalIdsEn = false;
+#endif
+}
+
+// Clear table of logical sensors
+void WeatherSensor::clearLogicalIds(void)
+{
+#if defined(WEATHERSENSOR_LOGICAL_IDS)
+    logicalIds.clear();
+    logicalIds.begin(millis());
+#endif
+    cfgPrefs.begin("BWS-CFG", false);
+    cfgPrefs.remove("logids");
+    cfgPrefs.end();
+}
+
+// Store table of logical sensors in Preferences if changed
+void WeatherSensor::flushLogicalIds(void)
+{
+#if defined(WEATHERSENSOR_LOGICAL_IDS)
+    if (logicalIdsEn && logicalIds.changed())
+        saveLogicalIds();
+#endif
+}
+
+// Store table of logical sensors in Preferences
+void WeatherSensor::saveLogicalIds(void)
+{
+#if defined(WEATHERSENSOR_LOGICAL_IDS)
+    uint8_t buf[LOGICAL_ID_IMAGE_SIZE];
+    size_t size = logicalIds.save(buf, sizeof(buf), millis());
+
+    cfgPrefs.begin("BWS-CFG", false);
+    cfgPrefs.putBytes("logids", buf, size);
+    cfgPrefs.end();
+#endif
+}
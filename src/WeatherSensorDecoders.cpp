@@ -52,6 +52,17 @@
 // 20240716 Added assignment of sensor[slot].decoder
 // 20250127 Added SENSOR_TYPE_WEATHER2 (8-in-1 Weather Sensor)
 // 20250129 Minor change in SENSOR_TYPE_WEATHER2 handling
+// 20250413 Added saving of sensor ID in findSlot() for RSSI tracking
+// 20250415 findSlot(): added handling of slots restored from RTC RAM
+// 20250416 Added lazy field decoding with raw payload retention;
+//          split 5-in-1/7-in-1 decoders into header and field conversion
+// 20250417 Added structural early-reject stage before integrity checks
+//          and slot allocation (see DecoderPrecheck.h), added RejectStats
+// 20250420 Added findLogicalSlot() for mapping of sensor IDs to logical sensor IDs
+// 20250507 Added decodePending()
+// 20250507 findLogicalSlot(): table of logical sensors is not saved in the receive path
+// 20250508 Raw payloads (lazy decoding) only with WEATHERSENSOR_LAZY_DECODING
+// 20250508 findLogicalSlot(): logical sensor IDs only with WEATHERSENSOR_LOGICAL_IDS
 //
 // ToDo:
 // -
@@ -60,6 +71,7 @@
 
 #include "WeatherSensorCfg.h"
 #include "WeatherSensor.h"
+#include "DecoderPrecheck.h"
 
 //
 // Find slot in sensor data array
@@ -68,6 +80,10 @@ int WeatherSensor::findSlot(uint32_t id, DecodeStatus *status)
 {
     log_v("find_slot(): ID=%08X", id);
 
+    // Save ID of message which passed the integrity check
+    rxId = id;
+    rxIdValid = true;
+
     // Skip sensors from exclude-list (if any)
     for (const uint32_t &exc : sensor_ids_exc)
     {
@@ -102,28 +118,45 @@ int WeatherSensor::findSlot(uint32_t id, DecodeStatus *status)
     // Search all slots
     int free_slot = -1;
     int update_slot = -1;
+    int restored_slot = -1;
     for (size_t i = 0; i < sensor.size(); i++)
     {
         log_d("sensor[%d]: v=%d id=0x%08X t=%d c=%d", i, sensor[i].valid, (unsigned int)sensor[i].sensor_id, sensor[i].s_type, sensor[i].complete);
 
+        // Check if sensor has already been stored (or restored from RTC RAM)
+        if ((sensor[i].valid || sensor[i].restored) && (sensor[i].sensor_id == id))
+        {
+            update_slot = i;
+        }
+
         // Save first free slot
-        if (!sensor[i].valid && (free_slot < 0))
+        else if (!sensor[i].valid && !sensor[i].restored && (free_slot < 0))
         {
             free_slot = i;
         }
 
-        // Check if sensor has already been stored
-        else if (sensor[i].valid && (sensor[i].sensor_id == id))
+        // Save first slot restored from RTC RAM (used if no free slot is left)
+        else if (!sensor[i].valid && (restored_slot < 0))
         {
-            update_slot = i;
+            restored_slot = i;
         }
     }
 
+    if ((update_slot < 0) && (free_slot < 0) && (restored_slot > -1))
+    {
+        // Discard restored data of another sensor
+        sensor[restored_slot].restored = false;
+        free_slot = restored_slot;
+    }
+
     if (update_slot > -1)
     {
         // Update slot
         log_v("find_slot(): Updating slot #%d", update_slot);
         *status = DECODE_OK;
+        rxSlot = update_slot;
+        rxSlotComplete = sensor[update_slot].valid && sensor[update_slot].complete;
+        clearPending(update_slot);
         return update_slot;
     }
     else if (free_slot > -1)
@@ -131,6 +164,9 @@ int WeatherSensor::findSlot(uint32_t id, DecodeStatus *status)
         // Store to free slot
         log_v("find_slot(): Storing into slot #%d", free_slot);
         *status = DECODE_OK;
+        rxSlot = free_slot;
+        rxSlotComplete = false;
+        clearPending(free_slot);
         return free_slot;
     }
     else
@@ -142,10 +178,173 @@ int WeatherSensor::findSlot(uint32_t id, DecodeStatus *status)
     }
 }
 
+//
+// Find slot for logical sensor ID
+//
+int WeatherSensor::findLogicalSlot(uint32_t &id, uint8_t decoder, uint8_t s_type, uint8_t chan, bool startup, DecodeStatus *status)
+{
+#if defined(WEATHERSENSOR_LOGICAL_IDS)
+    if (!logicalIdsEn)
+        return findSlot(id, status);
+
+    // IDs configured explicitly are never remapped
+    bool pinned = false;
+    for (const uint32_t &inc : sensor_ids_inc)
+        pinned |= (id == inc);
+    for (const uint32_t &exc : sensor_ids_exc)
+        pinned |= (id == exc);
+
+    uint32_t logical = logicalIds.map(id, decoder, s_type, chan, startup, pinned, millis(),
+                                      sensor_ids_inc.data(), sensor_ids_inc.size());
+    if (logical != id)
+    {
+        log_d("Sensor ID 0x%08X -> logical ID 0x%08X", (unsigned int)id, (unsigned int)logical);
+        id = logical;
+    }
+
+    int slot = findSlot(id, status);
+    if (*status == DECODE_OK)
+    {
+        logicalIds.learn(id, decoder, s_type, chan, millis());
+    }
+
+    // Table changes are stored outside of the receive path (see flushLogicalIds())
+    return slot;
+#else
+    (void)decoder;
+    (void)s_type;
+    (void)chan;
+    (void)startup;
+    return findSlot(id, status);
+#endif
+}
+
+//
+// Retain raw payload for lazy decoding
+//
+void WeatherSensor::storeRaw(int slot, const uint8_t *msg, uint8_t msgSize, uint8_t decoder)
+{
+#if defined(WEATHERSENSOR_LAZY_DECODING)
+    if (rawPayload.size() < sensor.size())
+        rawPayload.resize(sensor.size());
+
+    if (msgSize > MSG_BUF_SIZE)
+        msgSize = MSG_BUF_SIZE;
+
+    RawPayload &raw = rawPayload[slot];
+    memcpy(raw.data, msg, msgSize);
+    raw.size = msgSize;
+    raw.decoder = decoder;
+    raw.pending = FIELD_ALL;
+#else
+    (void)slot;
+    (void)msg;
+    (void)msgSize;
+    (void)decoder;
+#endif
+}
+
+//
+// Get sensor data with lazily decoded measurement values
+//
+WeatherSensor::sensor_t &WeatherSensor::fields(int slot, uint16_t mask)
+{
+#if defined(WEATHERSENSOR_LAZY_DECODING)
+    if ((size_t)slot < rawPayload.size())
+    {
+        RawPayload &raw = rawPayload[slot];
+        uint16_t todo = raw.pending & mask;
+        if (todo)
+        {
+            switch (raw.decoder)
+            {
+#ifdef BRESSER_5_IN_1
+            case DECODER_5IN1:
+                decodeBresser5In1Fields(slot, raw.data, todo);
+                break;
+#endif
+#ifdef BRESSER_7_IN_1
+            case DECODER_7IN1:
+                decodeBresser7In1Fields(slot, raw.data, todo);
+                break;
+#endif
+            default:
+                break;
+            }
+            raw.pending &= ~todo;
+        }
+    }
+#else
+    (void)mask;
+#endif
+    return sensor[slot];
+}
+
+const WeatherSensor::RawPayload *WeatherSensor::getRaw(int slot)
+{
+#if defined(WEATHERSENSOR_LAZY_DECODING)
+    if ((slot < 0) || ((size_t)slot >= rawPayload.size()) || (rawPayload[slot].size == 0))
+        return nullptr;
+
+    return &rawPayload[slot];
+#else
+    (void)slot;
+    return nullptr;
+#endif
+}
+
+bool WeatherSensor::redecode(int slot)
+{
+#if defined(WEATHERSENSOR_LAZY_DECODING)
+    if (getRaw(slot) == nullptr)
+        return false;
+
+    rawPayload[slot].pending = FIELD_ALL;
+    fields(slot);
+    return true;
+#else
+    (void)slot;
+    return false;
+#endif
+}
+
+void WeatherSensor::decodePending(void)
+{
+#if defined(WEATHERSENSOR_LAZY_DECODING)
+    for (size_t i = 0; i < rawPayload.size() && i < sensor.size(); i++)
+    {
+        if (sensor[i].valid && rawPayload[i].pending)
+            fields(i);
+    }
+#endif
+}
+
+void WeatherSensor::setLazyDecoding(bool enable)
+{
+#if defined(WEATHERSENSOR_LAZY_DECODING)
+    lazyDecoding = enable;
+    if (!enable)
+    {
+        // Decode outstanding fields before the raw payloads are released
+        for (size_t i = 0; i < rawPayload.size() && i < sensor.size(); i++)
+            fields(i);
+        rawPayload.clear();
+        rawPayload.shrink_to_fit();
+    }
+#else
+    if (enable)
+        log_w("Lazy decoding not available (WEATHERSENSOR_LAZY_DECODING)");
+    lazyDecoding = false;
+#endif
+}
+
 
 DecodeStatus WeatherSensor::decodeMessage(const uint8_t *msg, uint8_t msgSize)
 {
     DecodeStatus decode_res = DECODE_INVALID;
+    rxIdValid = false;
+    rxSlot = -1;
+    rejectStats.frames++;
 
 #ifdef BRESSER_7_IN_1
     if (enDecoders & DECODER_7IN1) {
@@ -237,13 +436,11 @@ DecodeStatus WeatherSensor::decodeMessage(const uint8_t *msg, uint8_t msgSize)
 DecodeStatus WeatherSensor::decodeBresser5In1Payload(const uint8_t *msg, uint8_t msgSize)
 {
     // First 13 bytes need to match inverse of last 13 bytes
-    for (unsigned col = 0; col < msgSize / 2; ++col)
+    if (!precheck5In1(msg, msgSize))
     {
-        if ((msg[col] ^ msg[col + 13]) != 0xff)
-        {
-            log_d("Parity wrong at column %d", col);
-            return DECODE_PAR_ERR;
-        }
+        log_d("Parity wrong");
+        rejectStats.early[DECODER_IDX_5IN1]++;
+        return DECODE_PAR_ERR;
     }
 
     // Verify checksum (number bits set in bytes 14-25)
@@ -263,15 +460,18 @@ DecodeStatus WeatherSensor::decodeBresser5In1Payload(const uint8_t *msg, uint8_t
     if (bitsSet != expectedBitsSet)
     {
         log_d("Checksum wrong - actual [%02X] != [%02X]", bitsSet, expectedBitsSet);
+        rejectStats.integrity[DECODER_IDX_5IN1]++;
         return DECODE_CHK_ERR;
     }
 
-    uint8_t id_tmp = msg[14];
+    uint32_t id_tmp = msg[14];
     uint8_t type_tmp = msg[15] & 0x7F;
     DecodeStatus status;
 
     // Find appropriate slot in sensor data array and update <status>
-    int slot = findSlot(id_tmp, &status);
+    // (the Rain Gauge's type changes between resets, see below)
+    int slot = findLogicalSlot(id_tmp, DECODER_5IN1, ((type_tmp >= 0x39) && (type_tmp <= 0x3b)) ? 0x39 : type_tmp, 0,
+                               (msg[15] & 0x80) == 0, &status);
 
     if (status != DECODE_OK)
         return status;
@@ -284,33 +484,6 @@ DecodeStatus WeatherSensor::decodeBresser5In1Payload(const uint8_t *msg, uint8_t
     sensor[slot].rssi = rssi;
     sensor[slot].complete = true;
 
-    int temp_raw = (msg[20] & 0x0f) + ((msg[20] & 0xf0) >> 4) * 10 + (msg[21] & 0x0f) * 100;
-    if (msg[25] & 0x0f)
-    {
-        temp_raw = -temp_raw;
-    }
-    sensor[slot].w.temp_c = temp_raw * 0.1f;
-
-    sensor[slot].w.humidity = (msg[22] & 0x0f) + ((msg[22] & 0xf0) >> 4) * 10;
-
-    int wind_direction_raw = ((msg[17] & 0xf0) >> 4) * 225;
-    int gust_raw = ((msg[17] & 0x0f) << 8) + msg[16];
-    int wind_raw = (msg[18] & 0x0f) + ((msg[18] & 0xf0) >> 4) * 10 + (msg[19] & 0x0f) * 100;
-
-#ifdef WIND_DATA_FLOATINGPOINT
-    sensor[slot].w.wind_direction_deg = wind_direction_raw * 0.1f;
-    sensor[slot].w.wind_gust_meter_sec = gust_raw * 0.1f;
-    sensor[slot].w.wind_avg_meter_sec = wind_raw * 0.1f;
-#endif
-#ifdef WIND_DATA_FIXEDPOINT
-    sensor[slot].w.wind_direction_deg_fp1 = wind_direction_raw;
-    sensor[slot].w.wind_gust_meter_sec_fp1 = gust_raw;
-    sensor[slot].w.wind_avg_meter_sec_fp1 = wind_raw;
-#endif
-
-    int rain_raw = (msg[23] & 0x0f) + ((msg[23] & 0xf0) >> 4) * 10 + (msg[24] & 0x0f) * 100 + ((msg[24] & 0xf0) >> 4) * 1000;
-    sensor[slot].w.rain_mm = rain_raw * 0.1f;
-
     // Check if the message is from a Bresser Professional Rain Gauge
     // The sensor type for the Rain Gauge can be either 0x9, 0xA, or 0xB. The
     // value changes between resets, and the meaning of the two least
@@ -319,8 +492,6 @@ DecodeStatus WeatherSensor::decodeBresser5In1Payload(const uint8_t *msg, uint8_t
     // we change the type to SENSOR_TYPE_WEATHER0 here to simplify processing by the application.
     if ((type_tmp >= 0x39) && (type_tmp <= 0x3b))
     {
-        // rescale the rain sensor readings
-        sensor[slot].w.rain_mm *= 2.5;
         type_tmp = SENSOR_TYPE_WEATHER0;
 
         // Rain Gauge has no humidity (according to description) and no wind sensor (obviously)
@@ -340,8 +511,69 @@ DecodeStatus WeatherSensor::decodeBresser5In1Payload(const uint8_t *msg, uint8_t
     sensor[slot].w.uv_ok = false;
     sensor[slot].w.rain_ok = true;
 
+    if (lazyDecoding)
+    {
+        storeRaw(slot, msg, msgSize, DECODER_5IN1);
+    }
+    else
+    {
+        decodeBresser5In1Fields(slot, msg, FIELD_ALL);
+    }
+
     return DECODE_OK;
 }
+
+//
+// Convert measurement values of BRESSER_5_IN_1 message
+//
+void WeatherSensor::decodeBresser5In1Fields(int slot, const uint8_t *msg, uint16_t mask)
+{
+    if (mask & FIELD_TEMP)
+    {
+        int temp_raw = (msg[20] & 0x0f) + ((msg[20] & 0xf0) >> 4) * 10 + (msg[21] & 0x0f) * 100;
+        if (msg[25] & 0x0f)
+        {
+            temp_raw = -temp_raw;
+        }
+        sensor[slot].w.temp_c = temp_raw * 0.1f;
+    }
+
+    if (mask & FIELD_HUMIDITY)
+    {
+        sensor[slot].w.humidity = (msg[22] & 0x0f) + ((msg[22] & 0xf0) >> 4) * 10;
+    }
+
+    if (mask & FIELD_WIND)
+    {
+        int wind_direction_raw = ((msg[17] & 0xf0) >> 4) * 225;
+        int gust_raw = ((msg[17] & 0x0f) << 8) + msg[16];
+        int wind_raw = (msg[18] & 0x0f) + ((msg[18] & 0xf0) >> 4) * 10 + (msg[19] & 0x0f) * 100;
+
+#ifdef WIND_DATA_FLOATINGPOINT
+        sensor[slot].w.wind_direction_deg = wind_direction_raw * 0.1f;
+        sensor[slot].w.wind_gust_meter_sec = gust_raw * 0.1f;
+        sensor[slot].w.wind_avg_meter_sec = wind_raw * 0.1f;
+#endif
+#ifdef WIND_DATA_FIXEDPOINT
+        sensor[slot].w.wind_direction_deg_fp1 = wind_direction_raw;
+        sensor[slot].w.wind_gust_meter_sec_fp1 = gust_raw;
+        sensor[slot].w.wind_avg_meter_sec_fp1 = wind_raw;
+#endif
+    }
+
+    if (mask & FIELD_RAIN)
+    {
+        int rain_raw = (msg[23] & 0x0f) + ((msg[23] & 0xf0) >> 4) * 10 + (msg[24] & 0x0f) * 100 + ((msg[24] & 0xf0) >> 4) * 1000;
+        sensor[slot].w.rain_mm = rain_raw * 0.1f;
+
+        // Bresser Professional Rain Gauge - rescale the rain sensor readings
+        uint8_t type_tmp = msg[15] & 0x7F;
+        if ((type_tmp >= 0x39) && (type_tmp <= 0x3b))
+        {
+            sensor[slot].w.rain_mm *= 2.5;
+        }
+    }
+}
 #endif
 
 //
@@ -432,7 +664,6 @@ DecodeStatus WeatherSensor::decodeBresser5In1Payload(const uint8_t *msg, uint8_t
 #ifdef BRESSER_6_IN_1
 DecodeStatus WeatherSensor::decodeBresser6In1Payload(const uint8_t *msg, uint8_t msgSize)
 {
-    (void)msgSize;                                                                             // unused parameter - kept for consistency with other decoders; avoid warning
     int const moisture_map[] = {0, 7, 13, 20, 27, 33, 40, 47, 53, 60, 67, 73, 80, 87, 93, 99}; // scale is 20/3
 
     // Per-message status flags
@@ -443,21 +674,23 @@ DecodeStatus WeatherSensor::decodeBresser6In1Payload(const uint8_t *msg, uint8_t
     bool rain_ok = false;
     bool f_3in1 = false;
 
+    // Known sensor type and checksum (add with carry, msg[2] to msg[17])
+    if (!precheck6In1(msg, msgSize))
+    {
+        log_d("Type or checksum check failed");
+        rejectStats.early[DECODER_IDX_6IN1]++;
+        return DECODE_CHK_ERR;
+    }
+
     // LFSR-16 digest, generator 0x8810 init 0x5412
     int chkdgst = (msg[0] << 8) | msg[1];
     int digest = lfsr_digest16(&msg[2], 15, 0x8810, 0x5412);
     if (chkdgst != digest)
     {
         log_d("Digest check failed - [%02X] != [%02X]", chkdgst, digest);
+        rejectStats.integrity[DECODER_IDX_6IN1]++;
         return DECODE_DIG_ERR;
     }
-    // Checksum, add with carry
-    int sum = add_bytes(&msg[2], 16); // msg[2] to msg[17]
-    if ((sum & 0xff) != 0xff)
-    {
-        log_d("Checksum failed");
-        return DECODE_CHK_ERR;
-    }
 
     uint32_t id_tmp = ((uint32_t)msg[2] << 24) | (msg[3] << 16) | (msg[4] << 8) | (msg[5]);
     uint8_t type_tmp = (msg[6] >> 4); // 1: weather station, 2: indoor?, 4: soil probe
@@ -466,12 +699,12 @@ DecodeStatus WeatherSensor::decodeBresser6In1Payload(const uint8_t *msg, uint8_t
     DecodeStatus status;
 
     // Find appropriate slot in sensor data array and update <status>
-    int slot = findSlot(id_tmp, &status);
+    int slot = findLogicalSlot(id_tmp, DECODER_6IN1, type_tmp, chan_tmp, (msg[6] & 0x8) == 0, &status);
 
     if (status != DECODE_OK)
         return status;
 
-    if (!sensor[slot].valid)
+    if (!sensor[slot].valid && !sensor[slot].restored)
     {
         // Reset value after if slot is empty
         sensor[slot].w.temp_ok = false;
@@ -704,10 +937,13 @@ First two bytes are an LFSR-16 digest, generator 0x8810 key 0xba95 with a final
 #ifdef BRESSER_7_IN_1
 DecodeStatus WeatherSensor::decodeBresser7In1Payload(const uint8_t *msg, uint8_t msgSize)
 {
-
-    if (msg[21] == 0x00)
+    // Known sensor type and data sanity
+    // (unknown types are rejected, see PRECHECK_TYPES_7IN1)
+    if (!precheck7In1(msg, msgSize))
     {
-        log_d("Data sanity check failed");
+        log_d("Type or data sanity check failed");
+        rejectStats.early[DECODER_IDX_7IN1]++;
+        return DECODE_INVALID;
     }
 
     // data de-whitening
@@ -723,6 +959,7 @@ DecodeStatus WeatherSensor::decodeBresser7In1Payload(const uint8_t *msg, uint8_t
     if ((chkdgst ^ digest) != 0x6df1)
     { // bresser_7in1
         log_d("Digest check failed - [%04X] vs [%04X] (%04X)", chkdgst, digest, chkdgst ^ digest);
+        rejectStats.integrity[DECODER_IDX_7IN1]++;
         return DECODE_DIG_ERR;
     }
 
@@ -730,13 +967,13 @@ DecodeStatus WeatherSensor::decodeBresser7In1Payload(const uint8_t *msg, uint8_t
     log_message("De-whitened Data", msgw, msgSize);
 #endif
 
-    int id_tmp = (msgw[2] << 8) | (msgw[3]);
+    uint32_t id_tmp = (msgw[2] << 8) | (msgw[3]);
     int s_type = msg[6] >> 4; // raw data, no de-whitening
 
     DecodeStatus status;
 
     // Find appropriate slot in sensor data array and update <status>
-    int slot = findSlot(id_tmp, &status);
+    int slot = findLogicalSlot(id_tmp, DECODER_7IN1, s_type, msg[6] & 0x07, (msg[6] & 0x08) == 0x00, &status);
 
     if (status != DECODE_OK)
         return status;
@@ -756,24 +993,6 @@ DecodeStatus WeatherSensor::decodeBresser7In1Payload(const uint8_t *msg, uint8_t
 
     if ((s_type == SENSOR_TYPE_WEATHER1) || (s_type == SENSOR_TYPE_WEATHER2))
     {
-        sensor[slot].w.tglobe_ok = false;
-        int wdir = (msgw[4] >> 4) * 100 + (msgw[4] & 0x0f) * 10 + (msgw[5] >> 4);
-        int wgst_raw = (msgw[7] >> 4) * 100 + (msgw[7] & 0x0f) * 10 + (msgw[8] >> 4);
-        int wavg_raw = (msgw[8] & 0x0f) * 100 + (msgw[9] >> 4) * 10 + (msgw[9] & 0x0f);
-        int rain_raw = (msgw[10] >> 4) * 100000 + (msgw[10] & 0x0f) * 10000 + (msgw[11] >> 4) * 1000 + (msgw[11] & 0x0f) * 100 + (msgw[12] >> 4) * 10 + (msgw[12] & 0x0f) * 1; // 6 digits
-        float rain_mm = rain_raw * 0.1f;
-        int temp_raw = (msgw[14] >> 4) * 100 + (msgw[14] & 0x0f) * 10 + (msgw[15] >> 4);
-        float temp_c = temp_raw * 0.1f;
-        if (temp_raw > 600)
-            temp_c = (temp_raw - 1000) * 0.1f;
-        int humidity = (msgw[16] >> 4) * 10 + (msgw[16] & 0x0f);
-        int lght_raw = (msgw[17] >> 4) * 100000 + (msgw[17] & 0x0f) * 10000 + (msgw[18] >> 4) * 1000 + (msgw[18] & 0x0f) * 100 + (msgw[19] >> 4) * 10 + (msgw[19] & 0x0f);
-        int uv_raw = (msgw[20] >> 4) * 100 + (msgw[20] & 0x0f) * 10 + (msgw[21] >> 4);
-
-        float light_klx = lght_raw * 0.001f; // TODO: remove this
-        float light_lux = lght_raw;
-        float uv_index = uv_raw * 0.1f;
-
         // The RTL_433 decoder does not include any field to verify that these data
         // are ok, so we are assuming that they are ok if the decode status is ok.
         sensor[slot].w.temp_ok = true;
@@ -782,33 +1001,96 @@ DecodeStatus WeatherSensor::decodeBresser7In1Payload(const uint8_t *msg, uint8_t
         sensor[slot].w.rain_ok = true;
         sensor[slot].w.light_ok = true;
         sensor[slot].w.uv_ok = true;
-        sensor[slot].w.temp_c = temp_c;
-        sensor[slot].w.humidity = humidity;
+        sensor[slot].w.tglobe_ok = (s_type == SENSOR_TYPE_WEATHER2) && ((msgw[23] >> 4) < 10); // 8-in-1 sensor
+    }
+    else if (s_type == SENSOR_TYPE_AIR_PM)
+    {
+        sensor[slot].pm.pm_1_0_init = ((msgw[10] >> 4) & 0x0f) == 0x0f;
+        sensor[slot].pm.pm_2_5_init = ((msgw[12] >> 4) & 0x0f) == 0x0f;
+        sensor[slot].pm.pm_10_init = ((msgw[14] >> 4) & 0x0f) == 0x0f;
+    }
+    else if (s_type == SENSOR_TYPE_CO2)
+    {
+        sensor[slot].co2.co2_init = (msgw[5] & 0x0f) == 0x0f;
+    }
+    else if (s_type == SENSOR_TYPE_HCHO_VOC)
+    {
+        sensor[slot].voc.hcho_init = (msgw[5] & 0x0f) == 0x0f;
+        sensor[slot].voc.voc_init = msgw[22] == 0x0f;
+    }
+
+    if (lazyDecoding)
+    {
+        storeRaw(slot, msgw, msgSize, DECODER_7IN1);
+    }
+    else
+    {
+        decodeBresser7In1Fields(slot, msgw, FIELD_ALL);
+    }
+
+    return DECODE_OK;
+}
+
+//
+// Convert measurement values of BRESSER_7_IN_1 message
+//
+void WeatherSensor::decodeBresser7In1Fields(int slot, const uint8_t *msgw, uint16_t mask)
+{
+    int s_type = (msgw[6] ^ 0xaa) >> 4; // raw data, no de-whitening
+
+    if ((s_type == SENSOR_TYPE_WEATHER1) || (s_type == SENSOR_TYPE_WEATHER2))
+    {
+        if (mask & FIELD_WIND)
+        {
+            int wdir = (msgw[4] >> 4) * 100 + (msgw[4] & 0x0f) * 10 + (msgw[5] >> 4);
+            int wgst_raw = (msgw[7] >> 4) * 100 + (msgw[7] & 0x0f) * 10 + (msgw[8] >> 4);
+            int wavg_raw = (msgw[8] & 0x0f) * 100 + (msgw[9] >> 4) * 10 + (msgw[9] & 0x0f);
 #ifdef WIND_DATA_FLOATINGPOINT
-        sensor[slot].w.wind_gust_meter_sec = wgst_raw * 0.1f;
-        sensor[slot].w.wind_avg_meter_sec = wavg_raw * 0.1f;
-        sensor[slot].w.wind_direction_deg = wdir * 1.0f;
+            sensor[slot].w.wind_gust_meter_sec = wgst_raw * 0.1f;
+            sensor[slot].w.wind_avg_meter_sec = wavg_raw * 0.1f;
+            sensor[slot].w.wind_direction_deg = wdir * 1.0f;
 #endif
 #ifdef WIND_DATA_FIXEDPOINT
-        sensor[slot].w.wind_gust_meter_sec_fp1 = wgst_raw;
-        sensor[slot].w.wind_avg_meter_sec_fp1 = wavg_raw;
-        sensor[slot].w.wind_direction_deg_fp1 = wdir * 10;
+            sensor[slot].w.wind_gust_meter_sec_fp1 = wgst_raw;
+            sensor[slot].w.wind_avg_meter_sec_fp1 = wavg_raw;
+            sensor[slot].w.wind_direction_deg_fp1 = wdir * 10;
 #endif
-        sensor[slot].w.rain_mm = rain_mm;
-        sensor[slot].w.light_klx = light_klx;
-        sensor[slot].w.light_lux = light_lux;
-        sensor[slot].w.uv = uv_index;
-
-        if (s_type == SENSOR_TYPE_WEATHER2)
+        }
+        if (mask & FIELD_RAIN)
+        {
+            int rain_raw = (msgw[10] >> 4) * 100000 + (msgw[10] & 0x0f) * 10000 + (msgw[11] >> 4) * 1000 + (msgw[11] & 0x0f) * 100 + (msgw[12] >> 4) * 10 + (msgw[12] & 0x0f) * 1; // 6 digits
+            sensor[slot].w.rain_mm = rain_raw * 0.1f;
+        }
+        if (mask & FIELD_TEMP)
+        {
+            int temp_raw = (msgw[14] >> 4) * 100 + (msgw[14] & 0x0f) * 10 + (msgw[15] >> 4);
+            float temp_c = temp_raw * 0.1f;
+            if (temp_raw > 600)
+                temp_c = (temp_raw - 1000) * 0.1f;
+            sensor[slot].w.temp_c = temp_c;
+        }
+        if (mask & FIELD_HUMIDITY)
+        {
+            sensor[slot].w.humidity = (msgw[16] >> 4) * 10 + (msgw[16] & 0x0f);
+        }
+        if (mask & FIELD_LIGHT)
+        {
+            int lght_raw = (msgw[17] >> 4) * 100000 + (msgw[17] & 0x0f) * 10000 + (msgw[18] >> 4) * 1000 + (msgw[18] & 0x0f) * 100 + (msgw[19] >> 4) * 10 + (msgw[19] & 0x0f);
+            sensor[slot].w.light_klx = lght_raw * 0.001f; // TODO: remove this
+            sensor[slot].w.light_lux = lght_raw;
+        }
+        if (mask & FIELD_UV)
+        {
+            int uv_raw = (msgw[20] >> 4) * 100 + (msgw[20] & 0x0f) * 10 + (msgw[21] >> 4);
+            sensor[slot].w.uv = uv_raw * 0.1f;
+        }
+        if ((s_type == SENSOR_TYPE_WEATHER2) && (mask & FIELD_TGLOBE))
         {
             // 8-in-1 sensor
-            if ((msgw[23] >> 4) < 10) {
-                sensor[slot].w.tglobe_ok = true;
-            }
             sensor[slot].w.tglobe_c = (msgw[22] >> 4) * 10 + (msgw[22] & 0x0f) + (msgw[23] >> 4) * 0.1f;
         }
     }
-    else if (s_type == SENSOR_TYPE_AIR_PM)
+    else if ((s_type == SENSOR_TYPE_AIR_PM) && (mask & FIELD_AIR))
     {
 #if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
         uint16_t pn1 = (msgw[14] & 0x0f) * 1000 + (msgw[15] >> 4) * 100 + (msgw[15] & 0x0f) * 10 + (msgw[16] >> 4);
@@ -819,24 +1101,16 @@ DecodeStatus WeatherSensor::decodeBresser7In1Payload(const uint8_t *msg, uint8_t
         sensor[slot].pm.pm_1_0 = (msgw[8] & 0x0f) * 1000 + (msgw[9] >> 4) * 100 + (msgw[9] & 0x0f) * 10 + (msgw[10] >> 4);
         sensor[slot].pm.pm_2_5 = (msgw[10] & 0x0f) * 1000 + (msgw[11] >> 4) * 100 + (msgw[11] & 0x0f) * 10 + (msgw[12] >> 4);
         sensor[slot].pm.pm_10 = (msgw[12] & 0x0f) * 1000 + (msgw[13] >> 4) * 100 + (msgw[13] & 0x0f) * 10 + (msgw[14] >> 4);
-        sensor[slot].pm.pm_1_0_init = ((msgw[10] >> 4) & 0x0f) == 0x0f;
-        sensor[slot].pm.pm_2_5_init = ((msgw[12] >> 4) & 0x0f) == 0x0f;
-        sensor[slot].pm.pm_10_init = ((msgw[14] >> 4) & 0x0f) == 0x0f;
     }
-    else if (s_type == SENSOR_TYPE_CO2)
+    else if ((s_type == SENSOR_TYPE_CO2) && (mask & FIELD_AIR))
     {
         sensor[slot].co2.co2_ppm = ((msgw[4] & 0xf0) >> 4) * 1000 + (msgw[4] & 0x0f) * 100 + ((msgw[5] & 0xf0) >> 4) * 10 + (msgw[5] & 0x0f);
-        sensor[slot].co2.co2_init = (msgw[5] & 0x0f) == 0x0f;
     }
-    else if (s_type == SENSOR_TYPE_HCHO_VOC)
+    else if ((s_type == SENSOR_TYPE_HCHO_VOC) && (mask & FIELD_AIR))
     {
         sensor[slot].voc.hcho_ppb = ((msgw[4] & 0xf0) >> 4) * 1000 + (msgw[4] & 0x0f) * 100 + ((msgw[5] & 0xf0) >> 4) * 10 + (msgw[5] & 0x0f);
         sensor[slot].voc.voc_level = (msgw[22] & 0x0f);
-        sensor[slot].voc.hcho_init = (msgw[5] & 0x0f) == 0x0f;
-        sensor[slot].voc.voc_init = msgw[22] == 0x0f;
     }
-
-    return DECODE_OK;
 }
 #endif
 
@@ -862,7 +1136,6 @@ First two bytes are an LFSR-16 digest, generator 0x8810 key 0xabf9 with a final
 #ifdef BRESSER_LIGHTNING
 DecodeStatus WeatherSensor::decodeBresserLightningPayload(const uint8_t *msg, uint8_t msgSize)
 {
-    (void)msgSize;
 #if CORE_DEBUG_LEVEL == ARDUHAL_LOG_LEVEL_VERBOSE
     // see AS3935 Datasheet, Table 17 - Distance Estimation
     uint8_t const distance_map[] = {1, 5, 6, 8, 10, 12, 14, 17, 20, 24, 27, 31, 34, 37, 40, 63};
@@ -873,15 +1146,23 @@ DecodeStatus WeatherSensor::decodeBresserLightningPayload(const uint8_t *msg, ui
                            0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x15};
 #endif
 
+#if defined(LIGHTNING_TEST_DATA)
+    msg = test_data;
+#endif
+
+    // Known sensor type and BCD strike counter
+    if (!precheckLightning(msg, msgSize))
+    {
+        log_d("Type or BCD check failed");
+        rejectStats.early[DECODER_IDX_LIGHTNING]++;
+        return DECODE_INVALID;
+    }
+
     // data de-whitening
     uint8_t msgw[MSG_BUF_SIZE];
     for (unsigned i = 0; i < msgSize; ++i)
     {
-#if defined(LIGHTNING_TEST_DATA)
-        msgw[i] = test_data[i] ^ 0xaa;
-#else
         msgw[i] = msg[i] ^ 0xaa;
-#endif
     }
 
     // LFSR-16 digest, generator 0x8810 key 0xabf9 with a final xor 0x899e
@@ -890,6 +1171,7 @@ DecodeStatus WeatherSensor::decodeBresserLightningPayload(const uint8_t *msg, ui
     if (((chk ^ digest) != 0x899e))
     {
         log_d("Digest check failed - [%04X] vs [%04X] (%04X)", chk, digest, chk ^ digest);
+        rejectStats.integrity[DECODER_IDX_LIGHTNING]++;
         return DECODE_DIG_ERR;
     }
 
@@ -898,14 +1180,14 @@ DecodeStatus WeatherSensor::decodeBresserLightningPayload(const uint8_t *msg, ui
     log_message("De-whitened Data", msgw, msgSize);
 #endif
 
-    int id_tmp = (msgw[2] << 8) | (msgw[3]);
+    uint32_t id_tmp = (msgw[2] << 8) | (msgw[3]);
     int s_type = msg[6] >> 4;
     int startup = (msg[6] & 0x8) == 0x00;
 
     DecodeStatus status;
 
     // Find appropriate slot in sensor data array and update <status>
-    int slot = findSlot(id_tmp, &status);
+    int slot = findLogicalSlot(id_tmp, DECODER_LIGHTNING, s_type, 0, startup, &status);
 
     if (status != DECODE_OK)
         return status;
@@ -934,7 +1216,7 @@ DecodeStatus WeatherSensor::decodeBresserLightningPayload(const uint8_t *msg, ui
     sensor[slot].lgt.unknown1 = unknown1;
     sensor[slot].lgt.unknown2 = unknown2;
 
-    log_d("ID: 0x%04X  TYPE: %d  CTR: %u  batt_low: %d  distance_km: %d  unknown1: 0x%x  unknown2: 0x%04x", id_tmp, s_type, ctr, battery_low, distance_km, unknown1, unknown2);
+    log_d("ID: 0x%04X  TYPE: %d  CTR: %u  batt_low: %d  distance_km: %d  unknown1: 0x%x  unknown2: 0x%04x", (unsigned int)id_tmp, s_type, ctr, battery_low, distance_km, unknown1, unknown2);
 
     return DECODE_OK;
 }
@@ -987,16 +1269,22 @@ DecodeStatus WeatherSensor::decodeBresserLeakagePayload(const uint8_t *msg, uint
 {
 #if CORE_DEBUG_LEVEL == ARDUHAL_LOG_LEVEL_VERBOSE
     log_message("Data", msg, msgSize);
-#else
-    (void)msgSize;
 #endif
 
+    // Sanity checks (type, channel, alarm flags)
+    if (!precheckLeakage(msg, msgSize))
+    {
+        rejectStats.early[DECODER_IDX_LEAKAGE]++;
+        return DECODE_INVALID;
+    }
+
     // Verify CRC (CRC16/XMODEM)
     uint16_t crc_act = crc16(&msg[2], 5, 0x1021, 0x0000);
     uint16_t crc_exp = (msg[0] << 8) | msg[1];
     if (crc_act != crc_exp)
     {
         log_d("CRC16 check failed - [%04X] vs [%04X]", crc_act, crc_exp);
+        rejectStats.integrity[DECODER_IDX_LEAKAGE]++;
         return DECODE_CHK_ERR;
     }
 
@@ -1006,18 +1294,10 @@ DecodeStatus WeatherSensor::decodeBresserLeakagePayload(const uint8_t *msg, uint
     bool alarm = (msg[7] & 0x80) == 0x80;
     bool no_alarm = (msg[7] & 0x40) == 0x40;
 
-    // Sanity checks
-    bool decode_ok = (type_tmp == SENSOR_TYPE_LEAKAGE) &&
-                     (alarm != no_alarm) &&
-                     (chan_tmp != 0);
-
-    if (!decode_ok)
-        return DECODE_INVALID;
-
     DecodeStatus status = DECODE_OK;
 
     // Find appropriate slot in sensor data array and update <status>
-    int slot = findSlot(id_tmp, &status);
+    int slot = findLogicalSlot(id_tmp, DECODER_LEAKAGE, type_tmp, chan_tmp, (msg[6] & 0x8) == 0x00, &status);
 
     if (status != DECODE_OK)
         return status;
@@ -0,0 +1,282 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WeatherSensorRtc.cpp
+//
+// Retention of sensor data in RTC RAM during deep sleep
+//
+// Bresser 5-in-1/6-in-1/7-in1 868 MHz Weather Sensor Radio Receiver
+// based on CC1101 or SX1276/RFM95W and ESP32/ESP8266
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+//
+// 20250415 Created
+// 20250416 saveSlots(): decode pending fields (lazy decoding) before saving
+// 20250507 Unit tests: keep SlotImage in memory (simulated RTC RAM)
+// 20250508 Storage of SlotImage provided by the application (see setSlotImage()),
+//          replaces unit test specific handling
+//
+//
+// ToDo:
+// -
+//
+// Notes:
+// - ESP32:   SlotImage is located in RTC slow memory (RTC_DATA_ATTR)
+// - ESP8266: SlotImage is copied from/to RTC user memory at SLOTS_RTC_OFFSET;
+//            the WakeCycle data is located in front of it
+// - Other architectures: no retention; restoreSlots() always fails
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "WeatherSensorCfg.h"
+#include "WeatherSensor.h"
+
+// Magic number for validation of SlotImage
+#define SLOTS_RTC_MAGIC 0x534C5431 // "SLT1"
+
+#if defined(ESP32)
+RTC_DATA_ATTR WeatherSensor::SlotImage rtcSlotImage;
+#endif
+
+#if defined(ESP8266)
+static_assert(WAKE_CYCLE_RTC_OFFSET * 4 + sizeof(nvWakeCycle_t) <= SLOTS_RTC_OFFSET * 4,
+              "WakeCycle data overlaps SlotImage in RTC user memory");
+static_assert(SLOTS_RTC_OFFSET * 4 + sizeof(WeatherSensor::SlotImage) <= 512,
+              "SlotImage exceeds RTC user memory");
+#endif
+
+// Get pointer to SlotImage
+WeatherSensor::SlotImage *WeatherSensor::slotImage(void)
+{
+    if (slotImg)
+        return slotImg;
+
+    #if defined(ESP32) || defined(ESP8266)
+    return &rtcSlotImage;
+    #else
+    return nullptr;
+    #endif
+}
+
+// Save sensor data slots to RTC RAM
+void WeatherSensor::saveSlots(uint32_t sleep_ms)
+{
+    SlotImage *img = slotImage();
+    if (!img)
+    {
+        log_d("No storage for slot image");
+        return;
+    }
+
+    uint8_t count = 0;
+    for (size_t i = 0; (i < sensor.size()) && (count < SLOTS_RTC_MAX); i++)
+    {
+        if (!sensor[i].valid)
+            continue;
+
+        // Raw payloads are not retained - decode pending fields
+        sensor_t tmp = fields(i);
+
+        // Convert time of reception to time base retained in RTC RAM
+        tmp.rx_time = rtcClock + tmp.rx_time;
+        tmp.restored = false;
+        memcpy(img->slots[count++], &tmp, sizeof(sensor_t));
+    }
+
+    img->magic = SLOTS_RTC_MAGIC;
+    img->clock = rtcClock + millis() + sleep_ms;
+    img->completions = rtcCompletions;
+    img->early = rtcEarly;
+    img->slotSize = sizeof(sensor_t);
+    img->count = count;
+    img->reserved = 0;
+    img->reserved2 = 0;
+    img->crc = 0;
+    img->crc = crc16(reinterpret_cast<const uint8_t *>(img), sizeof(SlotImage), 0x1021, 0xFFFF);
+
+    #if defined(ESP8266)
+    if (img == &rtcSlotImage)
+        ESP.rtcUserMemoryWrite(SLOTS_RTC_OFFSET, reinterpret_cast<uint32_t *>(img), sizeof(SlotImage));
+    #endif
+
+    // Previous data has been overwritten
+    rtcImageValid = false;
+
+    log_d("Saved %u slots", count);
+}
+
+// Restore sensor data slots from RTC RAM
+uint8_t WeatherSensor::restoreSlots(uint32_t max_age)
+{
+    SlotImage *img = slotImage();
+
+    #if defined(ESP8266)
+    if (img == &rtcSlotImage)
+        ESP.rtcUserMemoryRead(SLOTS_RTC_OFFSET, reinterpret_cast<uint32_t *>(img), sizeof(SlotImage));
+    #endif
+
+    rtcImageValid = false;
+    rtcClock = 0;
+
+    if (!img || (img->magic != SLOTS_RTC_MAGIC) || (img->slotSize != sizeof(sensor_t)) || (img->count > SLOTS_RTC_MAX))
+    {
+        log_d("No valid data in RTC RAM");
+        return 0;
+    }
+
+    uint16_t crc = img->crc;
+    img->crc = 0;
+    if (crc != crc16(reinterpret_cast<const uint8_t *>(img), sizeof(SlotImage), 0x1021, 0xFFFF))
+    {
+        log_d("CRC error in RTC RAM data");
+        return 0;
+    }
+    img->crc = crc;
+
+    rtcImageValid = true;
+    rtcClock = img->clock;
+    rtcCompletions = img->completions;
+    rtcEarly = img->early;
+
+    uint32_t now = millis();
+    uint8_t restored = 0;
+    for (uint8_t n = 0; n < img->count; n++)
+    {
+        sensor_t tmp;
+        memcpy(&tmp, img->slots[n], sizeof(sensor_t));
+
+        // Age of entry in ms (relative to time base at boot)
+        uint32_t age = rtcClock + now - tmp.rx_time;
+        if (!tmp.valid || (age / 1000 > max_age))
+        {
+            log_d("ID 0x%08X: stale, skipping", (unsigned int)tmp.sensor_id);
+            continue;
+        }
+
+        // Decoder disabled in the meantime?
+        if (!(enDecoders & tmp.decoder))
+            continue;
+
+        // Include/exclude lists changed in the meantime?
+        bool skip = false;
+        for (const uint32_t &exc : sensor_ids_exc)
+        {
+            if (tmp.sensor_id == exc)
+                skip = true;
+        }
+        if (sensor_ids_inc.size() > 0)
+        {
+            bool found = false;
+            for (const uint32_t &inc : sensor_ids_inc)
+            {
+                if (tmp.sensor_id == inc)
+                    found = true;
+            }
+            skip |= !found;
+        }
+        if (skip)
+            continue;
+
+        // Find slot which is neither valid nor restored
+        int slot = -1;
+        for (size_t i = 0; i < sensor.size(); i++)
+        {
+            if (!sensor[i].valid && !sensor[i].restored)
+            {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0)
+            break;
+
+        // Not visible in getData() until updated by a new message
+        tmp.valid = false;
+        tmp.complete = false;
+        tmp.restored = true;
+        tmp.rx_time = now - age;
+        sensor[slot] = tmp;
+        clearPending(slot);
+        restored++;
+        log_d("ID 0x%08X: restored to slot #%d (age: %u s)", (unsigned int)tmp.sensor_id, slot, (unsigned)(age / 1000));
+    }
+
+    return restored;
+}
+
+// Get sensor data of previous wake cycle
+bool WeatherSensor::getPrevious(uint32_t id, sensor_t &prev)
+{
+    if (!rtcImageValid)
+        return false;
+
+    SlotImage *img = slotImage();
+    for (uint8_t n = 0; n < img->count; n++)
+    {
+        sensor_t tmp;
+        memcpy(&tmp, img->slots[n], sizeof(sensor_t));
+        if (tmp.sensor_id == id)
+        {
+            prev = tmp;
+            prev.rx_time = tmp.rx_time - rtcClock;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Get statistics of getData() completion with restored data
+void WeatherSensor::getRestoreStats(uint32_t &completions, uint32_t &early)
+{
+    completions = rtcCompletions;
+    early = rtcEarly;
+}
+
+// Update restore statistics after successful getData()
+void WeatherSensor::countCompletion(int slot)
+{
+    rtcCompletions++;
+
+    if (slot > -1)
+    {
+        if (sensor[slot].restored)
+            rtcEarly++;
+        return;
+    }
+
+    for (size_t i = 0; i < sensor.size(); i++)
+    {
+        if (sensor[i].valid && sensor[i].restored)
+        {
+            rtcEarly++;
+            break;
+        }
+    }
+}
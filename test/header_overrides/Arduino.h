@@ -1,7 +1,13 @@
+#include <algorithm>
 #include "WStringMock.h"
+#include "TimeMock.h"
+
+using std::max;
+using std::min;
 
 #define RTC_DATA_ATTR static
 #define log_e(...) { printf(__VA_ARGS__); printf("\n"); }
 #define log_w(...) { printf(__VA_ARGS__); printf("\n"); }
+#define log_i(...) { printf(__VA_ARGS__); printf("\n"); }
 #define log_d(...) { printf(__VA_ARGS__); printf("\n"); }
 #define log_v(...) { printf(__VA_ARGS__); printf("\n"); }
@@ -1 +1,170 @@
-// Intentionally left empty
\ No newline at end of file
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Preferences.h
+//
+// Mock of ESP32 Preferences (non-volatile storage) for unit tests
+//
+// Data is kept in a small static table (without heap allocation) which is shared by all
+// instances, i.e. it is retained like NVS data when an object is re-created.
+// mockPrefsClear() erases all data (e.g. in a test's setup()).
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250507 Created (previously empty)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _PREFERENCES_MOCK_H
+#define _PREFERENCES_MOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MOCK_PREFS_ENTRIES  16
+#define MOCK_PREFS_KEY_SIZE 32
+#define MOCK_PREFS_VAL_SIZE 128
+
+struct MockPrefsEntry {
+    char    key[MOCK_PREFS_KEY_SIZE];   // "<namespace>/<key>"
+    uint8_t val[MOCK_PREFS_VAL_SIZE];
+    size_t  len;
+    bool    used;
+};
+
+inline MockPrefsEntry *mockPrefsTable(void)
+{
+    static MockPrefsEntry table[MOCK_PREFS_ENTRIES];
+    return table;
+}
+
+// Number of write accesses (putX(), remove())
+inline unsigned &mockPrefsWrites(void)
+{
+    static unsigned writes;
+    return writes;
+}
+
+inline void mockPrefsClear(void)
+{
+    memset(mockPrefsTable(), 0, sizeof(MockPrefsEntry) * MOCK_PREFS_ENTRIES);
+    mockPrefsWrites() = 0;
+}
+
+class Preferences {
+private:
+    char ns[16] = "";
+
+    MockPrefsEntry *find(const char *key, bool create)
+    {
+        char name[MOCK_PREFS_KEY_SIZE];
+        snprintf(name, sizeof(name), "%s/%s", ns, key);
+        MockPrefsEntry *table = mockPrefsTable();
+        MockPrefsEntry *free_entry = nullptr;
+        for (int i = 0; i < MOCK_PREFS_ENTRIES; i++) {
+            if (table[i].used && (strcmp(table[i].key, name) == 0))
+                return &table[i];
+            if (!table[i].used && !free_entry)
+                free_entry = &table[i];
+        }
+        if (!create || !free_entry)
+            return nullptr;
+        free_entry->used = true;
+        free_entry->len = 0;
+        strcpy(free_entry->key, name);
+        return free_entry;
+    }
+
+public:
+    bool begin(const char *name, bool readOnly = false)
+    {
+        (void)readOnly;
+        snprintf(ns, sizeof(ns), "%s", name);
+        return true;
+    }
+
+    void end(void) {}
+
+    bool isKey(const char *key)
+    {
+        return find(key, false) != nullptr;
+    }
+
+    bool remove(const char *key)
+    {
+        MockPrefsEntry *e = find(key, false);
+        mockPrefsWrites()++;
+        if (e)
+            e->used = false;
+        return e != nullptr;
+    }
+
+    size_t putBytes(const char *key, const void *value, size_t len)
+    {
+        MockPrefsEntry *e = find(key, true);
+        if (!e || (len > MOCK_PREFS_VAL_SIZE))
+            return 0;
+        memcpy(e->val, value, len);
+        e->len = len;
+        mockPrefsWrites()++;
+        return len;
+    }
+
+    size_t getBytesLength(const char *key)
+    {
+        MockPrefsEntry *e = find(key, false);
+        return e ? e->len : 0;
+    }
+
+    size_t getBytes(const char *key, void *buf, size_t maxLen)
+    {
+        MockPrefsEntry *e = find(key, false);
+        if (!e || (e->len > maxLen))
+            return 0;
+        memcpy(buf, e->val, e->len);
+        return e->len;
+    }
+
+    size_t putUChar(const char *key, uint8_t value)
+    {
+        return putBytes(key, &value, 1);
+    }
+
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0)
+    {
+        uint8_t value;
+        return (getBytes(key, &value, 1) == 1) ? value : defaultValue;
+    }
+};
+#endif // _PREFERENCES_MOCK_H
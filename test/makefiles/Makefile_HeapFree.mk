@@ -0,0 +1,22 @@
+COMPONENT_NAME=HeapFree
+
+SRC_FILES = \
+  $(PROJECT_SRC_DIR)/RainGauge.cpp \
+  $(PROJECT_SRC_DIR)/Lightning.cpp \
+  $(PROJECT_SRC_DIR)/DecoderPrecheck.cpp \
+  $(PROJECT_SRC_DIR)/SensorRecord.cpp \
+  $(PROJECT_SRC_DIR)/PromMetrics.cpp \
+  $(PROJECT_SRC_DIR)/SensorIdentity.cpp \
+  $(PROJECT_SRC_DIR)/DataPredicate.cpp \
+  $(PROJECT_SRC_DIR)/SensorIdsJson.cpp
+
+MOCKS_SRC_DIRS = \
+  $(UNITTEST_ROOT)/mocks
+
+TEST_SRC_FILES = \
+  $(UNITTEST_SRC_DIR)/TestHeapFree.cpp
+
+# Heap-free build profile (see WeatherSensorCfg.h)
+CPPUTEST_CPPFLAGS += -DWEATHERSENSOR_HEAP_FREE
+
+include $(CPPUTEST_MAKFILE_INFRA)
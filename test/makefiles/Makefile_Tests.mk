@@ -2,14 +2,51 @@ COMPONENT_NAME=RainGauge
 
 SRC_FILES = \
   $(PROJECT_SRC_DIR)/RainGauge.cpp \
-  $(PROJECT_SRC_DIR)/Lightning.cpp
+  $(PROJECT_SRC_DIR)/Lightning.cpp \
+  $(PROJECT_SRC_DIR)/WakeCycle.cpp \
+  $(PROJECT_SRC_DIR)/DecoderPrecheck.cpp \
+  $(PROJECT_SRC_DIR)/SensorRecord.cpp \
+  $(PROJECT_SRC_DIR)/PromMetrics.cpp \
+  $(PROJECT_SRC_DIR)/SensorIdentity.cpp \
+  $(PROJECT_SRC_DIR)/DataPredicate.cpp \
+  $(PROJECT_SRC_DIR)/MemStats.cpp \
+  $(PROJECT_SRC_DIR)/RecordFusion.cpp \
+  $(PROJECT_SRC_DIR)/SensorOwnership.cpp \
+  $(PROJECT_SRC_DIR)/Trace.cpp \
+  $(PROJECT_SRC_DIR)/NoiseFloor.cpp \
+  $(PROJECT_SRC_DIR)/DigestBatch.cpp \
+  $(PROJECT_SRC_DIR)/SensorFields.cpp \
+  $(PROJECT_SRC_DIR)/SensorBus.cpp \
+  $(PROJECT_SRC_DIR)/SensorMailbox.cpp \
+  $(PROJECT_SRC_DIR)/AirQuality.cpp \
+  $(PROJECT_SRC_DIR)/Evapotranspiration.cpp \
+  $(PROJECT_SRC_DIR)/Checkpoint.cpp \
+  $(PROJECT_ROOT_DIR)/extras/udp_receiver/UdpRecordReceiver.cpp
 
 MOCKS_SRC_DIRS = \
   $(UNITTEST_ROOT)/mocks
 
 TEST_SRC_FILES = \
   $(UNITTEST_SRC_DIR)/TestRainGauge.cpp \
-  $(UNITTEST_SRC_DIR)/TestLightning.cpp
+  $(UNITTEST_SRC_DIR)/TestLightning.cpp \
+  $(UNITTEST_SRC_DIR)/TestWakeCycle.cpp \
+  $(UNITTEST_SRC_DIR)/TestDecoderPrecheck.cpp \
+  $(UNITTEST_SRC_DIR)/TestSensorRecord.cpp \
+  $(UNITTEST_SRC_DIR)/TestPromMetrics.cpp \
+  $(UNITTEST_SRC_DIR)/TestSensorIdentity.cpp \
+  $(UNITTEST_SRC_DIR)/TestDataPredicate.cpp \
+  $(UNITTEST_SRC_DIR)/TestMemStats.cpp \
+  $(UNITTEST_SRC_DIR)/TestRecordFusion.cpp \
+  $(UNITTEST_SRC_DIR)/TestSensorOwnership.cpp \
+  $(UNITTEST_SRC_DIR)/TestTraceDisabled.cpp \
+  $(UNITTEST_SRC_DIR)/TestNoiseFloor.cpp \
+  $(UNITTEST_SRC_DIR)/TestDigestBatch.cpp \
+  $(UNITTEST_SRC_DIR)/TestSensorFields.cpp \
+  $(UNITTEST_SRC_DIR)/TestSensorBus.cpp \
+  $(UNITTEST_SRC_DIR)/TestSensorMailbox.cpp \
+  $(UNITTEST_SRC_DIR)/TestAirQuality.cpp \
+  $(UNITTEST_SRC_DIR)/TestEvapotranspiration.cpp \
+  $(UNITTEST_SRC_DIR)/TestCheckpoint.cpp
   #$(UNITTEST_SRC_DIR)/TestRainGaugeReal.cpp
   
 include $(CPPUTEST_MAKFILE_INFRA)
@@ -0,0 +1,17 @@
+COMPONENT_NAME=Trace
+
+SRC_FILES = \
+  $(PROJECT_SRC_DIR)/Trace.cpp \
+  $(PROJECT_SRC_DIR)/SensorRecord.cpp \
+  $(PROJECT_SRC_DIR)/DataPredicate.cpp
+
+MOCKS_SRC_DIRS = \
+  $(UNITTEST_ROOT)/mocks
+
+TEST_SRC_FILES = \
+  $(UNITTEST_SRC_DIR)/TestTrace.cpp
+
+# Event tracing enabled (see WeatherSensorCfg.h)
+CPPUTEST_CPPFLAGS += -DWEATHERSENSOR_TRACE
+
+include $(CPPUTEST_MAKFILE_INFRA)
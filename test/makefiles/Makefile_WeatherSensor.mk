@@ -0,0 +1,31 @@
+COMPONENT_NAME=WeatherSensor
+
+SRC_FILES = \
+  $(PROJECT_SRC_DIR)/WeatherSensor.cpp \
+  $(PROJECT_SRC_DIR)/WeatherSensorDecoders.cpp \
+  $(PROJECT_SRC_DIR)/WeatherSensorConfig.cpp \
+  $(PROJECT_SRC_DIR)/WeatherSensorRtc.cpp \
+  $(PROJECT_SRC_DIR)/SensorIdsJson.cpp \
+  $(PROJECT_SRC_DIR)/DecoderPrecheck.cpp \
+  $(PROJECT_SRC_DIR)/SensorIdentity.cpp \
+  $(PROJECT_SRC_DIR)/DataPredicate.cpp \
+  $(PROJECT_SRC_DIR)/WakeCycle.cpp \
+  $(PROJECT_SRC_DIR)/MemStats.cpp \
+  $(PROJECT_SRC_DIR)/NoiseFloor.cpp \
+  $(PROJECT_SRC_DIR)/Trace.cpp \
+  $(PROJECT_SRC_DIR)/SensorFields.cpp \
+  $(PROJECT_SRC_DIR)/DigestBatch.cpp
+
+MOCKS_SRC_DIRS = \
+  $(UNITTEST_ROOT)/mocks
+
+TEST_SRC_FILES = \
+  $(UNITTEST_SRC_DIR)/TestWeatherSensor.cpp
+
+# Heap-free build profile with mocked radio (see mocks/RadioLib.h)
+CPPUTEST_CPPFLAGS += -DWEATHERSENSOR_HEAP_FREE -DUSE_SX1276
+# Optional features (compiled out in Makefile_WeatherSensorCC1101.mk)
+CPPUTEST_CPPFLAGS += -DWEATHERSENSOR_LAZY_DECODING -DWEATHERSENSOR_LOGICAL_IDS -DWEATHERSENSOR_DATA_REQUIRED
+CPPUTEST_CPPFLAGS += -DPIN_RECEIVER_CS=1 -DPIN_RECEIVER_IRQ=2 -DPIN_RECEIVER_RST=3 -DPIN_RECEIVER_GPIO=4
+
+include $(CPPUTEST_MAKFILE_INFRA)
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RadioLib.h
+//
+// Mock of RadioLib radio modules (SX1276, CC1101) for unit tests of WeatherSensor
+//
+// The test injects received packets with MockRadio::inject(); this triggers the packet
+// received action set by WeatherSensor::begin(). The RSSI of the channel between packets
+// (instantaneous RSSI) is set with MockRadio::rssiInst.
+//
+// As with RadioLib, getRSSI() of CC1101 returns the RSSI latched for the last received
+// packet (packet mode); SX1276 provides the current RSSI with getRSSI(false, true).
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250507 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _RADIOLIB_MOCK_H
+#define _RADIOLIB_MOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define RADIOLIB_ERR_NONE        0
+#define RADIOLIB_ERR_RX_TIMEOUT  (-6)
+#define RADIOLIB_NC              (0xFFFFFFFF)
+
+#define MOCK_RADIO_BUF_SIZE      64
+
+class Module {
+public:
+    Module(uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio)
+    {
+        (void)cs; (void)irq; (void)rst; (void)gpio;
+    }
+};
+
+class MockRadio {
+protected:
+    void (*action)(void) = nullptr;
+    uint8_t buf[MOCK_RADIO_BUF_SIZE];
+    size_t  len = 0;
+
+public:
+    float rssiPacket = 0;       //!< RSSI of last received packet [dBm]
+    float rssiInst = -120;      //!< RSSI of channel between packets [dBm]
+    bool  receiving = false;    //!< radio in receive mode
+
+    MockRadio(Module *mod)
+    {
+        // Module is owned by the radio object (global instance, never destroyed)
+        (void)mod;
+    }
+
+    // Test interface: receive packet
+    void inject(const uint8_t *data, size_t size, float rssi)
+    {
+        len = (size < sizeof(buf)) ? size : sizeof(buf);
+        memset(buf, 0, sizeof(buf));
+        memcpy(buf, data, len);
+        rssiPacket = rssi;
+        if (action)
+            action();
+    }
+
+    int16_t begin(float freq, float br, float freqDev, float rxBw, int8_t pwr, uint8_t preambleLength)
+    {
+        (void)freq; (void)br; (void)freqDev; (void)rxBw; (void)pwr; (void)preambleLength;
+        return RADIOLIB_ERR_NONE;
+    }
+    int16_t beginFSK(float freq, float br, float freqDev, float rxBw, int8_t pwr, uint16_t preambleLength)
+    {
+        return begin(freq, br, freqDev, rxBw, pwr, preambleLength);
+    }
+    int16_t fixedPacketLengthMode(uint8_t length)            { (void)length; return RADIOLIB_ERR_NONE; }
+    int16_t setCrcFiltering(bool enable)                     { (void)enable; return RADIOLIB_ERR_NONE; }
+    int16_t setSyncWord(uint8_t *sync, size_t size)          { (void)sync; (void)size; return RADIOLIB_ERR_NONE; }
+    int16_t setSyncWord(uint8_t sync_h, uint8_t sync_l, uint8_t max_err = 0, bool req_cs = false)
+    {
+        (void)sync_h; (void)sync_l; (void)max_err; (void)req_cs;
+        return RADIOLIB_ERR_NONE;
+    }
+    void    setPacketReceivedAction(void (*func)(void))      { action = func; }
+    int16_t startReceive(void)                               { receiving = true; return RADIOLIB_ERR_NONE; }
+    int16_t standby(void)                                    { receiving = false; return RADIOLIB_ERR_NONE; }
+    int16_t sleep(void)                                      { receiving = false; return RADIOLIB_ERR_NONE; }
+    void    reset(void)                                      {}
+
+    int16_t readData(uint8_t *data, size_t size)
+    {
+        memcpy(data, buf, (size < sizeof(buf)) ? size : sizeof(buf));
+        return RADIOLIB_ERR_NONE;
+    }
+};
+
+class SX1276 : public MockRadio {
+public:
+    SX1276(Module *mod) : MockRadio(mod) {}
+
+    // packet: RSSI of last packet, otherwise current RSSI
+    float getRSSI(bool packet = true, bool skipReceiverCheck = false)
+    {
+        (void)skipReceiverCheck;
+        return packet ? rssiPacket : rssiInst;
+    }
+};
+
+class CC1101 : public MockRadio {
+public:
+    CC1101(Module *mod) : MockRadio(mod) {}
+
+    // Packet mode: RSSI latched for last received packet
+    float getRSSI(void)
+    {
+        return rssiPacket;
+    }
+};
+#endif // _RADIOLIB_MOCK_H
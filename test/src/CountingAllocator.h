@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CountingAllocator.h
+//
+// CppUTest helper - count heap allocations (new, new[], malloc) while installed
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20250508 Created (moved from TestHeapFree.cpp)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _COUNTING_ALLOCATOR_H
+#define _COUNTING_ALLOCATOR_H
+
+#include "CppUTest/TestMemoryAllocator.h"
+
+/*
+ * Allocator counting allocations while installed
+ */
+class CountingAllocator : public TestMemoryAllocator {
+  TestMemoryAllocator *real;
+
+public:
+  size_t count;
+
+  CountingAllocator(TestMemoryAllocator *allocator) :
+    TestMemoryAllocator(allocator->name(), allocator->alloc_name(), allocator->free_name()),
+    real(allocator), count(0) {}
+
+  char *alloc_memory(size_t size, const char *file, size_t line) override {
+    count++;
+    return real->alloc_memory(size, file, line);
+  }
+
+  void free_memory(char *memory, size_t size, const char *file, size_t line) override {
+    real->free_memory(memory, size, file, line);
+  }
+};
+
+/*
+ * Counting allocators for new, new[] and malloc
+ *
+ * Create in a test group's setup(), destroy in teardown().
+ */
+class AllocationCounter {
+  TestMemoryAllocator *origNew;
+  TestMemoryAllocator *origNewArray;
+  TestMemoryAllocator *origMalloc;
+  CountingAllocator   newAlloc;
+  CountingAllocator   newArrayAlloc;
+  CountingAllocator   mallocAlloc;
+
+public:
+  AllocationCounter() :
+    origNew(getCurrentNewAllocator()),
+    origNewArray(getCurrentNewArrayAllocator()),
+    origMalloc(getCurrentMallocAllocator()),
+    newAlloc(origNew), newArrayAlloc(origNewArray), mallocAlloc(origMalloc) {}
+
+  ~AllocationCounter() {
+    stop();
+  }
+
+  // End of initialization - count all allocations from now on
+  void start(void) {
+    setCurrentNewAllocator(&newAlloc);
+    setCurrentNewArrayAllocator(&newArrayAlloc);
+    setCurrentMallocAllocator(&mallocAlloc);
+  }
+
+  // Stop counting, returns number of allocations
+  size_t stop(void) {
+    setCurrentNewAllocator(origNew);
+    setCurrentNewArrayAllocator(origNewArray);
+    setCurrentMallocAllocator(origMalloc);
+    return newAlloc.count + newArrayAlloc.count + mallocAlloc.count;
+  }
+};
+
+#endif // _COUNTING_ALLOCATOR_H
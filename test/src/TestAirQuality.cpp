@@ -0,0 +1,348 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestAirQuality.cpp
+//
+// CppUTest unit tests for AirQuality (PM NowCast and Air Quality Index)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250504 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <math.h>
+#include <string.h>
+#include "AirQuality.h"
+
+#define TOLERANCE 0.001
+
+// Start of an hour (2025-04-30 08:00:00 UTC)
+#define T0 1746000000
+
+static AirQuality *aq;
+
+// Feed one hour of PM2.5 (and PM10 = 2 * PM2.5) samples, every 6 minutes
+// (value < 0: no samples)
+static void feedHour(int hour, float pm2_5)
+{
+  if (pm2_5 < 0)
+    return;
+  for (int m = 0; m < 60; m += 6)
+    aq->update(T0 + hour * 3600 + m * 60, pm2_5 / 2, pm2_5, pm2_5 * 2);
+}
+
+// Feed hourly series (series[0]: oldest) and start the following hour
+static void feedSeries(const float *series, int n)
+{
+  for (int h = 0; h < n; h++)
+    feedHour(h, series[h]);
+  aq->update(T0 + n * 3600, 0, 0, 0, true, true, true);
+}
+
+// NowCast reference (c[0]: most recent hour, c < 0: no data)
+static double refNowCast(const float *c, int n)
+{
+  double cMin = 1e9, cMax = -1;
+  for (int i = 0; i < n; i++) {
+    if (c[i] < 0)
+      continue;
+    cMin = fmin(cMin, c[i]);
+    cMax = fmax(cMax, c[i]);
+  }
+  double w = (cMax > 0) ? cMin / cMax : 1;
+  w = fmax(w, 0.5);
+  double num = 0, den = 0;
+  for (int i = 0; i < n; i++) {
+    if (c[i] >= 0) {
+      num += pow(w, i) * c[i];
+      den += pow(w, i);
+    }
+  }
+  return num / den;
+}
+
+TEST_GROUP(TG_AirQuality) {
+  void setup() {
+    aq = new AirQuality();
+    aq->reset();
+  }
+
+  void teardown() {
+    delete aq;
+  }
+};
+
+/*
+ * Hourly averages, init flags, gaps and timestamps before current hour
+ */
+TEST(TG_AirQuality, Test_Hourly) {
+  DOUBLES_EQUAL(-1, aq->hourly(AQ_PM_2_5), TOLERANCE);
+
+  // Hour 0: 10, 11, 13 (PM10 still initializing)
+  aq->update(T0 + 60, 1, 10, 99, false, false, true);
+  aq->update(T0 + 1800, 2, 11, 99, false, false, true);
+  aq->update(T0 + 3599, 3, 13, 99, false, false, true);
+  // Hour 1: PM2.5 initializing, PM10 valid
+  aq->update(T0 + 3600, 4, 99, 20, false, true, false);
+  // Hour 4
+  aq->update(T0 + 4 * 3600, 5, 30, 40);
+  CHECK_FALSE(aq->update(T0 + 3 * 3600, 6, 30, 40));
+  aq->update(T0 + 5 * 3600, 5, 30, 40);
+
+  DOUBLES_EQUAL(11.3, aq->hourly(AQ_PM_2_5, 5), TOLERANCE);
+  DOUBLES_EQUAL(2.0, aq->hourly(AQ_PM_1_0, 5), TOLERANCE);
+  DOUBLES_EQUAL(-1, aq->hourly(AQ_PM_10, 5), TOLERANCE);
+  DOUBLES_EQUAL(-1, aq->hourly(AQ_PM_2_5, 4), TOLERANCE);
+  DOUBLES_EQUAL(20.0, aq->hourly(AQ_PM_10, 4), TOLERANCE);
+  DOUBLES_EQUAL(-1, aq->hourly(AQ_PM_10, 3), TOLERANCE);
+  DOUBLES_EQUAL(-1, aq->hourly(AQ_PM_10, 2), TOLERANCE);
+  DOUBLES_EQUAL(40.0, aq->hourly(AQ_PM_10, 1), TOLERANCE);
+  DOUBLES_EQUAL(-1, aq->hourly(AQ_PM_10, 0), TOLERANCE);
+  DOUBLES_EQUAL(-1, aq->hourly(AQ_PM_10, AIRQUALITY_HIST_SIZE + 1), TOLERANCE);
+
+  // Gap longer than history
+  aq->update(T0 + 40 * 3600, 5, 30, 40);
+  for (int age = 1; age <= AIRQUALITY_HIST_SIZE; age++)
+    DOUBLES_EQUAL(-1, aq->hourly(AQ_PM_2_5, age), TOLERANCE);
+}
+
+/*
+ * NowCast of constant, decreasing and increasing series
+ */
+TEST(TG_AirQuality, Test_NowCast) {
+  bool valid;
+
+  // Constant
+  const float constant[12] = {20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20};
+  feedSeries(constant, 12);
+  DOUBLES_EQUAL(20.0, aq->nowCast(AQ_PM_2_5, &valid), TOLERANCE);
+  CHECK_TRUE(valid);
+  DOUBLES_EQUAL(40.0, aq->nowCast(AQ_PM_10), TOLERANCE);
+
+  // Weight factor 2/3 (oldest first) - 10.526 truncated
+  aq->reset();
+  const float rising[3] = {8, 10, 12};
+  feedSeries(rising, 3);
+  DOUBLES_EQUAL(10.5, aq->nowCast(AQ_PM_2_5), TOLERANCE);
+  DOUBLES_EQUAL(21.0, aq->nowCast(AQ_PM_10), TOLERANCE);
+
+  // Weight factor limited to 0.5 - 15.714 truncated
+  aq->reset();
+  const float spike[3] = {10, 10, 20};
+  feedSeries(spike, 3);
+  DOUBLES_EQUAL(15.7, aq->nowCast(AQ_PM_2_5), TOLERANCE);
+
+  // Missing hours keep their weight exponent
+  aq->reset();
+  const float gaps[12] = {50, -1, 30, 5, -1, -1, 40, 10, 12, -1, 20, 25};
+  feedSeries(gaps, 12);
+  float c[12];
+  for (int i = 0; i < 12; i++)
+    c[i] = gaps[11 - i];
+  DOUBLES_EQUAL(floor(refNowCast(c, 12) * 10) / 10, aq->nowCast(AQ_PM_2_5), TOLERANCE);
+  for (int i = 0; i < 12; i++)
+    c[i] = (c[i] < 0) ? -1 : c[i] * 2;
+  DOUBLES_EQUAL(floor(refNowCast(c, 12)), aq->nowCast(AQ_PM_10), TOLERANCE);
+}
+
+/*
+ * NowCast requires two of the three most recent hours
+ */
+TEST(TG_AirQuality, Test_NowCastValid) {
+  bool valid = true;
+
+  DOUBLES_EQUAL(-1, aq->nowCast(AQ_PM_2_5, &valid), TOLERANCE);
+  CHECK_FALSE(valid);
+
+  const float oneRecent[12] = {20, 20, 20, 20, 20, 20, 20, 20, 20, -1, -1, 20};
+  feedSeries(oneRecent, 12);
+  DOUBLES_EQUAL(-1, aq->nowCast(AQ_PM_2_5, &valid), TOLERANCE);
+  CHECK_FALSE(valid);
+  LONGS_EQUAL(-1, aq->aqi());
+
+  aq->reset();
+  const float twoRecent[12] = {20, 20, 20, 20, 20, 20, 20, 20, 20, -1, 20, 20};
+  feedSeries(twoRecent, 12);
+  DOUBLES_EQUAL(20.0, aq->nowCast(AQ_PM_2_5, &valid), TOLERANCE);
+  CHECK_TRUE(valid);
+}
+
+/*
+ * Random hourly series with missing hours vs. reference implementation
+ */
+TEST(TG_AirQuality, Test_NowCastRandom) {
+  uint32_t state = 0x2545F491;
+  float series[36];
+
+  for (int run = 0; run < 200; run++) {
+    aq->reset();
+    for (int h = 0; h < 36; h++) {
+      state = state * 1664525 + 1013904223;
+      int r = state >> 20;
+      // Missing hours (about 15%), values 0...409
+      series[h] = ((r % 7) == 0) ? -1 : (r % 410);
+    }
+    feedSeries(series, 36);
+
+    float c[12];
+    int recent = 0;
+    for (int i = 0; i < 12; i++) {
+      c[i] = series[35 - i];
+      if ((i < 3) && (c[i] >= 0))
+        recent++;
+    }
+    bool valid;
+    float nc = aq->nowCast(AQ_PM_2_5, &valid);
+    CHECK_EQUAL(recent >= 2, valid);
+    if (valid) {
+      double ref = refNowCast(c, 12);
+      DOUBLES_EQUAL(floor(ref * 10 + 1e-6) / 10, nc, 0.1 + TOLERANCE);
+      CHECK(aq->aqi() >= AirQuality::aqiIndex(AQ_PM_2_5, nc));
+    }
+  }
+}
+
+/*
+ * AQI breakpoints
+ */
+TEST(TG_AirQuality, Test_AqiIndex) {
+  LONGS_EQUAL(0, AirQuality::aqiIndex(AQ_PM_2_5, 0));
+  LONGS_EQUAL(50, AirQuality::aqiIndex(AQ_PM_2_5, 9.0));
+  LONGS_EQUAL(50, AirQuality::aqiIndex(AQ_PM_2_5, 9.09));
+  LONGS_EQUAL(51, AirQuality::aqiIndex(AQ_PM_2_5, 9.1));
+  LONGS_EQUAL(71, AirQuality::aqiIndex(AQ_PM_2_5, 20.0));
+  LONGS_EQUAL(100, AirQuality::aqiIndex(AQ_PM_2_5, 35.4));
+  LONGS_EQUAL(101, AirQuality::aqiIndex(AQ_PM_2_5, 35.5));
+  LONGS_EQUAL(102, AirQuality::aqiIndex(AQ_PM_2_5, 35.9));
+  LONGS_EQUAL(150, AirQuality::aqiIndex(AQ_PM_2_5, 55.4));
+  LONGS_EQUAL(151, AirQuality::aqiIndex(AQ_PM_2_5, 55.5));
+  LONGS_EQUAL(200, AirQuality::aqiIndex(AQ_PM_2_5, 125.4));
+  LONGS_EQUAL(300, AirQuality::aqiIndex(AQ_PM_2_5, 225.4));
+  LONGS_EQUAL(301, AirQuality::aqiIndex(AQ_PM_2_5, 225.5));
+  LONGS_EQUAL(500, AirQuality::aqiIndex(AQ_PM_2_5, 325.4));
+  LONGS_EQUAL(500, AirQuality::aqiIndex(AQ_PM_2_5, 600));
+
+  LONGS_EQUAL(50, AirQuality::aqiIndex(AQ_PM_10, 54));
+  LONGS_EQUAL(50, AirQuality::aqiIndex(AQ_PM_10, 54.9));
+  LONGS_EQUAL(51, AirQuality::aqiIndex(AQ_PM_10, 55));
+  LONGS_EQUAL(100, AirQuality::aqiIndex(AQ_PM_10, 154));
+  LONGS_EQUAL(151, AirQuality::aqiIndex(AQ_PM_10, 255));
+  LONGS_EQUAL(300, AirQuality::aqiIndex(AQ_PM_10, 424));
+  LONGS_EQUAL(500, AirQuality::aqiIndex(AQ_PM_10, 604));
+  LONGS_EQUAL(500, AirQuality::aqiIndex(AQ_PM_10, 1000));
+
+  LONGS_EQUAL(-1, AirQuality::aqiIndex(AQ_PM_1_0, 10));
+  LONGS_EQUAL(-1, AirQuality::aqiIndex(AQ_PM_2_5, -1));
+}
+
+/*
+ * AQI of NowCast and dominant pollutant
+ */
+TEST(TG_AirQuality, Test_Aqi) {
+  AqPollutant dominant;
+
+  // PM2.5 20 -> 71, PM10 40 -> 37
+  const float constant[3] = {20, 20, 20};
+  feedSeries(constant, 3);
+  LONGS_EQUAL(71, aq->aqi(&dominant));
+  LONGS_EQUAL(AQ_PM_2_5, dominant);
+
+  // PM10 only (PM2.5 initializing): 100 -> 73
+  aq->reset();
+  for (int h = 0; h < 3; h++)
+    aq->update(T0 + h * 3600, 0, 0, 100, true, true, false);
+  aq->update(T0 + 3 * 3600, 0, 0, 0, true, true, true);
+  LONGS_EQUAL(73, aq->aqi(&dominant));
+  LONGS_EQUAL(AQ_PM_10, dominant);
+}
+
+/*
+ * 24-hour average and completeness
+ */
+TEST(TG_AirQuality, Test_PastDay) {
+  float series[30];
+  bool valid;
+  int nbins;
+
+  for (int h = 0; h < 30; h++)
+    series[h] = 10 + h;
+  // 6 hours missing within the past 24 hours
+  for (int h = 8; h < 14; h++)
+    series[h] = -1;
+  feedSeries(series, 30);
+
+  float sum = 0;
+  for (int h = 6; h < 30; h++)
+    sum += (series[h] >= 0) ? series[h] : 0;
+  DOUBLES_EQUAL(sum / 18, aq->pastDay(AQ_PM_2_5, &valid, &nbins), TOLERANCE);
+  LONGS_EQUAL(18, nbins);
+  CHECK_TRUE(valid);
+
+  // One more hour missing
+  aq->update(T0 + 31 * 3600, 0, 0, 0, true, true, true);
+  aq->pastDay(AQ_PM_2_5, &valid, &nbins);
+  LONGS_EQUAL(17, nbins);
+  CHECK_FALSE(valid);
+}
+
+/*
+ * Non-volatile data provided by application (e.g. RTC RAM), one instance per sensor
+ */
+TEST(TG_AirQuality, Test_Storage) {
+  static nvAirQuality_t nvAq[2];
+  memset(nvAq, 0, sizeof(nvAq));
+
+  AirQuality *a = new AirQuality(&nvAq[0]);
+  AirQuality *b = new AirQuality(&nvAq[1]);
+  for (int h = 0; h < 3; h++) {
+    a->update(T0 + h * 3600, 1, 10, 20);
+    b->update(T0 + h * 3600, 2, 30, 60);
+  }
+  delete a;
+  delete b;
+
+  // After "deep sleep"
+  a = new AirQuality(&nvAq[0]);
+  b = new AirQuality(&nvAq[1]);
+  a->update(T0 + 3 * 3600, 1, 10, 20);
+  b->update(T0 + 3 * 3600, 2, 30, 60);
+  DOUBLES_EQUAL(10.0, a->nowCast(AQ_PM_2_5), TOLERANCE);
+  DOUBLES_EQUAL(30.0, b->nowCast(AQ_PM_2_5), TOLERANCE);
+  DOUBLES_EQUAL(60.0, b->hourly(AQ_PM_10, 3), TOLERANCE);
+  delete a;
+  delete b;
+
+  CHECK(sizeof(nvAirQuality_t) <= 4 + 3 * 4 + 3 * 2 + 3 * 2 * AIRQUALITY_HIST_SIZE + 2);
+}
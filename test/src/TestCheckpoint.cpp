@@ -0,0 +1,354 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestCheckpoint.cpp
+//
+// CppUTest unit tests for Checkpoint (versioned checkpoint of post-processing state)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250506 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+#include "Checkpoint.h"
+
+#define TOLERANCE 0.1
+
+// Offsets in checkpoint with RainGauge section only
+#define OFS_DATA_LEN    6
+#define OFS_SEC_VERSION 9
+#define OFS_SEC_LEN     10
+#define OFS_SEC_DATA    12
+#define OFS_RAIN_HIST_N (OFS_SEC_DATA + 8)
+
+static RainGauge *rainGauge;
+static Lightning *lightning;
+
+static void setTime(const char *time, tm &tm, time_t &ts)
+{
+  tm = {};
+  strptime(time, "%Y-%m-%d %H:%M", &tm);
+  tm.tm_isdst = -1;
+  ts = mktime(&tm);
+}
+
+static uint16_t crc16(const uint8_t *buf, size_t len)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)buf[i] << 8;
+    for (int b = 0; b < 8; b++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+// Remove (n > 0) or insert (n < 0, zero bytes) bytes at pos, update lengths and CRC
+// (checkpoint with one section)
+static size_t edit(uint8_t *buf, size_t len, size_t pos, int n)
+{
+  len -= 2;
+  if (n > 0) {
+    memmove(&buf[pos], &buf[pos + n], len - pos - n);
+  } else {
+    memmove(&buf[pos - n], &buf[pos], len - pos);
+    memset(&buf[pos], 0, -n);
+  }
+  len -= n;
+  put16(&buf[OFS_DATA_LEN], get16(&buf[OFS_DATA_LEN]) - n);
+  put16(&buf[OFS_SEC_LEN], get16(&buf[OFS_SEC_LEN]) - n);
+  put16(&buf[len], crc16(buf, len));
+  return len + 2;
+}
+
+// Rain gauge and lightning sensor data of a few hours
+static void feed(RainGauge *rg, Lightning *lgt)
+{
+  tm tm;
+  time_t ts;
+  const char *times[] = {"2025-05-05 08:00", "2025-05-05 08:06", "2025-05-05 08:12",
+                         "2025-05-06 09:00", "2025-05-06 09:06", "2025-05-06 09:12"};
+
+  for (int i = 0; i < 6; i++) {
+    setTime(times[i], tm, ts);
+    rg->update(ts, 10.0 + i * 1.5);
+    lgt->update(ts, 20 + i * 3, 7 + i);
+  }
+}
+
+TEST_GROUP(TG_Checkpoint) {
+  void setup() {
+    rainGauge = new RainGauge();
+    rainGauge->reset();
+    lightning = new Lightning();
+    lightning->reset();
+  }
+
+  void teardown() {
+    delete rainGauge;
+    delete lightning;
+  }
+};
+
+/*
+ * Save and restore RainGauge, Lightning and configuration
+ */
+TEST(TG_Checkpoint, Test_RoundTrip) {
+  uint8_t buf[CHECKPOINT_MAX_SIZE];
+  uint8_t restored;
+  CheckpointConfig cfg = {};
+
+  feed(rainGauge, lightning);
+  cfg.maxSensors = 3;
+  cfg.rxFlags = 1;
+  cfg.enDecoders = 0xFE;
+  cfg.incCount = MAX_SENSOR_IDS;
+  for (int i = 0; i < MAX_SENSOR_IDS; i++)
+    cfg.inc[i] = 0x39582376 + i;
+  cfg.excCount = 1;
+  cfg.exc[0] = 0x12345678;
+
+  Checkpoint cp(rainGauge, lightning, &cfg);
+  size_t len = cp.save(buf, sizeof(buf));
+  CHECK(len > 0);
+  CHECK(len <= CHECKPOINT_MAX_SIZE);
+  UNSIGNED_LONGS_EQUAL(0, cp.save(buf, len - 1));
+  len = cp.save(buf, sizeof(buf));
+
+  // Restore into new objects (e.g. new hardware)
+  RainGauge rg2;
+  Lightning lgt2;
+  CheckpointConfig cfg2 = {};
+  rg2.reset();
+  lgt2.reset();
+  Checkpoint cp2(&rg2, &lgt2, &cfg2);
+  LONGS_EQUAL(CKPT_OK, cp2.restore(buf, len, &restored));
+  UNSIGNED_LONGS_EQUAL(CKPT_RAIN | CKPT_LIGHTNING | CKPT_CONFIG, restored);
+
+  nvData_t rain1, rain2;
+  rainGauge->getState(rain1);
+  rg2.getState(rain2);
+  LONGS_EQUAL(rain1.lastUpdate, rain2.lastUpdate);
+  MEMCMP_EQUAL(rain1.hist, rain2.hist, sizeof(rain1.hist));
+  DOUBLES_EQUAL(rain1.rainDayBegin, rain2.rainDayBegin, TOLERANCE);
+  DOUBLES_EQUAL(rain1.rainAcc, rain2.rainAcc, TOLERANCE);
+  UNSIGNED_LONGS_EQUAL(rain1.tsMonthBegin, rain2.tsMonthBegin);
+  DOUBLES_EQUAL(rainGauge->currentDay(), rg2.currentDay(), TOLERANCE);
+  DOUBLES_EQUAL(rainGauge->currentWeek(), rg2.currentWeek(), TOLERANCE);
+  DOUBLES_EQUAL(rainGauge->currentMonth(), rg2.currentMonth(), TOLERANCE);
+
+  nvLightning_t lgt1s, lgt2s;
+  lightning->getState(lgt1s);
+  lgt2.getState(lgt2s);
+  LONGS_EQUAL(lgt1s.lastUpdate, lgt2s.lastUpdate);
+  LONGS_EQUAL(lgt1s.timestamp, lgt2s.timestamp);
+  LONGS_EQUAL(lgt1s.accCount, lgt2s.accCount);
+  LONGS_EQUAL(lgt1s.prevCount, lgt2s.prevCount);
+  LONGS_EQUAL(lgt1s.events, lgt2s.events);
+  LONGS_EQUAL(lgt1s.distance, lgt2s.distance);
+  MEMCMP_EQUAL(lgt1s.hist, lgt2s.hist, sizeof(lgt1s.hist));
+
+  MEMCMP_EQUAL(&cfg, &cfg2, sizeof(cfg));
+
+  // Processing continues seamlessly
+  tm tm;
+  time_t ts;
+  setTime("2025-05-06 09:18", tm, ts);
+  rainGauge->update(ts, 20.0);
+  rg2.update(ts, 20.0);
+  DOUBLES_EQUAL(rainGauge->currentDay(), rg2.currentDay(), TOLERANCE);
+  DOUBLES_EQUAL(rainGauge->pastHour(), rg2.pastHour(), TOLERANCE);
+}
+
+/*
+ * Invalid checkpoints are rejected without changing the state
+ */
+TEST(TG_Checkpoint, Test_Errors) {
+  uint8_t buf[CHECKPOINT_MAX_SIZE];
+  uint8_t restored;
+
+  feed(rainGauge, lightning);
+  Checkpoint cp(rainGauge, lightning);
+  size_t len = cp.save(buf, sizeof(buf));
+
+  RainGauge rg2;
+  Lightning lgt2;
+  rg2.reset();
+  lgt2.reset();
+  Checkpoint cp2(&rg2, &lgt2);
+
+  LONGS_EQUAL(CKPT_ERR_SIZE, cp2.restore(buf, 5));
+  LONGS_EQUAL(CKPT_ERR_SIZE, cp2.restore(buf, len - 1));
+
+  buf[len - 5] ^= 0x10;
+  LONGS_EQUAL(CKPT_ERR_CRC, cp2.restore(buf, len, &restored));
+  UNSIGNED_LONGS_EQUAL(0, restored);
+  buf[len - 5] ^= 0x10;
+
+  buf[0] = 'X';
+  LONGS_EQUAL(CKPT_ERR_MAGIC, cp2.restore(buf, len));
+  buf[0] = 'B';
+
+  buf[4] = CHECKPOINT_VERSION + 1;
+  LONGS_EQUAL(CKPT_ERR_VERSION, cp2.restore(buf, len));
+  buf[4] = CHECKPOINT_VERSION;
+
+  // Section exceeds checkpoint
+  put16(&buf[OFS_SEC_LEN], 200);
+  LONGS_EQUAL(CKPT_ERR_FORMAT, cp2.restore(buf, len));
+
+  nvData_t nv;
+  nvLightning_t lgt;
+  rg2.getState(nv);
+  lgt2.getState(lgt);
+  LONGS_EQUAL(0, nv.lastUpdate);
+  LONGS_EQUAL(0, lgt.lastUpdate);
+}
+
+/*
+ * Section version 1 (without update rate) is upgraded
+ */
+TEST(TG_Checkpoint, Test_Upgrade) {
+  uint8_t buf[CHECKPOINT_MAX_SIZE];
+  uint8_t restored;
+
+  feed(rainGauge, lightning);
+  rainGauge->setUpdateRate(12);
+  Checkpoint cp(rainGauge);
+  size_t len = cp.save(buf, sizeof(buf));
+
+  RainGauge rg2;
+  rg2.reset();
+  Checkpoint cp2(&rg2);
+  nvData_t nv;
+  LONGS_EQUAL(CKPT_OK, cp2.restore(buf, len));
+  rg2.getState(nv);
+  UNSIGNED_LONGS_EQUAL(12, nv.updateRate);
+
+  // Remove update rate (last field)
+  buf[OFS_SEC_VERSION] = 1;
+  len = edit(buf, len, len - 3, 1);
+  LONGS_EQUAL(CKPT_OK, cp2.restore(buf, len, &restored));
+  UNSIGNED_LONGS_EQUAL(CKPT_RAIN, restored);
+  rg2.getState(nv);
+  UNSIGNED_LONGS_EQUAL(RAINGAUGE_UPD_RATE, nv.updateRate);
+  DOUBLES_EQUAL(rainGauge->currentMonth(), rg2.currentMonth(), TOLERANCE);
+}
+
+/*
+ * Fields/sections unknown to this version are skipped,
+ * history with different size is discarded
+ */
+TEST(TG_Checkpoint, Test_Newer) {
+  uint8_t buf[CHECKPOINT_MAX_SIZE];
+  uint8_t restored;
+
+  feed(rainGauge, lightning);
+  Checkpoint cp(rainGauge);
+  size_t len = cp.save(buf, sizeof(buf));
+
+  RainGauge rg2;
+  rg2.reset();
+  Checkpoint cp2(&rg2);
+  nvData_t nv1, nv2;
+  rainGauge->getState(nv1);
+
+  // Version 3 with additional field
+  buf[OFS_SEC_VERSION] = 3;
+  len = edit(buf, len, len - 2, -4);
+  LONGS_EQUAL(CKPT_OK, cp2.restore(buf, len, &restored));
+  UNSIGNED_LONGS_EQUAL(CKPT_RAIN, restored);
+  rg2.getState(nv2);
+  MEMCMP_EQUAL(nv1.hist, nv2.hist, sizeof(nv1.hist));
+  DOUBLES_EQUAL(nv1.rainAcc, nv2.rainAcc, TOLERANCE);
+
+  // Unknown section only
+  buf[OFS_SEC_VERSION - 1] = 9;
+  put16(&buf[len - 2], crc16(buf, len - 2));
+  LONGS_EQUAL(CKPT_OK, cp2.restore(buf, len, &restored));
+  UNSIGNED_LONGS_EQUAL(0, restored);
+  buf[OFS_SEC_VERSION - 1] = CKPT_SEC_RAIN;
+  put16(&buf[len - 2], crc16(buf, len - 2));
+
+  // History with 8 entries
+  buf[OFS_RAIN_HIST_N] = RAIN_HIST_SIZE - 2;
+  len = edit(buf, len, OFS_RAIN_HIST_N + 1, 4);
+  LONGS_EQUAL(CKPT_OK, cp2.restore(buf, len, &restored));
+  rg2.getState(nv2);
+  for (int i = 0; i < RAIN_HIST_SIZE; i++)
+    LONGS_EQUAL(-1, nv2.hist[i]);
+  DOUBLES_EQUAL(nv1.rainAcc, nv2.rainAcc, TOLERANCE);
+  DOUBLES_EQUAL(nv1.rainDayBegin, nv2.rainDayBegin, TOLERANCE);
+}
+
+/*
+ * Conversion to/from hex string (serial console, MQTT)
+ */
+TEST(TG_Checkpoint, Test_Hex) {
+  uint8_t buf[CHECKPOINT_MAX_SIZE];
+  uint8_t buf2[CHECKPOINT_MAX_SIZE];
+  char hex[2 * CHECKPOINT_MAX_SIZE + 1];
+
+  feed(rainGauge, lightning);
+  Checkpoint cp(rainGauge, lightning);
+  size_t len = cp.save(buf, sizeof(buf));
+
+  UNSIGNED_LONGS_EQUAL(2 * len, Checkpoint::toHex(buf, len, hex, sizeof(hex)));
+  UNSIGNED_LONGS_EQUAL(0, Checkpoint::toHex(buf, len, hex, 2 * len));
+  Checkpoint::toHex(buf, len, hex, sizeof(hex));
+  MEMCMP_EQUAL("42574350", hex, 8);
+  UNSIGNED_LONGS_EQUAL(len, Checkpoint::fromHex(hex, buf2, sizeof(buf2)));
+  MEMCMP_EQUAL(buf, buf2, len);
+
+  UNSIGNED_LONGS_EQUAL(3, Checkpoint::fromHex(" 0a Bc\r\nff\n", buf2, sizeof(buf2)));
+  UNSIGNED_LONGS_EQUAL(0x0A, buf2[0]);
+  UNSIGNED_LONGS_EQUAL(0xBC, buf2[1]);
+  UNSIGNED_LONGS_EQUAL(0xFF, buf2[2]);
+  UNSIGNED_LONGS_EQUAL(0, Checkpoint::fromHex("0a0", buf2, sizeof(buf2)));
+  UNSIGNED_LONGS_EQUAL(0, Checkpoint::fromHex("0x0a", buf2, sizeof(buf2)));
+  UNSIGNED_LONGS_EQUAL(0, Checkpoint::fromHex("0a0b", buf2, 1));
+}
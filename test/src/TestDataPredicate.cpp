@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestDataPredicate.cpp
+//
+// CppUTest unit tests for DataPredicate (required sensors in getData())
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250421 Created
+// 20250507 Added Test_Release
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include "DataPredicate.h"
+
+// Sensor types (see SENSOR_TYPE_* in WeatherSensor.h)
+#define T_WEATHER   1
+#define T_SOIL      4
+
+#define SLOTS       4
+
+static DataPredicate pred;
+
+// Evaluate slot and update state (as in WeatherSensor::getData())
+static bool rx(size_t slot, uint32_t id, uint8_t s_type, uint8_t chan, bool complete = true)
+{
+  return pred.update(slot, pred.match(slot, id, s_type, chan, true, complete));
+}
+
+TEST_GROUP(TG_DataPredicate) {
+  void setup() {
+    pred.clear();
+    pred.begin(SLOTS);
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Weather station plus soil probes on channels 1 and 2
+ */
+TEST(TG_DataPredicate, Test_TypeChannel) {
+  CHECK(pred.requireType(T_WEATHER));
+  CHECK(pred.requireType(T_SOIL, 1));
+  CHECK(pred.requireType(T_SOIL, 2));
+  UNSIGNED_LONGS_EQUAL(3, pred.size());
+  UNSIGNED_LONGS_EQUAL(0x7, pred.missing());
+
+  // Incomplete weather data
+  CHECK_FALSE(rx(0, 0x1000, T_WEATHER, 0, false));
+  UNSIGNED_LONGS_EQUAL(0x7, pred.missing());
+
+  // Wrong channel
+  CHECK_FALSE(rx(1, 0x2000, T_SOIL, 3));
+  CHECK_FALSE(rx(1, 0x2000, T_SOIL, 2));
+  UNSIGNED_LONGS_EQUAL(0x3, pred.missing());
+
+  CHECK_FALSE(rx(0, 0x1000, T_WEATHER, 0));
+  UNSIGNED_LONGS_EQUAL(0x2, pred.missing());
+
+  // Repeated message from same sensor
+  CHECK_FALSE(rx(1, 0x2000, T_SOIL, 2));
+
+  CHECK(rx(2, 0x3000, T_SOIL, 1));
+  UNSIGNED_LONGS_EQUAL(0, pred.missing());
+}
+
+/*
+ * Same type/channel required twice -> two different sensors
+ */
+TEST(TG_DataPredicate, Test_Count) {
+  pred.requireType(T_SOIL);
+  pred.requireType(T_SOIL);
+
+  CHECK_FALSE(rx(0, 0x2000, T_SOIL, 1));
+  CHECK_FALSE(rx(0, 0x2000, T_SOIL, 1));
+  UNSIGNED_LONGS_EQUAL(0x2, pred.missing());
+  CHECK(rx(3, 0x3000, T_SOIL, 2));
+
+  // Slot becomes incomplete again
+  CHECK_FALSE(rx(0, 0x2000, T_SOIL, 1, false));
+  UNSIGNED_LONGS_EQUAL(0x1, pred.missing());
+}
+
+/*
+ * Type/channel requirement released by slot -> can be taken by another slot
+ */
+TEST(TG_DataPredicate, Test_Release) {
+  pred.requireType(T_SOIL);
+  pred.requireId(0x1000);
+
+  CHECK_FALSE(rx(0, 0x2000, T_SOIL, 1));
+  UNSIGNED_LONGS_EQUAL(0x1, pred.match(0, 0x2000, T_SOIL, 1, true, true));
+  UNSIGNED_LONGS_EQUAL(0x0, pred.match(1, 0x3000, T_SOIL, 1, true, true));
+
+  // Slot 0 invalidated
+  CHECK_FALSE(pred.update(0, pred.match(0, 0x2000, T_SOIL, 1, false, true)));
+  UNSIGNED_LONGS_EQUAL(0x3, pred.missing());
+  CHECK_FALSE(rx(1, 0x3000, T_SOIL, 1));
+  UNSIGNED_LONGS_EQUAL(0x2, pred.missing());
+
+  // Repeated updates of the same slot are counted once
+  CHECK(rx(2, 0x1000, T_WEATHER, 0));
+  CHECK(rx(2, 0x1000, T_WEATHER, 0));
+  CHECK_FALSE(rx(2, 0x1000, T_WEATHER, 0, false));
+  UNSIGNED_LONGS_EQUAL(0x2, pred.missing());
+}
+
+/*
+ * Sensor IDs, partial data accepted, initial state from valid slots
+ */
+TEST(TG_DataPredicate, Test_Id) {
+  pred.requireId(0x1000);
+  pred.requireId(0x2000, false);
+
+  // Slots valid before start of reception
+  pred.update(1, pred.match(1, 0x2000, T_SOIL, 1, true, false));
+  pred.update(2, pred.match(2, 0x1000, T_WEATHER, 0, false, true));
+  UNSIGNED_LONGS_EQUAL(0x1, pred.missing());
+
+  CHECK_FALSE(rx(3, 0x3000, T_WEATHER, 0));
+  CHECK(rx(2, 0x1000, T_WEATHER, 0));
+
+  // Restart - previous state discarded
+  pred.begin(SLOTS);
+  UNSIGNED_LONGS_EQUAL(0x3, pred.missing());
+}
+
+/*
+ * Limits, empty set
+ */
+TEST(TG_DataPredicate, Test_Limits) {
+  // Empty set is fulfilled by any message
+  CHECK(rx(0, 0x1000, T_WEATHER, 0, false));
+
+  for (int i = 0; i < DATA_REQ_MAX; i++) {
+    CHECK(pred.requireId(0x100 + i));
+  }
+  CHECK_FALSE(pred.requireId(0x200));
+  CHECK_FALSE(pred.requireType(T_SOIL));
+  UNSIGNED_LONGS_EQUAL(DATA_REQ_MAX, pred.size());
+
+  // Slot index out of range is ignored
+  CHECK_FALSE(rx(SLOTS, 0x100, T_WEATHER, 0));
+
+  pred.clear();
+  UNSIGNED_LONGS_EQUAL(0, pred.size());
+  UNSIGNED_LONGS_EQUAL(0, pred.missing());
+}
@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestDecoderPrecheck.cpp
+//
+// CppUTest unit tests for DecoderPrecheck - known messages and noise corpus
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250417 Created
+//
+// ToDo: 
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <chrono>
+#include <stdio.h>
+#include "DecoderPrecheck.h"
+
+#define NOISE_FRAMES 20000
+#define FRAME_SIZE 27
+
+// LFSR-16 digest (copy of WeatherSensor::lfsr_digest16()) - cost reference for skipped checks
+static uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
+{
+    uint16_t sum = 0;
+    for (unsigned k = 0; k < bytes; ++k)
+    {
+        uint8_t data = message[k];
+        for (int i = 7; i >= 0; --i)
+        {
+            if ((data >> i) & 1)
+                sum ^= key;
+            if (key & 1)
+                key = (key >> 1) ^ gen;
+            else
+                key = (key >> 1);
+        }
+    }
+    return sum;
+}
+
+// Deterministic noise generator (xorshift32)
+static uint32_t noiseState;
+
+static uint8_t noise(void)
+{
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return noiseState & 0xff;
+}
+
+static uint8_t corpus[NOISE_FRAMES][FRAME_SIZE];
+
+// Returns rejection rate of precheck on noise corpus; prints CPU time with/without precheck
+static float measure(const char *name, bool (*precheck)(const uint8_t *, uint8_t), unsigned digestBytes)
+{
+    unsigned rejected = 0;
+    volatile uint16_t sink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int n = 0; n < NOISE_FRAMES; n++)
+    {
+        sink ^= lfsr_digest16(&corpus[n][2], digestBytes, 0x8810, 0x5412);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int n = 0; n < NOISE_FRAMES; n++)
+    {
+        if (!precheck(corpus[n], FRAME_SIZE))
+        {
+            rejected++;
+            continue;
+        }
+        sink ^= lfsr_digest16(&corpus[n][2], digestBytes, 0x8810, 0x5412);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    float rate = (float)rejected / NOISE_FRAMES;
+    double without = std::chrono::duration<double, std::micro>(t1 - t0).count();
+    double with = std::chrono::duration<double, std::micro>(t2 - t1).count();
+    printf("\n%-10s rejected: %5.1f%%  integrity check: %7.0f us -> %7.0f us (%d frames)",
+           name, rate * 100.0, without, with, NOISE_FRAMES);
+    (void)sink;
+
+    return rate;
+}
+
+TEST_GROUP(TG_DecoderPrecheck) {
+  void setup() {
+    noiseState = 0x12345678;
+    for (int n = 0; n < NOISE_FRAMES; n++) {
+      for (int i = 0; i < FRAME_SIZE; i++) {
+        corpus[n][i] = noise();
+      }
+    }
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Known valid messages must pass
+ */
+TEST(TG_DecoderPrecheck, Test_ValidMessages) {
+  // 5-in-1: synthetic message, bytes 0..12 are the inverse of bytes 13..25
+  uint8_t msg5[26] = {0};
+  const uint8_t data5[13] = {0x1b, 0x5e, 0x7f, 0x00, 0x10, 0x27, 0x01, 0x55, 0x98, 0x53, 0x00, 0x07, 0x00};
+  for (int i = 0; i < 13; i++) {
+    msg5[i + 13] = data5[i];
+    msg5[i] = ~data5[i];
+  }
+  CHECK(precheck5In1(msg5, sizeof(msg5)));
+
+  // 6-in-1: Soil Moisture Sensor (rtl_433)
+  const uint8_t msg6[26] = {0xe3, 0xae, 0x18, 0x70, 0x07, 0x93, 0x41, 0xff, 0xff, 0xff,
+                            0x00, 0x00, 0x22, 0x12, 0x01, 0xff, 0xf2, 0x79};
+  CHECK(precheck6In1(msg6, sizeof(msg6)));
+
+  // 7-in-1: Weather Center (rtl_433)
+  const uint8_t msg7[26] = {0x63, 0x1d, 0x05, 0xc0, 0x9e, 0x9a, 0x18, 0xab, 0xaa, 0xba,
+                            0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x8a, 0xda, 0xcb, 0xac, 0xff,
+                            0x9c, 0xaf, 0xca, 0xaa, 0xaa, 0xaa};
+  CHECK(precheck7In1(msg7, sizeof(msg7)));
+
+  // Lightning (LIGHTNING_TEST_DATA)
+  const uint8_t msgL[27] = {0x73, 0x69, 0xB5, 0x08, 0xAA, 0xA2, 0x90, 0xAA, 0xAA, 0xAA,
+                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                            0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x15};
+  CHECK(precheckLightning(msgL, sizeof(msgL)));
+
+  // Water Leakage [CH7] and [CH1+BATT_LO+NSTARTUP+ALARM]
+  const uint8_t msgW1[26] = {0xC7, 0x70, 0x35, 0x97, 0x04, 0x08, 0x57, 0x70, 0x00, 0x00,
+                             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xFF, 0xFF, 0xFF,
+                             0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  const uint8_t msgW2[26] = {0xF0, 0x94, 0x54, 0x81, 0x72, 0x09, 0x59, 0x80, 0x00, 0x00,
+                             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xFF, 0xB7, 0xFF,
+                             0xED, 0xFF, 0xFF, 0xFF, 0xDF, 0xFF};
+  CHECK(precheckLeakage(msgW1, sizeof(msgW1)));
+  CHECK(precheckLeakage(msgW2, sizeof(msgW2)));
+
+  // Messages of other sensor types
+  CHECK_FALSE(precheckLightning(msg7, sizeof(msg7)));
+  CHECK_FALSE(precheckLeakage(msg6, sizeof(msg6)));
+  CHECK_FALSE(precheck7In1(msgW1, sizeof(msgW1)));
+
+  // Too short
+  CHECK_FALSE(precheck5In1(msg5, 25));
+  CHECK_FALSE(precheck7In1(msg7, 24));
+}
+
+/*
+ * Invalid data
+ */
+TEST(TG_DecoderPrecheck, Test_InvalidData) {
+  uint8_t msg7[26] = {0x63, 0x1d, 0x05, 0xc0, 0x9e, 0x9a, 0x18, 0xab, 0xaa, 0xba,
+                      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x8a, 0xda, 0xcb, 0xac, 0xff,
+                      0x9c, 0xaf, 0xca, 0xaa, 0xaa, 0xaa};
+  // Sanity byte
+  msg7[21] = 0x00;
+  CHECK_FALSE(precheck7In1(msg7, sizeof(msg7)));
+
+  // Unknown type (rejected by design, see PRECHECK_TYPES_7IN1)
+  msg7[21] = 0xaf;
+  msg7[6] = 0x78;
+  CHECK_FALSE(precheck7In1(msg7, sizeof(msg7)));
+
+  // Lightning: strike counter digit out of BCD range
+  uint8_t msgL[10] = {0x73, 0x69, 0xB5, 0x08, 0xAA, 0xA2, 0x90, 0xAA, 0xAA, 0xAA};
+  msgL[4] = 0xAA ^ 0x0C;
+  CHECK_FALSE(precheckLightning(msgL, sizeof(msgL)));
+
+  // Leakage: both ALARM and NALARM set, channel 0
+  uint8_t msgW[16] = {0xC7, 0x70, 0x35, 0x97, 0x04, 0x08, 0x57, 0xF0};
+  CHECK_FALSE(precheckLeakage(msgW, sizeof(msgW)));
+  msgW[7] = 0x70;
+  msgW[6] = 0x50;
+  CHECK_FALSE(precheckLeakage(msgW, sizeof(msgW)));
+
+  // 6-in-1: checksum error
+  uint8_t msg6[18] = {0xe3, 0xae, 0x18, 0x70, 0x07, 0x93, 0x41, 0xff, 0xff, 0xff,
+                      0x00, 0x00, 0x22, 0x12, 0x01, 0xff, 0xf2, 0x79};
+  msg6[10] = 0x01;
+  CHECK_FALSE(precheck6In1(msg6, sizeof(msg6)));
+}
+
+/*
+ * Rejection rate and CPU time on noise corpus
+ */
+TEST(TG_DecoderPrecheck, Test_NoiseCorpus) {
+  CHECK(measure("5-in-1", precheck5In1, 15) > 0.999);
+  CHECK(measure("6-in-1", precheck6In1, 15) > 0.99);
+  CHECK(measure("7-in-1", precheck7In1, 23) > 0.6);
+  CHECK(measure("Lightning", precheckLightning, 8) > 0.9);
+  CHECK(measure("Leakage", precheckLeakage, 5) > 0.9);
+  printf("\n");
+}
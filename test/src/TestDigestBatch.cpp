@@ -0,0 +1,303 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestDigestBatch.cpp
+//
+// CppUTest unit tests for DigestBatch (bitsliced integrity checks of multiple messages)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250430 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "DigestBatch.h"
+
+#define FRAMES      4096
+#define FRAME_SIZE  27
+#define BENCH_LOOPS 16
+
+static const DigestImpl impls[] = {DIGEST_IMPL_SCALAR, DIGEST_IMPL_SLICE64, DIGEST_IMPL_AVX2};
+static const DigestParams *params[] = {&DIGEST_6IN1, &DIGEST_7IN1, &DIGEST_LIGHTNING};
+
+// Batch sizes covering partial and complete blocks of all implementations
+static const size_t sizes[] = {1, 7, 8, 63, 64, 65, 255, 256, 300, 1000, FRAMES};
+
+// LFSR-16 digest (copy of WeatherSensor::lfsr_digest16()) - reference
+static uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
+{
+    uint16_t sum = 0;
+    for (unsigned k = 0; k < bytes; ++k)
+    {
+        uint8_t data = message[k];
+        for (int i = 7; i >= 0; --i)
+        {
+            if ((data >> i) & 1)
+                sum ^= key;
+            if (key & 1)
+                key = (key >> 1) ^ gen;
+            else
+                key = (key >> 1);
+        }
+    }
+    return sum;
+}
+
+// Deterministic noise generator (xorshift32)
+static uint32_t noiseState;
+
+static uint8_t noise(void)
+{
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return noiseState & 0xff;
+}
+
+static uint8_t corpus[FRAMES][FRAME_SIZE];
+static const uint8_t *msgs[FRAMES];
+static bool ok[FRAMES];
+static bool okRef[FRAMES];
+
+// Valid digest message, every 4th message corrupted (single bit error)
+static void makeDigestFrame(uint8_t *msg, const DigestParams &p, bool corrupt)
+{
+    for (unsigned i = 0; i < FRAME_SIZE; i++)
+        msg[i] = noise();
+    uint16_t chk = lfsr_digest16(&msg[2], p.bytes, p.gen, p.key) ^ p.final;
+    msg[0] = chk >> 8;
+    msg[1] = chk & 0xff;
+    for (unsigned i = 0; i < 2U + p.bytes; i++)
+        msg[i] ^= p.whitening;
+    if (corrupt)
+    {
+        unsigned bit = noise() % ((2 + p.bytes) * 8);
+        msg[bit / 8] ^= 0x80 >> (bit % 8);
+    }
+}
+
+static bool checkDigest(const uint8_t *msg, const DigestParams &p)
+{
+    uint8_t msgw[FRAME_SIZE];
+    for (unsigned i = 0; i < FRAME_SIZE; i++)
+        msgw[i] = msg[i] ^ p.whitening;
+    int chkdgst = (msgw[0] << 8) | msgw[1];
+    int digest = lfsr_digest16(&msgw[2], p.bytes, p.gen, p.key);
+    return (chkdgst ^ digest) == p.final;
+}
+
+// Valid 5-in-1 message or one of parity error, checksum error or noise
+static void make5In1Frame(uint8_t *msg, unsigned variant)
+{
+    uint8_t bits = 0;
+    for (unsigned i = 14; i < 26; i++)
+    {
+        msg[i] = noise();
+        for (uint8_t b = msg[i]; b; b >>= 1)
+            bits += b & 1;
+    }
+    msg[13] = bits;
+    for (unsigned i = 0; i < 13; i++)
+        msg[i] = ~msg[i + 13];
+    msg[26] = noise();
+
+    unsigned k = noise() % 13;
+    uint8_t bit = 1 << (noise() % 8);
+    switch (variant % 4)
+    {
+    case 1:
+        // parity error
+        msg[k + (noise() & 1) * 13] ^= bit;
+        break;
+    case 2:
+        // checksum error with valid parity
+        msg[k] ^= bit;
+        msg[k + 13] ^= bit;
+        break;
+    case 3:
+        for (unsigned i = 0; i < FRAME_SIZE; i++)
+            msg[i] = noise();
+        break;
+    }
+}
+
+static bool check5In1(const uint8_t *msg)
+{
+    for (unsigned col = 0; col < 13; ++col)
+    {
+        if ((msg[col] ^ msg[col + 13]) != 0xff)
+            return false;
+    }
+    uint8_t bitsSet = 0;
+    for (unsigned p = 14; p < 26; p++)
+    {
+        for (uint8_t b = msg[p]; b; b >>= 1)
+            bitsSet += b & 1;
+    }
+    return bitsSet == msg[13];
+}
+
+TEST_GROUP(TG_DigestBatch) {
+  void setup() {
+    noiseState = 0x12345678;
+    for (int i = 0; i < FRAMES; i++)
+      msgs[i] = corpus[i];
+  }
+
+  void teardown() {
+    digestBatchSelect(DIGEST_IMPL_AUTO);
+  }
+};
+
+/*
+ * Digests of all implementations are bit-exact with lfsr_digest16()
+ */
+TEST(TG_DigestBatch, Test_Digest) {
+  static uint16_t out[FRAMES + 1];
+
+  for (int i = 0; i < FRAMES; i++)
+    for (int j = 0; j < FRAME_SIZE; j++)
+      corpus[i][j] = noise();
+
+  for (DigestImpl impl : impls) {
+    digestBatchSelect(impl);
+    for (const DigestParams *p : params) {
+      for (size_t n : sizes) {
+        memset(out, 0, sizeof(out));
+        lfsrDigest16Batch(msgs, n, p->bytes, p->gen, p->key, out);
+        for (size_t i = 0; i < n; i++)
+          UNSIGNED_LONGS_EQUAL(lfsr_digest16(msgs[i], p->bytes, p->gen, p->key), out[i]);
+        UNSIGNED_LONGS_EQUAL(0, out[n]);
+      }
+    }
+    // All bytes of frame
+    lfsrDigest16Batch(msgs, FRAMES, FRAME_SIZE, 0x8810, 0x5412, out);
+    for (size_t i = 0; i < FRAMES; i++)
+      UNSIGNED_LONGS_EQUAL(lfsr_digest16(msgs[i], FRAME_SIZE, 0x8810, 0x5412), out[i]);
+  }
+}
+
+/*
+ * Digest checks of all implementations match the decoders' checks
+ */
+TEST(TG_DigestBatch, Test_Verify) {
+  for (const DigestParams *p : params) {
+    size_t valid = 0;
+    for (int i = 0; i < FRAMES; i++) {
+      makeDigestFrame(corpus[i], *p, (i % 4) == 3);
+      okRef[i] = checkDigest(corpus[i], *p);
+      valid += okRef[i];
+    }
+    UNSIGNED_LONGS_EQUAL(FRAMES - FRAMES / 4, valid);
+
+    for (DigestImpl impl : impls) {
+      digestBatchSelect(impl);
+      for (size_t n : sizes) {
+        size_t passed = verifyDigest16Batch(msgs, n, *p, ok);
+        size_t expected = 0;
+        for (size_t i = 0; i < n; i++) {
+          CHECK_EQUAL(okRef[i], ok[i]);
+          expected += okRef[i];
+        }
+        UNSIGNED_LONGS_EQUAL(expected, passed);
+      }
+    }
+  }
+}
+
+/*
+ * 5-in-1 parity/checksum checks of all implementations match the decoder's checks
+ */
+TEST(TG_DigestBatch, Test_5In1) {
+  size_t valid = 0;
+  for (int i = 0; i < FRAMES; i++) {
+    make5In1Frame(corpus[i], i);
+    okRef[i] = check5In1(corpus[i]);
+    valid += okRef[i];
+  }
+  UNSIGNED_LONGS_EQUAL(FRAMES / 4, valid);
+
+  for (DigestImpl impl : impls) {
+    digestBatchSelect(impl);
+    for (size_t n : sizes) {
+      size_t passed = verify5In1Batch(msgs, n, ok);
+      size_t expected = 0;
+      for (size_t i = 0; i < n; i++) {
+        CHECK_EQUAL(okRef[i], ok[i]);
+        expected += okRef[i];
+      }
+      UNSIGNED_LONGS_EQUAL(expected, passed);
+    }
+  }
+}
+
+/*
+ * Throughput of all implementations supported by the CPU [frames/s]
+ */
+TEST(TG_DigestBatch, Test_Benchmark) {
+  static uint8_t corpus5[FRAMES][FRAME_SIZE];
+  static const uint8_t *msgs5[FRAMES];
+  for (int i = 0; i < FRAMES; i++) {
+    makeDigestFrame(corpus[i], DIGEST_7IN1, (i % 4) == 3);
+    make5In1Frame(corpus5[i], i);
+    msgs5[i] = corpus5[i];
+  }
+
+  printf("\n");
+  for (DigestImpl impl : impls) {
+    if (digestBatchSelect(impl) != impl)
+      continue;
+
+    size_t passed7 = 0, passed5 = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < BENCH_LOOPS; k++)
+      passed7 += verifyDigest16Batch(msgs, FRAMES, DIGEST_7IN1, ok);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k = 0; k < BENCH_LOOPS; k++)
+      passed5 += verify5In1Batch(msgs5, FRAMES, ok);
+    auto t2 = std::chrono::steady_clock::now();
+
+    double frames = (double)FRAMES * BENCH_LOOPS;
+    double s7 = std::chrono::duration<double>(t1 - t0).count();
+    double s5 = std::chrono::duration<double>(t2 - t1).count();
+    printf("%-8s 7-in-1 digest: %8.2f Mframes/s  5-in-1 parity/checksum: %8.2f Mframes/s\n",
+           digestBatchName(impl), frames / s7 / 1e6, frames / s5 / 1e6);
+
+    UNSIGNED_LONGS_EQUAL((FRAMES - FRAMES / 4) * BENCH_LOOPS, passed7);
+    UNSIGNED_LONGS_EQUAL(FRAMES / 4 * BENCH_LOOPS, passed5);
+  }
+}
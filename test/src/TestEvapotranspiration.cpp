@@ -0,0 +1,253 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestEvapotranspiration.cpp
+//
+// CppUTest unit tests for Evapotranspiration (FAO-56 reference evapotranspiration)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250505 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <math.h>
+#include "Evapotranspiration.h"
+
+#define TOLERANCE 0.05
+
+// FAO-56, Example 18: Brussels (50°48'N, 100 m), 6 July
+#define EX18_LAT    50.8f
+#define EX18_ELEV   100.0f
+#define EX18_DOY    187
+#define EX18_TMIN   12.3f
+#define EX18_TMAX   21.5f
+#define EX18_RHMIN  63.0f
+#define EX18_RHMAX  84.0f
+#define EX18_U2     2.078f
+#define EX18_RS     22.07f
+#define EX18_ET0    3.9
+
+// Daylight from 06:00 to 20:00 (half sine), integral: EX18_RS
+#define SUNRISE     (6 * 3600)
+#define DAYLIGHT    (14 * 3600)
+
+static Evapotranspiration *et;
+
+static void setTime(const char *time, tm &tm, time_t &ts)
+{
+  tm = {};
+  strptime(time, "%Y-%m-%d %H:%M", &tm);
+  tm.tm_isdst = -1;
+  ts = mktime(&tm);
+}
+
+// Synthetic weather data of Example 18 at time of day t [s]
+static void ex18Update(time_t day, int t)
+{
+  float temp = (EX18_TMIN + EX18_TMAX) / 2 -
+               (EX18_TMAX - EX18_TMIN) / 2 * cos(2 * M_PI * (t - 2 * 3600) / 86400);
+  float rh = (EX18_RHMIN + EX18_RHMAX) / 2 +
+             (EX18_RHMAX - EX18_RHMIN) / 2 * cos(2 * M_PI * (t - 2 * 3600) / 86400);
+  float lux = 0;
+  if ((t > SUNRISE) && (t < SUNRISE + DAYLIGHT)) {
+    float peak = EX18_RS * 1e6 * M_PI / (2 * DAYLIGHT);
+    lux = peak * sin(M_PI * (t - SUNRISE) / DAYLIGHT) / ET0_LUX_TO_WM2;
+  }
+  et->update(day + t, temp, rh, EX18_U2, lux);
+}
+
+TEST_GROUP(TG_Evapotranspiration) {
+  void setup() {
+    et = new Evapotranspiration(EX18_LAT, EX18_ELEV);
+    et->reset();
+  }
+
+  void teardown() {
+    delete et;
+  }
+};
+
+/*
+ * FAO-56 Example 18: ET0 = 3.9 mm/day
+ */
+TEST(TG_Evapotranspiration, Test_Fao56) {
+  float et0 = Evapotranspiration::fao56(EX18_TMIN, EX18_TMAX, EX18_RHMIN, EX18_RHMAX,
+                                        EX18_U2, EX18_RS, EX18_LAT, EX18_DOY, EX18_ELEV);
+  DOUBLES_EQUAL(EX18_ET0, et0, TOLERANCE);
+
+  // No solar radiation, no wind, saturated air
+  et0 = Evapotranspiration::fao56(10, 10, 100, 100, 0, 0, EX18_LAT, EX18_DOY, EX18_ELEV);
+  CHECK(et0 < 0);
+}
+
+/*
+ * Wind speed at 10 m (Example 18: 2.78 m/s -> 2.078 m/s)
+ */
+TEST(TG_Evapotranspiration, Test_WindHeight) {
+  DOUBLES_EQUAL(2.078, Evapotranspiration::windAt2m(2.78f, 10.0f), 0.01);
+  DOUBLES_EQUAL(2.78, Evapotranspiration::windAt2m(2.78f, 2.0f), 0.0001);
+}
+
+/*
+ * Updates every minute during one day -> same result as with daily data
+ */
+TEST(TG_Evapotranspiration, Test_Day) {
+  tm tm;
+  time_t day;
+  bool valid;
+  float et0;
+  setTime("2025-07-06 00:00", tm, day);
+
+  CHECK_EQUAL(-1, et->currentDay(&valid));
+  CHECK_FALSE(valid);
+  CHECK_EQUAL(-1, et->previousDay(&valid));
+  CHECK_FALSE(valid);
+
+  for (int t = 0; t < 86400; t += 60) {
+    ex18Update(day, t);
+    if (t == 12 * 3600) {
+      et0 = et->currentDay(&valid);
+      CHECK_TRUE(valid);
+      CHECK(et0 > 0.5);
+      CHECK(et0 < EX18_ET0);
+    }
+  }
+
+  // Provisional value at end of day is close to the final one
+  et0 = et->currentDay(&valid);
+  CHECK_TRUE(valid);
+  DOUBLES_EQUAL(EX18_ET0, et0, TOLERANCE);
+
+  // Begin of next day
+  time_t prev;
+  ex18Update(day, 86400);
+  et0 = et->previousDay(&valid, &prev);
+  CHECK_TRUE(valid);
+  CHECK_EQUAL(day, prev);
+  DOUBLES_EQUAL(EX18_ET0, et0, TOLERANCE);
+
+  DOUBLES_EQUAL(0, et->currentDay(), 0.001);
+  DOUBLES_EQUAL(5.0, et->waterBalance(5.0), 0.001);
+
+  ex18Update(day, 86400 + 12 * 3600);
+  DOUBLES_EQUAL(5.0 - et->currentDay(), et->waterBalance(5.0), 0.001);
+}
+
+/*
+ * Sensor height 10 m: wind speed converted to 2 m
+ */
+TEST(TG_Evapotranspiration, Test_DayWindHeight) {
+  tm tm;
+  time_t day;
+  setTime("2025-07-06 00:00", tm, day);
+
+  delete et;
+  et = new Evapotranspiration(EX18_LAT, EX18_ELEV, 10.0f);
+  et->reset();
+  for (int t = 0; t <= 86400; t += 300) {
+    float lux = 0;
+    if ((t > SUNRISE) && (t < SUNRISE + DAYLIGHT))
+      lux = EX18_RS * 1e6 * M_PI / (2 * DAYLIGHT) * sin(M_PI * (t - SUNRISE) / DAYLIGHT) / ET0_LUX_TO_WM2;
+    et->update(day + t, (t < 43200) ? EX18_TMIN : EX18_TMAX, (t < 43200) ? EX18_RHMAX : EX18_RHMIN, 2.78f, lux);
+  }
+  DOUBLES_EQUAL(EX18_ET0, et->previousDay(), TOLERANCE);
+}
+
+/*
+ * Intervals longer than ET0_MAX_GAP are not integrated
+ */
+TEST(TG_Evapotranspiration, Test_Gap) {
+  tm tm;
+  time_t day;
+  bool valid;
+  setTime("2025-07-06 00:00", tm, day);
+
+  for (int t = 0; t <= 6 * 3600; t += 60)
+    ex18Update(day, t);
+  et->currentDay(&valid);
+  CHECK_TRUE(valid);
+
+  // Receiver off from 06:00 to 18:00
+  for (int t = 18 * 3600; t <= 86400; t += 60)
+    ex18Update(day, t);
+  et->currentDay(&valid);
+  CHECK_FALSE(valid);
+  et->previousDay(&valid);
+  CHECK_FALSE(valid);
+
+  // Gap across midnight: new day starts without integration
+  ex18Update(day, 86400 + 3600);
+  et->currentDay(&valid);
+  CHECK_FALSE(valid);
+  ex18Update(day, 86400 + 3660);
+  et->currentDay(&valid);
+  CHECK_FALSE(valid);
+}
+
+/*
+ * Timestamp before last update
+ */
+TEST(TG_Evapotranspiration, Test_TimeBack) {
+  tm tm;
+  time_t ts;
+  setTime("2025-07-06 08:00", tm, ts);
+
+  CHECK_TRUE(et->update(ts, 20, 50, 1, 1000));
+  CHECK_TRUE(et->update(ts + 60, 20, 50, 1, 1000));
+  CHECK_FALSE(et->update(ts, 20, 50, 1, 1000));
+}
+
+/*
+ * Non-volatile data provided by application
+ */
+TEST(TG_Evapotranspiration, Test_Storage) {
+  tm tm;
+  time_t day;
+  nvEt0_t nv = {};
+  setTime("2025-07-06 00:00", tm, day);
+
+  delete et;
+  et = new Evapotranspiration(EX18_LAT, EX18_ELEV, 2.0f, &nv);
+  for (int t = 0; t <= 86400; t += 60)
+    ex18Update(day, t);
+  delete et;
+
+  // e.g. after deep sleep
+  et = new Evapotranspiration(EX18_LAT, EX18_ELEV, 2.0f, &nv);
+  DOUBLES_EQUAL(EX18_ET0, et->previousDay(), TOLERANCE);
+  et->reset();
+  CHECK_EQUAL(0, nv.dayStart);
+  CHECK_EQUAL(-1, et->previousDay());
+}
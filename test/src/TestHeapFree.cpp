@@ -0,0 +1,255 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestHeapFree.cpp
+//
+// CppUTest unit tests for the heap-free build profile (WEATHERSENSOR_HEAP_FREE)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250422 Created
+// 20250508 CountingAllocator moved to CountingAllocator.h
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <type_traits>
+#include "FixedVector.h"
+#include "SensorIdsJson.h"
+#include "DataPredicate.h"
+#include "SensorIdentity.h"
+#include "PromMetrics.h"
+#include "SensorRecord.h"
+#include "DecoderPrecheck.h"
+#include "RainGauge.h"
+#include "Lightning.h"
+#include "CountingAllocator.h"
+
+// Slot as used by WeatherSensor (reduced)
+typedef struct Slot {
+  uint32_t sensor_id;
+  uint8_t  s_type;
+  uint8_t  chan;
+  bool     valid;
+  bool     complete;
+} Slot;
+
+TEST_GROUP(TG_HeapFree) {
+  AllocationCounter *allocs;
+
+  void setup() {
+    allocs = new AllocationCounter();
+  }
+
+  void teardown() {
+    delete allocs;
+  }
+
+  // End of initialization - count all allocations from now on
+  void startCounting(void) {
+    allocs->start();
+  }
+
+  // Stop counting, returns number of allocations
+  size_t stopCounting(void) {
+    return allocs->stop();
+  }
+};
+
+/*
+ * Containers of the library are statically sized in this profile
+ */
+TEST(TG_HeapFree, Test_FixedVector) {
+  CHECK((std::is_same<WsVector<uint32_t, MAX_SENSOR_IDS>, FixedVector<uint32_t, MAX_SENSOR_IDS>>::value));
+
+  FixedVector<uint32_t, 4> v;
+  startCounting();
+
+  CHECK(v.empty());
+  v = {1, 2, 3};
+  UNSIGNED_LONGS_EQUAL(3, v.size());
+  UNSIGNED_LONGS_EQUAL(2, v[1]);
+
+  // Capacity exceeded - truncated
+  v.push_back(4);
+  v.push_back(5);
+  UNSIGNED_LONGS_EQUAL(4, v.size());
+  UNSIGNED_LONGS_EQUAL(4, v[3]);
+  v = {5, 6, 7, 8, 9};
+  UNSIGNED_LONGS_EQUAL(4, v.size());
+
+  uint32_t sum = 0;
+  for (const uint32_t &x : v)
+    sum += x;
+  UNSIGNED_LONGS_EQUAL(26, sum);
+
+  v.resize(2);
+  v.resize(3);
+  UNSIGNED_LONGS_EQUAL(0, v[2]);
+  v.resize(10);
+  UNSIGNED_LONGS_EQUAL(4, v.size());
+  v.assign(2, 0xFF);
+  UNSIGNED_LONGS_EQUAL(2, v.size());
+  v.clear();
+  v.shrink_to_fit();
+  CHECK(v.empty());
+  UNSIGNED_LONGS_EQUAL(4, v.capacity());
+
+  UNSIGNED_LONGS_EQUAL(0, stopCounting());
+}
+
+/*
+ * JSON include/exclude lists - format compatible with ArduinoJson implementation
+ */
+TEST(TG_HeapFree, Test_SensorIdsJson) {
+  const uint32_t ids[] = {0x39582376, 0x0000ABCD};
+  char json[SENSOR_IDS_JSON_SIZE(2)];
+  uint8_t buf[MAX_SENSOR_IDS * 4];
+  const uint8_t exp[] = {0x39, 0x58, 0x23, 0x76, 0x00, 0x00, 0xAB, 0xCD};
+
+  startCounting();
+
+  UNSIGNED_LONGS_EQUAL(35, sensorIdsToJson(ids, 2, json, sizeof(json)));
+  STRCMP_EQUAL("{\"ids\":[\"0x39582376\",\"0x0000abcd\"]}", json);
+  UNSIGNED_LONGS_EQUAL(0, sensorIdsToJson(ids, 2, json, sizeof(json) - 1));
+  STRCMP_EQUAL("", json);
+  UNSIGNED_LONGS_EQUAL(10, sensorIdsToJson(ids, 0, json, SENSOR_IDS_JSON_SIZE(0)));
+  STRCMP_EQUAL("{\"ids\":[]}", json);
+
+  UNSIGNED_LONGS_EQUAL(8, sensorIdsFromJson("{\"ids\": [ \"0x39582376\", \"0x0000ABCD\" ]}", buf, MAX_SENSOR_IDS));
+  MEMCMP_EQUAL(exp, buf, sizeof(exp));
+
+  // Limited to max_ids, invalid elements skipped
+  UNSIGNED_LONGS_EQUAL(4, sensorIdsFromJson("{\"ids\":[\"0x39582376\",\"0x0000ABCD\"]}", buf, 1));
+  UNSIGNED_LONGS_EQUAL(4, sensorIdsFromJson("{\"ids\":[\"xyz\",\"\",1234,\"0x39582376\"]}", buf, MAX_SENSOR_IDS));
+  MEMCMP_EQUAL(exp, buf, 4);
+  UNSIGNED_LONGS_EQUAL(0, sensorIdsFromJson("{\"ids\":[]}", buf, MAX_SENSOR_IDS));
+  UNSIGNED_LONGS_EQUAL(0, sensorIdsFromJson("{\"id\":[\"0x39582376\"]}", buf, MAX_SENSOR_IDS));
+  UNSIGNED_LONGS_EQUAL(0, sensorIdsFromJson("", buf, MAX_SENSOR_IDS));
+
+  UNSIGNED_LONGS_EQUAL(0, stopCounting());
+}
+
+/*
+ * Receive path after initialization: slot handling, filter lists, required sensors,
+ * logical IDs, post-processing, metrics and records - no allocation allowed
+ */
+TEST(TG_HeapFree, Test_NoAllocAfterInit) {
+  // Initialization
+  WsSlotVector<Slot> sensor;
+  WsVector<uint32_t, MAX_SENSOR_IDS> ids_inc;
+  static DataPredicate required;
+  static SensorIdentity logicalIds;
+  static PromMetrics metrics;
+  static RainGauge rainGauge;
+  static Lightning lightning;
+  RecordSeqTracker tracker;
+  uint8_t msg[26] = {0};
+  uint8_t rec_buf[SENSOR_RECORD_MAX_SIZE];
+  char json[SENSOR_IDS_JSON_SIZE(MAX_SENSOR_IDS)];
+  uint8_t id_buf[MAX_SENSOR_IDS * 4];
+
+  sensor.resize(WEATHERSENSOR_MAX_SLOTS);
+  required.clear();
+  required.requireType(1);
+  required.requireType(4, 2);
+  required.begin(sensor.size());
+  logicalIds.clear();
+  logicalIds.begin(0);
+  metrics.reset();
+  rainGauge.reset();
+  lightning.reset();
+  tracker.reset();
+  time_t ts = 1744970000;
+  rainGauge.update(ts, 10.0);
+  lightning.update(ts, 0, 7);
+
+  startCounting();
+
+  bool done = false;
+  for (uint32_t i = 0; i < 1000; i++) {
+    uint32_t now = i * 12000;
+    ts += 12;
+
+    // Filter lists updated via JSON
+    if (i % 100 == 0) {
+      ids_inc.clear();
+      size_t size = sensorIdsFromJson("{\"ids\":[\"0x39582376\",\"0x12345678\"]}", id_buf, MAX_SENSOR_IDS);
+      for (size_t j = 0; j < size; j += 4)
+        ids_inc.push_back((id_buf[j] << 24) | (id_buf[j + 1] << 16) | (id_buf[j + 2] << 8) | id_buf[j + 3]);
+      CHECK(sensorIdsToJson(ids_inc.data(), ids_inc.size(), json, sizeof(json)) > 0);
+    }
+
+    // Message
+    msg[i % sizeof(msg)] = i & 0xFF;
+    precheck5In1(msg, sizeof(msg));
+    precheck6In1(msg, sizeof(msg));
+    precheck7In1(msg, sizeof(msg));
+    uint32_t id = ids_inc[i % 2];
+    uint8_t s_type = (i % 2) ? 4 : 1;
+    id = logicalIds.map(id, 0x02, s_type, 2, false, false, now);
+    logicalIds.learn(id, 0x02, s_type, 2, now);
+
+    // Slot
+    size_t slot = i % 2;
+    sensor[slot].sensor_id = id;
+    sensor[slot].s_type = s_type;
+    sensor[slot].chan = 2;
+    sensor[slot].valid = true;
+    sensor[slot].complete = true;
+    done |= required.update(slot, required.match(slot, id, s_type, 2, true, true));
+
+    // Post-processing
+    rainGauge.update(ts, 10.0 + i * 0.1);
+    lightning.update(ts, i / 10, 7);
+
+    // Metrics & records
+    metrics.countStatus(0);
+    metrics.onPacket(id, -80.0, now);
+    metrics.observeGetData(100, true);
+    if (i % 100 == 0) {
+      metrics.setRain(rainGauge.pastHour(), rainGauge.currentDay(), rainGauge.currentWeek(), rainGauge.currentMonth());
+      CHECK(metrics.render() > 0);
+    }
+    SensorRecord rec = {};
+    rec.sensor_id = id;
+    rec.seq = i;
+    CHECK(encodeRecord(rec_buf, sizeof(rec_buf), rec) > 0);
+    CHECK(decodeRecord(rec_buf, sizeof(rec_buf), rec));
+    tracker.update(1, i);
+  }
+
+  UNSIGNED_LONGS_EQUAL(0, stopCounting());
+  CHECK(done);
+  UNSIGNED_LONGS_EQUAL(2, logicalIds.count());
+}
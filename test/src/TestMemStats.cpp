@@ -0,0 +1,253 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestMemStats.cpp
+//
+// CppUTest unit tests for MemStats (heap and stack instrumentation)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250423 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestMemoryAllocator.h"
+
+#include <string.h>
+#include "MemStats.h"
+
+// Size of simulated heap
+#define HEAP_SIZE   100000
+
+/*
+ * Allocator counting allocations and tracking allocated blocks/bytes while installed
+ */
+class HeapAllocator : public TestMemoryAllocator {
+  TestMemoryAllocator *real;
+
+  struct {
+    char   *ptr;
+    size_t size;
+  } blocks[64];
+
+public:
+  uint32_t allocs;
+  uint32_t numBlocks;
+  uint32_t allocated;
+
+  HeapAllocator(TestMemoryAllocator *allocator) :
+    TestMemoryAllocator(allocator->name(), allocator->alloc_name(), allocator->free_name()),
+    real(allocator), allocs(0), numBlocks(0), allocated(0) {
+    memset(blocks, 0, sizeof(blocks));
+  }
+
+  char *alloc_memory(size_t size, const char *file, size_t line) override {
+    char *p = real->alloc_memory(size, file, line);
+    allocs++;
+    for (auto &b : blocks) {
+      if (!b.ptr) {
+        b.ptr = p;
+        b.size = size;
+        numBlocks++;
+        allocated += size;
+        break;
+      }
+    }
+    return p;
+  }
+
+  void free_memory(char *memory, size_t size, const char *file, size_t line) override {
+    for (auto &b : blocks) {
+      if (b.ptr && (b.ptr == memory)) {
+        numBlocks--;
+        allocated -= b.size;
+        b.ptr = nullptr;
+        break;
+      }
+    }
+    real->free_memory(memory, size, file, line);
+  }
+};
+
+static HeapAllocator *heap;
+
+// Allocate via new[] (pointer is stored to prevent the allocation from being optimized away)
+static char *volatile lastAlloc;
+
+static char *alloc(size_t size)
+{
+  lastAlloc = new char[size];
+  return lastAlloc;
+}
+
+// Probe based on HeapAllocator (largest free block: free heap minus 10%)
+static void heapProbe(MemSample &s)
+{
+  s.free = HEAP_SIZE - heap->allocated;
+  s.maxBlock = s.free - s.free / 10;
+  s.blocks = heap->numBlocks;
+  s.allocs = heap->allocs;
+}
+
+TEST_GROUP(TG_MemStats) {
+  TestMemoryAllocator *origNew;
+  TestMemoryAllocator *origNewArray;
+
+  void setup() {
+    origNew = getCurrentNewAllocator();
+    origNewArray = getCurrentNewArrayAllocator();
+    heap = new HeapAllocator(origNewArray);
+    setCurrentNewAllocator(heap);
+    setCurrentNewArrayAllocator(heap);
+  }
+
+  void teardown() {
+    setCurrentNewAllocator(origNew);
+    setCurrentNewArrayAllocator(origNewArray);
+    delete heap;
+  }
+};
+
+/*
+ * Allocations, blocks and free heap per phase
+ */
+TEST(TG_MemStats, Test_Phases) {
+  MemStats stats(heapProbe);
+  const MemStatsData &d = stats.data();
+
+  // Phase without allocations
+  stats.enter(MEM_PHASE_GETDATA);
+  stats.leave(MEM_PHASE_GETDATA);
+  UNSIGNED_LONGS_EQUAL(1, d.phase[MEM_PHASE_GETDATA].calls);
+  UNSIGNED_LONGS_EQUAL(0, d.phase[MEM_PHASE_GETDATA].allocs);
+  LONGS_EQUAL(0, d.phase[MEM_PHASE_GETDATA].blocks);
+  UNSIGNED_LONGS_EQUAL(HEAP_SIZE, d.phase[MEM_PHASE_GETDATA].freeMin);
+
+  // Temporary allocations are freed within phase
+  for (int i = 0; i < 3; i++) {
+    MemStatsScope scope(&stats, MEM_PHASE_PUBLISH);
+    char *tmp = alloc(200);
+    delete[] tmp;
+  }
+  const MemPhaseStats &pub = d.phase[MEM_PHASE_PUBLISH];
+  UNSIGNED_LONGS_EQUAL(3, pub.calls);
+  UNSIGNED_LONGS_EQUAL(3, pub.allocs);
+  LONGS_EQUAL(0, pub.blocks);
+  LONGS_EQUAL(0, pub.heap);
+
+  // Allocation retained after phase (potential leak)
+  stats.enter(MEM_PHASE_DISCOVERY);
+  char *kept = alloc(1000);
+  stats.leave(MEM_PHASE_DISCOVERY);
+  const MemPhaseStats &disc = d.phase[MEM_PHASE_DISCOVERY];
+  UNSIGNED_LONGS_EQUAL(1, disc.allocs);
+  LONGS_EQUAL(1, disc.blocks);
+  LONGS_EQUAL(-1000, disc.heap);
+  UNSIGNED_LONGS_EQUAL(HEAP_SIZE - 1000, disc.freeMin);
+  UNSIGNED_LONGS_EQUAL(HEAP_SIZE - 1000, d.freeMin);
+  UNSIGNED_LONGS_EQUAL((HEAP_SIZE - 1000) * 9 / 10, d.maxBlockMin);
+  UNSIGNED_LONGS_EQUAL(10, d.fragMax);
+  delete[] kept;
+
+  // Leaving a phase which was not entered is ignored
+  stats.leave(MEM_PHASE_DISCOVERY);
+  UNSIGNED_LONGS_EQUAL(1, disc.calls);
+
+  stats.reset();
+  UNSIGNED_LONGS_EQUAL(0, d.samples);
+  UNSIGNED_LONGS_EQUAL(0, d.phase[MEM_PHASE_PUBLISH].calls);
+}
+
+/*
+ * Nested phases (decoding within getData())
+ */
+TEST(TG_MemStats, Test_Nested) {
+  MemStats stats(heapProbe);
+  const MemStatsData &d = stats.data();
+
+  {
+    MemStatsScope outer(&stats, MEM_PHASE_GETDATA);
+    char *a = alloc(100);
+    stats.enter(MEM_PHASE_DECODE);
+    char *b = alloc(50);
+    char *c = alloc(50);
+    stats.leave(MEM_PHASE_DECODE);
+    delete[] a;
+    delete[] b;
+    delete[] c;
+  }
+
+  UNSIGNED_LONGS_EQUAL(2, d.phase[MEM_PHASE_DECODE].allocs);
+  LONGS_EQUAL(2, d.phase[MEM_PHASE_DECODE].blocks);
+  LONGS_EQUAL(-100, d.phase[MEM_PHASE_DECODE].heap);
+
+  // Outer phase includes allocations of inner phase
+  UNSIGNED_LONGS_EQUAL(3, d.phase[MEM_PHASE_GETDATA].allocs);
+  LONGS_EQUAL(0, d.phase[MEM_PHASE_GETDATA].blocks);
+  LONGS_EQUAL(0, d.phase[MEM_PHASE_GETDATA].heap);
+  UNSIGNED_LONGS_EQUAL(HEAP_SIZE - 200, d.freeMin);
+
+  // nullptr is accepted
+  MemStatsScope none(nullptr, MEM_PHASE_GETDATA);
+}
+
+/*
+ * Stack high-water marks and JSON summary
+ */
+TEST(TG_MemStats, Test_Summary) {
+  MemStats stats(heapProbe);
+  char buf[400];
+
+  stats.sampleStack(MEM_STACK_LOOP, 3000);
+  stats.sampleStack(MEM_STACK_LOOP, 2500);
+  stats.sampleStack(MEM_STACK_LOOP, 2800);
+  UNSIGNED_LONGS_EQUAL(2500, stats.data().stackMin[MEM_STACK_LOOP]);
+
+  stats.enter(MEM_PHASE_DECODE);
+  stats.leave(MEM_PHASE_DECODE);
+
+  size_t len = stats.summary(buf, sizeof(buf));
+  const char *exp = "{\"n\":2,\"free\":100000,\"free_min\":100000,\"blk_min\":90000,\"frag_max\":10,"
+                    "\"stack\":[2500,-1],"
+                    "\"getdata\":[0,0,0,0,-1,-1],"
+                    "\"decode\":[1,0,0,0,100000,90000],"
+                    "\"publish\":[0,0,0,0,-1,-1],"
+                    "\"discovery\":[0,0,0,0,-1,-1]}";
+  STRCMP_EQUAL(exp, buf);
+  UNSIGNED_LONGS_EQUAL(strlen(exp), len);
+
+  // Buffer too small
+  UNSIGNED_LONGS_EQUAL(0, stats.summary(buf, strlen(exp)));
+  STRCMP_EQUAL("", buf);
+  UNSIGNED_LONGS_EQUAL(strlen(exp), stats.summary(buf, strlen(exp) + 1));
+}
@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestNoiseFloor.cpp
+//
+// CppUTest unit tests for NoiseFloor (noise floor estimator and adaptive RSSI threshold)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250429 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+#include <stdio.h>
+#include "NoiseFloor.h"
+
+#define FLOOR   -105.0f
+
+static NoiseFloor nf;
+static uint32_t seed;
+static uint32_t now;
+
+// Uniform random number in [lo, hi)
+static float uniform(float lo, float hi)
+{
+  seed = seed * 1103515245 + 12345;
+  return lo + (hi - lo) * ((seed >> 8) & 0xFFFF) / 65536.0f;
+}
+
+// Idle sample: noise around floor, every 10th sample taken during a transmission
+static void idle(float floor, int n)
+{
+  for (int i = 0; i < n; i++) {
+    now += NOISE_FLOOR_INTERVAL;
+    float rssi = floor + uniform(-1.5, 1.5) + uniform(-1.5, 1.5);
+    if ((seed >> 4) % 10 == 0)
+      rssi = -70;
+    nf.addSample(now, rssi);
+  }
+}
+
+TEST_GROUP(TG_NoiseFloor) {
+  void setup() {
+    nf = NoiseFloor();
+    seed = 1;
+    now = 0;
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Noise floor estimate is robust against samples taken during transmissions
+ */
+TEST(TG_NoiseFloor, Test_Estimate) {
+  // Not enough samples - no threshold, all frames accepted
+  idle(FLOOR, NOISE_FLOOR_MIN_SAMPLES - 1);
+  CHECK_FALSE(nf.stats().ready);
+  CHECK(nf.accept(-120));
+
+  idle(FLOOR, 200);
+  CHECK(nf.stats().ready);
+  DOUBLES_EQUAL(FLOOR, nf.stats().floor, 1.0);
+  DOUBLES_EQUAL(FLOOR, nf.stats().baseline, 1.0);
+  CHECK(nf.stats().spread < 3.0);
+  CHECK_FALSE(nf.stats().jammed);
+  UNSIGNED_LONGS_EQUAL(NOISE_FLOOR_MIN_SAMPLES - 1 + 200, nf.stats().samples);
+
+  CHECK_FALSE(nf.sampleDue(now + NOISE_FLOOR_INTERVAL - 1));
+  CHECK(nf.sampleDue(now + NOISE_FLOOR_INTERVAL));
+}
+
+/*
+ * Margin adapts to drop noise triggered frames while keeping valid frames
+ */
+TEST(TG_NoiseFloor, Test_Adapt) {
+  idle(FLOOR, 64);
+  UNSIGNED_LONGS_EQUAL(NOISE_MARGIN_MIN, nf.stats().margin);
+
+  // Valid frames 6..40 dB, noise triggered frames -2..5 dB above floor
+  uint32_t validSent = 0, validDecoded = 0;
+  uint32_t invalidSent = 0, invalidDecoded = 0;
+  for (int i = 0; i < 4000; i++) {
+    idle(FLOOR, 2);
+    bool valid = uniform(0, 1) < 0.3f;
+    float rssi = FLOOR + (valid ? uniform(6, 40) : uniform(-2, 5));
+    bool decoded = nf.accept(rssi);
+    if (decoded)
+      nf.feedback(rssi, valid);
+    if (i >= 2000) {
+      validSent += valid;
+      validDecoded += valid && decoded;
+      invalidSent += !valid;
+      invalidDecoded += !valid && decoded;
+    }
+  }
+  printf("\nNoise floor: margin %u dB, valid yield %u/%u, invalid decoded %u/%u\n",
+         nf.stats().margin, (unsigned)validDecoded, (unsigned)validSent,
+         (unsigned)invalidDecoded, (unsigned)invalidSent);
+
+  CHECK((nf.stats().margin >= 5) && (nf.stats().margin <= 7));
+  CHECK(validDecoded * 1000 >= validSent * (1000 - NOISE_YIELD_LOSS));
+  // Only probes of noise triggered frames are decoded
+  CHECK(invalidDecoded * 100 < invalidSent * 20);
+  CHECK(nf.stats().rejected > 0);
+  CHECK(nf.stats().probes > 0);
+
+  // Threshold follows the noise floor
+  idle(FLOOR + 5, NOISE_FLOOR_WINDOW);
+  DOUBLES_EQUAL(FLOOR + 5 + nf.stats().margin, nf.threshold(), 1.0);
+}
+
+/*
+ * No invalid frames - no reason to raise the threshold
+ */
+TEST(TG_NoiseFloor, Test_Clean) {
+  idle(FLOOR, 64);
+  for (int i = 0; i < 500; i++) {
+    float rssi = FLOOR + uniform(3, 40);
+    CHECK(nf.accept(rssi));
+    nf.feedback(rssi, true);
+  }
+  UNSIGNED_LONGS_EQUAL(NOISE_MARGIN_MIN, nf.stats().margin);
+  UNSIGNED_LONGS_EQUAL(0, nf.stats().rejected);
+}
+
+/*
+ * Rise of noise floor above long-term baseline is reported as interference/jamming
+ */
+TEST(TG_NoiseFloor, Test_Jamming) {
+  idle(FLOOR, 500);
+  CHECK_FALSE(nf.stats().jammed);
+
+  idle(FLOOR + NOISE_JAM_DB + 5, NOISE_FLOOR_WINDOW);
+  CHECK(nf.stats().jammed);
+  UNSIGNED_LONGS_EQUAL(1, nf.stats().jamEvents);
+  DOUBLES_EQUAL(FLOOR, nf.stats().baseline, 1.0);
+
+  char buf[256];
+  size_t len = nf.summary(buf, sizeof(buf));
+  CHECK(len > 0);
+  UNSIGNED_LONGS_EQUAL(strlen(buf), len);
+  CHECK(strstr(buf, "\"jam\":1,\"jam_events\":1") != nullptr);
+  CHECK(nf.summary(buf, 20) == 0);
+
+  idle(FLOOR, NOISE_FLOOR_WINDOW);
+  CHECK_FALSE(nf.stats().jammed);
+  UNSIGNED_LONGS_EQUAL(1, nf.stats().jamEvents);
+}
@@ -0,0 +1,410 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestPromMetrics.cpp
+//
+// CppUTest unit tests for PromMetrics (including HTTP exchange via loopback)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250419 Created
+// 20250428 Added radio packet/false trigger counters
+// 20250429 Added noise floor metrics
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "PromMetrics.h"
+
+// Decoding status values (see DecodeStatus in WeatherSensor.h)
+#define ST_INVALID  0
+#define ST_OK       1
+#define ST_DIG_ERR  4
+
+static PromMetrics metrics;
+
+/*
+ * Simulated radio traffic - one message every 'period' ms over 'duration' ms
+ * from 'num' sensors (round robin); every 10th message is corrupted
+ * and every 25th message is noise.
+ */
+static uint32_t simulate(uint32_t start, uint32_t duration, uint32_t period, int num)
+{
+    uint32_t n = 0;
+    for (uint32_t t = start; t < start + duration; t += period, n++) {
+        uint32_t id = 0x39582370 + (n % num);
+        if (n % 25 == 24) {
+            metrics.countStatus(ST_INVALID);
+        } else if (n % 10 == 9) {
+            metrics.countStatus(ST_DIG_ERR);
+        } else {
+            metrics.countStatus(ST_OK);
+            metrics.onPacket(id, -60.0 - (n % num), t);
+        }
+    }
+    return n;
+}
+
+// Find line in text
+static bool hasLine(const char *text, const char *line)
+{
+    size_t len = strlen(line);
+    for (const char *p = strstr(text, line); p; p = strstr(p + 1, line)) {
+        if (((p == text) || (p[-1] == '\n')) && (p[len] == '\n'))
+            return true;
+    }
+    return false;
+}
+
+// Check syntax: comment lines or '<name>[{<labels>}] <value>'
+static bool checkSyntax(const char *text, size_t len)
+{
+    if ((len == 0) || (text[len - 1] != '\n') || (strlen(text) != len))
+        return false;
+
+    const char *p = text;
+    while (*p) {
+        const char *eol = strchr(p, '\n');
+        if (*p != '#') {
+            const char *sp = strchr(p, ' ');
+            if (!sp || (sp > eol) || (sp == p) || (sp + 1 == eol))
+                return false;
+            for (const char *c = p; c < sp; c++) {
+                if (*c == '{')
+                    break;
+                if (!((*c >= 'a') && (*c <= 'z')) && (*c != '_') && !((*c >= '0') && (*c <= '9')))
+                    return false;
+            }
+        }
+        p = eol + 1;
+    }
+    return true;
+}
+
+TEST_GROUP(TG_PromMetrics) {
+  void setup() {
+    metrics.reset();
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Counters and gauges from simulated radio traffic
+ */
+TEST(TG_PromMetrics, Test_Render) {
+  // 2 sensors, one message every 6 s for one hour
+  uint32_t n = simulate(1000, 3600000, 6000, 2);
+  UNSIGNED_LONGS_EQUAL(600, n);
+
+  RejectStats stats = {};
+  stats.frames = 600;
+  stats.early[0] = 17;
+  stats.integrity[2] = 60;
+  metrics.setRejectStats(stats);
+  SyncStats sync = {};
+  sync.irqs = 650;
+  sync.syncErr = 50;
+  sync.invalid = 24;
+  metrics.setSyncStats(sync, "CC1101");
+  NoiseFloorStats noise = {};
+  noise.floor = -104.5;
+  noise.baseline = -105.2;
+  noise.margin = 6;
+  noise.ready = true;
+  noise.rejected = 123;
+  metrics.setNoiseFloor(noise);
+  metrics.setHeap(180000, 150000, 110000);
+  metrics.setRain(0.8, 12.3, 45.6, 78.9);
+  metrics.setLightning(3, 2, 7);
+  metrics.observeGetData(900, true);
+  metrics.observeGetData(4800, true);
+  metrics.observeGetData(180000, false);
+
+  size_t len = metrics.render();
+  const char *text = metrics.text();
+  CHECK(checkSyntax(text, len));
+
+  // Every 25th message is noise, every 10th (unless noise) corrupted
+  CHECK(hasLine(text, "bresser_decode_total{status=\"invalid\"} 24"));
+  CHECK(hasLine(text, "bresser_decode_total{status=\"digest_error\"} 48"));
+  CHECK(hasLine(text, "bresser_decode_total{status=\"ok\"} 528"));
+  CHECK(hasLine(text, "bresser_decode_total{status=\"full\"} 0"));
+  CHECK(hasLine(text, "bresser_decoder_frames_total 600"));
+  CHECK(hasLine(text, "bresser_decoder_early_rejects_total{decoder=\"5in1\"} 17"));
+  CHECK(hasLine(text, "bresser_decoder_integrity_rejects_total{decoder=\"7in1\"} 60"));
+  CHECK(hasLine(text, "bresser_radio_packets_total{chip=\"CC1101\",sync=\"sw\"} 650"));
+  CHECK(hasLine(text, "bresser_radio_false_triggers_total{chip=\"CC1101\",sync=\"sw\",stage=\"sync\"} 50"));
+  CHECK(hasLine(text, "bresser_radio_false_triggers_total{chip=\"CC1101\",sync=\"sw\",stage=\"decode\"} 24"));
+  CHECK(hasLine(text, "bresser_radio_noise_floor_dbm -104.5"));
+  CHECK(hasLine(text, "bresser_radio_noise_baseline_dbm -105.2"));
+  CHECK(hasLine(text, "bresser_radio_rssi_margin_db 6"));
+  CHECK(hasLine(text, "bresser_radio_squelched_total 123"));
+  CHECK(hasLine(text, "bresser_radio_jammed 0"));
+  CHECK(hasLine(text, "# TYPE bresser_sensor_rssi_dbm gauge"));
+  CHECK(hasLine(text, "bresser_sensor_rssi_dbm{id=\"0x39582370\"} -60.0"));
+  CHECK(hasLine(text, "bresser_sensor_rssi_dbm{id=\"0x39582371\"} -61.0"));
+  CHECK(hasLine(text, "bresser_sensor_packets_total{id=\"0x39582370\"} 288"));
+
+  // Each sensor transmits every 12 s; some messages are lost -> 4..5 per minute
+  const char *rate = strstr(text, "bresser_sensor_packet_rate_per_minute{id=\"0x39582370\"} ");
+  CHECK(rate != nullptr);
+  double r = atof(strchr(rate, ' ') + 1);
+  CHECK((r > 4.0) && (r <= 5.0));
+
+  CHECK(hasLine(text, "# TYPE bresser_getdata_duration_seconds histogram"));
+  CHECK(hasLine(text, "bresser_getdata_duration_seconds_bucket{le=\"0.5\"} 0"));
+  CHECK(hasLine(text, "bresser_getdata_duration_seconds_bucket{le=\"1\"} 1"));
+  CHECK(hasLine(text, "bresser_getdata_duration_seconds_bucket{le=\"5\"} 2"));
+  CHECK(hasLine(text, "bresser_getdata_duration_seconds_bucket{le=\"120\"} 2"));
+  CHECK(hasLine(text, "bresser_getdata_duration_seconds_bucket{le=\"+Inf\"} 3"));
+  CHECK(hasLine(text, "bresser_getdata_duration_seconds_sum 185.700"));
+  CHECK(hasLine(text, "bresser_getdata_duration_seconds_count 3"));
+  CHECK(hasLine(text, "bresser_getdata_total{result=\"timeout\"} 1"));
+  CHECK(hasLine(text, "bresser_heap_min_free_bytes 150000"));
+  CHECK(hasLine(text, "bresser_rain_mm{period=\"day\"} 12.3"));
+  CHECK(hasLine(text, "bresser_lightning_last_event_distance_km 7"));
+  CHECK(hasLine(text, "bresser_metrics_renders_total 1"));
+  CHECK(hasLine(text, "bresser_metrics_truncations_total 0"));
+}
+
+/*
+ * Optional sections are omitted until set
+ */
+TEST(TG_PromMetrics, Test_Optional) {
+  size_t len = metrics.render();
+  const char *text = metrics.text();
+  CHECK(checkSyntax(text, len));
+  CHECK(strstr(text, "bresser_heap") == nullptr);
+  CHECK(strstr(text, "bresser_rain") == nullptr);
+  CHECK(strstr(text, "bresser_lightning") == nullptr);
+  CHECK(strstr(text, "bresser_decoder_") == nullptr);
+  CHECK(strstr(text, "bresser_radio_") == nullptr);
+  CHECK(strstr(text, "bresser_sensor_rssi_dbm{") == nullptr);
+}
+
+/*
+ * Sensor table overflow - least recently seen sensor is replaced;
+ * the fully populated table fits into the text buffer
+ */
+TEST(TG_PromMetrics, Test_Eviction) {
+  for (int i = 0; i < METRICS_MAX_SENSORS; i++) {
+    metrics.onPacket(0x1000 + i, -70, 1000 * i);
+    metrics.onPacket(0x1000 + i, -70, 1000 * i + 500);
+  }
+  // Refresh first sensor - second one is now the least recently seen
+  metrics.onPacket(0x1000, -71, 100000);
+  metrics.onPacket(0xFFFFFFFF, -99.5, 100001);
+
+  RejectStats stats = {};
+  metrics.setRejectStats(stats);
+  SyncStats sync = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, true};
+  metrics.setSyncStats(sync, "LR1121");
+  NoiseFloorStats noise = {};
+  noise.floor = -32768.0f;
+  noise.baseline = -32768.0f;
+  noise.margin = 255;
+  noise.ready = true;
+  noise.jammed = true;
+  noise.rejected = 0xFFFFFFFF;
+  noise.jamEvents = 0xFFFFFFFF;
+  metrics.setNoiseFloor(noise);
+  metrics.setHeap(0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF);
+  metrics.setRain(99999.9, 99999.9, 99999.9, 99999.9);
+  metrics.setLightning(-1, -1, 255);
+  metrics.observeGetData(0xFFFFFFFF, false);
+
+  size_t len = metrics.render();
+  const char *text = metrics.text();
+  CHECK(checkSyntax(text, len));
+  CHECK(hasLine(text, "bresser_metrics_truncations_total 0"));
+  CHECK(hasLine(text, "bresser_sensor_evictions_total 1"));
+  CHECK(hasLine(text, "bresser_sensor_rssi_dbm{id=\"0x00001000\"} -71.0"));
+  CHECK(hasLine(text, "bresser_sensor_rssi_dbm{id=\"0xFFFFFFFF\"} -99.5"));
+  CHECK(hasLine(text, "bresser_sensor_packets_total{id=\"0xFFFFFFFF\"} 1"));
+  CHECK(strstr(text, "0x00001001") == nullptr);
+  CHECK(strstr(text, "0x00001002") != nullptr);
+  CHECK(hasLine(text, "bresser_sensor_packet_rate_per_minute{id=\"0x00001002\"} 120.00"));
+
+  // Render is repeatable
+  CHECK(hasLine(text, "bresser_metrics_renders_total 1"));
+  size_t len2 = metrics.render();
+  CHECK(len2 == len);
+  CHECK(hasLine(metrics.text(), "bresser_metrics_renders_total 2"));
+  printf("\nMetrics text with %d sensors: %u of %u bytes\n",
+         METRICS_MAX_SENSORS, (unsigned)len, (unsigned)METRICS_BUF_SIZE);
+}
+
+/*
+ * HTTP request routing and response header
+ */
+TEST(TG_PromMetrics, Test_HttpHelpers) {
+  char hdr[160];
+
+  LONGS_EQUAL(200, PromMetrics::httpStatus("GET /metrics HTTP/1.1\r\n"));
+  LONGS_EQUAL(200, PromMetrics::httpStatus("GET /metrics?x=1 HTTP/1.0"));
+  LONGS_EQUAL(404, PromMetrics::httpStatus("GET /metricsx HTTP/1.1"));
+  LONGS_EQUAL(404, PromMetrics::httpStatus("GET / HTTP/1.1"));
+  LONGS_EQUAL(405, PromMetrics::httpStatus("POST /metrics HTTP/1.1"));
+  LONGS_EQUAL(405, PromMetrics::httpStatus(""));
+
+  size_t n = PromMetrics::httpHeader(hdr, sizeof(hdr), 200, 1234);
+  STRCMP_EQUAL("HTTP/1.1 200 OK\r\n"
+               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+               "Content-Length: 1234\r\n"
+               "Connection: close\r\n"
+               "\r\n", hdr);
+  UNSIGNED_LONGS_EQUAL(strlen(hdr), n);
+
+  n = PromMetrics::httpHeader(hdr, sizeof(hdr), 404, 0);
+  CHECK(strncmp(hdr, "HTTP/1.1 404 Not Found\r\n", 24) == 0);
+
+  // Buffer too small
+  UNSIGNED_LONGS_EQUAL(0, PromMetrics::httpHeader(hdr, 20, 200, 0));
+  STRCMP_EQUAL("", hdr);
+}
+
+// Minimal HTTP server - serves a single request (see metrics_http.cpp for the ESP32 version)
+static void serveOnce(int listener)
+{
+    char req[256];
+    char hdr[160];
+
+    int fd = accept(listener, nullptr, nullptr);
+    if (fd < 0)
+        return;
+
+    ssize_t n = recv(fd, req, sizeof(req) - 1, 0);
+    req[(n > 0) ? n : 0] = '\0';
+
+    int status = PromMetrics::httpStatus(req);
+    size_t len = (status == 200) ? metrics.render() : 0;
+    size_t hlen = PromMetrics::httpHeader(hdr, sizeof(hdr), status, len);
+    send(fd, hdr, hlen, 0);
+    if (len)
+        send(fd, metrics.text(), len, 0);
+    close(fd);
+}
+
+// HTTP client - returns response (header and body)
+static size_t fetch(uint16_t port, const char *request, char *resp, size_t size)
+{
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return 0;
+    }
+    send(fd, request, strlen(request), 0);
+
+    size_t pos = 0;
+    ssize_t n;
+    while ((pos < size - 1) && ((n = recv(fd, &resp[pos], size - 1 - pos, 0)) > 0)) {
+        pos += n;
+    }
+    resp[pos] = '\0';
+    close(fd);
+    return pos;
+}
+
+/*
+ * Scrape via local HTTP client while simulated traffic is fed
+ */
+TEST(TG_PromMetrics, Test_HttpLoopback) {
+  static char resp[METRICS_BUF_SIZE + 256];
+
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  CHECK(listener >= 0);
+  int on = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = 0;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  CHECK(bind(listener, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+  CHECK(listen(listener, 1) == 0);
+  socklen_t alen = sizeof(addr);
+  getsockname(listener, (struct sockaddr *)&addr, &alen);
+  uint16_t port = ntohs(addr.sin_port);
+
+  simulate(0, 600000, 4000, 3);
+  metrics.setHeap(200000, 190000, 100000);
+
+  // Scrape
+  std::thread server(serveOnce, listener);
+  size_t n = fetch(port, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n", resp, sizeof(resp));
+  server.join();
+
+  CHECK(n > 0);
+  CHECK(strncmp(resp, "HTTP/1.1 200 OK\r\n", 17) == 0);
+  const char *body = strstr(resp, "\r\n\r\n");
+  CHECK(body != nullptr);
+  body += 4;
+  const char *cl = strstr(resp, "Content-Length: ");
+  CHECK(cl != nullptr);
+  UNSIGNED_LONGS_EQUAL(strlen(body), (size_t)atoi(cl + 16));
+  STRCMP_EQUAL(metrics.text(), body);
+  CHECK(checkSyntax(body, strlen(body)));
+  CHECK(hasLine(body, "bresser_heap_free_bytes 200000"));
+  CHECK(hasLine(body, "bresser_sensor_packets_total{id=\"0x39582372\"} 44"));
+
+  // Wrong path
+  server = std::thread(serveOnce, listener);
+  n = fetch(port, "GET /favicon.ico HTTP/1.1\r\n\r\n", resp, sizeof(resp));
+  server.join();
+  CHECK(strncmp(resp, "HTTP/1.1 404 Not Found\r\n", 24) == 0);
+  CHECK(strstr(resp, "Content-Length: 0\r\n") != nullptr);
+
+  close(listener);
+
+  // Rendering time
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < 1000; i++) {
+    metrics.render();
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double us = std::chrono::duration<double, std::micro>(t1 - t0).count() / 1000;
+  printf("\nRendering: %.1f us per scrape (host)\n", us);
+}
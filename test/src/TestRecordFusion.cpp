@@ -0,0 +1,246 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestRecordFusion.cpp
+//
+// CppUTest unit tests for RecordFusion (multi-gateway record fusion)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250424 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+#include "RecordFusion.h"
+
+#define RX_A        0xA0000001
+#define RX_B        0xB0000002
+#define RX_C        0xC0000003
+#define ID_WS       0x39582376
+#define ID_SOIL     0x12345678
+#define T0          100000
+
+static RecordFusion fusion;
+static uint32_t seqNo[3];
+
+// Record of weather sensor as forwarded by receiver 'rx' (index 'n')
+static SensorRecord weather(int n, uint32_t rx, uint32_t id, float temp, float rssi)
+{
+  SensorRecord rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.receiver_id = rx;
+  rec.seq = seqNo[n]++;
+  rec.timestamp = 1745000000 + n;
+  rec.sensor_id = id;
+  rec.rssi = rssi;
+  rec.kind = RECORD_KIND_WEATHER;
+  rec.s_type = 1;
+  rec.decoder = 2;
+  rec.flags = RECORD_FLAG_BATTERY_OK;
+  rec.ok = RECORD_OK_TEMP | RECORD_OK_HUMIDITY;
+  rec.temp_c = temp;
+  rec.humidity = 55;
+  return rec;
+}
+
+TEST_GROUP(TG_RecordFusion) {
+  void setup() {
+    fusion = RecordFusion(FUSION_WINDOW_MS);
+    memset(seqNo, 0, sizeof(seqNo));
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Three receivers forward the same message - one fused record with best RSSI
+ */
+TEST(TG_RecordFusion, Test_BestRssi) {
+  FusedRecord out;
+
+  CHECK(fusion.ingest(weather(0, RX_A, ID_WS, 21.3, -95.0), T0));
+  CHECK_FALSE(fusion.ingest(weather(1, RX_B, ID_WS, 21.3, -71.5), T0 + 200));
+  CHECK_FALSE(fusion.ingest(weather(2, RX_C, ID_WS, 21.3, -84.0), T0 + 900));
+
+  // Window not expired yet
+  CHECK_FALSE(fusion.poll(T0 + FUSION_WINDOW_MS - 1, out));
+  UNSIGNED_LONGS_EQUAL(1, fusion.pending());
+
+  CHECK(fusion.poll(T0 + FUSION_WINDOW_MS, out));
+  CHECK_FALSE(fusion.poll(T0 + FUSION_WINDOW_MS, out));
+  UNSIGNED_LONGS_EQUAL(RX_B, out.rec.receiver_id);
+  DOUBLES_EQUAL(-71.5, out.rec.rssi, 0.01);
+  DOUBLES_EQUAL(21.3, out.rec.temp_c, 0.01);
+  UNSIGNED_LONGS_EQUAL(3, out.copies);
+  UNSIGNED_LONGS_EQUAL(3, out.receivers);
+  UNSIGNED_LONGS_EQUAL(RX_A, out.receiver_id[0]);
+  DOUBLES_EQUAL(-95.0, out.rssi[0], 0.01);
+  UNSIGNED_LONGS_EQUAL(RX_C, out.receiver_id[2]);
+  DOUBLES_EQUAL(-84.0, out.rssi[2], 0.01);
+
+  UNSIGNED_LONGS_EQUAL(3, fusion.received);
+  UNSIGNED_LONGS_EQUAL(2, fusion.duplicates);
+  UNSIGNED_LONGS_EQUAL(1, fusion.published);
+  UNSIGNED_LONGS_EQUAL(0, fusion.pending());
+}
+
+/*
+ * Different sensors, different payloads, same payload in next transmission
+ */
+TEST(TG_RecordFusion, Test_Groups) {
+  FusedRecord out;
+
+  // Hash independent of receiver specific fields
+  UNSIGNED_LONGS_EQUAL(RecordFusion::payloadHash(weather(0, RX_A, ID_WS, 21.3, -95.0)),
+                       RecordFusion::payloadHash(weather(1, RX_B, ID_WS, 21.3, -60.0)));
+  CHECK(RecordFusion::payloadHash(weather(0, RX_A, ID_WS, 21.3, -95.0)) !=
+        RecordFusion::payloadHash(weather(0, RX_A, ID_WS, 21.4, -95.0)));
+
+  CHECK(fusion.ingest(weather(0, RX_A, ID_WS, 21.3, -80.0), T0));
+  CHECK(fusion.ingest(weather(0, RX_A, ID_SOIL, 21.3, -80.0), T0 + 10));
+  CHECK(fusion.ingest(weather(1, RX_B, ID_WS, 21.4, -70.0), T0 + 20));
+  CHECK_FALSE(fusion.ingest(weather(1, RX_B, ID_SOIL, 21.3, -90.0), T0 + 30));
+  UNSIGNED_LONGS_EQUAL(3, fusion.pending());
+
+  // Provided in order of first reception
+  CHECK(fusion.poll(T0 + FUSION_WINDOW_MS + 30, out));
+  UNSIGNED_LONGS_EQUAL(ID_WS, out.rec.sensor_id);
+  UNSIGNED_LONGS_EQUAL(1, out.copies);
+  CHECK(fusion.poll(T0 + FUSION_WINDOW_MS + 30, out));
+  UNSIGNED_LONGS_EQUAL(ID_SOIL, out.rec.sensor_id);
+  UNSIGNED_LONGS_EQUAL(2, out.copies);
+  UNSIGNED_LONGS_EQUAL(RX_A, out.rec.receiver_id);
+  CHECK(fusion.poll(T0 + FUSION_WINDOW_MS + 30, out));
+  DOUBLES_EQUAL(21.4, out.rec.temp_c, 0.01);
+
+  // Unchanged data in next transmission (after window) is published again
+  CHECK(fusion.ingest(weather(0, RX_A, ID_WS, 21.3, -80.0), T0 + 12000));
+  CHECK(fusion.poll(T0 + 12000 + FUSION_WINDOW_MS, out));
+  UNSIGNED_LONGS_EQUAL(4, fusion.published);
+}
+
+/*
+ * Repeated copies from one receiver count once per receiver
+ */
+TEST(TG_RecordFusion, Test_SameReceiver) {
+  FusedRecord out;
+
+  fusion.ingest(weather(0, RX_A, ID_WS, 10.0, -90.0), T0);
+  fusion.ingest(weather(0, RX_A, ID_WS, 10.0, -85.0), T0 + 5);
+  fusion.flush(out);
+  UNSIGNED_LONGS_EQUAL(2, out.copies);
+  UNSIGNED_LONGS_EQUAL(1, out.receivers);
+  DOUBLES_EQUAL(-85.0, out.rssi[0], 0.01);
+  CHECK_FALSE(fusion.flush(out));
+}
+
+/*
+ * Pool full - oldest group is closed early
+ */
+TEST(TG_RecordFusion, Test_PoolFull) {
+  FusedRecord out;
+
+  for (int i = 0; i < FUSION_ENTRIES; i++) {
+    CHECK(fusion.ingest(weather(0, RX_A, 0x1000 + i, 20.0, -80.0), T0));
+  }
+  CHECK_FALSE(fusion.poll(T0 + 1, out));
+
+  CHECK(fusion.ingest(weather(0, RX_A, 0x2000, 20.0, -80.0), T0 + 1));
+  UNSIGNED_LONGS_EQUAL(1, fusion.evicted);
+  UNSIGNED_LONGS_EQUAL(FUSION_ENTRIES + 1, fusion.pending());
+
+  // Next record dropped if early closed group has not been polled
+  CHECK_FALSE(fusion.ingest(weather(0, RX_A, 0x3000, 20.0, -80.0), T0 + 2));
+  UNSIGNED_LONGS_EQUAL(1, fusion.dropped);
+
+  CHECK(fusion.poll(T0 + 2, out));
+  UNSIGNED_LONGS_EQUAL(0x1000, out.rec.sensor_id);
+  CHECK_FALSE(fusion.poll(T0 + 2, out));
+
+  // Copy of group still in pool is merged
+  CHECK_FALSE(fusion.ingest(weather(1, RX_B, 0x1001, 20.0, -60.0), T0 + 3));
+
+  int n = 0;
+  while (fusion.poll(T0 + 1 + FUSION_WINDOW_MS, out)) {
+    if (out.rec.sensor_id == 0x1001)
+      UNSIGNED_LONGS_EQUAL(2, out.receivers);
+    n++;
+  }
+  LONGS_EQUAL(FUSION_ENTRIES, n);
+  UNSIGNED_LONGS_EQUAL(0, fusion.pending());
+}
+
+/*
+ * Simulated receivers with random delays, losses and RSSI - each message published once
+ */
+TEST(TG_RecordFusion, Test_Simulation) {
+  FusedRecord out;
+  uint32_t rnd = 12345;
+  const uint32_t rx[3] = {RX_A, RX_B, RX_C};
+  int published = 0;
+
+  for (int msg = 0; msg < 1000; msg++) {
+    uint32_t t = T0 + msg * 12000;
+    uint32_t id = 0x100 + (msg % 5);
+    float temp = 15.0 + (msg / 5) % 3;
+    float best = -200;
+    int best_rx = -1;
+
+    for (int n = 0; n < 3; n++) {
+      rnd = rnd * 1103515245 + 12345;
+      if ((rnd >> 16) % 10 == 0)
+        continue; // not received
+      float rssi = -60.0f - (float)((rnd >> 8) % 40);
+      if (rssi > best) {
+        best = rssi;
+        best_rx = n;
+      }
+      uint32_t now = t + n * 500 + (rnd >> 4) % 500;
+      fusion.ingest(weather(n, rx[n], id, temp, rssi), now);
+      while (fusion.poll(now, out))
+        published++;
+    }
+    if (best_rx >= 0) {
+      CHECK(fusion.flush(out));
+      published++;
+      UNSIGNED_LONGS_EQUAL(id, out.rec.sensor_id);
+      DOUBLES_EQUAL(best, out.rec.rssi, 0.01);
+    }
+  }
+  UNSIGNED_LONGS_EQUAL(fusion.published, published);
+  UNSIGNED_LONGS_EQUAL(fusion.received, fusion.published + fusion.duplicates);
+  UNSIGNED_LONGS_EQUAL(0, fusion.evicted);
+}
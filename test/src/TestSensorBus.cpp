@@ -0,0 +1,276 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestSensorBus.cpp
+//
+// CppUTest unit tests for SensorBus (in-process publish/subscribe bus)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250502 Created
+// 20250508 record()/intact() moved to TornRecord.h
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
+#include "SensorBus.h"
+#include "TornRecord.h"
+
+#define BENCH_RECORDS   1000000
+#define BENCH_PACED     100000
+#define BENCH_SENSORS   6
+
+static SensorBus *bus;
+
+TEST_GROUP(TG_SensorBus) {
+  void setup() {
+    bus = new SensorBus();
+  }
+
+  void teardown() {
+    delete bus;
+  }
+};
+
+/*
+ * Records are provided in order; new consumers start with the next record
+ */
+TEST(TG_SensorBus, Test_Order) {
+  SensorRecord rec;
+  SensorBusConsumer early(*bus);
+
+  CHECK_FALSE(early.poll(rec));
+  for (uint32_t i = 0; i < 10; i++)
+    bus->publish(record(i, 100 + i));
+  UNSIGNED_LONGS_EQUAL(10, bus->published());
+  UNSIGNED_LONGS_EQUAL(10, early.lag());
+
+  SensorBusConsumer late(*bus);
+  SensorBusConsumer replay(*bus, BUS_DROP_OLDEST, true);
+  CHECK_FALSE(late.poll(rec));
+
+  for (uint32_t i = 0; i < 10; i++) {
+    CHECK_TRUE(early.poll(rec));
+    UNSIGNED_LONGS_EQUAL(i, rec.seq);
+    UNSIGNED_LONGS_EQUAL(100 + i, rec.sensor_id);
+    CHECK_TRUE(intact(rec));
+    CHECK_TRUE(replay.poll(rec));
+    UNSIGNED_LONGS_EQUAL(i, rec.seq);
+  }
+  CHECK_FALSE(early.poll(rec));
+  CHECK_FALSE(replay.poll(rec));
+  UNSIGNED_LONGS_EQUAL(0, early.lag());
+
+  bus->publish(record(10, 110));
+  CHECK_TRUE(late.poll(rec));
+  UNSIGNED_LONGS_EQUAL(10, rec.seq);
+  CHECK_TRUE(early.poll(rec));
+  UNSIGNED_LONGS_EQUAL(10, rec.seq);
+
+  UNSIGNED_LONGS_EQUAL(11, early.received);
+  UNSIGNED_LONGS_EQUAL(0, early.dropped);
+  UNSIGNED_LONGS_EQUAL(1, late.received);
+}
+
+/*
+ * Slow consumer with BUS_DROP_OLDEST gets the latest SENSOR_BUS_SIZE records
+ */
+TEST(TG_SensorBus, Test_DropOldest) {
+  SensorRecord rec;
+  SensorBusConsumer fast(*bus);
+  SensorBusConsumer slow(*bus);
+  const uint32_t n = SENSOR_BUS_SIZE * 2 + 5;
+
+  for (uint32_t i = 0; i < n; i++) {
+    bus->publish(record(i, 1));
+    CHECK_TRUE(fast.poll(rec));
+    UNSIGNED_LONGS_EQUAL(i, rec.seq);
+  }
+  UNSIGNED_LONGS_EQUAL(n, slow.lag());
+
+  for (uint32_t i = n - SENSOR_BUS_SIZE; i < n; i++) {
+    CHECK_TRUE(slow.poll(rec));
+    UNSIGNED_LONGS_EQUAL(i, rec.seq);
+    CHECK_TRUE(intact(rec));
+  }
+  CHECK_FALSE(slow.poll(rec));
+
+  UNSIGNED_LONGS_EQUAL(n, fast.received);
+  UNSIGNED_LONGS_EQUAL(0, fast.dropped);
+  UNSIGNED_LONGS_EQUAL(SENSOR_BUS_SIZE, slow.received);
+  UNSIGNED_LONGS_EQUAL(n - SENSOR_BUS_SIZE, slow.dropped);
+
+  // Replay starts with oldest record still available
+  SensorBusConsumer replay(*bus, BUS_DROP_OLDEST, true);
+  CHECK_TRUE(replay.poll(rec));
+  UNSIGNED_LONGS_EQUAL(n - SENSOR_BUS_SIZE, rec.seq);
+}
+
+/*
+ * Consumer with BUS_COALESCE gets the latest record per sensor, in order of arrival
+ */
+TEST(TG_SensorBus, Test_Coalesce) {
+  SensorRecord rec;
+  SensorBusConsumer display(*bus, BUS_COALESCE);
+  const uint32_t ids[] = {0x39582376, 0x12345678, 0x00000815};
+
+  // Sensor 3 has a different record kind with the same ID as sensor 1
+  for (uint32_t i = 0; i < 12; i++) {
+    rec = record(i, ids[i % 3]);
+    if (i % 3 == 2) {
+      rec.sensor_id = ids[0];
+      rec.kind = RECORD_KIND_SOIL;
+    }
+    bus->publish(rec);
+  }
+
+  CHECK_TRUE(display.poll(rec));
+  UNSIGNED_LONGS_EQUAL(9, rec.seq);
+  UNSIGNED_LONGS_EQUAL(ids[0], rec.sensor_id);
+  CHECK_TRUE(display.poll(rec));
+  UNSIGNED_LONGS_EQUAL(10, rec.seq);
+  UNSIGNED_LONGS_EQUAL(ids[1], rec.sensor_id);
+  CHECK_TRUE(display.poll(rec));
+  UNSIGNED_LONGS_EQUAL(11, rec.seq);
+  UNSIGNED_LONGS_EQUAL(RECORD_KIND_SOIL, rec.kind);
+  CHECK_TRUE(intact(rec));
+  CHECK_FALSE(display.poll(rec));
+
+  UNSIGNED_LONGS_EQUAL(3, display.received);
+  UNSIGNED_LONGS_EQUAL(9, display.coalesced);
+  UNSIGNED_LONGS_EQUAL(0, display.dropped);
+
+  // Ring buffer overflow: records lost before draining are counted as dropped
+  for (uint32_t i = 0; i < SENSOR_BUS_SIZE + 4; i++)
+    bus->publish(record(100 + i, ids[1]));
+  CHECK_TRUE(display.poll(rec));
+  UNSIGNED_LONGS_EQUAL(100 + SENSOR_BUS_SIZE + 3, rec.seq);
+  CHECK_FALSE(display.poll(rec));
+  UNSIGNED_LONGS_EQUAL(4, display.dropped);
+  UNSIGNED_LONGS_EQUAL(9 + SENSOR_BUS_SIZE - 1, display.coalesced);
+}
+
+/*
+ * More sensors than coalescing slots - oldest pending record is dropped
+ */
+TEST(TG_SensorBus, Test_CoalesceFull) {
+  SensorRecord rec;
+  SensorBusConsumer display(*bus, BUS_COALESCE);
+  const uint32_t n = SENSOR_BUS_COALESCE_SLOTS + 2;
+
+  for (uint32_t i = 0; i < n; i++)
+    bus->publish(record(i, 1000 + i));
+
+  for (uint32_t i = 2; i < n; i++) {
+    CHECK_TRUE(display.poll(rec));
+    UNSIGNED_LONGS_EQUAL(1000 + i, rec.sensor_id);
+  }
+  CHECK_FALSE(display.poll(rec));
+  UNSIGNED_LONGS_EQUAL(2, display.dropped);
+  UNSIGNED_LONGS_EQUAL(SENSOR_BUS_COALESCE_SLOTS, display.received);
+}
+
+/*
+ * Producer thread and several consumer threads
+ *
+ * Each record is either provided intact and in order, or counted (dropped/coalesced);
+ * prints publishing throughput and records received per consumer, with the producer
+ * publishing as fast as possible (burst) or yielding after each record (paced)
+ */
+TEST(TG_SensorBus, Test_Threads) {
+  static const int numConsumers[] = {0, 1, 2, 4};
+
+  printf("\n");
+  for (int run = 0; run < 8; run++) {
+    const int consumers = numConsumers[run % 4];
+    const bool paced = run >= 4;
+    const uint32_t records = paced ? BENCH_PACED : BENCH_RECORDS;
+    std::atomic<bool> done(false);
+    std::thread threads[4];
+    SensorBusConsumer *cons[4];
+    uint32_t errors[4] = {0};
+
+    for (int c = 0; c < consumers; c++) {
+      // Every second consumer coalesces
+      cons[c] = new SensorBusConsumer(*bus, (c & 1) ? BUS_COALESCE : BUS_DROP_OLDEST);
+      threads[c] = std::thread([&, c]() {
+        SensorRecord rec;
+        uint32_t last = 0;
+        bool first = true;
+        while (true) {
+          bool finished = done.load(std::memory_order_acquire);
+          if (cons[c]->poll(rec)) {
+            if (!intact(rec) || (!first && (int32_t)(rec.seq - last) <= 0 && (c & 1) == 0))
+              errors[c]++;
+            last = rec.seq;
+            first = false;
+          } else if (finished) {
+            break;
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < records; i++) {
+      bus->publish(record(i, i % BENCH_SENSORS));
+      if (paced)
+        std::this_thread::yield();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    done.store(true, std::memory_order_release);
+
+    double s = std::chrono::duration<double>(t1 - t0).count();
+    printf("%s %d consumer(s): publish %7.2f Mrecords/s", paced ? "paced" : "burst", consumers, records / s / 1e6);
+    for (int c = 0; c < consumers; c++) {
+      threads[c].join();
+      printf("  [%s rx %u drop %u coal %u]", (c & 1) ? "coalesce" : "drop", cons[c]->received,
+             cons[c]->dropped, cons[c]->coalesced);
+      UNSIGNED_LONGS_EQUAL(0, errors[c]);
+      UNSIGNED_LONGS_EQUAL(records, cons[c]->received + cons[c]->dropped + cons[c]->coalesced);
+      UNSIGNED_LONGS_EQUAL(0, cons[c]->lag());
+      delete cons[c];
+    }
+    printf("\n");
+
+    delete bus;
+    bus = new SensorBus();
+  }
+}
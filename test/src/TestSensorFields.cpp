@@ -0,0 +1,509 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestSensorFields.cpp
+//
+// CppUTest unit tests for SensorFields (compile-time field visitor and JSON writer)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250501 Created
+// 20250507 Test_JsonLegacy: also with floats as strings
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "WStringMock.h"
+#include "SensorFields.h"
+
+#define RECORDS     2000
+#define BENCH_LOOPS 20
+#define PAYLOAD_SIZE 400
+
+// Copy of WeatherSensor::Sensor (WeatherSensor.h depends on the radio driver)
+struct Weather {
+    bool     temp_ok;
+    bool     tglobe_ok;
+    bool     humidity_ok;
+    bool     light_ok;
+    bool     uv_ok;
+    bool     wind_ok;
+    bool     rain_ok;
+    float    temp_c;
+    float    tglobe_c;
+    float    light_klx;
+    float    light_lux;
+    float    uv;
+    float    rain_mm;
+    float    wind_direction_deg;
+    float    wind_gust_meter_sec;
+    float    wind_avg_meter_sec;
+    uint16_t wind_direction_deg_fp1;
+    uint16_t wind_gust_meter_sec_fp1;
+    uint16_t wind_avg_meter_sec_fp1;
+    uint8_t  humidity;
+};
+
+struct Soil {
+    float    temp_c;
+    uint8_t  moisture;
+};
+
+struct Lightning {
+    uint8_t  distance_km;
+    uint16_t strike_count;
+    uint16_t unknown1;
+    uint16_t unknown2;
+};
+
+struct Leakage {
+    bool     alarm;
+};
+
+struct AirPM {
+    uint16_t pm_1_0;
+    uint16_t pm_2_5;
+    uint16_t pm_10;
+    bool     pm_1_0_init;
+    bool     pm_2_5_init;
+    bool     pm_10_init;
+};
+
+struct AirCO2 {
+    uint16_t co2_ppm;
+    bool     co2_init;
+};
+
+struct AirVOC {
+    uint16_t hcho_ppb;
+    uint8_t  voc_level;
+    bool     hcho_init;
+    bool     voc_init;
+};
+
+struct Sensor {
+    uint32_t sensor_id;
+    float    rssi;
+    uint8_t  s_type;
+    uint8_t  chan;
+    uint8_t  decoder;
+    bool     startup;
+    bool     battery_ok;
+    bool     valid;
+    bool     complete;
+    bool     restored;
+    uint32_t rx_time;
+    union {
+        struct Weather      w;
+        struct Soil         soil;
+        struct Lightning    lgt;
+        struct Leakage      leak;
+        struct AirPM        pm;
+        struct AirCO2       co2;
+        struct AirVOC       voc;
+    };
+};
+
+// Derived values (RainGauge/Lightning in the MQTT example)
+#define RAIN_H      1.2f
+#define RAIN_D      3.4f
+#define RAIN_W      5.6f
+#define RAIN_M      78.9f
+#define LGT_HR      3
+
+// JSON_FLOAT_AS_STRING in the MQTT example, selected at run time
+#define JSON_FLOAT(x) (quoted ? String("\"") + x + String("\"") : x)
+#define HEX 16
+
+static Sensor sensors[RECORDS];
+static uint32_t seed;
+
+static uint32_t rnd(uint32_t n)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 8) & 0xFFFFFF) % n;
+}
+
+// Sensor data with values in the decoders' resolution
+static void makeSensor(Sensor &s)
+{
+    static const uint8_t types[] = {
+        SENSOR_TYPE_WEATHER0, SENSOR_TYPE_WEATHER1, SENSOR_TYPE_WEATHER2, SENSOR_TYPE_THERMO_HYGRO,
+        SENSOR_TYPE_POOL_THERMO, SENSOR_TYPE_SOIL, SENSOR_TYPE_LEAKAGE, SENSOR_TYPE_AIR_PM,
+        SENSOR_TYPE_LIGHTNING, SENSOR_TYPE_CO2, SENSOR_TYPE_HCHO_VOC, 7};
+
+    memset(&s, 0, sizeof(s));
+    s.sensor_id = rnd(0xFFFFFF) * 256 + rnd(256);
+    s.s_type = types[rnd(sizeof(types))];
+    s.chan = rnd(8);
+    s.battery_ok = rnd(2);
+
+    switch (s.s_type) {
+    case SENSOR_TYPE_SOIL:
+        s.soil.temp_c = ((int)rnd(800) - 300) * 0.1f;
+        s.soil.moisture = rnd(101);
+        break;
+    case SENSOR_TYPE_LIGHTNING:
+        s.lgt.strike_count = rnd(1600);
+        s.lgt.distance_km = rnd(41);
+        s.lgt.unknown1 = rnd(0x10000);
+        s.lgt.unknown2 = rnd(0x10000);
+        break;
+    case SENSOR_TYPE_LEAKAGE:
+        s.leak.alarm = rnd(2);
+        break;
+    case SENSOR_TYPE_AIR_PM:
+        s.pm.pm_1_0 = rnd(1000);
+        s.pm.pm_2_5 = rnd(1000);
+        s.pm.pm_10 = rnd(1000);
+        s.pm.pm_1_0_init = rnd(4) == 0;
+        s.pm.pm_2_5_init = rnd(4) == 0;
+        s.pm.pm_10_init = rnd(4) == 0;
+        break;
+    case SENSOR_TYPE_CO2:
+        s.co2.co2_ppm = rnd(5000);
+        s.co2.co2_init = rnd(4) == 0;
+        break;
+    case SENSOR_TYPE_HCHO_VOC:
+        s.voc.hcho_ppb = rnd(1000);
+        s.voc.voc_level = rnd(5) + 1;
+        s.voc.hcho_init = rnd(4) == 0;
+        s.voc.voc_init = rnd(4) == 0;
+        break;
+    default:
+        s.w.temp_ok = rnd(8) != 0;
+        s.w.humidity_ok = rnd(8) != 0;
+        s.w.wind_ok = rnd(8) != 0;
+        s.w.uv_ok = rnd(2);
+        s.w.light_ok = rnd(2);
+        s.w.tglobe_ok = rnd(2);
+        s.w.rain_ok = rnd(8) != 0;
+        s.w.temp_c = ((int)rnd(1000) - 400) * 0.1f;
+        s.w.tglobe_c = ((int)rnd(1000) - 400) * 0.1f;
+        s.w.humidity = rnd(101);
+        s.w.wind_gust_meter_sec = rnd(500) * 0.1f;
+        s.w.wind_avg_meter_sec = rnd(500) * 0.1f;
+        s.w.wind_direction_deg = rnd(3600) * 0.1f;
+        s.w.uv = rnd(160) * 0.1f;
+        s.w.light_lux = rnd(200000);
+        s.w.light_klx = s.w.light_lux / 1000;
+        s.w.rain_mm = rnd(1000000) * 0.1f;
+        break;
+    }
+}
+
+// JSON as built by publishWeatherdata() in BresserWeatherSensorMQTT (before SensorFields)
+static String legacyJson(const Sensor &s, bool complete, bool quoted = false)
+{
+    String mqtt_payload = "{";
+    mqtt_payload += String("\"id\":") + String(s.sensor_id);
+    mqtt_payload += String(",\"ch\":") + String(s.chan);
+    mqtt_payload += String(",\"battery_ok\":") + (s.battery_ok ? String("1") : String("0"));
+
+    if (s.s_type == SENSOR_TYPE_SOIL)
+    {
+        mqtt_payload += String(",\"temp_c\":") + String(s.soil.temp_c);
+        mqtt_payload += String(",\"moisture\":") + String(s.soil.moisture);
+    }
+    else if (s.s_type == SENSOR_TYPE_LIGHTNING)
+    {
+        mqtt_payload += String(",\"lightning_count\":") + String(s.lgt.strike_count);
+        mqtt_payload += String(",\"lightning_distance_km\":") + String(s.lgt.distance_km);
+        mqtt_payload += String(",\"lightning_unknown1\":\"0x") + String(s.lgt.unknown1, HEX) + String("\"");
+        mqtt_payload += String(",\"lightning_unknown2\":\"0x") + String(s.lgt.unknown2, HEX) + String("\"");
+        mqtt_payload += String(",\"lightning_hr\":") + String(LGT_HR);
+    }
+    else if (s.s_type == SENSOR_TYPE_LEAKAGE)
+    {
+        mqtt_payload += String(",\"leakage\":") + String(s.leak.alarm);
+    }
+    else if (s.s_type == SENSOR_TYPE_AIR_PM)
+    {
+        if (!s.pm.pm_1_0_init)
+            mqtt_payload += String(",\"pm1_0_ug_m3\":") + String(s.pm.pm_1_0);
+        if (!s.pm.pm_2_5_init)
+            mqtt_payload += String(",\"pm2_5_ug_m3\":") + String(s.pm.pm_2_5);
+        if (!s.pm.pm_10_init)
+            mqtt_payload += String(",\"pm10_ug_m3\":") + String(s.pm.pm_10);
+    }
+    else if (s.s_type == SENSOR_TYPE_CO2)
+    {
+        if (!s.co2.co2_init)
+            mqtt_payload += String(",\"co2_ppm\":") + String(s.co2.co2_ppm);
+    }
+    else if (s.s_type == SENSOR_TYPE_HCHO_VOC)
+    {
+        if (!s.voc.hcho_init)
+            mqtt_payload += String(",\"hcho_ppb\":") + String(s.voc.hcho_ppb);
+        if (!s.voc.voc_init)
+            mqtt_payload += String(",\"voc\":") + String(s.voc.voc_level);
+    }
+    else if ((s.s_type == SENSOR_TYPE_WEATHER0) ||
+             (s.s_type == SENSOR_TYPE_WEATHER1) ||
+             (s.s_type == SENSOR_TYPE_WEATHER2) ||
+             (s.s_type == SENSOR_TYPE_THERMO_HYGRO) ||
+             (s.s_type == SENSOR_TYPE_POOL_THERMO))
+    {
+        if (s.w.temp_ok || complete)
+            mqtt_payload += String(",\"temp_c\":") + JSON_FLOAT(String(s.w.temp_c, 1));
+        if (s.w.humidity_ok || complete)
+            mqtt_payload += String(",\"humidity\":") + String(s.w.humidity);
+        if (s.w.wind_ok || complete)
+        {
+            mqtt_payload += String(",\"wind_gust\":") + JSON_FLOAT(String(s.w.wind_gust_meter_sec, 1));
+            mqtt_payload += String(",\"wind_avg\":") + JSON_FLOAT(String(s.w.wind_avg_meter_sec, 1));
+            mqtt_payload += String(",\"wind_dir\":") + JSON_FLOAT(String(s.w.wind_direction_deg, 1));
+        }
+        if (s.w.uv_ok || complete)
+            mqtt_payload += String(",\"uv\":") + JSON_FLOAT(String(s.w.uv, 1));
+        if (s.w.light_ok || complete)
+            mqtt_payload += String(",\"light_klx\":") + JSON_FLOAT(String(s.w.light_klx, 1));
+        if (s.s_type == SENSOR_TYPE_WEATHER2)
+        {
+            if (s.w.tglobe_ok || complete)
+                mqtt_payload += String(",\"t_globe_c\":") + JSON_FLOAT(String(s.w.tglobe_c, 1));
+        }
+        if (s.w.rain_ok || complete)
+        {
+            mqtt_payload += String(",\"rain\":") + JSON_FLOAT(String(s.w.rain_mm, 1));
+            mqtt_payload += String(",\"rain_h\":") + JSON_FLOAT(String(RAIN_H, 1));
+            mqtt_payload += String(",\"rain_d\":") + JSON_FLOAT(String(RAIN_D, 1));
+            mqtt_payload += String(",\"rain_w\":") + JSON_FLOAT(String(RAIN_W, 1));
+            mqtt_payload += String(",\"rain_m\":") + JSON_FLOAT(String(RAIN_M, 1));
+        }
+    }
+    mqtt_payload += String("}");
+    return mqtt_payload;
+}
+
+// Writer with derived values (as DataJsonWriter in BresserWeatherSensorMQTT)
+class DataJsonWriter : public SensorJsonWriter {
+public:
+    DataJsonWriter(char *buf, size_t size, bool complete, bool quoted)
+        : SensorJsonWriter(buf, size, complete, quoted)
+    {
+    }
+
+    template <typename F, typename T>
+    void operator()(F f, T value, bool valid)
+    {
+        SensorJsonWriter::operator()(f, value, valid);
+        if ((F::id() == SF_RAIN) && (valid || complete)) {
+            writeFloat("rain_h", RAIN_H, 1);
+            writeFloat("rain_d", RAIN_D, 1);
+            writeFloat("rain_w", RAIN_W, 1);
+            writeFloat("rain_m", RAIN_M, 1);
+        }
+    }
+};
+
+static size_t visitorJson(const Sensor &s, bool complete, char *buf, size_t size, bool quoted = false)
+{
+    DataJsonWriter json(buf, size, complete, quoted);
+    visitSensorFields(s, json);
+    if (s.s_type == SENSOR_TYPE_LIGHTNING)
+        json.writeInt("lightning_hr", LGT_HR);
+    return json.end();
+}
+
+// Visitor counting fields
+struct FieldCounter {
+    unsigned fields;
+    unsigned valid;
+    uint32_t seen;
+
+    template <typename F, typename T>
+    void operator()(F, T, bool isValid)
+    {
+        fields++;
+        valid += isValid;
+        seen |= 1UL << F::id();
+    }
+};
+
+TEST_GROUP(TG_SensorFields) {
+  void setup() {
+    seed = 1;
+    for (int i = 0; i < RECORDS; i++)
+      makeSensor(sensors[i]);
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Field descriptors and fields per sensor type
+ */
+TEST(TG_SensorFields, Test_Visitor) {
+  STRCMP_EQUAL("temp_c", SensorField<SF_TEMP_C>::name());
+  STRCMP_EQUAL("°C", SensorField<SF_TEMP_C>::unit());
+  UNSIGNED_LONGS_EQUAL(SF_FMT_FLOAT, SensorField<SF_RAIN>::format());
+  UNSIGNED_LONGS_EQUAL(SF_FMT_NUMBER, SensorField<SF_SOIL_TEMP_C>::format());
+  UNSIGNED_LONGS_EQUAL(1, SensorField<SF_RAIN>::decimals());
+  UNSIGNED_LONGS_EQUAL(SF_GROUP_AIR, SensorField<SF_VOC>::group());
+
+  Sensor s;
+  memset(&s, 0, sizeof(s));
+
+  s.s_type = SENSOR_TYPE_WEATHER1;
+  s.w.temp_ok = true;
+  FieldCounter c = {};
+  visitSensorFields(s, c);
+  UNSIGNED_LONGS_EQUAL(3 + 8, c.fields);
+  UNSIGNED_LONGS_EQUAL(3 + 1, c.valid);
+  CHECK_FALSE(c.seen & (1UL << SF_TGLOBE_C));
+
+  s.s_type = SENSOR_TYPE_WEATHER2;
+  c = {};
+  visitSensorFields(s, c);
+  UNSIGNED_LONGS_EQUAL(3 + 9, c.fields);
+  CHECK(c.seen & (1UL << SF_TGLOBE_C));
+
+  memset(&s, 0, sizeof(s));
+  s.s_type = SENSOR_TYPE_AIR_PM;
+  s.pm.pm_2_5_init = true;
+  c = {};
+  visitSensorFields(s, c);
+  UNSIGNED_LONGS_EQUAL(3 + 3, c.fields);
+  UNSIGNED_LONGS_EQUAL(3 + 2, c.valid);
+
+  // Unknown type: header only
+  s.s_type = 7;
+  c = {};
+  visitSensorFields(s, c);
+  UNSIGNED_LONGS_EQUAL(3, c.fields);
+}
+
+/*
+ * JSON built with the visitor matches the MQTT example's JSON byte for byte
+ * (with and without JSON_FLOAT_AS_STRING)
+ */
+TEST(TG_SensorFields, Test_JsonLegacy) {
+  char buf[PAYLOAD_SIZE];
+
+  for (int quoted = 0; quoted < 2; quoted++) {
+    for (int complete = 0; complete < 2; complete++) {
+      for (int i = 0; i < RECORDS; i++) {
+        String ref = legacyJson(sensors[i], complete, quoted);
+        size_t len = visitorJson(sensors[i], complete, buf, sizeof(buf), quoted);
+        STRCMP_EQUAL(ref.c_str(), buf);
+        UNSIGNED_LONGS_EQUAL(ref.length(), len);
+      }
+    }
+  }
+}
+
+/*
+ * Floating point values are formatted as with printf() (ESP32: String(float, decimals))
+ */
+TEST(TG_SensorFields, Test_JsonFloat) {
+  static const float special[] = {0.0f, -0.0f, 0.25f, 0.75f, -0.25f, 2.5f, 0.125f, 0.375f, -0.04f,
+                                  99.95f, 1e9f, -3e12f, 1e30f, NAN, INFINITY, -INFINITY};
+  char buf[64];
+  char ref[80];
+
+  for (uint8_t dec = 0; dec <= 5; dec++) {
+    for (int i = 0; i < 20000; i++) {
+      float v;
+      if (i < (int)(sizeof(special) / sizeof(special[0]))) {
+        v = special[i];
+      } else {
+        // random mantissa/exponent within [-2^20, 2^20]
+        v = ((int)rnd(2000001) - 1000000) / (float)(1 << rnd(16));
+      }
+      SensorJsonWriter json(buf, sizeof(buf));
+      json.writeFloat("v", v, dec);
+      json.end();
+      snprintf(ref, sizeof(ref), "{\"v\":%.*f}", dec, v);
+      STRCMP_EQUAL(ref, buf);
+    }
+  }
+}
+
+/*
+ * Truncation
+ */
+TEST(TG_SensorFields, Test_JsonOverflow) {
+  char buf[32];
+  Sensor s;
+  memset(&s, 0, sizeof(s));
+  s.sensor_id = 0x12345678;
+  s.s_type = SENSOR_TYPE_WEATHER1;
+
+  SensorJsonWriter json(buf, sizeof(buf), true, true);
+  visitSensorFields(s, json);
+  json.end();
+  CHECK(json.overflowed());
+  UNSIGNED_LONGS_EQUAL(sizeof(buf) - 1, json.length());
+  UNSIGNED_LONGS_EQUAL(sizeof(buf) - 1, strlen(buf));
+
+  char big[256];
+  SensorJsonWriter json2(big, sizeof(big), true, true);
+  visitSensorFields(s, json2);
+  json2.end();
+  CHECK_FALSE(json2.overflowed());
+  STRCMP_EQUAL("{\"id\":305419896,\"ch\":0,\"battery_ok\":0,\"temp_c\":\"0.0\",\"humidity\":0,"
+               "\"wind_gust\":\"0.0\",\"wind_avg\":\"0.0\",\"wind_dir\":\"0.0\",\"uv\":\"0.0\","
+               "\"light_klx\":\"0.0\",\"rain\":\"0.0\"}", big);
+}
+
+/*
+ * Throughput of String based and visitor based JSON serialization [records/s]
+ */
+TEST(TG_SensorFields, Test_Benchmark) {
+  char buf[PAYLOAD_SIZE];
+  size_t bytesLegacy = 0, bytesVisitor = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (int k = 0; k < BENCH_LOOPS; k++)
+    for (int i = 0; i < RECORDS; i++)
+      bytesLegacy += legacyJson(sensors[i], false).length();
+  auto t1 = std::chrono::steady_clock::now();
+  for (int k = 0; k < BENCH_LOOPS; k++)
+    for (int i = 0; i < RECORDS; i++)
+      bytesVisitor += visitorJson(sensors[i], false, buf, sizeof(buf));
+  auto t2 = std::chrono::steady_clock::now();
+
+  double records = (double)RECORDS * BENCH_LOOPS;
+  double sl = std::chrono::duration<double>(t1 - t0).count();
+  double sv = std::chrono::duration<double>(t2 - t1).count();
+  printf("\nJSON serialization: String %.0f records/s, visitor %.0f records/s (%.1fx)\n",
+         records / sl, records / sv, sl / sv);
+
+  UNSIGNED_LONGS_EQUAL(bytesLegacy, bytesVisitor);
+}
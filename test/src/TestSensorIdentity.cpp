@@ -0,0 +1,310 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestSensorIdentity.cpp
+//
+// CppUTest unit tests for SensorIdentity (logical sensor IDs)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250420 Created
+// 20250507 Added Test_Learn, Test_Expire; remap after restart only if configured
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include "SensorIdentity.h"
+
+// Decoder bits (see DECODER_* in WeatherSensor.h)
+#define DEC_6IN1    0x02
+#define DEC_7IN1    0x04
+
+#define ID_A        0x39582376
+#define ID_A_NEW    0x8F3A0C11
+#define ID_B        0x12345678
+#define T0          1000
+
+static SensorIdentity ids;
+
+// Receive sensor LOGICAL_ID_LEARN_MIN times
+static bool learnN(SensorIdentity &si, uint32_t id, uint8_t decoder, uint8_t s_type, uint8_t chan, uint32_t now)
+{
+  bool res = false;
+  for (int i = 0; i < LOGICAL_ID_LEARN_MIN; i++)
+    res = si.learn(id, decoder, s_type, chan, now);
+  return res;
+}
+
+TEST_GROUP(TG_SensorIdentity) {
+  void setup() {
+    ids.clear();
+    ids.begin(T0);
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Sensor changes its ID after battery change
+ */
+TEST(TG_SensorIdentity, Test_Remap) {
+  IdRemap ev;
+
+  UNSIGNED_LONGS_EQUAL(ID_A, ids.map(ID_A, DEC_6IN1, 1, 0, false, false, T0));
+  CHECK(learnN(ids, ID_A, DEC_6IN1, 1, 0, T0));
+  CHECK_FALSE(ids.learn(ID_A, DEC_6IN1, 1, 0, T0));
+  CHECK(ids.changed());
+  CHECK_FALSE(ids.changed());
+  UNSIGNED_LONGS_EQUAL(1, ids.count());
+
+  // Known ID
+  UNSIGNED_LONGS_EQUAL(ID_A, ids.map(ID_A, DEC_6IN1, 1, 0, false, false, T0 + 60000));
+
+  // New ID while old one is still active -> not remapped
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ids.map(ID_A_NEW, DEC_6IN1, 1, 0, true, false, T0 + 90000));
+  CHECK_FALSE(ids.getRemap(ev));
+
+  // New ID after silence period, but without startup flag -> not remapped
+  uint32_t t = T0 + 60000 + LOGICAL_ID_SILENCE;
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ids.map(ID_A_NEW, DEC_6IN1, 1, 0, false, false, t));
+
+  // Startup flag set, but different channel/type/decoder -> not remapped
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ids.map(ID_A_NEW, DEC_6IN1, 1, 1, true, false, t));
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ids.map(ID_A_NEW, DEC_6IN1, 2, 0, true, false, t));
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ids.map(ID_A_NEW, DEC_7IN1, 1, 0, true, false, t));
+
+  // New ID configured explicitly -> not remapped
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ids.map(ID_A_NEW, DEC_6IN1, 1, 0, true, true, t));
+  CHECK_FALSE(ids.getRemap(ev));
+  CHECK_FALSE(ids.changed());
+
+  // Remapped
+  UNSIGNED_LONGS_EQUAL(ID_A, ids.map(ID_A_NEW, DEC_6IN1, 1, 0, true, false, t));
+  UNSIGNED_LONGS_EQUAL(1, ids.remaps());
+  CHECK(ids.changed());
+  CHECK(ids.getRemap(ev));
+  UNSIGNED_LONGS_EQUAL(ID_A, ev.logical_id);
+  UNSIGNED_LONGS_EQUAL(ID_A, ev.old_id);
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ev.new_id);
+  UNSIGNED_LONGS_EQUAL(DEC_6IN1, ev.decoder);
+  UNSIGNED_LONGS_EQUAL(1, ev.s_type);
+  UNSIGNED_LONGS_EQUAL(0, ev.chan);
+  CHECK_FALSE(ids.getRemap(ev));
+
+  // Subsequent messages (startup flag cleared after one hour)
+  UNSIGNED_LONGS_EQUAL(ID_A, ids.map(ID_A_NEW, DEC_6IN1, 1, 0, false, false, t + 3600000));
+  CHECK_FALSE(ids.learn(ID_A, DEC_6IN1, 1, 0, t + 3600000));
+  CHECK_FALSE(ids.changed());
+  UNSIGNED_LONGS_EQUAL(1, ids.count());
+}
+
+/*
+ * Two silent sensors with same decoder/type/channel -> ambiguous, not remapped
+ */
+TEST(TG_SensorIdentity, Test_Ambiguous) {
+  IdRemap ev;
+
+  learnN(ids, ID_A, DEC_6IN1, 1, 0, T0);
+  learnN(ids, ID_B, DEC_6IN1, 1, 0, T0);
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ids.map(ID_A_NEW, DEC_6IN1, 1, 0, true, false, T0 + LOGICAL_ID_SILENCE));
+  CHECK_FALSE(ids.getRemap(ev));
+
+  // One of them is still active -> unambiguous
+  ids.map(ID_B, DEC_6IN1, 1, 0, false, false, T0 + LOGICAL_ID_SILENCE);
+  UNSIGNED_LONGS_EQUAL(ID_A, ids.map(ID_A_NEW, DEC_6IN1, 1, 0, true, false, T0 + LOGICAL_ID_SILENCE + 1000));
+  CHECK(ids.getRemap(ev));
+}
+
+/*
+ * Table restored from non-volatile memory - silence is measured from begin();
+ * sensors not received since begin() are only remapped if configured explicitly
+ */
+TEST(TG_SensorIdentity, Test_SaveLoad) {
+  uint8_t buf[LOGICAL_ID_IMAGE_SIZE];
+  IdRemap ev;
+
+  learnN(ids, ID_A, DEC_6IN1, 1, 0, T0);
+  learnN(ids, ID_B, DEC_7IN1, 13, 2, T0);
+  ids.map(ID_A_NEW, DEC_6IN1, 1, 0, true, false, T0 + LOGICAL_ID_SILENCE);
+
+  size_t size = ids.save(buf, sizeof(buf), T0 + LOGICAL_ID_SILENCE);
+  UNSIGNED_LONGS_EQUAL(2 + 2 * LOGICAL_ID_ENTRY_SIZE, size);
+  UNSIGNED_LONGS_EQUAL(0, ids.save(buf, size - 1, T0 + LOGICAL_ID_SILENCE));
+
+  SensorIdentity restored;
+  CHECK(restored.load(buf, size));
+  UNSIGNED_LONGS_EQUAL(2, restored.count());
+  CHECK_FALSE(restored.changed());
+  restored.begin(5000);
+  UNSIGNED_LONGS_EQUAL(ID_A, restored.map(ID_A_NEW, DEC_6IN1, 1, 0, false, false, 5000));
+  UNSIGNED_LONGS_EQUAL(ID_B, restored.map(ID_B, DEC_7IN1, 13, 2, false, false, 5000));
+
+  // Not received since begin() (restart) - not remapped (foreign sensor)
+  uint32_t id_new = 0xABCD;
+  const uint32_t inc[] = {ID_A, ID_B};
+  restored.begin(6000);
+  UNSIGNED_LONGS_EQUAL(id_new, restored.map(id_new, DEC_7IN1, 13, 2, true, false, 6000 + LOGICAL_ID_SILENCE));
+  CHECK_FALSE(restored.getRemap(ev));
+
+  // ...unless configured explicitly, after the silence period
+  UNSIGNED_LONGS_EQUAL(id_new, restored.map(id_new, DEC_7IN1, 13, 2, true, false, 6000 + LOGICAL_ID_SILENCE - 1, inc, 2));
+  UNSIGNED_LONGS_EQUAL(ID_B, restored.map(id_new, DEC_7IN1, 13, 2, true, false, 6000 + LOGICAL_ID_SILENCE, inc, 2));
+  CHECK(restored.getRemap(ev));
+  UNSIGNED_LONGS_EQUAL(ID_B, ev.old_id);
+
+  // Table version 1 (without age)
+  const uint8_t v1[] = {1, 1, 0x76, 0x23, 0x58, 0x39, 0x11, 0x0C, 0x3A, 0x8F, DEC_6IN1, 1, 0};
+  CHECK(restored.load(v1, sizeof(v1)));
+  UNSIGNED_LONGS_EQUAL(1, restored.count());
+  restored.begin(7000);
+  UNSIGNED_LONGS_EQUAL(ID_A, restored.map(ID_A_NEW, DEC_6IN1, 1, 0, false, false, 7000));
+  CHECK(restored.load(buf, size));
+
+  // Invalid data
+  CHECK_FALSE(restored.load(buf, size - 1));
+  buf[0] = LOGICAL_ID_VERSION + 1;
+  CHECK_FALSE(restored.load(buf, size));
+  UNSIGNED_LONGS_EQUAL(2, restored.count());
+}
+
+/*
+ * Table full, event ring buffer overflow
+ */
+TEST(TG_SensorIdentity, Test_Limits) {
+  IdRemap ev;
+
+  CHECK_FALSE(learnN(ids, 0, DEC_6IN1, 1, 0, T0));
+  for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+    CHECK(learnN(ids, 0x100 + i, DEC_6IN1, 2, i, T0));
+  }
+  CHECK_FALSE(learnN(ids, 0x200, DEC_6IN1, 2, 0, T0));
+  UNSIGNED_LONGS_EQUAL(LOGICAL_IDS_MAX, ids.count());
+
+  // Remap all sensors (more than LOGICAL_ID_EVENTS)
+  for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+    UNSIGNED_LONGS_EQUAL(0x100 + i, ids.map(0x300 + i, DEC_6IN1, 2, i, true, false, T0 + LOGICAL_ID_SILENCE));
+  }
+  UNSIGNED_LONGS_EQUAL(LOGICAL_IDS_MAX, ids.remaps());
+
+  // Only the most recent events are retained
+  for (int i = LOGICAL_IDS_MAX - LOGICAL_ID_EVENTS; i < LOGICAL_IDS_MAX; i++) {
+    CHECK(ids.getRemap(ev));
+    UNSIGNED_LONGS_EQUAL(0x300 + i, ev.new_id);
+  }
+  CHECK_FALSE(ids.getRemap(ev));
+}
+
+/*
+ * Sensors are added after repeated reception; candidates are replaced first
+ */
+TEST(TG_SensorIdentity, Test_Learn) {
+  IdRemap ev;
+  uint8_t buf[LOGICAL_ID_IMAGE_SIZE];
+
+  // Single reception - candidate only
+  CHECK_FALSE(ids.learn(ID_B, DEC_6IN1, 1, 0, T0));
+  UNSIGNED_LONGS_EQUAL(0, ids.count());
+  CHECK_FALSE(ids.changed());
+  UNSIGNED_LONGS_EQUAL(2, ids.save(buf, sizeof(buf), T0));
+
+  // Candidates are not remapped
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, ids.map(ID_A_NEW, DEC_6IN1, 1, 0, true, false, T0 + LOGICAL_ID_SILENCE));
+  CHECK_FALSE(ids.getRemap(ev));
+
+  // Table full of candidates - least recently received one is replaced
+  for (int i = 1; i < LOGICAL_IDS_MAX; i++) {
+    CHECK_FALSE(ids.learn(0x100 + i, DEC_6IN1, 2, i, T0 + i));
+  }
+  CHECK_FALSE(ids.learn(ID_A, DEC_6IN1, 1, 0, T0 + 100));
+
+  // ID_B has been replaced - counting starts again
+  CHECK_FALSE(ids.learn(ID_B, DEC_6IN1, 1, 0, T0 + 200));
+  CHECK_FALSE(ids.learn(ID_B, DEC_6IN1, 1, 0, T0 + 200));
+  CHECK_FALSE(ids.changed());
+  CHECK(ids.learn(ID_B, DEC_6IN1, 1, 0, T0 + 200));
+  CHECK(ids.changed());
+  UNSIGNED_LONGS_EQUAL(1, ids.count());
+
+  // Repeated reception
+  CHECK_FALSE(ids.learn(ID_A, DEC_6IN1, 1, 0, T0 + 300));
+  CHECK(ids.learn(ID_A, DEC_6IN1, 1, 0, T0 + 400));
+  UNSIGNED_LONGS_EQUAL(2, ids.count());
+  UNSIGNED_LONGS_EQUAL(2 + 2 * LOGICAL_ID_ENTRY_SIZE, ids.save(buf, sizeof(buf), T0 + 400));
+}
+
+/*
+ * Sensors not received for LOGICAL_ID_EXPIRE are replaced if the table is full;
+ * the time without reception is retained across save/load
+ */
+TEST(TG_SensorIdentity, Test_Expire) {
+  uint8_t buf[LOGICAL_ID_IMAGE_SIZE];
+
+  for (int i = 0; i < LOGICAL_IDS_MAX; i++) {
+    CHECK(learnN(ids, 0x100 + i, DEC_6IN1, 2, i, T0));
+  }
+  CHECK(ids.changed());
+
+  // Not expired yet
+  CHECK_FALSE(learnN(ids, 0x200, DEC_6IN1, 2, 0, T0 + LOGICAL_ID_EXPIRE - 1));
+  CHECK_FALSE(ids.changed());
+
+  // All but the last sensor received again
+  uint32_t t = T0 + LOGICAL_ID_EXPIRE;
+  for (int i = 0; i < LOGICAL_IDS_MAX - 1; i++) {
+    ids.map(0x100 + i, DEC_6IN1, 2, i, false, false, t);
+  }
+  CHECK(learnN(ids, 0x200, DEC_6IN1, 2, 0, t));
+  CHECK(ids.changed());
+  UNSIGNED_LONGS_EQUAL(LOGICAL_IDS_MAX, ids.count());
+
+  // Replaced sensor starts as candidate again
+  CHECK_FALSE(ids.learn(0x100 + LOGICAL_IDS_MAX - 1, DEC_6IN1, 2, LOGICAL_IDS_MAX - 1, t));
+
+  // Age saved with table: 0x200 not received for half of LOGICAL_ID_EXPIRE before restart
+  ids.clear();
+  ids.begin(T0);
+  CHECK(learnN(ids, ID_A, DEC_6IN1, 1, 0, T0));
+  size_t size = ids.save(buf, sizeof(buf), T0 + LOGICAL_ID_EXPIRE / 2);
+
+  SensorIdentity restored;
+  CHECK(restored.load(buf, size));
+  restored.begin(100);
+  for (int i = 1; i < LOGICAL_IDS_MAX; i++) {
+    CHECK(learnN(restored, 0x100 + i, DEC_6IN1, 2, i, 100));
+  }
+  CHECK_FALSE(learnN(restored, ID_B, DEC_6IN1, 1, 1, 100 + LOGICAL_ID_EXPIRE / 2 - 60000));
+  CHECK(learnN(restored, ID_B, DEC_6IN1, 1, 1, 100 + LOGICAL_ID_EXPIRE / 2));
+  UNSIGNED_LONGS_EQUAL(ID_A_NEW, restored.map(ID_A_NEW, DEC_6IN1, 1, 0, false, false, 100 + LOGICAL_ID_EXPIRE / 2));
+  CHECK_FALSE(restored.learn(ID_A, DEC_6IN1, 1, 0, 100 + LOGICAL_ID_EXPIRE / 2));
+}
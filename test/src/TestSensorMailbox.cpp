@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestSensorMailbox.cpp
+//
+// CppUTest unit tests for SensorMailbox (latest-value-wins mailbox)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250503 Created
+// 20250508 record()/intact() from TornRecord.h
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <atomic>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
+#include "SensorMailbox.h"
+#include "TornRecord.h"
+
+#define THREAD_RECORDS  500000
+#define THREAD_SENSORS  12
+
+static SensorMailbox *mailbox;
+
+TEST_GROUP(TG_SensorMailbox) {
+  void setup() {
+    mailbox = new SensorMailbox();
+  }
+
+  void teardown() {
+    delete mailbox;
+  }
+};
+
+/*
+ * Each sensor's latest record is taken once; overwritten records are counted
+ */
+TEST(TG_SensorMailbox, Test_Coalesce) {
+  SensorRecord rec;
+  uint8_t slot;
+  uint8_t slotOf[3];
+  uint32_t seqOf[3];
+  const uint32_t ids[] = {0x39582376, 0x12345678, 0x39582376};
+  const uint8_t kinds[] = {RECORD_KIND_WEATHER, RECORD_KIND_WEATHER, RECORD_KIND_SOIL};
+
+  CHECK_FALSE(mailbox->take(rec));
+  UNSIGNED_LONGS_EQUAL(0, mailbox->pending());
+
+  // Sensor 0: 5 records, sensor 1: 1 record, sensor 2: 3 records
+  const uint8_t sensorOf[] = {0, 1, 0, 2, 0, 2, 0, 2, 0};
+  for (uint32_t i = 0; i < sizeof(sensorOf); i++) {
+    uint8_t s = sensorOf[i];
+    CHECK_TRUE(mailbox->post(record(i, ids[s], kinds[s])));
+  }
+  UNSIGNED_LONGS_EQUAL(9, mailbox->posted);
+  UNSIGNED_LONGS_EQUAL(3, __builtin_popcount(mailbox->pending()));
+
+  for (int n = 0; n < 3; n++) {
+    CHECK_TRUE(mailbox->take(rec, &slot));
+    CHECK_TRUE(intact(rec));
+    int s = (rec.sensor_id == ids[1]) ? 1 : (rec.kind == RECORD_KIND_SOIL) ? 2 : 0;
+    slotOf[s] = slot;
+    seqOf[s] = rec.seq;
+  }
+  CHECK_FALSE(mailbox->take(rec));
+  UNSIGNED_LONGS_EQUAL(0, mailbox->pending());
+
+  UNSIGNED_LONGS_EQUAL(8, seqOf[0]);
+  UNSIGNED_LONGS_EQUAL(1, seqOf[1]);
+  UNSIGNED_LONGS_EQUAL(7, seqOf[2]);
+  UNSIGNED_LONGS_EQUAL(4, mailbox->overwrites(slotOf[0]));
+  UNSIGNED_LONGS_EQUAL(0, mailbox->overwrites(slotOf[1]));
+  UNSIGNED_LONGS_EQUAL(2, mailbox->overwrites(slotOf[2]));
+  UNSIGNED_LONGS_EQUAL(3, mailbox->taken);
+
+  // Only updated sensors are taken again
+  CHECK_TRUE(mailbox->post(record(20, ids[1])));
+  UNSIGNED_LONGS_EQUAL(1UL << slotOf[1], mailbox->pending());
+  CHECK_TRUE(mailbox->take(rec, &slot));
+  UNSIGNED_LONGS_EQUAL(slotOf[1], slot);
+  UNSIGNED_LONGS_EQUAL(20, rec.seq);
+  UNSIGNED_LONGS_EQUAL(0, mailbox->overwrites(slot));
+  CHECK_FALSE(mailbox->take(rec));
+}
+
+/*
+ * All entries assigned - records of further sensors are rejected
+ */
+TEST(TG_SensorMailbox, Test_Full) {
+  SensorRecord rec;
+  uint32_t mask = 0;
+
+  for (uint32_t i = 0; i < SENSOR_MAILBOX_SLOTS; i++)
+    CHECK_TRUE(mailbox->post(record(i, 1000 + i)));
+  CHECK_FALSE(mailbox->post(record(99, 5000)));
+  UNSIGNED_LONGS_EQUAL(1, mailbox->rejected);
+
+  // Known sensors are still accepted
+  CHECK_TRUE(mailbox->post(record(100, 1000)));
+
+  for (uint32_t i = 0; i < SENSOR_MAILBOX_SLOTS; i++) {
+    uint8_t slot;
+    CHECK_TRUE(mailbox->take(rec, &slot));
+    mask |= 1UL << slot;
+    CHECK_TRUE(intact(rec));
+  }
+  CHECK_FALSE(mailbox->take(rec));
+  UNSIGNED_LONGS_EQUAL(SENSOR_MAILBOX_SLOTS, __builtin_popcount(mask));
+
+  mailbox->clear();
+  CHECK_TRUE(mailbox->post(record(1, 5000)));
+  UNSIGNED_LONGS_EQUAL(0, mailbox->rejected);
+}
+
+/*
+ * Producer thread posting faster than the consumer thread takes
+ *
+ * Records are intact, each sensor's records are taken in order, and every record
+ * posted is either taken or counted as overwritten
+ */
+TEST(TG_SensorMailbox, Test_Threads) {
+  std::atomic<bool> done(false);
+  uint32_t errors = 0;
+  uint32_t last[THREAD_SENSORS];
+  bool seen[THREAD_SENSORS] = {false};
+  uint8_t slotOf[THREAD_SENSORS];
+
+  std::thread consumer([&]() {
+    SensorRecord rec;
+    uint8_t slot;
+    while (true) {
+      bool finished = done.load(std::memory_order_acquire);
+      if (mailbox->take(rec, &slot)) {
+        uint32_t s = rec.sensor_id - 1;
+        if (!intact(rec) || (s >= THREAD_SENSORS) || (seen[s] && (rec.seq <= last[s])))
+          errors++;
+        else {
+          last[s] = rec.seq;
+          seen[s] = true;
+          slotOf[s] = slot;
+        }
+      } else if (finished) {
+        break;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (uint32_t i = 0; i < THREAD_RECORDS; i++) {
+    mailbox->post(record(i, 1 + i % THREAD_SENSORS));
+    if ((i % 64) == 0)
+      std::this_thread::yield();
+  }
+  done.store(true, std::memory_order_release);
+  consumer.join();
+
+  uint32_t overwrites = 0;
+  for (int s = 0; s < THREAD_SENSORS; s++) {
+    CHECK_TRUE(seen[s]);
+    UNSIGNED_LONGS_EQUAL(THREAD_RECORDS - 1 - (THREAD_RECORDS - 1 - s) % THREAD_SENSORS, last[s]);
+    overwrites += mailbox->overwrites(slotOf[s]);
+  }
+  printf("\nposted %u taken %u overwritten %u\n", mailbox->posted, mailbox->taken, overwrites);
+  UNSIGNED_LONGS_EQUAL(0, errors);
+  UNSIGNED_LONGS_EQUAL(THREAD_RECORDS, mailbox->posted);
+  UNSIGNED_LONGS_EQUAL(THREAD_RECORDS, mailbox->taken + overwrites);
+}
@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestSensorOwnership.cpp
+//
+// CppUTest unit tests for SensorOwnership (sensor ownership election)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250425 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include "SensorOwnership.h"
+
+#define RX_A        0xA001
+#define RX_B        0xB002
+#define RX_C        0xC003
+#define ID_1        0x39582376
+#define ID_2        0x12345678
+#define T0          1000
+
+static SensorOwnership rx[3] = {SensorOwnership(RX_A), SensorOwnership(RX_B), SensorOwnership(RX_C)};
+
+// Each receiver announces its summary to all others
+static void exchange(uint32_t now)
+{
+  uint8_t buf[OWNER_MSG_SIZE];
+
+  for (int i = 0; i < 3; i++) {
+    size_t len = rx[i].announce(buf, sizeof(buf), now);
+    for (int j = 0; j < 3; j++) {
+      // Own announcement is ignored (multicast loopback)
+      CHECK(rx[j].receive(buf, len, now));
+    }
+  }
+}
+
+// Number of receivers owning sensor
+static int owners(uint32_t id, uint32_t now)
+{
+  int n = 0;
+  for (int i = 0; i < 3; i++) {
+    if (rx[i].owns(id, now))
+      n++;
+  }
+  return n;
+}
+
+TEST_GROUP(TG_SensorOwnership) {
+  void setup() {
+    rx[0].begin(RX_A);
+    rx[1].begin(RX_B);
+    rx[2].begin(RX_C);
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Best receiver is elected by all receivers
+ */
+TEST(TG_SensorOwnership, Test_Election) {
+  rx[0].update(ID_1, -90.0, T0);
+  rx[1].update(ID_1, -70.0, T0);
+  rx[2].update(ID_1, -80.0, T0);
+  rx[2].update(ID_2, -75.0, T0);
+  rx[0].update(ID_2, -85.0, T0);
+
+  // No announcements yet - each receiver publishes
+  LONGS_EQUAL(3, owners(ID_1, T0));
+  CHECK(rx[0].announceDue(T0));
+
+  exchange(T0);
+  UNSIGNED_LONGS_EQUAL(2, rx[0].numPeers());
+  CHECK_FALSE(rx[0].announceDue(T0 + OWNER_ANNOUNCE_MS - 1));
+  CHECK(rx[0].announceDue(T0 + OWNER_ANNOUNCE_MS));
+
+  for (int i = 0; i < 3; i++) {
+    UNSIGNED_LONGS_EQUAL(RX_B, rx[i].owner(ID_1, T0));
+  }
+  LONGS_EQUAL(1, owners(ID_1, T0));
+  CHECK(rx[1].owns(ID_1, T0));
+  CHECK(rx[2].owns(ID_2, T0));
+  CHECK_FALSE(rx[0].owns(ID_2, T0));
+
+  // Sensor not received by this receiver's peers
+  CHECK(rx[1].owns(0x777, T0));
+  UNSIGNED_LONGS_EQUAL(0, rx[1].owner(0x777, T0));
+}
+
+/*
+ * Owner is only changed if another receiver is better by the hysteresis
+ */
+TEST(TG_SensorOwnership, Test_Hysteresis) {
+  rx[0].update(ID_1, -80.0, T0);
+  rx[1].update(ID_1, -81.0, T0);
+  exchange(T0);
+  UNSIGNED_LONGS_EQUAL(RX_A, rx[1].owner(ID_1, T0));
+
+  // B slightly better - no change
+  uint32_t t = T0 + OWNER_ANNOUNCE_MS;
+  for (int i = 0; i < 20; i++) {
+    rx[0].update(ID_1, -81.0, t);
+    rx[1].update(ID_1, -79.0, t);
+  }
+  exchange(t);
+  UNSIGNED_LONGS_EQUAL(RX_A, rx[0].owner(ID_1, t));
+  UNSIGNED_LONGS_EQUAL(RX_A, rx[1].owner(ID_1, t));
+  CHECK(rx[0].owns(ID_1, t));
+  CHECK_FALSE(rx[1].owns(ID_1, t));
+
+  // B better by more than hysteresis - change
+  t += OWNER_ANNOUNCE_MS;
+  for (int i = 0; i < 20; i++) {
+    rx[0].update(ID_1, -85.0, t);
+    rx[1].update(ID_1, -79.0, t);
+  }
+  exchange(t);
+  UNSIGNED_LONGS_EQUAL(RX_B, rx[0].owner(ID_1, t));
+  UNSIGNED_LONGS_EQUAL(RX_B, rx[1].owner(ID_1, t));
+  UNSIGNED_LONGS_EQUAL(1, rx[0].changes);
+  CHECK_FALSE(rx[0].owns(ID_1, t));
+  CHECK(rx[1].owns(ID_1, t));
+}
+
+/*
+ * Owner fails - ownership is taken over after timeout
+ */
+TEST(TG_SensorOwnership, Test_Timeout) {
+  uint8_t buf[OWNER_MSG_SIZE];
+
+  rx[0].update(ID_1, -90.0, T0);
+  rx[1].update(ID_1, -70.0, T0);
+  exchange(T0);
+  CHECK_FALSE(rx[0].owns(ID_1, T0));
+
+  // B stops announcing, A keeps receiving the sensor
+  uint32_t t = T0;
+  while (t <= T0 + OWNER_TIMEOUT_MS) {
+    t += OWNER_ANNOUNCE_MS;
+    rx[0].update(ID_1, -90.0, t);
+    rx[0].announce(buf, sizeof(buf), t);
+  }
+  CHECK(rx[0].owns(ID_1, t));
+  UNSIGNED_LONGS_EQUAL(0, rx[0].numPeers());
+}
+
+/*
+ * Restarted receiver adopts claimed owner; conflicting claims are resolved
+ */
+TEST(TG_SensorOwnership, Test_Claims) {
+  uint8_t buf[OWNER_MSG_SIZE];
+
+  rx[0].update(ID_1, -80.0, T0);
+  rx[1].update(ID_1, -81.0, T0);
+  exchange(T0);
+
+  // B becomes better (within hysteresis), C restarts and receives the sensor
+  uint32_t t = T0 + OWNER_ANNOUNCE_MS;
+  for (int i = 0; i < 20; i++) {
+    rx[1].update(ID_1, -78.0, t);
+  }
+  rx[2].begin(RX_C);
+  rx[2].update(ID_1, -95.0, t);
+  exchange(t);
+  UNSIGNED_LONGS_EQUAL(RX_A, rx[2].owner(ID_1, t));
+  LONGS_EQUAL(1, owners(ID_1, t));
+
+  // Conflicting claim (B restarted and claims sensor before receiving announcements)
+  rx[1].begin(RX_B);
+  rx[1].update(ID_1, -78.0, t);
+  size_t len = rx[1].announce(buf, sizeof(buf), t);
+  rx[0].receive(buf, len, t);
+  rx[2].receive(buf, len, t);
+  len = rx[0].announce(buf, sizeof(buf), t);
+  rx[1].receive(buf, len, t);
+  rx[2].receive(buf, len, t);
+  UNSIGNED_LONGS_EQUAL(RX_B, rx[0].owner(ID_1, t));
+  UNSIGNED_LONGS_EQUAL(RX_B, rx[1].owner(ID_1, t));
+  UNSIGNED_LONGS_EQUAL(RX_B, rx[2].owner(ID_1, t));
+}
+
+/*
+ * Invalid announcements
+ */
+TEST(TG_SensorOwnership, Test_Invalid) {
+  uint8_t buf[OWNER_MSG_SIZE];
+
+  rx[0].update(ID_1, -80.0, T0);
+  size_t len = rx[0].announce(buf, sizeof(buf), T0);
+  UNSIGNED_LONGS_EQUAL(OWNER_HDR_SIZE + OWNER_ENTRY_SIZE, len);
+  UNSIGNED_LONGS_EQUAL(0, rx[0].announce(buf, len - 1, T0));
+
+  CHECK_FALSE(rx[1].receive(buf, len - 1, T0));
+  buf[2] = OWNER_VERSION + 1;
+  CHECK_FALSE(rx[1].receive(buf, len, T0));
+  UNSIGNED_LONGS_EQUAL(2, rx[1].invalid);
+  UNSIGNED_LONGS_EQUAL(0, rx[1].numPeers());
+}
@@ -0,0 +1,290 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestSensorRecord.cpp
+//
+// CppUTest unit tests for SensorRecord and UdpRecordReceiver (loopback)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250418 Created
+//
+// ToDo: 
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "SensorRecord.h"
+#include "UdpRecordReceiver.h"
+
+#define TOLERANCE 0.051
+#define LOOPBACK_PORT 47884
+#define LOOPBACK_RECORDS 20000
+#define LOOPBACK_BURST 32
+
+static void initWeather(SensorRecord &rec)
+{
+  memset(&rec, 0, sizeof(rec));
+  rec.kind = RECORD_KIND_WEATHER;
+  rec.receiver_id = 0xCAFE0001;
+  rec.seq = 4711;
+  rec.timestamp = 1744970000;
+  rec.sensor_id = 0x39582376;
+  rec.rssi = -87.5;
+  rec.s_type = 1;
+  rec.chan = 0;
+  rec.decoder = 0x02;
+  rec.flags = RECORD_FLAG_BATTERY_OK | RECORD_FLAG_COMPLETE;
+  rec.ok = RECORD_OK_TEMP | RECORD_OK_HUMIDITY | RECORD_OK_WIND | RECORD_OK_RAIN | RECORD_OK_UV;
+  rec.temp_c = -12.3;
+  rec.humidity = 87;
+  rec.wind_direction_deg = 337.5;
+  rec.wind_gust_meter_sec = 12.7;
+  rec.wind_avg_meter_sec = 8.2;
+  rec.rain_mm = 12345.6;
+  rec.light_lux = 123456;
+  rec.uv = 7.1;
+  rec.tglobe_c = 31.4;
+}
+
+TEST_GROUP(TG_SensorRecord) {
+  void setup() {
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Encoding/decoding of weather record
+ */
+TEST(TG_SensorRecord, Test_Weather) {
+  SensorRecord rec;
+  SensorRecord dec;
+  uint8_t buf[SENSOR_RECORD_MAX_SIZE];
+
+  initWeather(rec);
+  size_t len = encodeRecord(buf, sizeof(buf), rec);
+  UNSIGNED_LONGS_EQUAL(SENSOR_RECORD_MAX_SIZE, len);
+
+  // Byte order
+  BYTES_EQUAL(0x42, buf[0]);
+  BYTES_EQUAL(0x57, buf[1]);
+  BYTES_EQUAL(0x01, buf[4]);
+  BYTES_EQUAL(0xCA, buf[7]);
+
+  CHECK(decodeRecord(buf, len, dec));
+  UNSIGNED_LONGS_EQUAL(rec.receiver_id, dec.receiver_id);
+  UNSIGNED_LONGS_EQUAL(rec.seq, dec.seq);
+  UNSIGNED_LONGS_EQUAL(rec.timestamp, dec.timestamp);
+  UNSIGNED_LONGS_EQUAL(rec.sensor_id, dec.sensor_id);
+  DOUBLES_EQUAL(rec.rssi, dec.rssi, TOLERANCE);
+  UNSIGNED_LONGS_EQUAL(rec.kind, dec.kind);
+  UNSIGNED_LONGS_EQUAL(rec.s_type, dec.s_type);
+  UNSIGNED_LONGS_EQUAL(rec.decoder, dec.decoder);
+  UNSIGNED_LONGS_EQUAL(rec.flags, dec.flags);
+  UNSIGNED_LONGS_EQUAL(rec.ok, dec.ok);
+  DOUBLES_EQUAL(rec.temp_c, dec.temp_c, TOLERANCE);
+  UNSIGNED_LONGS_EQUAL(rec.humidity, dec.humidity);
+  DOUBLES_EQUAL(rec.wind_direction_deg, dec.wind_direction_deg, TOLERANCE);
+  DOUBLES_EQUAL(rec.wind_gust_meter_sec, dec.wind_gust_meter_sec, TOLERANCE);
+  DOUBLES_EQUAL(rec.wind_avg_meter_sec, dec.wind_avg_meter_sec, TOLERANCE);
+  DOUBLES_EQUAL(rec.rain_mm, dec.rain_mm, TOLERANCE);
+  UNSIGNED_LONGS_EQUAL(rec.light_lux, dec.light_lux);
+  DOUBLES_EQUAL(rec.uv, dec.uv, TOLERANCE);
+  DOUBLES_EQUAL(rec.tglobe_c, dec.tglobe_c, TOLERANCE);
+}
+
+/*
+ * Encoding/decoding of other record kinds
+ */
+TEST(TG_SensorRecord, Test_OtherKinds) {
+  SensorRecord rec;
+  SensorRecord dec;
+  uint8_t buf[SENSOR_RECORD_MAX_SIZE];
+
+  memset(&rec, 0, sizeof(rec));
+  rec.kind = RECORD_KIND_LIGHTNING;
+  rec.strike_count = 1599;
+  rec.distance_km = 17;
+  rec.unknown1 = 0x123;
+  rec.unknown2 = 0xBEEF;
+  size_t len = encodeRecord(buf, sizeof(buf), rec);
+  UNSIGNED_LONGS_EQUAL(SENSOR_RECORD_HDR_SIZE + 7, len);
+  CHECK(decodeRecord(buf, len, dec));
+  UNSIGNED_LONGS_EQUAL(1599, dec.strike_count);
+  UNSIGNED_LONGS_EQUAL(17, dec.distance_km);
+  UNSIGNED_LONGS_EQUAL(0x123, dec.unknown1);
+  UNSIGNED_LONGS_EQUAL(0xBEEF, dec.unknown2);
+
+  memset(&rec, 0, sizeof(rec));
+  rec.kind = RECORD_KIND_AIR_PM;
+  rec.ok = RECORD_INIT_PM_10;
+  rec.pm_1_0 = 5;
+  rec.pm_2_5 = 12;
+  rec.pm_10 = 9999;
+  len = encodeRecord(buf, sizeof(buf), rec);
+  CHECK(decodeRecord(buf, len, dec));
+  UNSIGNED_LONGS_EQUAL(RECORD_INIT_PM_10, dec.ok);
+  UNSIGNED_LONGS_EQUAL(5, dec.pm_1_0);
+  UNSIGNED_LONGS_EQUAL(12, dec.pm_2_5);
+  UNSIGNED_LONGS_EQUAL(9999, dec.pm_10);
+
+  memset(&rec, 0, sizeof(rec));
+  rec.kind = RECORD_KIND_SOIL;
+  rec.temp_c = -3.4;
+  rec.humidity = 47;
+  len = encodeRecord(buf, sizeof(buf), rec);
+  CHECK(decodeRecord(buf, len, dec));
+  DOUBLES_EQUAL(-3.4, dec.temp_c, TOLERANCE);
+  UNSIGNED_LONGS_EQUAL(47, dec.humidity);
+
+  memset(&rec, 0, sizeof(rec));
+  rec.kind = RECORD_KIND_LEAKAGE;
+  rec.alarm = true;
+  len = encodeRecord(buf, sizeof(buf), rec);
+  CHECK(decodeRecord(buf, len, dec));
+  CHECK(dec.alarm);
+}
+
+/*
+ * Invalid buffers
+ */
+TEST(TG_SensorRecord, Test_Invalid) {
+  SensorRecord rec;
+  SensorRecord dec;
+  uint8_t buf[SENSOR_RECORD_MAX_SIZE];
+
+  initWeather(rec);
+  UNSIGNED_LONGS_EQUAL(0, encodeRecord(buf, SENSOR_RECORD_MAX_SIZE - 1, rec));
+  rec.kind = 99;
+  UNSIGNED_LONGS_EQUAL(0, encodeRecord(buf, sizeof(buf), rec));
+
+  initWeather(rec);
+  size_t len = encodeRecord(buf, sizeof(buf), rec);
+  CHECK_FALSE(decodeRecord(buf, len - 1, dec));
+  buf[2] = SENSOR_RECORD_VERSION + 1;
+  CHECK_FALSE(decodeRecord(buf, len, dec));
+  buf[2] = SENSOR_RECORD_VERSION;
+  buf[0] = 0;
+  CHECK_FALSE(decodeRecord(buf, len, dec));
+}
+
+/*
+ * Loss detection
+ */
+TEST(TG_SensorRecord, Test_SeqTracker) {
+  RecordSeqTracker seq;
+
+  UNSIGNED_LONGS_EQUAL(0, seq.update(1, 100));
+  UNSIGNED_LONGS_EQUAL(0, seq.update(1, 101));
+  UNSIGNED_LONGS_EQUAL(2, seq.update(1, 104));
+  UNSIGNED_LONGS_EQUAL(2, seq.lost);
+
+  // Other receiver
+  UNSIGNED_LONGS_EQUAL(0, seq.update(2, 7));
+  UNSIGNED_LONGS_EQUAL(0, seq.update(2, 8));
+
+  // Late/duplicate record
+  UNSIGNED_LONGS_EQUAL(0, seq.update(1, 103));
+  UNSIGNED_LONGS_EQUAL(1, seq.late);
+
+  // Large gap, restart of receiver
+  UNSIGNED_LONGS_EQUAL(99895, seq.update(1, 100000));
+  UNSIGNED_LONGS_EQUAL(0, seq.update(1, 0));
+  UNSIGNED_LONGS_EQUAL(1, seq.restarts);
+  UNSIGNED_LONGS_EQUAL(0, seq.update(1, 1));
+
+  // Wrap-around
+  UNSIGNED_LONGS_EQUAL(0, seq.update(3, 0xFFFFFFFF));
+  UNSIGNED_LONGS_EQUAL(0, seq.update(3, 0));
+
+  UNSIGNED_LONGS_EQUAL(11, seq.received);
+  UNSIGNED_LONGS_EQUAL(99897, seq.lost);
+}
+
+/*
+ * Loopback: send encoded records via UDP and receive them with UdpRecordReceiver;
+ * prints records per second
+ */
+TEST(TG_SensorRecord, Test_Loopback) {
+  UdpRecordReceiver receiver;
+  CHECK(receiver.open("127.0.0.1", LOOPBACK_PORT));
+
+  int tx = socket(AF_INET, SOCK_DGRAM, 0);
+  CHECK(tx >= 0);
+  struct sockaddr_in dst;
+  memset(&dst, 0, sizeof(dst));
+  dst.sin_family = AF_INET;
+  dst.sin_port = htons(LOOPBACK_PORT);
+  dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  SensorRecord rec;
+  SensorRecord dec;
+  uint8_t buf[SENSOR_RECORD_MAX_SIZE];
+  uint32_t received = 0;
+  initWeather(rec);
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < LOOPBACK_RECORDS; n += LOOPBACK_BURST) {
+    for (uint32_t i = n; (i < n + LOOPBACK_BURST) && (i < LOOPBACK_RECORDS); i++) {
+      rec.seq = i;
+      rec.temp_c = (i % 1000) * 0.1f;
+      size_t len = encodeRecord(buf, sizeof(buf), rec);
+      sendto(tx, buf, len, 0, (struct sockaddr *)&dst, sizeof(dst));
+    }
+    while (receiver.receive(dec, 0) > 0) {
+      DOUBLES_EQUAL((dec.seq % 1000) * 0.1, dec.temp_c, TOLERANCE);
+      received++;
+    }
+  }
+  while (receiver.receive(dec, 100) > 0) {
+    received++;
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  close(tx);
+
+  double s = std::chrono::duration<double>(t1 - t0).count() - 0.1;
+  printf("\nLoopback: %u/%u records received, %u lost, %.0f records/s\n",
+         received, LOOPBACK_RECORDS, receiver.seq.lost, received / s);
+
+  CHECK(received > 0);
+  UNSIGNED_LONGS_EQUAL(0, receiver.invalid);
+  UNSIGNED_LONGS_EQUAL(received, receiver.seq.received);
+  // Records lost at the end of the sequence are not detected
+  CHECK(received + receiver.seq.lost <= LOOPBACK_RECORDS);
+}
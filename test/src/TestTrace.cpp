@@ -0,0 +1,219 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestTrace.cpp
+//
+// CppUTest unit tests for Trace (event tracing, Chrome trace export)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250426 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Trace.h"
+#include "SensorRecord.h"
+#include "DataPredicate.h"
+
+TEST_GROUP(TG_Trace) {
+  void setup() {
+    wsTrace.clear();
+    wsTrace.enable(true);
+    wsTrace.setClock(nullptr);
+    mockMicros = 0;
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Events and JSON export (virtual time)
+ */
+TEST(TG_Trace, Test_Export) {
+  char buf[1024];
+
+  mockMicros = 1000;
+  {
+    TRACE_SCOPE("getData", TRACE_TID_RADIO);
+    mockMicros = 1500;
+    TRACE_INSTANT("slot", TRACE_TID_RADIO, 2);
+    mockMicros = 2000;
+  }
+  TRACE_COUNTER("queue", 3);
+
+  UNSIGNED_LONGS_EQUAL(4, wsTrace.size());
+  BYTES_EQUAL('B', wsTrace.event(0).ph);
+  UNSIGNED_LONGS_EQUAL(1000, wsTrace.event(0).ts);
+  BYTES_EQUAL('E', wsTrace.event(2).ph);
+  UNSIGNED_LONGS_EQUAL(2000, wsTrace.event(2).ts);
+
+  size_t len = wsTrace.exportJson(buf, sizeof(buf));
+  const char *exp =
+    "{\"traceEvents\":["
+    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"radio\"}},"
+    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"app\"}},"
+    "{\"name\":\"getData\",\"ph\":\"B\",\"ts\":1000,\"pid\":1,\"tid\":0},"
+    "{\"name\":\"slot\",\"ph\":\"i\",\"ts\":1500,\"pid\":1,\"tid\":0,\"s\":\"t\",\"args\":{\"arg\":2}},"
+    "{\"name\":\"getData\",\"ph\":\"E\",\"ts\":2000,\"pid\":1,\"tid\":0},"
+    "{\"name\":\"queue\",\"ph\":\"C\",\"ts\":2000,\"pid\":1,\"tid\":1,\"args\":{\"value\":3}}"
+    "],\"displayTimeUnit\":\"ms\"}";
+  STRCMP_EQUAL(exp, buf);
+  UNSIGNED_LONGS_EQUAL(strlen(exp), len);
+
+  // Buffer too small
+  UNSIGNED_LONGS_EQUAL(0, wsTrace.exportJson(buf, strlen(exp)));
+  STRCMP_EQUAL("", buf);
+}
+
+static uint32_t realClock(void)
+{
+  return 42;
+}
+
+/*
+ * Ring buffer overflow, custom clock, disabled recording
+ */
+TEST(TG_Trace, Test_Ring) {
+  for (int i = 0; i < TRACE_RING_SIZE + 10; i++) {
+    mockMicros = i;
+    TRACE_INSTANT("packet", TRACE_TID_RADIO, i);
+  }
+  UNSIGNED_LONGS_EQUAL(TRACE_RING_SIZE, wsTrace.size());
+  UNSIGNED_LONGS_EQUAL(10, wsTrace.overwritten);
+  LONGS_EQUAL(10, wsTrace.event(0).arg);
+  LONGS_EQUAL(TRACE_RING_SIZE + 9, wsTrace.event(TRACE_RING_SIZE - 1).arg);
+
+  wsTrace.clear();
+  wsTrace.setClock(realClock);
+  TRACE_BEGIN("decode", TRACE_TID_RADIO);
+  UNSIGNED_LONGS_EQUAL(42, wsTrace.event(0).ts);
+
+  wsTrace.enable(false);
+  TRACE_END("decode", TRACE_TID_RADIO);
+  UNSIGNED_LONGS_EQUAL(1, wsTrace.size());
+}
+
+// Writer appending to file
+static void fileWrite(const char *str, size_t len, void *ctx)
+{
+  fwrite(str, 1, len, (FILE *)ctx);
+}
+
+/*
+ * Synthetic traffic through a simulated receive/publish pipeline
+ *
+ * Set TRACE_JSON=<file> to write the trace for viewing in Perfetto (https://ui.perfetto.dev).
+ */
+TEST(TG_Trace, Test_Pipeline) {
+  static char json[TRACE_RING_SIZE * 100];
+  DataPredicate required;
+  SensorRecord rec;
+  uint8_t msg[SENSOR_RECORD_MAX_SIZE];
+  uint32_t rnd = 1;
+  int published = 0;
+
+  required.requireType(1);
+  required.requireType(2);
+  required.begin(2);
+
+  mockMicros = 0;
+  for (int cycle = 0; cycle < 3; cycle++) {
+    TRACE_SCOPE("getData", TRACE_TID_RADIO);
+    for (int n = 0; n < 4; n++) {
+      // Packet arrival after random delay
+      rnd = rnd * 1103515245 + 12345;
+      mockMicros += 100000 + (rnd >> 8) % 2000000;
+      memset(&rec, 0, sizeof(rec));
+      rec.sensor_id = 0x100 + n % 2;
+      rec.kind = RECORD_KIND_WEATHER;
+      rec.s_type = 1 + n % 2;
+      rec.rssi = -70.0f - (float)((rnd >> 4) % 30);
+      size_t len = encodeRecord(msg, sizeof(msg), rec);
+      TRACE_INSTANT("packet", TRACE_TID_RADIO, rec.rssi);
+
+      TRACE_BEGIN("decode", TRACE_TID_RADIO);
+      mockMicros += 300;
+      CHECK(decodeRecord(msg, len, rec));
+      TRACE_END("decode", TRACE_TID_RADIO);
+
+      int slot = n % 2;
+      TRACE_INSTANT("slot", TRACE_TID_RADIO, slot);
+      bool done = required.update(slot, required.match(slot, rec.sensor_id, rec.s_type, 0, true, true));
+      {
+        TRACE_SCOPE("callback", TRACE_TID_APP);
+        mockMicros += 50;
+      }
+      if (done)
+        break;
+    }
+    {
+      TRACE_SCOPE("publish", TRACE_TID_APP);
+      mockMicros += 20000;
+      published++;
+    }
+    required.begin(2);
+  }
+  LONGS_EQUAL(3, published);
+
+  size_t len = wsTrace.exportJson(json, sizeof(json));
+  CHECK(len > 0);
+
+  // Begin/end events balanced per track, timestamps monotonic
+  int depth[2] = {0, 0};
+  for (uint16_t i = 0; i < wsTrace.size(); i++) {
+    const TraceEvent &ev = wsTrace.event(i);
+    if (i > 0)
+      CHECK(ev.ts >= wsTrace.event(i - 1).ts);
+    if (ev.ph == 'B')
+      depth[ev.tid]++;
+    if (ev.ph == 'E')
+      depth[ev.tid]--;
+    CHECK(depth[ev.tid] >= 0);
+  }
+  LONGS_EQUAL(0, depth[TRACE_TID_RADIO]);
+  LONGS_EQUAL(0, depth[TRACE_TID_APP]);
+
+  const char *fname = getenv("TRACE_JSON");
+  if (fname) {
+    FILE *f = fopen(fname, "w");
+    if (f) {
+      wsTrace.exportJson(fileWrite, f);
+      fclose(f);
+    }
+  }
+}
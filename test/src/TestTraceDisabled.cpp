@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestTraceDisabled.cpp
+//
+// CppUTest unit tests for Trace macros without WEATHERSENSOR_TRACE
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250426 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include "Trace.h"
+
+TEST_GROUP(TG_TraceDisabled) {
+  void setup() {
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Without WEATHERSENSOR_TRACE, the TRACE_* macros do not evaluate their arguments
+ */
+TEST(TG_TraceDisabled, Test_CompiledOut) {
+  int n = 0;
+
+  TRACE_BEGIN("x", n++);
+  TRACE_END("x", n++);
+  TRACE_INSTANT("x", TRACE_TID_APP, n++);
+  TRACE_COUNTER("x", n++);
+  TRACE_SCOPE("x", n++);
+  LONGS_EQUAL(0, n);
+}
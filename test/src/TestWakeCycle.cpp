@@ -0,0 +1,195 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestWakeCycle.cpp
+//
+// CppUTest unit tests for WakeCycle
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 04/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250414 Created
+//
+// ToDo: 
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "CppUTest/TestHarness.h"
+
+#include "WakeCycle.h"
+
+#define TOLERANCE 0.01
+
+TEST_GROUP(TG_WakeCycle) {
+  void setup() {
+    mockMicros = 0;
+  }
+
+  void teardown() {
+  }
+};
+
+/*
+ * Run one wake cycle with the given phase durations [ms]
+ */
+static void runCycle(WakeCycle &wc, uint32_t boot, uint32_t rx, uint32_t decode, uint32_t mqtt, uint32_t sleep_ms = 0)
+{
+  mockMicros = boot * 1000;
+  wc.begin();
+  wc.mark(WAKE_PHASE_RX);
+  mockMicros += rx * 1000;
+  WakePhase prev = wc.mark(WAKE_PHASE_DECODE);
+  mockMicros += decode * 1000;
+  wc.mark(prev);
+  wc.mark(WAKE_PHASE_MQTT);
+  mockMicros += mqtt * 1000;
+  wc.mark(WAKE_PHASE_SLEEP);
+  wc.end(sleep_ms);
+}
+
+/*
+ * Test phase accounting of a single cycle
+ */
+TEST(TG_WakeCycle, Test_Phases) {
+  WakeCycle wc;
+  wakeCycleRec_t rec;
+
+  CHECK_FALSE(wc.getRecord(0, rec));
+
+  runCycle(wc, 80, 25000, 3, 250);
+
+  CHECK_EQUAL(1, wc.cycles());
+  CHECK_EQUAL(1, wc.count());
+  CHECK(wc.getRecord(0, rec));
+  CHECK_EQUAL(80, rec.phase[WAKE_PHASE_BOOT]);
+  CHECK_EQUAL(0, rec.phase[WAKE_PHASE_BEGIN]);
+  CHECK_EQUAL(25000, rec.phase[WAKE_PHASE_RX]);
+  CHECK_EQUAL(3, rec.phase[WAKE_PHASE_DECODE]);
+  CHECK_EQUAL(250, rec.phase[WAKE_PHASE_MQTT]);
+  CHECK_EQUAL(0, rec.phase[WAKE_PHASE_SLEEP]);
+  CHECK_EQUAL(0, rec.sleep);
+}
+
+/*
+ * Test accumulation if a phase is entered repeatedly and saturation
+ */
+TEST(TG_WakeCycle, Test_Accumulation) {
+  WakeCycle wc;
+  wakeCycleRec_t rec;
+
+  mockMicros = 0;
+  wc.begin();
+  for (int i = 0; i < 10; i++) {
+    wc.mark(WAKE_PHASE_DECODE);
+    mockMicros += 1500;
+    wc.mark(WAKE_PHASE_RX);
+    mockMicros += 100000;
+  }
+  CHECK_EQUAL(15, wc.elapsed(WAKE_PHASE_DECODE));
+  CHECK_EQUAL(1000, wc.elapsed(WAKE_PHASE_RX));
+
+  mockMicros += 70000000UL;
+  wc.end(100000000UL);
+  wc.getRecord(0, rec);
+  CHECK_EQUAL(15, rec.phase[WAKE_PHASE_DECODE]);
+  CHECK_EQUAL(UINT16_MAX, rec.phase[WAKE_PHASE_RX]);
+  CHECK_EQUAL(UINT16_MAX, rec.sleep);
+}
+
+/*
+ * Test ring buffer overflow and record order
+ */
+TEST(TG_WakeCycle, Test_Ring) {
+  WakeCycle wc;
+  wakeCycleRec_t rec;
+
+  for (uint32_t i = 1; i <= WAKE_CYCLE_HIST_SIZE + 3; i++) {
+    runCycle(wc, 10, i * 100, 1, 10);
+  }
+  CHECK_EQUAL(WAKE_CYCLE_HIST_SIZE + 3, wc.cycles());
+  CHECK_EQUAL(WAKE_CYCLE_HIST_SIZE, wc.count());
+
+  // Most recent first
+  for (uint8_t i = 0; i < WAKE_CYCLE_HIST_SIZE; i++) {
+    CHECK(wc.getRecord(i, rec));
+    CHECK_EQUAL((WAKE_CYCLE_HIST_SIZE + 3 - i) * 100, rec.phase[WAKE_PHASE_RX]);
+  }
+  CHECK_FALSE(wc.getRecord(WAKE_CYCLE_HIST_SIZE, rec));
+
+  wc.reset();
+  CHECK_EQUAL(0, wc.cycles());
+  CHECK_EQUAL(0, wc.count());
+}
+
+/*
+ * Test charge estimation
+ */
+TEST(TG_WakeCycle, Test_Charge) {
+  WakeCycle wc;
+  wakeCycleRec_t rec;
+
+  for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+    wc.setCurrent((WakePhase)i, 0);
+  }
+  wc.setCurrent(WAKE_PHASE_RX, 36.0);
+  wc.setSleepCurrent(0.36);
+
+  // 36 mA * 10 s = 100 uAh; 0.36 mA * 100 s = 10 uAh
+  runCycle(wc, 10, 10000, 1, 10, 100000);
+  wc.getRecord(0, rec);
+  DOUBLES_EQUAL(110.0, wc.charge(rec), TOLERANCE);
+}
+
+/*
+ * Test summary string
+ */
+TEST(TG_WakeCycle, Test_Summary) {
+  WakeCycle wc;
+  char buf[400];
+
+  for (int i = 0; i < WAKE_PHASE_NUM; i++) {
+    wc.setCurrent((WakePhase)i, 0);
+  }
+  wc.setSleepCurrent(0);
+
+  runCycle(wc, 80, 1000, 2, 200);
+  runCycle(wc, 80, 3000, 4, 400);
+
+  size_t n = wc.summary(buf, sizeof(buf));
+  CHECK_EQUAL(strlen(buf), n);
+  STRCMP_EQUAL("{\"cycles\":2,\"n\":2,"
+    "\"last\":{\"boot\":80,\"begin\":0,\"rx\":3000,\"decode\":4,\"wifi\":0,\"mqtt\":400,\"sleep\":0,\"other\":0,\"total\":3484,\"uAh\":0.0},"
+    "\"avg\":{\"boot\":80,\"begin\":0,\"rx\":2000,\"decode\":3,\"wifi\":0,\"mqtt\":300,\"sleep\":0,\"other\":0,\"total\":2383,\"uAh\":0.0}}",
+    buf);
+
+  // Buffer too small
+  CHECK_EQUAL(0, wc.summary(buf, 50));
+  STRCMP_EQUAL("", buf);
+}
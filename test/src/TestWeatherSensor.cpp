@@ -0,0 +1,606 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestWeatherSensor.cpp
+//
+// CppUTest unit tests for WeatherSensor - reception and slot handling with mocked radio
+// (see mocks/RadioLib.h)
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20250507 Created
+// 20250508 Added Test_NoAllocInReceivePath
+// 20250508 Added Test_CheckpointConfigClamp
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CppUTest/TestHarness.h"
+
+#include "WeatherSensor.h"
+#include "DigestBatch.h"
+#include "DecoderPrecheck.h"
+#include "NoiseFloor.h"
+#include "Checkpoint.h"
+#include "CountingAllocator.h"
+
+#define ID_WEATHER  0x39582376
+#define ID_WEATHER5 0x42
+#define ID_WEATHER2 0x39582377
+
+// Radio instance of WeatherSensor.cpp
+extern RADIO_CHIP radio;
+
+static WeatherSensor *ws;
+
+// Sensor data slots retained during (simulated) deep sleep
+static WeatherSensor::SlotImage slotImage;
+
+// Packets received during getData(), one per iteration
+#define RX_QUEUE_SIZE 60
+static uint8_t rxQueue[RX_QUEUE_SIZE][MSG_BUF_SIZE];
+static float   rxQueueRssi[RX_QUEUE_SIZE];
+static int     rxQueueLen;
+static int     rxQueuePos;
+static int     rxGap;       // number of idle getData() iterations between packets
+static int     rxIdle;
+
+static void rxQueueClear(void)
+{
+  rxQueueLen = 0;
+  rxQueuePos = 0;
+  rxGap = 0;
+  rxIdle = 0;
+}
+
+static void rxQueueAdd(const uint8_t *msg, float rssi = -60)
+{
+  memcpy(rxQueue[rxQueueLen], msg, MSG_BUF_SIZE);
+  rxQueueRssi[rxQueueLen++] = rssi;
+}
+
+// getData() callback: advance time by 100 ms, receive next packet
+static void rxStep(void)
+{
+  mockMicros += 100000;
+  if (rxIdle < rxGap) {
+    rxIdle++;
+    return;
+  }
+  rxIdle = 0;
+  if (rxQueuePos < rxQueueLen) {
+#if defined(USE_CC1101)
+    // Last sync byte is received as 1st payload byte
+    uint8_t frame[MSG_BUF_SIZE];
+    frame[0] = SYNC_WORD_2;
+    memcpy(&frame[1], rxQueue[rxQueuePos], MSG_BUF_SIZE - 1);
+    radio.inject(frame, MSG_BUF_SIZE, rxQueueRssi[rxQueuePos]);
+#else
+    radio.inject(rxQueue[rxQueuePos], MSG_BUF_SIZE - 1, rxQueueRssi[rxQueuePos]);
+#endif
+    rxQueuePos++;
+  }
+}
+
+// 6-in-1 weather sensor message
+// rain == false: temperature/humidity, rain == true: rain gauge
+static void msg6in1(uint8_t *msg, uint32_t id, bool rain, bool startup = false)
+{
+  memset(msg, 0, MSG_BUF_SIZE);
+  msg[2] = id >> 24;
+  msg[3] = (id >> 16) & 0xFF;
+  msg[4] = (id >> 8) & 0xFF;
+  msg[5] = id & 0xFF;
+  msg[6] = (SENSOR_TYPE_WEATHER1 << 4) | (startup ? 0 : 0x8);
+  msg[7] = 0xFF;                    // wind gust 0.0 m/s (inverted BCD)
+  msg[8] = 0xFF;
+  msg[9] = 0xFF;                    // wind avg 0.0 m/s
+  msg[10] = 0x18;                   // wind direction 180°
+  if (rain) {
+    msg[12] = 0xFF;                 // rain 12.3 mm (inverted BCD)
+    msg[13] = 0xFE;
+    msg[14] = 0xDC;
+    msg[16] = 0x01;
+  } else {
+    msg[12] = 0x21;                 // 21.5 °C
+    msg[13] = 0x52;                 // battery o.k.
+    msg[14] = 0x55;                 // 55 %
+    msg[15] = 0xFF;                 // no UV
+    msg[16] = 0xF0;
+  }
+  unsigned sum = 0;
+  for (int i = 2; i < 17; i++)
+    sum += msg[i];
+  msg[17] = 0xFF - (sum & 0xFF);
+  uint16_t digest = lfsrDigest16(&msg[2], 15, 0x8810, 0x5412);
+  msg[0] = digest >> 8;
+  msg[1] = digest & 0xFF;
+}
+
+// 5-in-1 weather sensor message (8-bit ID), temperature in 0.1 °C (BCD)
+static void msg5in1(uint8_t *msg, uint8_t id, unsigned temp)
+{
+  memset(msg, 0, MSG_BUF_SIZE);
+  msg[14] = id;
+  msg[15] = 0x80 | SENSOR_TYPE_WEATHER1;            // not startup
+  msg[20] = ((temp / 10 % 10) << 4) | (temp % 10);
+  msg[21] = temp / 100 % 10;
+  msg[22] = 0x55;                                   // 55 %
+  uint8_t bits = 0;
+  for (int i = 14; i < 26; i++)
+    for (uint8_t b = msg[i]; b; b >>= 1)
+      bits += b & 1;
+  msg[13] = bits;
+  for (int i = 0; i < 13; i++)
+    msg[i] = ~msg[i + 13];
+}
+
+static int findSlot(uint32_t id)
+{
+  for (size_t i = 0; i < ws->sensor.size(); i++) {
+    if (ws->sensor[i].sensor_id == id)
+      return i;
+  }
+  return -1;
+}
+
+TEST_GROUP(TG_WeatherSensor) {
+  void setup() {
+    mockPrefsClear();
+    mockMicros = 0;
+    rxQueueClear();
+    ws = new WeatherSensor();
+    ws->begin(2);
+  }
+
+  void teardown() {
+    delete ws;
+  }
+};
+
+/*
+ * 5-in-1 message received and decoded into a sensor data slot
+ */
+TEST(TG_WeatherSensor, Test_Receive5in1) {
+  uint8_t msg[MSG_BUF_SIZE];
+  msg5in1(msg, ID_WEATHER5, 215);
+
+  rxQueueAdd(msg, -70);
+  CHECK_TRUE(ws->getData(1000, DATA_COMPLETE, 0, rxStep));
+  UNSIGNED_LONGS_EQUAL(1, rxQueuePos);
+  int slot = findSlot(ID_WEATHER5);
+  CHECK(slot > -1);
+  CHECK_TRUE(ws->sensor[slot].valid);
+  CHECK_TRUE(ws->sensor[slot].complete);
+  CHECK_TRUE(ws->sensor[slot].w.temp_ok);
+  DOUBLES_EQUAL(21.5, ws->sensor[slot].w.temp_c, 0.01);
+  CHECK_TRUE(ws->sensor[slot].w.humidity_ok);
+  UNSIGNED_LONGS_EQUAL(55, ws->sensor[slot].w.humidity);
+  DOUBLES_EQUAL(-70, ws->sensor[slot].rssi, 0.1);
+}
+
+/*
+ * Without storage for the slot image (not ESP32/ESP8266), nothing is retained
+ */
+TEST(TG_WeatherSensor, Test_RestoreNoStorage) {
+  uint8_t temp[MSG_BUF_SIZE];
+  msg6in1(temp, ID_WEATHER, false);
+
+  rxQueueAdd(temp);
+  ws->getData(1000, DATA_COMPLETE, 0, rxStep);
+  CHECK(findSlot(ID_WEATHER) > -1);
+  ws->saveSlots(0);
+  ws->clearSlots();
+  UNSIGNED_LONGS_EQUAL(0, ws->restoreSlots());
+  WeatherSensor::sensor_t prev;
+  CHECK_FALSE(ws->getPrevious(ID_WEATHER, prev));
+}
+
+/*
+ * Split 6-in-1 message completed with data restored from RTC RAM;
+ * the slot must not be treated as restored in later getData() calls
+ */
+TEST(TG_WeatherSensor, Test_RestoreCompleteClear) {
+  uint8_t temp[MSG_BUF_SIZE];
+  uint8_t rain[MSG_BUF_SIZE];
+  uint32_t completions, early;
+  msg6in1(temp, ID_WEATHER, false);
+  msg6in1(rain, ID_WEATHER, true);
+  memset(&slotImage, 0, sizeof(slotImage));
+  ws->setSlotImage(&slotImage);
+
+  // Previous wake cycle: temperature message only
+  rxQueueAdd(temp);
+  CHECK_FALSE(ws->getData(1000, DATA_COMPLETE, 0, rxStep));
+  int slot = findSlot(ID_WEATHER);
+  CHECK(slot > -1);
+  CHECK_TRUE(ws->sensor[slot].valid);
+  CHECK_FALSE(ws->sensor[slot].complete);
+  ws->saveSlots(0);
+
+  // Wake-up: data restored from RTC RAM
+  ws->clearSlots();
+  UNSIGNED_LONGS_EQUAL(1, ws->restoreSlots());
+  slot = findSlot(ID_WEATHER);
+  CHECK_TRUE(ws->sensor[slot].restored);
+
+  // Rain message completes the data set early
+  rxQueueClear();
+  rxQueueAdd(rain);
+  CHECK_TRUE(ws->getData(1000, DATA_COMPLETE, 0, rxStep));
+  CHECK_TRUE(ws->sensor[slot].complete);
+  ws->getRestoreStats(completions, early);
+  UNSIGNED_LONGS_EQUAL(1, early);
+
+  // Next cycle: the restored temperature must not be combined with new data again
+  ws->clearSlots();
+  CHECK_FALSE(ws->sensor[slot].restored);
+  CHECK_FALSE(ws->sensor[slot].w.temp_ok);
+  rxQueueClear();
+  rxQueueAdd(rain);
+  CHECK_FALSE(ws->getData(1000, DATA_COMPLETE, 0, rxStep));
+  slot = findSlot(ID_WEATHER);
+  CHECK_TRUE(ws->sensor[slot].valid);
+  CHECK_FALSE(ws->sensor[slot].complete);
+  CHECK_FALSE(ws->sensor[slot].restored);
+  ws->getRestoreStats(completions, early);
+  UNSIGNED_LONGS_EQUAL(1, early);
+
+  // Both messages received in this cycle
+  rxQueueClear();
+  rxQueueAdd(temp);
+  CHECK_TRUE(ws->getData(1000, DATA_COMPLETE, 0, rxStep));
+  ws->getRestoreStats(completions, early);
+  UNSIGNED_LONGS_EQUAL(2, completions);
+  UNSIGNED_LONGS_EQUAL(1, early);
+}
+
+/*
+ * Continuous RSSI sampling between packets
+ * (not supported with CC1101 - RSSI latched for last packet)
+ */
+TEST(TG_WeatherSensor, Test_RssiSampling) {
+  uint8_t temp[MSG_BUF_SIZE];
+  RssiSample ring[RSSI_RING_SIZE];
+  RssiSample sample;
+  int count = 0;
+  msg6in1(temp, ID_WEATHER, false);
+
+  radio.rssiInst = -110;
+  ws->setRssiBuffer(ring, RSSI_RING_SIZE);
+  ws->setRssiSampling(50);
+  rxQueueAdd(temp, -50);
+  rxQueueAdd(temp, -55);
+  ws->getData(1000, DATA_COMPLETE, 0, rxStep);
+
+  while (ws->getRssiSample(sample)) {
+    if (sample.type == RSSI_SAMPLE_CONT) {
+      DOUBLES_EQUAL(-110, sample.rssi, 0.1);
+      count++;
+    }
+  }
+#if defined(RSSI_INST_SUPPORTED)
+  CHECK(count > 0);
+#else
+  LONGS_EQUAL(0, count);
+#endif
+}
+
+/*
+ * Noise floor and RSSI threshold are estimated from samples taken between packets,
+ * i.e. neither a strong sensor raises the noise floor nor is a weak sensor rejected,
+ * but frames triggered by noise slightly above the noise floor are
+ * (not supported with CC1101 - estimator not attached)
+ */
+TEST(TG_WeatherSensor, Test_NoiseFloorIdleSamples) {
+  uint8_t strong[MSG_BUF_SIZE];
+  uint8_t weak[MSG_BUF_SIZE];
+  uint8_t noise_frame[MSG_BUF_SIZE];
+  NoiseFloor noise;
+  msg6in1(strong, ID_WEATHER, false);
+  msg6in1(weak, ID_WEATHER2, false);
+  memset(noise_frame, 0x55, sizeof(noise_frame));
+
+  radio.rssiInst = -110;
+  ws->setNoiseFloor(&noise);
+  for (int i = 0; i < RX_QUEUE_SIZE / 3; i++) {
+    rxQueueAdd(strong, -50);
+    rxQueueAdd(weak, -80);
+    rxQueueAdd(noise_frame, -105);
+  }
+  rxGap = 2;
+  CHECK_FALSE(ws->getData(RX_QUEUE_SIZE * 300 + 1000, DATA_COMPLETE, 0, rxStep));
+  UNSIGNED_LONGS_EQUAL(RX_QUEUE_SIZE, rxQueuePos);
+
+  const NoiseFloorStats &st = noise.stats();
+#if defined(RSSI_INST_SUPPORTED)
+  CHECK_TRUE(st.ready);
+  DOUBLES_EQUAL(-110, st.floor, 0.1);
+  CHECK_FALSE(st.jammed);
+  UNSIGNED_LONGS_EQUAL(0, st.jamEvents);
+  UNSIGNED_LONGS_EQUAL(RX_QUEUE_SIZE * 2 / 3, st.valid);
+  CHECK(st.rejected > 0);
+  CHECK(noise.threshold() > -110);
+  CHECK(noise.threshold() < -80);
+#else
+  UNSIGNED_LONGS_EQUAL(0, st.samples);
+  UNSIGNED_LONGS_EQUAL(0, st.accepted);
+#endif
+  CHECK(findSlot(ID_WEATHER) > -1);
+  CHECK(findSlot(ID_WEATHER2) > -1);
+}
+
+#if defined(WEATHERSENSOR_DATA_REQUIRED)
+/*
+ * DATA_REQUIRED already fulfilled by valid slots on entry
+ */
+TEST(TG_WeatherSensor, Test_RequiredOnEntry) {
+  uint8_t temp[MSG_BUF_SIZE];
+  uint8_t other[MSG_BUF_SIZE];
+  msg6in1(temp, ID_WEATHER, false);
+  msg6in1(other, ID_WEATHER2, false);
+
+  ws->requireId(ID_WEATHER, false);
+  rxQueueAdd(temp);
+  CHECK_TRUE(ws->getData(1000, DATA_REQUIRED, 0, rxStep));
+  UNSIGNED_LONGS_EQUAL(0, ws->getMissing());
+
+  // Slot still valid - no further message required
+  rxQueueClear();
+  rxQueueAdd(other);
+  uint32_t start = millis();
+  CHECK_TRUE(ws->getData(1000, DATA_REQUIRED, 0, rxStep));
+  UNSIGNED_LONGS_EQUAL(0, rxQueuePos);
+  UNSIGNED_LONGS_EQUAL(start, millis());
+
+  // Slots cleared - a message from another sensor does not fulfill the requirement
+  ws->clearSlots();
+  rxQueueClear();
+  rxQueueAdd(other);
+  CHECK_FALSE(ws->getData(1000, DATA_REQUIRED, 0, rxStep));
+  UNSIGNED_LONGS_EQUAL(1, rxQueuePos);
+  UNSIGNED_LONGS_EQUAL(0x1, ws->getMissing());
+}
+#else
+/*
+ * DATA_REQUIRED compiled out: requirements are rejected, any message is sufficient
+ */
+TEST(TG_WeatherSensor, Test_RequiredNotAvailable) {
+  uint8_t other[MSG_BUF_SIZE];
+  msg6in1(other, ID_WEATHER2, false);
+
+  CHECK_FALSE(ws->requireId(ID_WEATHER, false));
+  CHECK_FALSE(ws->requireType(SENSOR_TYPE_WEATHER1));
+  rxQueueAdd(other);
+  CHECK_TRUE(ws->getData(1000, DATA_REQUIRED, 0, rxStep));
+  UNSIGNED_LONGS_EQUAL(1, rxQueuePos);
+  UNSIGNED_LONGS_EQUAL(0, ws->getMissing());
+}
+#endif
+
+#if defined(WEATHERSENSOR_LAZY_DECODING)
+/*
+ * Lazy decoding: measurement values in sensor[] are up-to-date after getData()
+ * (without calling fields())
+ */
+TEST(TG_WeatherSensor, Test_LazyDecodingNoStaleData) {
+  uint8_t msg1[MSG_BUF_SIZE];
+  uint8_t msg2[MSG_BUF_SIZE];
+  msg5in1(msg1, 0x42, 215);
+  msg5in1(msg2, 0x42, 103);
+
+  ws->setLazyDecoding(true);
+  rxQueueAdd(msg1);
+  CHECK_TRUE(ws->getData(1000, 0, 0, rxStep));
+  int slot = findSlot(0x42);
+  CHECK(slot > -1);
+  CHECK_TRUE(ws->sensor[slot].w.temp_ok);
+  DOUBLES_EQUAL(21.5, ws->sensor[slot].w.temp_c, 0.01);
+  UNSIGNED_LONGS_EQUAL(55, ws->sensor[slot].w.humidity);
+  UNSIGNED_LONGS_EQUAL(0, ws->getRaw(slot)->pending);
+
+  rxQueueClear();
+  rxQueueAdd(msg2);
+  CHECK_TRUE(ws->getData(1000, 0, 0, rxStep));
+  DOUBLES_EQUAL(10.3, ws->sensor[slot].w.temp_c, 0.01);
+
+  // Raw payload retained for re-decoding
+  CHECK_TRUE(ws->redecode(slot));
+  DOUBLES_EQUAL(10.3, ws->sensor[slot].w.temp_c, 0.01);
+}
+#else
+/*
+ * Lazy decoding not available: messages are decoded eagerly, no raw payload
+ */
+TEST(TG_WeatherSensor, Test_LazyDecodingNotAvailable) {
+  uint8_t msg[MSG_BUF_SIZE];
+  msg5in1(msg, 0x42, 215);
+
+  ws->setLazyDecoding(true);
+  rxQueueAdd(msg);
+  CHECK_TRUE(ws->getData(1000, 0, 0, rxStep));
+  int slot = findSlot(0x42);
+  CHECK(slot > -1);
+  DOUBLES_EQUAL(21.5, ws->sensor[slot].w.temp_c, 0.01);
+  CHECK(ws->getRaw(slot) == nullptr);
+  CHECK_FALSE(ws->redecode(slot));
+}
+#endif
+
+#if defined(WEATHERSENSOR_LOGICAL_IDS)
+static unsigned prefsWritesInRx;
+
+// getData() callback: receive next packet and record Preferences write accesses
+static void rxStepPrefs(void)
+{
+  rxStep();
+  prefsWritesInRx += mockPrefsWrites();
+}
+
+/*
+ * Logical sensor IDs: sensor learned after repeated reception,
+ * table stored in Preferences after getData() - not in the receive path
+ */
+TEST(TG_WeatherSensor, Test_LogicalIdsDeferredSave) {
+  uint8_t temp[MSG_BUF_SIZE];
+  msg6in1(temp, ID_WEATHER, false);
+
+  ws->setLogicalIds(true);
+  for (int i = 0; i < LOGICAL_ID_LEARN_MIN; i++)
+    rxQueueAdd(temp);
+  mockPrefsWrites() = 0;
+  prefsWritesInRx = 0;
+  CHECK_FALSE(ws->getData(1000, DATA_COMPLETE, 0, rxStepPrefs));
+  UNSIGNED_LONGS_EQUAL(LOGICAL_ID_LEARN_MIN, rxQueuePos);
+  UNSIGNED_LONGS_EQUAL(0, prefsWritesInRx);
+  UNSIGNED_LONGS_EQUAL(1, mockPrefsWrites());
+
+  Preferences prefs;
+  prefs.begin("BWS-CFG", true);
+  UNSIGNED_LONGS_EQUAL(2 + LOGICAL_ID_ENTRY_SIZE, prefs.getBytesLength("logids"));
+  prefs.end();
+
+  // Table not changed - not stored again
+  mockPrefsWrites() = 0;
+  ws->flushLogicalIds();
+  UNSIGNED_LONGS_EQUAL(0, mockPrefsWrites());
+}
+
+/*
+ * Logical sensor IDs: table in Preferences larger than LOGICAL_ID_IMAGE_SIZE
+ * is discarded, new table is learned and stored
+ */
+TEST(TG_WeatherSensor, Test_LogicalIdsOversizedPrefs) {
+  uint8_t blob[LOGICAL_ID_IMAGE_SIZE + 8];
+  memset(blob, 0x55, sizeof(blob));
+  Preferences prefs;
+  prefs.begin("BWS-CFG", false);
+  UNSIGNED_LONGS_EQUAL(sizeof(blob), prefs.putBytes("logids", blob, sizeof(blob)));
+  prefs.end();
+
+  uint8_t temp[MSG_BUF_SIZE];
+  msg6in1(temp, ID_WEATHER, false);
+
+  ws->setLogicalIds(true);
+  for (int i = 0; i < LOGICAL_ID_LEARN_MIN; i++)
+    rxQueueAdd(temp);
+  CHECK_FALSE(ws->getData(1000, DATA_COMPLETE, 0, rxStep));
+
+  prefs.begin("BWS-CFG", true);
+  UNSIGNED_LONGS_EQUAL(2 + LOGICAL_ID_ENTRY_SIZE, prefs.getBytesLength("logids"));
+  prefs.end();
+}
+#else
+/*
+ * Logical sensor IDs compiled out: IDs are not remapped, nothing is stored
+ */
+TEST(TG_WeatherSensor, Test_LogicalIdsNotAvailable) {
+  uint8_t temp[MSG_BUF_SIZE];
+  msg6in1(temp, ID_WEATHER, false);
+
+  ws->setLogicalIds(true);
+  for (int i = 0; i < LOGICAL_ID_LEARN_MIN; i++)
+    rxQueueAdd(temp);
+  mockPrefsWrites() = 0;
+  CHECK_FALSE(ws->getData(1000, DATA_COMPLETE, 0, rxStep));
+  UNSIGNED_LONGS_EQUAL(LOGICAL_ID_LEARN_MIN, rxQueuePos);
+  UNSIGNED_LONGS_EQUAL(0, mockPrefsWrites());
+  CHECK(findSlot(ID_WEATHER) > -1);
+
+  IdRemap ev;
+  CHECK_FALSE(ws->getIdRemap(ev));
+}
+#endif
+
+/*
+ * Checkpoint configuration with invalid list sizes - limited to MAX_SENSOR_IDS
+ */
+TEST(TG_WeatherSensor, Test_CheckpointConfigClamp) {
+  CheckpointConfig cfg = {};
+  cfg.maxSensors = 2;
+  cfg.rxFlags = DATA_COMPLETE;
+  cfg.enDecoders = 0xFF;
+  cfg.incCount = 200;
+  cfg.excCount = MAX_SENSOR_IDS + 1;
+  for (int i = 0; i < MAX_SENSOR_IDS; i++) {
+    cfg.inc[i] = 0x1000 + i;
+    cfg.exc[i] = 0x2000 + i;
+  }
+  ws->setCheckpointConfig(cfg);
+
+  CheckpointConfig out = {};
+  ws->getCheckpointConfig(out);
+  UNSIGNED_LONGS_EQUAL(MAX_SENSOR_IDS, out.incCount);
+  UNSIGNED_LONGS_EQUAL(MAX_SENSOR_IDS, out.excCount);
+  UNSIGNED_LONGS_EQUAL(0x1000 + MAX_SENSOR_IDS - 1, out.inc[MAX_SENSOR_IDS - 1]);
+  UNSIGNED_LONGS_EQUAL(0x2000 + MAX_SENSOR_IDS - 1, out.exc[MAX_SENSOR_IDS - 1]);
+}
+
+#if defined(WEATHERSENSOR_HEAP_FREE)
+/*
+ * Heap-free build profile: no allocation in getData() and the decoders
+ * after begin() (including the optional features enabled in the makefile)
+ */
+TEST(TG_WeatherSensor, Test_NoAllocInReceivePath) {
+  uint8_t temp[MSG_BUF_SIZE];
+  uint8_t rain[MSG_BUF_SIZE];
+  uint8_t msg5[MSG_BUF_SIZE];
+  msg6in1(temp, ID_WEATHER, false);
+  msg6in1(rain, ID_WEATHER, true);
+  msg5in1(msg5, ID_WEATHER5, 215);
+
+  ws->setLazyDecoding(true);
+  ws->setLogicalIds(true);
+  ws->clearRequired();
+  ws->requireId(ID_WEATHER);
+  ws->requireId(ID_WEATHER5);
+  for (int i = 0; i < LOGICAL_ID_LEARN_MIN; i++) {
+    rxQueueAdd(msg5);
+    rxQueueAdd(temp);
+  }
+  rxQueueAdd(rain);
+
+  AllocationCounter allocs;
+  allocs.start();
+  bool ok = ws->getData(10000, DATA_REQUIRED, 0, rxStep);
+  ws->clearSlots();
+  rxQueueClear();
+  rxQueueAdd(msg5);
+  bool ok5 = ws->getData(10000, DATA_COMPLETE, 0, rxStep);
+  UNSIGNED_LONGS_EQUAL(0, allocs.stop());
+
+  CHECK_TRUE(ok);
+  CHECK_TRUE(ok5);
+  int slot = findSlot(ID_WEATHER5);
+  CHECK(slot > -1);
+  DOUBLES_EQUAL(21.5, ws->sensor[slot].w.temp_c, 0.01);
+}
+#endif
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TornRecord.h
+//
+// CppUTest helper - sensor data records with all fields derived from a sequence number,
+// used to detect torn reads in concurrent producer/consumer tests
+//
+// https://github.com/matthias-bs/BresserWeatherSensorReceiver
+//
+//
+// created: 05/2025
+//
+//
+// MIT License
+//
+// Copyright (c) 2025 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20250508 Created (from TestSensorBus.cpp and TestSensorMailbox.cpp)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TORN_RECORD_H
+#define _TORN_RECORD_H
+
+#include <string.h>
+#include "SensorRecord.h"
+
+// Record with all fields derived from sequence number (detects torn reads)
+static inline SensorRecord record(uint32_t seq, uint32_t sensor_id, uint8_t kind = RECORD_KIND_WEATHER)
+{
+  SensorRecord rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.seq = seq;
+  rec.timestamp = ~seq;
+  rec.sensor_id = sensor_id;
+  rec.kind = kind;
+  rec.ok = RECORD_OK_RAIN;
+  rec.rain_mm = (float)(seq & 0xffff);
+  rec.pm_10 = seq & 0xffff;
+  rec.co2_ppm = seq & 0xffff;
+  rec.voc_level = seq & 0xff;
+  return rec;
+}
+
+// All fields consistent with the record's sequence number
+static inline bool intact(const SensorRecord &rec)
+{
+  return (rec.timestamp == ~rec.seq) &&
+         (rec.rain_mm == (float)(rec.seq & 0xffff)) &&
+         (rec.pm_10 == (rec.seq & 0xffff)) &&
+         (rec.co2_ppm == (rec.seq & 0xffff)) &&
+         (rec.voc_level == (rec.seq & 0xff));
+}
+
+#endif // _TORN_RECORD_H